@@ -20,6 +20,7 @@
 #include "APFloat.h"
 #include "DataType.h"
 
+#include <boost/functional/hash.hpp>
 #include <cassert>
 #include <numeric>
 #include <ostream>
@@ -105,6 +106,25 @@ bool APFloat::BitwiseCmp::cmpMpfrStructs (const mpfr_srcptr x, const mpfr_srcptr
     return std::memcmp (x->_mpfr_d, y->_mpfr_d, num_bytes) < 0;
 }
 
+bool APFloat::BitwiseEq::eqMpfrStructs (const mpfr_srcptr x, const mpfr_srcptr y) {
+    if (x->_mpfr_prec != y->_mpfr_prec) return false;
+    if (x->_mpfr_sign != y->_mpfr_sign) return false;
+    if (x->_mpfr_exp  != y->_mpfr_exp)  return false;
+    const size_t num_bytes = mpfr_custom_get_size (x->_mpfr_prec);
+    return std::memcmp (x->_mpfr_d, y->_mpfr_d, num_bytes) == 0;
+}
+
+size_t APFloat::BitwiseHash::hashMpfrStruct (const mpfr_srcptr x) {
+    size_t seed = 0;
+    boost::hash_combine (seed, x->_mpfr_prec);
+    boost::hash_combine (seed, x->_mpfr_sign);
+    boost::hash_combine (seed, x->_mpfr_exp);
+    const size_t num_bytes = mpfr_custom_get_size (x->_mpfr_prec);
+    const auto bytes = reinterpret_cast<const unsigned char*> (x->_mpfr_d);
+    boost::hash_range (seed, bytes, bytes + num_bytes);
+    return seed;
+}
+
 static_assert(sizeof(uint32_t) == sizeof(float) &&
               std::numeric_limits<float>::is_iec559,
               "uint32_t and float have different size. "
@@ -69,6 +69,24 @@ public: /* Types: */
         static bool cmpMpfrStructs (const mpfr_srcptr x, const mpfr_srcptr y);
     };
 
+    /// Equality consistent with BitwiseCmp.
+    struct BitwiseEq {
+        inline bool operator () (const APFloat& x, const APFloat& y) const {
+            return eqMpfrStructs (x.m_value, y.m_value);
+        }
+    private:
+        static bool eqMpfrStructs (const mpfr_srcptr x, const mpfr_srcptr y);
+    };
+
+    /// Hash consistent with BitwiseEq.
+    struct BitwiseHash {
+        inline size_t operator () (const APFloat& x) const {
+            return hashMpfrStruct (x.m_value);
+        }
+    private:
+        static size_t hashMpfrStruct (const mpfr_srcptr x);
+    };
+
 public: /* Methods: */
 
     explicit APFloat (prec_t p);
@@ -20,6 +20,7 @@
 #ifndef SECREC_APINT_H
 #define SECREC_APINT_H
 
+#include <boost/functional/hash.hpp>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -108,6 +109,7 @@ public: /* Methods: */
     friend bool operator < (APInt x, APInt y);
     friend bool operator == (APInt x, APInt y);
     friend bool operator != (APInt x, APInt y);
+    friend size_t hash_value (APInt x);
 
 private:
 
@@ -150,6 +152,13 @@ inline bool operator < (APInt x, APInt y) {
     return std::tie (x.m_numBits, x.m_bits) < std::tie (y.m_numBits, y.m_bits);
 }
 
+inline size_t hash_value (APInt x) {
+    size_t seed = 0;
+    boost::hash_combine (seed, x.m_numBits);
+    boost::hash_combine (seed, x.m_bits);
+    return seed;
+}
+
 } // namespace SecreC
 
 #endif // SECREC_APINT_H
@@ -223,7 +223,7 @@ Symbol * CodeGen::getSizeOr(Symbol * sym, uint64_t val) {
 }
 
 SymbolConstant * CodeGen::indexConstant(uint64_t value) {
-    return ConstantInt::get(DATATYPE_UINT64, value);
+    return ConstantInt::get(getContext(), DATATYPE_UINT64, value);
 }
 
 Symbol* CodeGen::findIdentifier (SymbolCategory type, const TreeNodeIdentifier* id) const {
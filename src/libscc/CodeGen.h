@@ -196,6 +196,8 @@ public: /* Methods: */
     CodeGen (ICodeList& code, ICode& icode, Location::PathStyle pathStyle);
     ~CodeGen ();
 
+    const TypeChecker& typeChecker () const { return *m_tyChecker; }
+
     CGResult codeGen (TreeNodeExpr* e);
     CGBranchResult codeGenBranch (TreeNodeExpr* e);
     CGStmtResult codeGenStmt (TreeNodeStmt* s);
@@ -444,6 +446,9 @@ private:
                      TreeNodeExpr * e,
                      Symbol * eArgRes,
                      Symbol * size);
+    SymbolSymbol* newOffsetVector(CGResult & result,
+                                  TreeNodeExpr * e,
+                                  Symbol * size);
     void cgBinExprShapeCheck(TreeNodeExpr * e,
                              Symbol * e1result,
                              Symbol * e2result,
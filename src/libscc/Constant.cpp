@@ -24,12 +24,10 @@
 #include "DataType.h"
 #include "Types.h"
 
-#include <array>
 #include <cstring>
 #include <sharemind/ToUnsigned.h>
 #include <sstream>
 #include <string>
-#include <map>
 
 namespace SecreC {
 
@@ -61,19 +59,19 @@ unsigned widthInBits (SecrecDataType type) {
 
 SymbolConstant* defaultConstant (Context& cxt, SecrecDataType ty) {
     switch (ty) {
-    case DATATYPE_BOOL: return ConstantInt::getBool (false);
+    case DATATYPE_BOOL: return ConstantInt::getBool (cxt, false);
     case DATATYPE_STRING: return ConstantString::get (cxt, "");
     default:
         if (isNumericDataType (ty)) {
-            return numericConstant (ty, 0);
+            return numericConstant (cxt, ty, 0);
         }
     }
 
     return nullptr;
 }
 
-SymbolConstant* numericConstant (SecrecDataType ty, uint64_t value) {
-    return numericConstant (DataTypeBuiltinPrimitive::get (ty), value);
+SymbolConstant* numericConstant (Context& cxt, SecrecDataType ty, uint64_t value) {
+    return numericConstant (cxt, DataTypeBuiltinPrimitive::get (ty), value);
 }
 
 SymbolConstant* defaultConstant (Context& cxt, const DataType* ty) {
@@ -81,31 +79,27 @@ SymbolConstant* defaultConstant (Context& cxt, const DataType* ty) {
     return defaultConstant (cxt, static_cast<const DataTypeBuiltinPrimitive*>(ty)->secrecDataType ());
 }
 
-SymbolConstant* numericConstant (const DataType* ty, uint64_t value) {
+SymbolConstant* numericConstant (Context& cxt, const DataType* ty, uint64_t value) {
     assert (ty != nullptr && isNumericDataType (ty));
     if (isFloatingDataType (ty))
-        return ConstantFloat::get (ty, value);
+        return ConstantFloat::get (cxt, ty, value);
     else
-        return ConstantInt::get (ty, value);
+        return ConstantInt::get (cxt, ty, value);
 }
 
 /*******************************************************************************
   ConstantInt
 *******************************************************************************/
 
-ConstantInt* ConstantInt::get (const DataType* type, uint64_t value) {
+ConstantInt* ConstantInt::get (Context& cxt, const DataType* type, uint64_t value) {
     assert (type != nullptr && type->isBuiltinPrimitive ());
     const auto primDataType = static_cast<const DataTypeBuiltinPrimitive*>(type);
-    return ConstantInt::get (primDataType->secrecDataType (), value);
+    return ConstantInt::get (cxt, primDataType->secrecDataType (), value);
 }
 
-// TODO: use flyweight
 // TODO: const correctness
-ConstantInt* ConstantInt::get (SecrecDataType type, uint64_t value) {
-    using NumericConstantMap = std::map<APInt, ConstantInt>;
-    static std::array<NumericConstantMap, 2> numericConstants; // 0 - unsigned, 1 - signed
-
-    NumericConstantMap& map = numericConstants[isSignedNumericDataType(type)];
+ConstantInt* ConstantInt::get (Context& cxt, SecrecDataType type, uint64_t value) {
+    auto& map = cxt.pImpl ()->m_numericConstants[isSignedNumericDataType(type)];
     const APInt apvalue (widthInBits (type), value);
     auto it = map.find (apvalue);
     if (it == map.end ()) {
@@ -117,8 +111,8 @@ ConstantInt* ConstantInt::get (SecrecDataType type, uint64_t value) {
     return &it->second;
 }
 
-ConstantInt* ConstantInt::getBool (bool value) {
-    return ConstantInt::get (DATATYPE_BOOL, value);
+ConstantInt* ConstantInt::getBool (Context& cxt, bool value) {
+    return ConstantInt::get (cxt, DATATYPE_BOOL, value);
 }
 
 void ConstantInt::print (std::ostream &os) const {
@@ -135,20 +129,17 @@ void ConstantInt::print (std::ostream &os) const {
   ConstantFloat
 *******************************************************************************/
 
-ConstantFloat* ConstantFloat::get (const DataType* type, uint64_t value) {
-    return get (type, APFloat (floatPrec (type), value));
+ConstantFloat* ConstantFloat::get (Context& cxt, const DataType* type, uint64_t value) {
+    return get (cxt, type, APFloat (floatPrec (type), value));
 }
 
-ConstantFloat* ConstantFloat::get (const DataType* type, StringRef str) {
-    return get (type, APFloat (floatPrec (type), str));
+ConstantFloat* ConstantFloat::get (Context& cxt, const DataType* type, StringRef str) {
+    return get (cxt, type, APFloat (floatPrec (type), str));
 }
 
-// TODO: use flyweight
 // TODO: const correctness
-ConstantFloat* ConstantFloat::get (const DataType* type, const APFloat& value) {
-    using FloatConstantMap = std::map<APFloat, ConstantFloat, APFloat::BitwiseCmp>;
-    static FloatConstantMap floatConstants;
-
+ConstantFloat* ConstantFloat::get (Context& cxt, const DataType* type, const APFloat& value) {
+    auto& floatConstants = cxt.pImpl ()->m_floatConstants;
     auto it = floatConstants.find (value);
     if (it == floatConstants.end ()) {
         const auto f = ConstantFloat (TypeBasic::get (type), value);
@@ -166,12 +157,9 @@ void ConstantFloat::print (std::ostream &os) const
   ConstantString
 *******************************************************************************/
 
-// TODO: use flyweight
 // TODO: const correctness
 ConstantString* ConstantString::get (Context& cxt, StringRef str) {
-    using ConstantStringMap = std::map<StringRef, ConstantString>;
-    static ConstantStringMap stringLiterals;
-
+    auto& stringLiterals = cxt.pImpl ()->m_stringLiterals;
     auto it = stringLiterals.find (str);
     if (it == stringLiterals.end ()) {
         // Make sure that the string is allocated in the table
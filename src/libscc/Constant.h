@@ -35,10 +35,10 @@ namespace SecreC {
 class Context;
 
 SymbolConstant* defaultConstant (Context& cxt, SecrecDataType ty);
-SymbolConstant* numericConstant (SecrecDataType ty, uint64_t value);
+SymbolConstant* numericConstant (Context& cxt, SecrecDataType ty, uint64_t value);
 
 SymbolConstant* defaultConstant (Context& cxt, const DataType* ty);
-SymbolConstant* numericConstant (const DataType* ty, uint64_t value);
+SymbolConstant* numericConstant (Context& cxt, const DataType* ty, uint64_t value);
 
 /******************************************************************
   ConstantInt
@@ -53,9 +53,9 @@ private: /* Methods: */
 
 public:
 
-    static ConstantInt* get (SecrecDataType type, uint64_t value);
-    static ConstantInt* get (const DataType* type, uint64_t value);
-    static ConstantInt* getBool (bool value);
+    static ConstantInt* get (Context& cxt, SecrecDataType type, uint64_t value);
+    static ConstantInt* get (Context& cxt, const DataType* type, uint64_t value);
+    static ConstantInt* getBool (Context& cxt, bool value);
 
     const APInt& value () const { return m_value; }
 
@@ -80,9 +80,9 @@ private: /* Methods: */
 
 public:
 
-    static ConstantFloat* get (const DataType* type, uint64_t value);
-    static ConstantFloat* get (const DataType* type, StringRef str);
-    static ConstantFloat* get (const DataType* type, const APFloat& value);
+    static ConstantFloat* get (Context& cxt, const DataType* type, uint64_t value);
+    static ConstantFloat* get (Context& cxt, const DataType* type, StringRef str);
+    static ConstantFloat* get (Context& cxt, const DataType* type, const APFloat& value);
 
     const APFloat& value () const { return m_value; }
 
@@ -20,16 +20,58 @@
 #ifndef CONTEXT_IMPL_H
 #define CONTEXT_IMPL_H
 
+#include "Constant.h"
+#include "DataType.h"
+#include "SecurityType.h"
 #include "StringTable.h"
+#include "TypeArgument.h"
+
+#include <array>
+#include <boost/functional/hash.hpp>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace SecreC {
 
+class SymbolKind;
+
+/**
+ * Everything interned while compiling with a Context lives here, so that
+ * independent contexts can be used from different threads and all of it is
+ * released together with the context. Only types that are keyed on builtin
+ * data or other interned pointers are still shared process-wide.
+ */
 class ContextImpl {
 private:
 
     ContextImpl (const ContextImpl&) = delete;
     ContextImpl& operator = (const ContextImpl&) = delete;
 
+public: /* Types: */
+
+    using NumericConstantMap =
+        std::unordered_map<APInt, ConstantInt, boost::hash<APInt> >;
+    using FloatConstantMap =
+        std::unordered_map<APFloat, ConstantFloat,
+                           APFloat::BitwiseHash, APFloat::BitwiseEq>;
+    using ConstantStringMap =
+        std::unordered_map<StringRef, ConstantString>;
+
+    using UserPrimitiveTypeMap =
+        std::unordered_map<StringRef, std::unique_ptr<const DataTypeUserPrimitive> >;
+    using PrivateSecTypeKey = std::pair<StringRef, SymbolKind*>;
+    using PrivateSecTypeMap =
+        std::unordered_map<PrivateSecTypeKey,
+                           std::unique_ptr<const PrivateSecType>,
+                           boost::hash<PrivateSecTypeKey> >;
+    using StructTypeKey = std::pair<StringRef, std::vector<TypeArgument> >;
+    using StructTypeMap =
+        std::unordered_map<StructTypeKey,
+                           std::unique_ptr<const DataTypeStruct>,
+                           boost::hash<StructTypeKey> >;
+
 public: /* Methods: */
 
     ContextImpl () { }
@@ -42,6 +84,16 @@ public: /* Fields: */
 
     /* Strings: */
     StringTable m_stringTable;
+
+    /* Constants: */
+    std::array<NumericConstantMap, 2> m_numericConstants; // 0 - unsigned, 1 - signed
+    FloatConstantMap m_floatConstants;
+    ConstantStringMap m_stringLiterals;
+
+    /* Types: */
+    UserPrimitiveTypeMap m_userPrimitiveTypes;
+    PrivateSecTypeMap m_privateSecTypes;
+    StructTypeMap m_structTypes;
 };
 
 } // namespace SecreC
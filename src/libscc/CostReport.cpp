@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "CostReport.h"
+
+#include "Blocks.h"
+#include "PrettyPrint.h"
+#include "SecurityType.h"
+#include "Symbol.h"
+#include "SyscallName.h"
+#include "Types.h"
+#include "VirtualMachineSyscalls.h"
+#include "analysis/ConstantFolding.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+
+
+namespace SecreC {
+
+namespace /* anonymous */ {
+
+std::string procedureName (const Procedure& proc) {
+    const SymbolProcedure* sym = proc.name ();
+    if (sym == nullptr)
+        return "<entry>";
+
+    std::ostringstream os;
+    os << sym->procedureName () << '(';
+    const auto procType = static_cast<const TypeProc*>(sym->secrecType ());
+    bool first = true;
+    for (const TypeBasic* argType : procType->paramTypes ()) {
+        if (! first)
+            os << ", ";
+        first = false;
+        os << PrettyPrint (argType);
+    }
+
+    os << ')';
+    return os.str ();
+}
+
+/// Rounds of a call that is not in the cost table.
+std::uint64_t defaultRounds (const Imop& imop) {
+    switch (imop.type ()) {
+    case Imop::SYSCALL:
+    case Imop::DECLASSIFY:
+        return 1u;
+    case Imop::CLASSIFY:
+        return imop.isVectorized () ? 1u : 0u;
+    default:
+        // Allocating, copying and moving values within a protection domain:
+        return 0u;
+    }
+}
+
+bool isNumber (const std::string& str) {
+    return ! str.empty () && std::all_of (str.begin (), str.end (),
+        [](char c) { return std::isdigit (static_cast<unsigned char> (c)); });
+}
+
+void writeString (std::ostream& os, const std::string& str) {
+    os << '"';
+    for (char c : str) {
+        switch (c) {
+        case '"':  os << "\\\""; break;
+        case '\\': os << "\\\\"; break;
+        case '\n': os << "\\n";  break;
+        case '\t': os << "\\t";  break;
+        default:
+            if (static_cast<unsigned char> (c) < 0x20) {
+                os << "\\u" << std::hex << std::setw (4) << std::setfill ('0')
+                   << static_cast<int> (c) << std::dec << std::setfill (' ');
+            }
+            else {
+                os << c;
+            }
+        }
+    }
+
+    os << '"';
+}
+
+void writeCounters (std::ostream& os, const CostReport::Counters& c) {
+    os << "\"calls\": " << c.calls
+       << ", \"rounds\": " << c.rounds
+       << ", \"elements\": " << c.elements
+       << ", \"sizes\": [";
+    bool first = true;
+    for (const std::string& size : c.sizes) {
+        if (! first)
+            os << ", ";
+        first = false;
+        writeString (os, size);
+    }
+
+    os << ']';
+}
+
+void writeSyscalls (std::ostream& os, const CostReport::SyscallMap& syscalls,
+                    const char* indent)
+{
+    CostReport::Counters total;
+    os << "{\n" << indent << "  \"syscalls\": {";
+    bool first = true;
+    for (const auto& p : syscalls) {
+        os << (first ? "\n" : ",\n") << indent << "    ";
+        first = false;
+        writeString (os, p.first);
+        os << ": {\"kind\": ";
+        writeString (os, p.second.kind);
+        os << ", \"type\": ";
+        writeString (os, p.second.type);
+        os << ", ";
+        writeCounters (os, p.second.counters);
+        os << '}';
+        total += p.second.counters;
+    }
+
+    if (! first)
+        os << '\n' << indent << "  ";
+    os << "},\n";
+    os << indent << "  \"total\": {";
+    writeCounters (os, total);
+    os << "}\n" << indent << '}';
+}
+
+} // anonymous namespace
+
+/*******************************************************************************
+  CostReport
+*******************************************************************************/
+
+CostReport::Counters& CostReport::Counters::operator += (const Counters& other) {
+    calls += other.calls;
+    rounds += other.rounds;
+    elements += other.elements;
+    sizes.insert (other.sizes.begin (), other.sizes.end ());
+    return *this;
+}
+
+void CostReport::compute (const Program& program, const ConstantFolding& cf,
+                          const SyscallCostTable* costs)
+{
+    m_procedures.clear ();
+    m_index.clear ();
+
+    for (const Procedure& proc : program) {
+        m_index[&proc] = m_procedures.size ();
+        m_procedures.emplace_back ();
+        m_procedures.back ().name = procedureName (proc);
+    }
+
+    if (! program.empty ())
+        m_entry = m_index[program.entryBlock ()->proc ()];
+
+    for (const Procedure& proc : program) {
+        ProcedureCosts& out = m_procedures[m_index[&proc]];
+        for (const Block& block : proc) {
+            cf.visitBlock (block, [&](const Imop& imop, const ConstantFolding::ValueOf& valueOf) {
+                if (imop.type () == Imop::CALL) {
+                    ++ out.callees[m_index[imop.callDest ()->block ()->proc ()]];
+                    return;
+                }
+
+                for (const PrivateSyscall& call : privateSyscalls (imop)) {
+                    Syscall& syscall = out.self[call.name];
+                    const auto secTy = static_cast<const PrivateSecType*> (call.type->secrecSecType ());
+                    syscall.kind = secTy->securityKind ()->name ();
+                    syscall.type = (SyscallName () << call.type->secrecDataType ()).str ();
+
+                    Counters& c = syscall.counters;
+                    ++ c.calls;
+
+                    const SyscallCostTable::Cost* cost = costs ? costs->find (call.name) : nullptr;
+                    c.rounds += cost ? cost->rounds : defaultRounds (imop);
+
+                    std::string size = "1";
+                    if (call.size != nullptr) {
+                        const Value value = valueOf (call.size);
+                        size = value.isConst () ? value.toString () : call.size->name ();
+                    }
+
+                    if (isNumber (size))
+                        c.elements += std::stoull (size);
+                    c.sizes.insert (size);
+                }
+            });
+        }
+    }
+
+    std::vector<int> state (m_procedures.size (), 0);
+    for (size_t i = 0; i < m_procedures.size (); ++ i)
+        inclusive (i, state);
+}
+
+/// Visits callees depth-first, state is 0 if not visited, 1 if on the stack and 2 if done.
+const CostReport::SyscallMap& CostReport::inclusive (size_t i, std::vector<int>& state) {
+    ProcedureCosts& proc = m_procedures[i];
+    if (state[i] != 0)
+        return proc.inclusive;
+
+    state[i] = 1;
+    proc.inclusive = proc.self;
+    for (const auto& callee : proc.callees) {
+        const size_t j = callee.first;
+        if (state[j] == 1) {
+            proc.recursive = true;
+            continue;
+        }
+
+        for (const auto& p : inclusive (j, state)) {
+            Syscall& syscall = proc.inclusive[p.first];
+            syscall.kind = p.second.kind;
+            syscall.type = p.second.type;
+            for (unsigned k = 0; k < callee.second; ++ k)
+                syscall.counters += p.second.counters;
+        }
+    }
+
+    state[i] = 2;
+    return proc.inclusive;
+}
+
+void CostReport::writeJson (std::ostream& os) const {
+    os << "{\n  \"program\": ";
+    if (! m_procedures.empty ())
+        writeSyscalls (os, m_procedures[m_entry].inclusive, "  ");
+    else
+        os << "{}";
+
+    os << ",\n  \"procedures\": [";
+    bool first = true;
+    for (const ProcedureCosts& proc : m_procedures) {
+        os << (first ? "\n" : ",\n") << "    {\n      \"name\": ";
+        first = false;
+        writeString (os, proc.name);
+        os << ",\n      \"recursive\": " << (proc.recursive ? "true" : "false");
+        os << ",\n      \"calls\": [";
+        bool firstCallee = true;
+        for (const auto& callee : proc.callees) {
+            if (! firstCallee)
+                os << ", ";
+            firstCallee = false;
+            writeString (os, m_procedures[callee.first].name);
+        }
+
+        os << "],\n      \"self\": ";
+        writeSyscalls (os, proc.self, "      ");
+        os << ",\n      \"inclusive\": ";
+        writeSyscalls (os, proc.inclusive, "      ");
+        os << "\n    }";
+    }
+
+    os << (first ? "]\n" : "\n  ]\n") << "}\n";
+}
+
+} // namespace SecreC
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SECREC_COST_REPORT_H
+#define SECREC_COST_REPORT_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace SecreC {
+
+class ConstantFolding;
+class Procedure;
+class Program;
+class SyscallCostTable;
+
+/*******************************************************************************
+  CostReport
+*******************************************************************************/
+
+/**
+ * Static estimate of the private system calls a program makes, computed
+ * without running it. Every call site is counted once, calls in loops are
+ * not multiplied by the number of iterations. Rounds are summed as if no
+ * two calls were performed in parallel.
+ */
+class CostReport {
+public: /* Types: */
+
+    struct Counters {
+        std::uint64_t calls = 0u;
+        std::uint64_t rounds = 0u;
+        std::uint64_t elements = 0u;    ///< Elements of calls with known sizes.
+        std::set<std::string> sizes;    ///< Known and symbolic vector sizes.
+
+        Counters& operator += (const Counters& other);
+    };
+
+    struct Syscall {
+        std::string kind;       ///< Protection domain kind.
+        std::string type;       ///< Data type of the private operands.
+        Counters counters;
+    };
+
+    using SyscallMap = std::map<std::string, Syscall>;
+
+    struct ProcedureCosts {
+        std::string name;
+        SyscallMap self;        ///< Calls in the procedure.
+        SyscallMap inclusive;   ///< Calls in the procedure and the ones it calls.
+        std::map<size_t, unsigned> callees; ///< Indices of the called procedures to call sites.
+        bool recursive = false; ///< Calls of the cycle are not included.
+    };
+
+public: /* Methods: */
+
+    /**
+     * \param cf constant folding analysis, run on the program, to find the
+     *           sizes of vectors
+     * \param costs rounds of system calls, if nullptr only the calls of
+     *        protection domain operations count for a round each
+     */
+    void compute (const Program& program, const ConstantFolding& cf,
+                  const SyscallCostTable* costs);
+
+    const std::vector<ProcedureCosts>& procedures () const { return m_procedures; }
+
+    /// Writes the report as a JSON object.
+    void writeJson (std::ostream& os) const;
+
+private:
+
+    const SyscallMap& inclusive (size_t i, std::vector<int>& state);
+
+private: /* Fields: */
+    std::vector<ProcedureCosts>           m_procedures;
+    std::map<const Procedure*, size_t>    m_index;
+    size_t                                m_entry = 0u; ///< Procedure the program starts from.
+};
+
+} /* namespace SecreC */
+
+#endif // SECREC_COST_REPORT_H
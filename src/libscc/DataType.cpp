@@ -30,8 +30,8 @@
 
 #include <boost/flyweight.hpp>
 #include <boost/flyweight/key_value.hpp>
-#include <boost/flyweight/no_locking.hpp>
 #include <boost/flyweight/no_tracking.hpp>
+#include <boost/flyweight/simple_locking.hpp>
 
 namespace SecreC {
 
@@ -384,7 +384,7 @@ const DataTypeBuiltinPrimitive* DataTypeBuiltinPrimitive::get (SecrecDataType da
     using namespace ::boost::flyweights;
     using fw_t = flyweight<
         key_value<SecrecDataType, DataTypeBuiltinPrimitive>,
-        no_locking, no_tracking>;
+        simple_locking, no_tracking>;
     return &fw_t{dataType}.get();
 }
 
@@ -405,12 +405,16 @@ void DataTypeUserPrimitive::print (std::ostream& os) const {
     os << m_name;
 }
 
-const DataTypeUserPrimitive* DataTypeUserPrimitive::get (StringRef name)
+const DataTypeUserPrimitive* DataTypeUserPrimitive::get (Context& cxt, StringRef name)
 {
-    using namespace ::boost::flyweights;
-    using fw_t = flyweight<key_value<StringRef, DataTypeUserPrimitive>,
-                           no_locking, no_tracking>;
-    return &fw_t{name}.get();
+    auto& userPrimitiveTypes = cxt.pImpl ()->m_userPrimitiveTypes;
+    auto it = userPrimitiveTypes.find (name);
+    if (it == userPrimitiveTypes.end ()) {
+        it = userPrimitiveTypes.emplace (name,
+            std::unique_ptr<DataTypeUserPrimitive>{new DataTypeUserPrimitive {name}}).first;
+    }
+
+    return it->second.get ();
 }
 
 bool DataTypeUserPrimitive::equals (const DataType* other) const {
@@ -442,15 +446,12 @@ void DataTypeStruct::print (std::ostream& os) const {
     }
 }
 
-const DataTypeStruct* DataTypeStruct::get (StringRef name,
+const DataTypeStruct* DataTypeStruct::get (Context& cxt,
+                                           StringRef name,
                                            const DataTypeStruct::FieldList& fields,
                                            const DataTypeStruct::TypeArgumentList& args)
 {
-    using StructTypeMap = std::map<
-        std::pair<StringRef, std::vector<TypeArgument> >,
-        std::unique_ptr<const DataTypeStruct> >;
-    static StructTypeMap structTypes;
-
+    auto& structTypes = cxt.pImpl ()->m_structTypes;
     const auto index = std::make_pair(name, args);
     auto it = structTypes.find(index);
     if (it == structTypes.end()) {
@@ -152,7 +152,7 @@ public: /* Methods: */
         , m_name (name)
     { }
 
-    static const DataTypeUserPrimitive* get (StringRef name);
+    static const DataTypeUserPrimitive* get (Context& cxt, StringRef name);
 
     StringRef name () const { return m_name; }
 
@@ -189,7 +189,8 @@ public: /* Methods: */
 
     StringRef name () const { return m_name; }
 
-    static const DataTypeStruct* get (StringRef name,
+    static const DataTypeStruct* get (Context& cxt,
+        StringRef name,
         const FieldList& fields,
         const TypeArgumentList& typeArgs = TypeArgumentList());
 
@@ -21,7 +21,9 @@
 
 #include "Intermediate.h"
 
-#include <functional>
+#include <algorithm>
+#include <boost/dynamic_bitset.hpp>
+#include <chrono>
 #include <thread>
 #include <vector>
 
@@ -30,29 +32,155 @@ namespace SecreC {
 
 namespace /* anonymous */ {
 
+using BlockSet = DataFlowAnalysis::BlockSet;
+using Statistics = DataFlowAnalysisRunner::Statistics;
+
+/**
+ * Worklist of blocks indexed by their depth-first numbers. The blocks are
+ * visited in rounds: the cursor walks over the blocks of the current round in
+ * the order of DFNs, and the blocks added meanwhile wait for the next round.
+ * All storage is allocated up front.
+ */
+class WorkList {
+private: /* Types: */
+    using Bits = boost::dynamic_bitset<>;
+
+public: /* Methods: */
+
+    WorkList (const Program& program, bool descending)
+        : m_descending (descending)
+        , m_cursor (0)
+        , m_rounds (0)
+    {
+        size_t maxDfn = 0;
+        FOREACH_BLOCK (bi, program) {
+            if (bi->reachable ()) {
+                maxDfn = std::max (maxDfn, bi->dfn ());
+            }
+        }
+
+        m_blocks.resize (maxDfn + 1, nullptr);
+        FOREACH_BLOCK (bi, program) {
+            if (bi->reachable ()) {
+                assert (m_blocks[slot (*bi)] == nullptr &&
+                        "Reachable blocks must have distinct DFNs!");
+                m_blocks[slot (*bi)] = &*bi;
+            }
+        }
+
+        m_current.resize (m_blocks.size ());
+        m_next.resize (m_blocks.size ());
+    }
+
+    /// Adds a block to the current round.
+    void insert (const Block& block) {
+        if (block.reachable ())
+            m_current.set (slot (block));
+    }
+
+    /// Adds a block to the next round.
+    void defer (const Block& block) {
+        if (block.reachable ())
+            m_next.set (slot (block));
+    }
+
+    /// \returns the next block to visit or nullptr if the list is exhausted.
+    const Block* pop () {
+        size_t i = m_rounds == 0 ? Bits::npos : m_current.find_next (m_cursor);
+        if (i == Bits::npos) {
+            // Start the next round:
+            if (m_rounds > 0)
+                m_current.swap (m_next);
+
+            i = m_current.find_first ();
+            if (i == Bits::npos)
+                return nullptr;
+
+            ++ m_rounds;
+        }
+
+        m_current.reset (i);
+        m_cursor = i;
+        return m_blocks[i];
+    }
+
+    size_t rounds () const { return m_rounds; }
+
+private:
+
+    size_t slot (const Block& block) const {
+        return m_descending ? m_blocks.size () - 1 - block.dfn () : block.dfn ();
+    }
+
+private: /* Fields: */
+    const bool                 m_descending;
+    std::vector<const Block*>  m_blocks;
+    Bits                       m_current;
+    Bits                       m_next;
+    size_t                     m_cursor;
+    size_t                     m_rounds;
+};
+
 template <class Analysis>
 class AnalysisRunner {
 public: /* Methods: */
-    AnalysisRunner (Analysis& a, const Program& p)
+    AnalysisRunner (Analysis& a, const Program& p, const BlockSet* region,
+                    Statistics& stats)
         : m_analysis (a)
         , m_program (p)
+        , m_region (region)
+        , m_stats (stats)
     { }
 
-    template <typename WorkList>
+    void populateWorkList (WorkList& list, const BlockSet& region) const {
+        for (const Block* block : region) {
+            list.insert (*block);
+        }
+    }
+
     void populateWorkList (WorkList& list) const {
         FOREACH_BLOCK (blockIt, m_program) {
-            const Block& block = *blockIt;
-            if (block.reachable ()) {
-                list.insert (std::cref (block));
-            }
+            list.insert (*blockIt);
         }
     }
 
+    void record (const WorkList& list, size_t blocks,
+                 std::chrono::steady_clock::time_point startTime) const
+    {
+        ++ m_stats.runs;
+        m_stats.rounds += list.rounds ();
+        m_stats.blocks += blocks;
+        m_stats.time += std::chrono::steady_clock::now () - startTime;
+    }
+
 protected: /* Fields: */
-    Analysis&       m_analysis;
-    const Program&  m_program;
+    Analysis&        m_analysis;
+    const Program&   m_program;
+    const BlockSet*  m_region;
+    Statistics&      m_stats;
 };
 
+/// Blocks from which the changed blocks can be reached along the given edges.
+template <typename Edges>
+BlockSet affectedRegion (const BlockSet& changed, Edges edges) {
+    BlockSet region;
+    std::vector<const Block*> todo (changed.begin (), changed.end ());
+    while (! todo.empty ()) {
+        const Block* block = todo.back ();
+        todo.pop_back ();
+        if (! region.insert (block).second)
+            continue;
+
+        for (const auto& edge : edges (*block)) {
+            if (region.count (edge.first) == 0) {
+                todo.push_back (edge.first);
+            }
+        }
+    }
+
+    return region;
+}
+
 } // namespace anonymous
 
 /*******************************************************************************
@@ -61,47 +189,43 @@ protected: /* Fields: */
 
 class ForwardAnalysisRunner : AnalysisRunner<ForwardDataFlowAnalysis> {
 private: /* Types: */
-    struct BlockCmp {
-        inline bool operator () (const Block& b1, const Block& b2) const {
-            return b1.dfn () > b2.dfn ();
-        }
-    };
-
-    using WorkList = std::set<std::reference_wrapper<const Block>, BlockCmp>;
     using Base = AnalysisRunner<ForwardDataFlowAnalysis>;
 
 public: /* Methods: */
 
-    ForwardAnalysisRunner (ForwardDataFlowAnalysis& a, const Program& p)
-        : AnalysisRunner<ForwardDataFlowAnalysis> (a, p)
+    ForwardAnalysisRunner (ForwardDataFlowAnalysis& a, const Program& p,
+                           const BlockSet* region, Statistics& stats)
+        : AnalysisRunner<ForwardDataFlowAnalysis> (a, p, region, stats)
     { }
 
     inline void operator () () const {
-        WorkList current, next;
-        Base::populateWorkList (current);
-        m_analysis.start (m_program);
-        while (! current.empty ()) {
-            auto i = current.begin ();
-            const Block& cur = *i;
-            current.erase (i);
-            if (! cur.reachable ()) continue;
-            m_analysis.startBlock (cur);
-            for (const auto& edge : cur.predecessors ()) {
-                m_analysis.inFrom (*edge.first, edge.second, cur);
-            }
+        const auto startTime = std::chrono::steady_clock::now ();
+        WorkList list (m_program, true);
+        if (m_region != nullptr && m_analysis.startRegion (m_program, *m_region)) {
+            Base::populateWorkList (list, *m_region);
+        }
+        else {
+            Base::populateWorkList (list);
+            m_analysis.start (m_program);
+        }
 
-            if (m_analysis.finishBlock (cur)) {
-                for (const auto& edge : cur.successors ()) {
-                    next.insert (std::cref (*edge.first));
-                }
+        size_t blocks = 0;
+        while (const Block* cur = list.pop ()) {
+            ++ blocks;
+            m_analysis.startBlock (*cur);
+            for (const auto& edge : cur->predecessors ()) {
+                m_analysis.inFrom (*edge.first, edge.second, *cur);
             }
 
-            if (current.empty ()) {
-                std::swap (current, next);
+            if (m_analysis.finishBlock (*cur)) {
+                for (const auto& edge : cur->successors ()) {
+                    list.defer (*edge.first);
+                }
             }
         }
 
         m_analysis.finish ();
+        Base::record (list, blocks, startTime);
     }
 };
 
@@ -111,48 +235,43 @@ public: /* Methods: */
 
 class BackwardAnalysisRunner : AnalysisRunner<BackwardDataFlowAnalysis> {
 private: /* Types: */
-
-    struct BlockCmp {
-        inline bool operator () (const Block& b1, const Block& b2) const {
-            return b1.dfn () < b2.dfn ();
-        }
-    };
-
-    using WorkList = std::set<std::reference_wrapper<const Block>, BlockCmp>;
     using Base = AnalysisRunner<BackwardDataFlowAnalysis>;
 
 public: /* Methods: */
 
-    BackwardAnalysisRunner (BackwardDataFlowAnalysis& a, const Program& p)
-        : AnalysisRunner<BackwardDataFlowAnalysis> (a, p)
+    BackwardAnalysisRunner (BackwardDataFlowAnalysis& a, const Program& p,
+                            const BlockSet* region, Statistics& stats)
+        : AnalysisRunner<BackwardDataFlowAnalysis> (a, p, region, stats)
     { }
 
     inline void operator () () const {
-        WorkList current, next;
-        Base::populateWorkList (current);
-        m_analysis.start (m_program);
-        while (! current.empty ()) {
-            auto i = current.begin ();
-            const Block& cur = *i;
-            current.erase (i);
-            if (! cur.reachable ()) continue;
-            m_analysis.startBlock (cur);
-            for (const auto& edge : cur.successors ()) {
-                m_analysis.outTo (*edge.first, edge.second, cur);
-            }
+        const auto startTime = std::chrono::steady_clock::now ();
+        WorkList list (m_program, false);
+        if (m_region != nullptr && m_analysis.startRegion (m_program, *m_region)) {
+            Base::populateWorkList (list, *m_region);
+        }
+        else {
+            Base::populateWorkList (list);
+            m_analysis.start (m_program);
+        }
 
-            if (m_analysis.finishBlock (cur)) {
-                for (const auto& edge : cur.predecessors ()) {
-                    next.insert (std::cref (*edge.first));
-                }
+        size_t blocks = 0;
+        while (const Block* cur = list.pop ()) {
+            ++ blocks;
+            m_analysis.startBlock (*cur);
+            for (const auto& edge : cur->successors ()) {
+                m_analysis.outTo (*edge.first, edge.second, *cur);
             }
 
-            if (current.empty ()) {
-                std::swap (current, next);
+            if (m_analysis.finishBlock (*cur)) {
+                for (const auto& edge : cur->predecessors ()) {
+                    list.defer (*edge.first);
+                }
             }
         }
 
         m_analysis.finish ();
+        Base::record (list, blocks, startTime);
     }
 };
 
@@ -161,19 +280,44 @@ public: /* Methods: */
 *******************************************************************************/
 
 DataFlowAnalysisRunner& DataFlowAnalysisRunner::run (const Program &pr) {
+    return run (pr, nullptr, nullptr);
+}
+
+DataFlowAnalysisRunner& DataFlowAnalysisRunner::update (const Program& pr,
+                                                        const BlockSet& changed)
+{
+    // Changes propagate forward to the successors and backward to the
+    // predecessors of the modified blocks:
+    const BlockSet forwardRegion = affectedRegion (changed,
+        [](const Block& b) -> const Block::CFGBase::NeighbourMap& { return b.successors (); });
+    const BlockSet backwardRegion = affectedRegion (changed,
+        [](const Block& b) -> const Block::CFGBase::NeighbourMap& { return b.predecessors (); });
+    return run (pr, &forwardRegion, &backwardRegion);
+}
+
+DataFlowAnalysisRunner& DataFlowAnalysisRunner::run (const Program& pr,
+                                                     const BlockSet* forwardRegion,
+                                                     const BlockSet* backwardRegion)
+{
+    // Allocate the statistics before any of the threads starts writing them:
+    for (DataFlowAnalysis* a : m_as) {
+        m_stats[a];
+    }
+
     std::vector<std::thread> threads;
     threads.reserve (m_as.size ());
     for (DataFlowAnalysis* a : m_as) {
+        Statistics& stats = m_stats[a];
         if (a->isForward ()) {
             assert (dynamic_cast<ForwardDataFlowAnalysis*>(a) != nullptr);
             ForwardDataFlowAnalysis& fa = *static_cast<ForwardDataFlowAnalysis*>(a);
-            threads.emplace_back (ForwardAnalysisRunner (fa, pr));
+            threads.emplace_back (ForwardAnalysisRunner (fa, pr, forwardRegion, stats));
         }
 
         if (a->isBackward ()) {
             assert (dynamic_cast<BackwardDataFlowAnalysis*>(a) != nullptr);
             BackwardDataFlowAnalysis& ba = *static_cast<BackwardDataFlowAnalysis*>(a);
-            threads.emplace_back (BackwardAnalysisRunner (ba, pr));
+            threads.emplace_back (BackwardAnalysisRunner (ba, pr, backwardRegion, stats));
         }
     }
 
@@ -184,6 +328,13 @@ DataFlowAnalysisRunner& DataFlowAnalysisRunner::run (const Program &pr) {
     return *this;
 }
 
+const DataFlowAnalysisRunner::Statistics&
+DataFlowAnalysisRunner::statistics (const DataFlowAnalysis& a) const {
+    static const Statistics none;
+    const auto it = m_stats.find (&a);
+    return it != m_stats.end () ? it->second : none;
+}
+
 std::string DataFlowAnalysisRunner::toString (const Program& program) {
     std::ostringstream os;
     for (DataFlowAnalysis* a : m_as) {
@@ -22,6 +22,8 @@
 
 #include "Blocks.h"
 
+#include <chrono>
+#include <map>
 #include <set>
 #include <string>
 
@@ -45,6 +47,10 @@ class DataFlowAnalysis {
     friend class ForwardAnalysisRunner;
     friend class BackwardAnalysisRunner;
 
+public: /* Types: */
+
+    using BlockSet = std::set<const Block*>;
+
 protected: /* Types: */
 
     class ImopSet: public std::set<Imop const*> {
@@ -86,9 +92,21 @@ public:
 
     virtual std::string toString (const Program& pr) const = 0;
 
+    /// \returns approximate number of bytes held by the results, or 0 if unknown.
+    virtual size_t memoryUsage () const { return 0; }
+
 protected:
 
     virtual void start (const Program&) {}
+
+    /**
+     * \brief Prepares to re-analyse a region of the program.
+     * The blocks in the region have to forget their results and recompute
+     * their local information, results of other blocks must be kept. The
+     * region is closed under the direction of the analysis.
+     * \returns false if the analysis has to be restarted on the whole program.
+     */
+    virtual bool startRegion (const Program&, const BlockSet&) { return false; }
     virtual void startBlock (const Block &) {}
     virtual void inFrom (const Block& from, Edge::Label label, const Block& to) = 0;
     virtual void outTo (const Block& from, Edge::Label label, const Block& to) = 0;
@@ -131,6 +149,15 @@ public: /* Types: */
     using AnalysisSet = std::set<DataFlowAnalysis*>;
     using BackwardAnalysisSet = std::set<BackwardDataFlowAnalysis*>;
     using ForwardAnalysisSet = std::set<ForwardDataFlowAnalysis*>;
+    using BlockSet = DataFlowAnalysis::BlockSet;
+
+    /// Accumulated cost of running an analysis.
+    struct Statistics {
+        size_t runs = 0;   ///< Number of times the analysis has been run
+        size_t rounds = 0; ///< Number of passes over the worklist
+        size_t blocks = 0; ///< Number of blocks visited
+        std::chrono::steady_clock::duration time {};
+    };
 
 public: /* Methods: */
     inline DataFlowAnalysisRunner& addAnalysis (DataFlowAnalysis& a) {
@@ -139,10 +166,27 @@ public: /* Methods: */
     }
 
     DataFlowAnalysisRunner& run (const Program &program);
+
+    /**
+     * \brief Updates the results after the given blocks were modified.
+     * Only the blocks from which the changes are reachable in the direction
+     * of each analysis are re-analysed. The control flow graph must be the
+     * same as during the previous run.
+     */
+    DataFlowAnalysisRunner& update (const Program& program, const BlockSet& changed);
     std::string toString (const Program& program);
 
+    const Statistics& statistics (const DataFlowAnalysis& a) const;
+
+private: /* Methods: */
+
+    DataFlowAnalysisRunner& run (const Program& program,
+                                 const BlockSet* forwardRegion,
+                                 const BlockSet* backwardRegion);
+
 private: /* Fields: */
     AnalysisSet m_as;
+    std::map<const DataFlowAnalysis*, Statistics> m_stats;
 };
 
 } // namespace SecreC
@@ -85,6 +85,8 @@ ImopInfoBits imopInfo [Imop::_NUM_INSTR] = {
     // Array expressions:
     , { Imop::STORE,      0, 0, 0, 0, 1,UD, 0 }
     , { Imop::LOAD,       1, 0, 0, 0, 0,UD, 1 }
+    , { Imop::GATHER,     1, 0, 0, 0, 1, 4, 1 }
+    , { Imop::SCATTER,    0, 0, 0, 0, 1, 4, 0 }
     , { Imop::ALLOC,      1, 1, 0, 0, 0,UD, 1 }
     , { Imop::COPY,       1, 1, 0, 0, 0,UD, 1 }
     , { Imop::RELEASE,    0, 0, 0, 0, 0,UD, 1 }
@@ -362,6 +364,64 @@ bool Imop::writesDest () const {
     return getImopInfoBits (m_type).writesDest;
 }
 
+const char* Imop::typeName (Type type) {
+    switch (type) {
+    case DECLARE: return "DECLARE";
+    case ASSIGN: return "ASSIGN";
+    case CAST: return "CAST";
+    case CLASSIFY: return "CLASSIFY";
+    case DECLASSIFY: return "DECLASSIFY";
+    case UINV: return "UINV";
+    case UNEG: return "UNEG";
+    case UMINUS: return "UMINUS";
+    case TOSTRING: return "TOSTRING";
+    case STRLEN: return "STRLEN";
+    case MUL: return "MUL";
+    case DIV: return "DIV";
+    case MOD: return "MOD";
+    case ADD: return "ADD";
+    case SUB: return "SUB";
+    case EQ: return "EQ";
+    case NE: return "NE";
+    case LE: return "LE";
+    case LT: return "LT";
+    case GE: return "GE";
+    case GT: return "GT";
+    case LAND: return "LAND";
+    case LOR: return "LOR";
+    case BAND: return "BAND";
+    case BOR: return "BOR";
+    case XOR: return "XOR";
+    case SHL: return "SHL";
+    case SHR: return "SHR";
+    case STORE: return "STORE";
+    case LOAD: return "LOAD";
+    case GATHER: return "GATHER";
+    case SCATTER: return "SCATTER";
+    case ALLOC: return "ALLOC";
+    case COPY: return "COPY";
+    case RELEASE: return "RELEASE";
+    case PARAM: return "PARAM";
+    case DOMAINID: return "DOMAINID";
+    case CALL: return "CALL";
+    case GETFPUSTATE: return "GETFPUSTATE";
+    case SETFPUSTATE: return "SETFPUSTATE";
+    case JUMP: return "JUMP";
+    case JT: return "JT";
+    case JF: return "JF";
+    case ERROR: return "ERROR";
+    case RETURN: return "RETURN";
+    case END: return "END";
+    case COMMENT: return "COMMENT";
+    case PRINT: return "PRINT";
+    case SYSCALL: return "SYSCALL";
+    case RETCLEAN: return "RETCLEAN";
+    default:
+        assert (false && "Invalid instruction type.");
+        return "UNKNOWN";
+    }
+}
+
 bool Imop::isSyscall() const {
     return static_cast<bool>(m_syscallOperands);
 }
@@ -461,6 +521,12 @@ void Imop::print(std::ostream & os) const {
     case LOAD:
         os << dname << " = " << a1name << "[" << a2name << "]";
         break;
+    case GATHER:
+        os << dname << " = GATHER " << a1name << "[" << a2name << "] (" << a3name << ")";
+        break;
+    case SCATTER:
+        os << "SCATTER " << dname << "[" << a1name << "] = " << a2name << " (" << a3name << ")";
+        break;
     case CAST: printUnaryArith (os, imop, "CAST"); break;
     case CLASSIFY: printUnaryArith (os, imop, "CLASSIFY"); break;
     case DECLASSIFY: printUnaryArith (os, imop, "DECLASSIFY"); break;
@@ -106,6 +106,8 @@ public: /* Types: */
         //-------------------
         STORE,      //    d[arg1] = arg2;
         LOAD,       //    d = arg1[arg2];
+        GATHER,     //    d = arg1[arg2] (arg3), arg2 is a vector of arg3 offsets
+        SCATTER,    //    d[arg1] = arg2 (arg3), arg1 is a vector of arg3 offsets
         ALLOC,      //    d = ALLOC (arg1 {, arg2})
         COPY,       //    d = COPY arg1 arg2
         RELEASE,    //    RELEASE arg1 (marks the end of lifetime)
@@ -210,6 +212,9 @@ public: /* Methods: */
     bool isSyscall() const;
     const SyscallOperands& syscallOperands() const;
 
+    /// Name of the instruction type, for example "ADD".
+    static const char* typeName (Type type);
+
     void replaceWith (Imop& imop) {
         assert (!imop.is_linked ());
         imop.m_index = m_index;
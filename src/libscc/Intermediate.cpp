@@ -67,7 +67,9 @@ void ICode::compile (TreeNodeModule *mod, Location::PathStyle pathStyle) {
     assert (mod != nullptr);
     ICodeList code;
     CodeGen cg (code, *this, pathStyle);
-    if (cg.cgMain(mod).status() != CGResult::OK) {
+    const CGResult::Status status = cg.cgMain(mod).status();
+    m_resolutionStats = cg.typeChecker().resolutionStats();
+    if (status != CGResult::OK) {
         m_status = ERROR;
         return;
     }
@@ -27,7 +27,9 @@
 #include "Location.h"
 #include "ModuleMap.h"
 #include "OperatorTable.h"
+#include "OptimizerStats.h"
 #include "SymbolTable.h"
+#include "TypeChecker.h"
 
 #include <boost/optional/optional_fwd.hpp>
 #include <iosfwd>
@@ -68,6 +70,13 @@ public: /* Methods: */
     Context& context () { return m_context; }
     StringTable& stringTable ();
 
+    const TypeChecker::ResolutionStats& resolutionStats () const {
+        return m_resolutionStats;
+    }
+
+    OptimizerStats& optimizerStats () { return m_optimizerStats; }
+    const OptimizerStats& optimizerStats () const { return m_optimizerStats; }
+
 private: /* Fields: */
 
     OperatorTable   m_operators;
@@ -77,6 +86,8 @@ private: /* Fields: */
     ModuleMap       m_modules;
     Program         m_program;
     CompileLog      m_log;
+    TypeChecker::ResolutionStats m_resolutionStats;
+    OptimizerStats  m_optimizerStats;
 };
 
 std::ostream &operator<<(std::ostream &out, const ICode::Status &s);
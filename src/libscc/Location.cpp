@@ -22,6 +22,7 @@
 #include "Parser.h"
 
 #include <boost/filesystem.hpp>
+#include <mutex>
 #include <ostream>
 #include <set>
 
@@ -31,10 +32,13 @@ namespace /* anonymous */ {
 // Pointers to set elements will are not invalidated!
 using FilenameCache = std::set<std::string>;
 
+// File names are shared by all contexts, possibly on different threads.
 static FilenameCache filenameCache;
+static std::mutex filenameCacheMutex;
 
 std::string const * initFilename (const char* filename) {
     assert(filename);
+    std::lock_guard<std::mutex> lock (filenameCacheMutex);
     return &*filenameCache.insert (filename).first;
 }
 
@@ -70,6 +70,9 @@ public: /* Methods: */
 
     inline const std::string & filename() const { return *m_filenameItem; }
 
+    inline std::size_t firstLine() const { return m_firstLine; }
+    inline std::size_t firstColumn() const { return m_firstColumn; }
+
     YYLTYPE toYYLTYPE() const;
 
     std::ostream & print(std::ostream & os, PathStyle style) const;
@@ -0,0 +1,530 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "ModuleCache.h"
+
+#include "Location.h"
+#include "Parser.h"
+#include "StringTable.h"
+#include "TreeNode.h"
+#include "TreeNodeC.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <cassert>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <memory>
+#include <sstream>
+
+#ifndef SECREC_COMPILER_VERSION
+#error "SECREC_COMPILER_VERSION not defined"
+#endif
+
+namespace SecreC {
+
+namespace /* anonymous */ {
+
+/// Increment whenever the layout of the serialized tree changes.
+constexpr uint32_t formatVersion = 3u;
+constexpr uint32_t magic = 0x54534353u; // "SCST"
+
+constexpr unsigned nodeTypeCount = 0u
+#define O(ENUM, CLASS) + 1u
+    TREENODE_LIST
+#undef O
+    ;
+
+TreeNode* toCxx (::TreeNode* node) {
+    return reinterpret_cast<TreeNode*> (node);
+}
+
+/*******************************************************************************
+  Writer
+*******************************************************************************/
+
+class Writer {
+public: /* Methods: */
+
+    explicit Writer (std::ostream& os) : m_os (os) { }
+
+    void u8 (uint8_t x) { m_os.put (static_cast<char> (x)); }
+    void u32 (uint32_t x) { m_os.write (reinterpret_cast<const char*> (&x), sizeof (x)); }
+    void u64 (uint64_t x) { m_os.write (reinterpret_cast<const char*> (&x), sizeof (x)); }
+
+    void string (StringRef str) {
+        u32 (static_cast<uint32_t> (str.size ()));
+        m_os.write (str.data (), str.size ());
+    }
+
+    void node (const TreeNode* n) {
+        const YYLTYPE loc = n->location ().toYYLTYPE ();
+        u32 (n->type ());
+        u64 (loc.first_line);
+        u64 (loc.first_column);
+        u64 (loc.last_line);
+        u64 (loc.last_column);
+
+        switch (n->type ()) {
+        case NODE_LITE_BOOL:
+            u8 (static_cast<const TreeNodeExprBool*> (n)->value ());
+            break;
+        case NODE_LITE_INT:
+            string (static_cast<const TreeNodeExprInt*> (n)->stringValue ());
+            break;
+        case NODE_LITE_FLOAT:
+            string (static_cast<const TreeNodeExprFloat*> (n)->value ());
+            break;
+        case NODE_STRING_PART_FRAGMENT:
+            string (static_cast<const TreeNodeStringPartFragment*> (n)->staticValue ());
+            break;
+        case NODE_STRING_PART_IDENTIFIER:
+            string (static_cast<const TreeNodeStringPartIdentifier*> (n)->name ());
+            break;
+        case NODE_IDENTIFIER:
+            string (static_cast<const TreeNodeIdentifier*> (n)->value ());
+            break;
+        case NODE_DATATYPE_CONST_F:
+            u32 (static_cast<const TreeNodeDataTypeConstF*> (n)->secrecDataType ());
+            break;
+        case NODE_TYPE_ARG_DATA_TYPE_CONST:
+            u32 (static_cast<const TreeNodeTypeArgDataTypeConst*> (n)->secrecDataType ());
+            break;
+        case NODE_DATATYPE_DECL:
+            string (static_cast<const TreeNodeDataTypeDecl*> (n)->typeName ());
+            break;
+        case NODE_DATATYPE_DECL_PARAM_PUBLIC:
+            u32 (static_cast<const TreeNodeDataTypeDeclParamPublic*> (n)->secrecDataType ());
+            break;
+        case NODE_DATATYPE_DECL_PARAM_SIZE:
+            u64 (static_cast<const TreeNodeDataTypeDeclParamSize*> (n)->size ());
+            break;
+        case NODE_OPDEF:
+            u32 (static_cast<const TreeNodeOpDef*> (n)->getOperator ());
+            break;
+        default:
+            break;
+        }
+
+        u32 (static_cast<uint32_t> (n->children ().size ()));
+        for (const TreeNode* child : n->children ())
+            node (child);
+    }
+
+private: /* Fields: */
+    std::ostream& m_os;
+};
+
+/*******************************************************************************
+  Reader
+*******************************************************************************/
+
+class Reader {
+public: /* Methods: */
+
+    Reader (std::istream& is, std::size_t size, StringTable& table,
+            const char* filename)
+        : m_is (is)
+        , m_size (size)
+        , m_table (table)
+        , m_filename (filename)
+    { }
+
+    bool good () const { return m_is.good (); }
+
+    uint8_t u8 () { return static_cast<uint8_t> (m_is.get ()); }
+
+    uint32_t u32 () {
+        uint32_t x = 0;
+        m_is.read (reinterpret_cast<char*> (&x), sizeof (x));
+        return x;
+    }
+
+    uint64_t u64 () {
+        uint64_t x = 0;
+        m_is.read (reinterpret_cast<char*> (&x), sizeof (x));
+        return x;
+    }
+
+    /// Fails, instead of allocating, on a length past the end of the entry.
+    std::string rawString () {
+        const uint32_t size = u32 ();
+        if (! good () || size > remaining ()) {
+            m_is.setstate (std::ios::failbit);
+            return std::string ();
+        }
+
+        std::string str (size, '\0');
+        m_is.read (&str[0], str.size ());
+        return str;
+    }
+
+    StringRef string () { return *m_table.addString (rawString ()); }
+
+    std::unique_ptr<TreeNode> node () {
+        const uint32_t typeNum = u32 ();
+        if (! good () || typeNum >= nodeTypeCount)
+            return nullptr;
+
+        const auto type = static_cast<SecrecTreeNodeType> (typeNum);
+        YYLTYPE loc;
+        loc.first_line = u64 ();
+        loc.first_column = u64 ();
+        loc.last_line = u64 ();
+        loc.last_column = u64 ();
+        loc.filename = m_filename;
+
+        std::unique_ptr<TreeNode> result (makeNode (type, loc));
+        if (result == nullptr)
+            return nullptr;
+
+        const uint32_t childCount = u32 ();
+        for (uint32_t i = 0; i < childCount && good (); ++ i) {
+            std::unique_ptr<TreeNode> child = node ();
+            if (child == nullptr)
+                return nullptr;
+
+            result->appendChild (child.release ());
+        }
+
+        if (! good ())
+            return nullptr;
+
+        return result;
+    }
+
+private:
+
+    std::size_t remaining () {
+        const std::streamoff pos = m_is.tellg ();
+        if (pos < 0 || static_cast<std::size_t> (pos) > m_size)
+            return 0u;
+        return m_size - static_cast<std::size_t> (pos);
+    }
+
+    TreeNode* makeNode (SecrecTreeNodeType type, const YYLTYPE& loc) {
+        switch (type) {
+        case NODE_LITE_BOOL:
+            return new TreeNodeExprBool (u8 () != 0, loc);
+        case NODE_LITE_INT:
+            return new TreeNodeExprInt (string (), loc);
+        case NODE_LITE_FLOAT:
+            return new TreeNodeExprFloat (string (), loc);
+        case NODE_STRING_PART_FRAGMENT:
+            return new TreeNodeStringPartFragment (string (), loc);
+        case NODE_STRING_PART_IDENTIFIER:
+            return new TreeNodeStringPartIdentifier (string (), loc);
+        case NODE_IDENTIFIER:
+            return new TreeNodeIdentifier (string (), loc);
+        case NODE_DATATYPE_CONST_F:
+            return new TreeNodeDataTypeConstF (static_cast<SecrecDataType> (u32 ()), loc);
+        case NODE_TYPE_ARG_DATA_TYPE_CONST:
+            return new TreeNodeTypeArgDataTypeConst (static_cast<SecrecDataType> (u32 ()), loc);
+        case NODE_DATATYPE_DECL:
+            return new TreeNodeDataTypeDecl (string (), loc);
+        case NODE_DATATYPE_DECL_PARAM_PUBLIC:
+            return new TreeNodeDataTypeDeclParamPublic (static_cast<SecrecDataType> (u32 ()), loc);
+        case NODE_DATATYPE_DECL_PARAM_SIZE:
+            return new TreeNodeDataTypeDeclParamSize (u64 (), loc);
+        case NODE_OPDEF:
+            // The annotation and identifier children are stored explicitly.
+            return new TreeNodeOpDef (static_cast<SecrecOperator> (u32 ()), loc);
+        case NODE_SECTYPE_PUBLIC_F:
+        case NODE_SECTYPE_PRIVATE_F:
+            return new TreeNodeSecTypeF (type, loc);
+        case NODE_DATATYPE_VAR_F:
+            return new TreeNodeDataTypeVarF (loc);
+        case NODE_TYPE_ARG_DIM_TYPE_CONST:
+            return new TreeNodeTypeArgDimTypeConst (loc);
+        case NODE_READONLY:
+            return new TreeNodeSyscallParam (type, loc);
+        // Nodes without data of their own:
+        case NODE_CASTDEF:
+        case NODE_PROGRAM:
+        case NODE_PROCDEF:
+        case NODE_DECL:
+        case NODE_TYPETYPE:
+        case NODE_TYPEVOID:
+        case NODE_EXPR_CAST:
+        case NODE_KIND:
+        case NODE_DOMAIN:
+        case NODE_TEMPLATE_QUANTIFIER_DATA:
+        case NODE_TEMPLATE_QUANTIFIER_DOMAIN:
+        case NODE_TEMPLATE_QUANTIFIER_DIM:
+        case NODE_TEMPLATE_DECL:
+        case NODE_VAR_INIT:
+        case NODE_MODULE:
+        case NODE_IMPORT:
+        case NODE_DIMTYPE_VAR_F:
+        case NODE_DIMTYPE_ZERO_F:
+        case NODE_DIMTYPE_CONST_F:
+        case NODE_TYPEVAR:
+        case NODE_LITE_STRING:
+        case NODE_STRUCT_DECL:
+        case NODE_ATTRIBUTE:
+        case NODE_INTERNAL_USE:
+        case NODE_DIMENSIONS:
+        case NODE_LVALUE_VARIABLE:
+        case NODE_LVALUE_INDEX:
+        case NODE_LVALUE_SELECT:
+        case NODE_SUBSCRIPT:
+        case NODE_INDEX_INT:
+        case NODE_INDEX_SLICE:
+        case NODE_ANNOTATION:
+        case NODE_TYPE_ARG_VAR:
+        case NODE_TYPE_ARG_TEMPLATE:
+        case NODE_TYPE_ARG_PUBLIC:
+        case NODE_DATATYPE_TEMPLATE_F:
+        case NODE_PUSH:
+        case NODE_PUSHCREF:
+        case NODE_PUSHREF:
+        case NODE_PURE:
+        case NODE_SYSCALL_RETURN:
+        case NODE_EXPR_NONE:
+        case NODE_EXPR_DECLASSIFY:
+        case NODE_EXPR_PROCCALL:
+        case NODE_EXPR_RVARIABLE:
+        case NODE_EXPR_INDEX:
+        case NODE_EXPR_SIZE:
+        case NODE_EXPR_SHAPE:
+        case NODE_EXPR_CAT:
+        case NODE_EXPR_RESHAPE:
+        case NODE_EXPR_TOSTRING:
+        case NODE_EXPR_STRING_FROM_BYTES:
+        case NODE_EXPR_BYTES_FROM_STRING:
+        case NODE_EXPR_SET_FPU_STATE:
+        case NODE_EXPR_GET_FPU_STATE:
+        case NODE_EXPR_DOMAINID:
+        case NODE_EXPR_TYPE_QUAL:
+        case NODE_EXPR_ARRAY_CONSTRUCTOR:
+        case NODE_EXPR_SELECTION:
+        case NODE_EXPR_STRLEN:
+        case NODE_EXPR_TERNIF:
+        case NODE_EXPR_UINV:
+        case NODE_EXPR_UNEG:
+        case NODE_EXPR_UMINUS:
+        case NODE_EXPR_POSTFIX_INC:
+        case NODE_EXPR_POSTFIX_DEC:
+        case NODE_EXPR_PREFIX_INC:
+        case NODE_EXPR_PREFIX_DEC:
+        case NODE_EXPR_BINARY_ADD:
+        case NODE_EXPR_BINARY_DIV:
+        case NODE_EXPR_BINARY_COMMA:
+        case NODE_EXPR_BINARY_EQ:
+        case NODE_EXPR_BINARY_GE:
+        case NODE_EXPR_BINARY_GT:
+        case NODE_EXPR_BINARY_LAND:
+        case NODE_EXPR_BINARY_LE:
+        case NODE_EXPR_BINARY_LOR:
+        case NODE_EXPR_BINARY_LT:
+        case NODE_EXPR_BINARY_MATRIXMUL:
+        case NODE_EXPR_BINARY_MOD:
+        case NODE_EXPR_BINARY_MUL:
+        case NODE_EXPR_BINARY_NE:
+        case NODE_EXPR_BINARY_SUB:
+        case NODE_EXPR_BITWISE_AND:
+        case NODE_EXPR_BITWISE_OR:
+        case NODE_EXPR_BITWISE_XOR:
+        case NODE_EXPR_BINARY_SHL:
+        case NODE_EXPR_BINARY_SHR:
+        case NODE_EXPR_BINARY_ASSIGN_ADD:
+        case NODE_EXPR_BINARY_ASSIGN_AND:
+        case NODE_EXPR_BINARY_ASSIGN_DIV:
+        case NODE_EXPR_BINARY_ASSIGN_MOD:
+        case NODE_EXPR_BINARY_ASSIGN_MUL:
+        case NODE_EXPR_BINARY_ASSIGN_OR:
+        case NODE_EXPR_BINARY_ASSIGN_SUB:
+        case NODE_EXPR_BINARY_ASSIGN_XOR:
+        case NODE_EXPR_BINARY_ASSIGN:
+        case NODE_STMT_BREAK:
+        case NODE_STMT_CONTINUE:
+        case NODE_STMT_COMPOUND:
+        case NODE_STMT_DOWHILE:
+        case NODE_STMT_EXPR:
+        case NODE_STMT_ASSERT:
+        case NODE_STMT_FOR:
+        case NODE_STMT_IF:
+        case NODE_STMT_RETURN:
+        case NODE_STMT_WHILE:
+        case NODE_STMT_PRINT:
+        case NODE_STMT_SYSCALL:
+            return toCxx (treenode_init (type, &loc));
+        default:
+            // The writer never emits any other type, for instance the
+            // classifications that only the type checker inserts, so the
+            // entry is corrupt and treated as a miss.
+            return nullptr;
+        }
+    }
+
+private: /* Fields: */
+    std::istream& m_is;
+    const std::size_t m_size;   ///< Bytes in the entry.
+    StringTable& m_table;
+    const char* const m_filename;
+};
+
+} // namespace anonymous
+
+/*******************************************************************************
+  ModuleCache
+*******************************************************************************/
+
+ModuleCache::ModuleCache () { }
+
+ModuleCache::ModuleCache (boost::filesystem::path directory)
+    : m_directory (std::move (directory))
+{ }
+
+ModuleCache::~ModuleCache () { }
+
+uint64_t ModuleCache::contentHash (const std::string& content) {
+    // 64-bit FNV-1a
+    uint64_t hash = 0xcbf29ce484222325u;
+    for (char c : content) {
+        hash ^= static_cast<unsigned char> (c);
+        hash *= 0x100000001b3u;
+    }
+
+    return hash;
+}
+
+ModuleCache::Stats ModuleCache::stats () const {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    return m_stats;
+}
+
+std::string ModuleCache::entryName (const boost::filesystem::path& source,
+                                    uint64_t hash)
+{
+    std::ostringstream os;
+    os << source.stem ().string () << '-'
+       << std::hex << std::setw (16) << std::setfill ('0') << hash
+       << ".ast";
+    return os.str ();
+}
+
+std::shared_ptr<const std::string> ModuleCache::findEntry (const std::string& name) {
+    {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        auto it = m_entries.find (name);
+        if (it != m_entries.end ())
+            return it->second;
+    }
+
+    if (m_directory.empty ())
+        return nullptr;
+
+    std::ifstream is ((m_directory / name).string (), std::ios::binary);
+    if (! is)
+        return nullptr;
+
+    auto entry = std::make_shared<const std::string> (
+        (std::istreambuf_iterator<char> (is)), std::istreambuf_iterator<char> ());
+    std::lock_guard<std::mutex> lock (m_mutex);
+    return m_entries.emplace (name, std::move (entry)).first->second;
+}
+
+TreeNodeModule* ModuleCache::load (const boost::filesystem::path& source,
+                                   const std::string& content,
+                                   StringTable& table)
+{
+    const uint64_t hash = contentHash (content);
+    std::unique_ptr<TreeNode> root;
+    if (auto entry = findEntry (entryName (source, hash))) {
+        boost::iostreams::stream<boost::iostreams::array_source> is (
+            entry->data (), entry->size ());
+        Reader in (is, entry->size (), table, source.c_str ());
+        const bool headerOk =
+            in.u32 () == magic &&
+            in.u32 () == formatVersion &&
+            in.rawString () == SECREC_COMPILER_VERSION &&
+            in.u64 () == hash &&
+            in.u64 () == content.size () &&
+            in.good ();
+
+        if (headerOk)
+            root = in.node ();
+    }
+
+    std::lock_guard<std::mutex> lock (m_mutex);
+    if (root == nullptr || root->type () != NODE_MODULE) {
+        ++ m_stats.misses;
+        return nullptr;
+    }
+
+    ++ m_stats.hits;
+    return static_cast<TreeNodeModule*> (root.release ());
+}
+
+void ModuleCache::store (const boost::filesystem::path& source,
+                         const std::string& content,
+                         const TreeNodeModule* module)
+{
+    namespace fs = boost::filesystem;
+
+    assert (module != nullptr);
+    const uint64_t hash = contentHash (content);
+    const std::string name = entryName (source, hash);
+
+    std::ostringstream os;
+    Writer out (os);
+    out.u32 (magic);
+    out.u32 (formatVersion);
+    out.string (SECREC_COMPILER_VERSION);
+    out.u64 (hash);
+    out.u64 (content.size ());
+    out.node (module);
+    auto entry = std::make_shared<const std::string> (os.str ());
+
+    {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        m_entries.emplace (name, entry);
+    }
+
+    if (m_directory.empty ())
+        return;
+
+    // Write to a temporary file first so that concurrent compilations never
+    // observe a partially written entry.
+    boost::system::error_code ec;
+    fs::create_directories (m_directory, ec);
+    const fs::path temp = m_directory / fs::unique_path ("%%%%-%%%%-%%%%.tmp");
+
+    {
+        std::ofstream file (temp.string (), std::ios::binary);
+        if (! file)
+            return;
+
+        file.write (entry->data (), entry->size ());
+        if (! file.flush ()) {
+            file.close ();
+            fs::remove (temp, ec);
+            return;
+        }
+    }
+
+    fs::rename (temp, m_directory / name, ec);
+    if (ec)
+        fs::remove (temp, ec);
+}
+
+} // namespace SecreC
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SECREC_MODULE_CACHE_H
+#define SECREC_MODULE_CACHE_H
+
+#include <boost/filesystem/path.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * This file contains the on-disk cache of parsed modules. Imported modules
+ * (most notably the standard library) are parsed once and their syntax trees
+ * are serialized into the cache directory. Later compilations that import an
+ * unchanged module deserialize the tree instead of running the parser.
+ *
+ * Entries are keyed by a hash of the module source together with the compiler
+ * version, so editing a module simply makes its old entry unreachable. The
+ * length of the source is stored next to the hash and compared as well, so a
+ * colliding edit that changes the length is not mistaken for a hit.
+ *
+ * Serialized entries are also kept in memory, and a cache may be shared by
+ * compilations running on different threads. Every load builds a fresh tree
+ * in the string table of the requesting context.
+ *
+ * Only parsing is cached. Types belong to the context of a compilation, so
+ * cached modules are still type checked by every compilation that imports
+ * them. Entries that are truncated or corrupt count as misses.
+ */
+
+namespace SecreC {
+
+class StringTable;
+class TreeNodeModule;
+
+/*******************************************************************************
+  ModuleCache
+*******************************************************************************/
+
+class ModuleCache {
+public: /* Types: */
+
+    struct Stats {
+        std::size_t hits = 0u;
+        std::size_t misses = 0u;
+    };
+
+public: /* Methods: */
+
+    /// Creates a cache that is only kept in memory.
+    ModuleCache ();
+    explicit ModuleCache (boost::filesystem::path directory);
+    ~ModuleCache ();
+
+    ModuleCache (const ModuleCache&) = delete;
+    ModuleCache& operator = (const ModuleCache&) = delete;
+
+    const boost::filesystem::path& directory () const { return m_directory; }
+
+    /**
+     * \brief Looks up the syntax tree of a module.
+     * \param source path of the module file, used for node locations
+     * \param content contents of the module file
+     * \returns nullptr if there is no usable cache entry.
+     */
+    TreeNodeModule* load (const boost::filesystem::path& source,
+                          const std::string& content,
+                          StringTable& table);
+
+    /**
+     * \brief Stores a freshly parsed module. Must be called before the tree
+     * is type checked. Failures to write the entry to disk are silently
+     * ignored.
+     */
+    void store (const boost::filesystem::path& source,
+                const std::string& content,
+                const TreeNodeModule* module);
+
+    Stats stats () const;
+
+    static uint64_t contentHash (const std::string& content);
+
+private:
+
+    static std::string entryName (const boost::filesystem::path& source,
+                                  uint64_t hash);
+
+    std::shared_ptr<const std::string> findEntry (const std::string& name);
+
+private: /* Fields: */
+
+    boost::filesystem::path const m_directory; ///< Empty if not stored on disk.
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, std::shared_ptr<const std::string> > m_entries;
+    Stats m_stats;
+};
+
+} // namespace SecreC
+
+#endif // SECREC_MODULE_CACHE_H
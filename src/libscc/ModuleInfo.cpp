@@ -21,10 +21,13 @@
 
 #include "Context.h"
 #include "ContextImpl.h"
+#include "ModuleCache.h"
 #include "TreeNode.h"
 #include "Parser.h"
 
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <boost/filesystem.hpp>
 
 using namespace boost;
@@ -47,24 +50,37 @@ void ModuleInfo::setCodeGenState (const CodeGenState& state) {
     m_cgState = state;
 }
 
-bool ModuleInfo::read() {
+bool ModuleInfo::read(ModuleCache* cache) {
     using namespace boost;
     assert (m_body == nullptr);
-    const char* fname = m_location.path ().c_str ();
-    FILE* f = fopen (fname, "r");
-    if (f == nullptr) {
+    const filesystem::path& path = m_location.path ();
+    const char* fname = path.c_str ();
+    std::ifstream f (fname, std::ios::binary);
+    if (! f) {
         std::cerr << "Was not able to open file \"" << fname << "\"." << std::endl;
         return false;
     }
 
+    const std::string content ((std::istreambuf_iterator<char> (f)),
+                               std::istreambuf_iterator<char> ());
+    f.close ();
+
     ContextImpl* pImpl = m_cxt.pImpl ();
+    if (cache != nullptr) {
+        m_body = cache->load (path, content, pImpl->stringTable ());
+        if (m_body != nullptr)
+            return true;
+    }
+
     TreeNodeModule* treeNode = nullptr;
-    int parseResult = sccparse_file(&pImpl->stringTable (), m_location.path().c_str (), f, &treeNode);
-    fclose (f);
+    int parseResult = sccparse_mem(&pImpl->stringTable (), fname, content.data (), content.size (), &treeNode);
     if (parseResult != 0 || treeNode == nullptr) {
         return false;
     }
 
+    if (cache != nullptr)
+        cache->store (path, content, treeNode);
+
     m_body = treeNode;
     return true;
 }
@@ -31,6 +31,7 @@ namespace SecreC {
 
 class TreeNodeProgram;
 class Context;
+class ModuleCache;
 
 /*******************************************************************************
   ModuleInfo
@@ -76,7 +77,11 @@ public: /* Methods: */
     CodeGenState& codeGenState () { return m_cgState; }
     TreeNodeModule* body () const { return m_body; }
     void setBody (TreeNodeModule* body) { m_body = body; }
-    bool read();
+    /**
+     * \brief Parses the module, or loads its syntax tree from the cache.
+     * \param cache module cache, or nullptr if caching is disabled
+     */
+    bool read(ModuleCache* cache = nullptr);
 
 private: /* Fields: */
     directory_entry   const  m_location;
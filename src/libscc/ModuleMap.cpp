@@ -19,6 +19,7 @@
 
 #include "ModuleMap.h"
 
+#include "ModuleCache.h"
 #include "ModuleInfo.h"
 
 #include <iostream>
@@ -49,9 +50,14 @@ bool ModuleMap::addModule (const std::string& name, std::unique_ptr<ModuleInfo>
 }
 
 void ModuleMap::addSearchPath (const std::string& pathName, bool verbose) {
+    addModuleFiles (findModuleFiles (pathName, verbose), verbose);
+}
+
+ModuleMap::ModuleFiles ModuleMap::findModuleFiles (const std::string& pathName, bool verbose) {
     using namespace boost::filesystem;
 
     const path p (pathName);
+    ModuleFiles files;
 
     try  {
         if (! exists(p)) {
@@ -60,7 +66,7 @@ void ModuleMap::addSearchPath (const std::string& pathName, bool verbose) {
                           << std::endl;
             }
 
-            return;
+            return files;
         }
 
         if (! is_directory (p)) {
@@ -70,7 +76,7 @@ void ModuleMap::addSearchPath (const std::string& pathName, bool verbose) {
                           << std::endl;
             }
 
-            return;
+            return files;
         }
 
         if (verbose) {
@@ -85,20 +91,7 @@ void ModuleMap::addSearchPath (const std::string& pathName, bool verbose) {
             if (! is_regular_file (f))
                 continue;
 
-            if (verbose) {
-                std::cerr << "Using module " << f.path() << std::endl;
-            }
-
-            if (! addModule (f.path ().stem ().string (),
-                    std::unique_ptr<ModuleInfo>(new ModuleInfo (f, m_cxt))))
-            {
-                if (verbose) {
-                    std::cerr << "    Ignoring. File with same name already found."
-                              << std::endl;
-                }
-
-                continue;
-            }
+            files.push_back (f);
         }
     }
     catch (const std::exception& e) {
@@ -110,6 +103,25 @@ void ModuleMap::addSearchPath (const std::string& pathName, bool verbose) {
         std::cerr << "Unknown exception thrown when adding search path for "
                   << pathName << std::endl;
     }
+
+    return files;
+}
+
+void ModuleMap::addModuleFiles (const ModuleFiles& files, bool verbose) {
+    for (const auto& f : files) {
+        if (verbose) {
+            std::cerr << "Using module " << f.path() << std::endl;
+        }
+
+        if (! addModule (f.path ().stem ().string (),
+                std::unique_ptr<ModuleInfo>(new ModuleInfo (f, m_cxt))))
+        {
+            if (verbose) {
+                std::cerr << "    Ignoring. File with same name already found."
+                          << std::endl;
+            }
+        }
+    }
 }
 
 ModuleInfo* ModuleMap::findModule (const std::string& name) const {
@@ -119,4 +131,8 @@ ModuleInfo* ModuleMap::findModule (const std::string& name) const {
     return i->second.get();
 }
 
+void ModuleMap::setCacheDirectory (const std::string& pathName) {
+    m_cache = std::make_shared<ModuleCache> (pathName);
+}
+
 } // namespace SecreC
@@ -20,12 +20,15 @@
 #ifndef SECREC_MODULE_MAP_H
 #define SECREC_MODULE_MAP_H
 
+#include <boost/filesystem/operations.hpp>
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace SecreC {
 
+class ModuleCache;
 class ModuleInfo;
 class Context;
 
@@ -38,17 +41,33 @@ class ModuleMap {
     ModuleMap& operator = (const ModuleMap&) = delete;
 private: /* Types: */
     using MapType = std::map<std::string, std::unique_ptr<ModuleInfo>>;
+public: /* Types: */
+    using ModuleFiles = std::vector<boost::filesystem::directory_entry>;
 public: /* Methods: */
 
     explicit ModuleMap (Context& cxt);
     ~ModuleMap();
 
     void addSearchPath (const std::string& pathName, bool verbose = false);
+
+    /**
+     * \brief Lists the module files in a search path without adding them.
+     * The result can be added to any number of module maps.
+     */
+    static ModuleFiles findModuleFiles (const std::string& pathName, bool verbose = false);
+    void addModuleFiles (const ModuleFiles& files, bool verbose = false);
+
     bool addModule (const std::string& name, std::unique_ptr<ModuleInfo> info);
     ModuleInfo* findModule (const std::string& name) const;
 
+    /// Enables caching of parsed modules in the given directory.
+    void setCacheDirectory (const std::string& pathName);
+    void setCache (std::shared_ptr<ModuleCache> cache) { m_cache = std::move (cache); }
+    ModuleCache* cache () const { return m_cache.get (); }
+
 private: /* Fields: */
     MapType m_modules;
+    std::shared_ptr<ModuleCache> m_cache;
     Context& m_cxt;
 };
 
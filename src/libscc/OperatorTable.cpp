@@ -30,6 +30,15 @@ OperatorTable::~OperatorTable () {
 
 void OperatorTable::appendOperator (Symbol* op) {
     m_ops.push_back (op);
+    if (op->symbolType () == SYM_PROCEDURE)
+        ++ m_generations[static_cast<SymbolProcedure*> (op)->procedureName ()];
+    else if (op->symbolType () == SYM_OPERATOR_TEMPLATE)
+        ++ m_generations[static_cast<SymbolOperatorTemplate*> (op)->decl ()->body ()->procedureName ()];
+}
+
+unsigned OperatorTable::generation (StringRef name) const {
+    const auto it = m_generations.find (name);
+    return it != m_generations.end () ? it->second : 0u;
 }
 
 std::vector<SymbolProcedure*> OperatorTable::findOperators (StringRef name) {
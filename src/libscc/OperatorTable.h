@@ -22,6 +22,7 @@
 
 #include "Symbol.h"
 
+#include <unordered_map>
 #include <vector>
 
 namespace SecreC {
@@ -40,9 +41,13 @@ public: /* Methods: */
 
     std::vector<SymbolOperatorTemplate*> findOperatorTemplates (StringRef name);
 
+    /// Changes whenever an operator or an operator template of the name is added.
+    unsigned generation (StringRef name) const;
+
 private: /* Fields: */
 
     std::vector<Symbol*> m_ops;
+    std::unordered_map<StringRef, unsigned> m_generations;
 };
 
 } /* namespace SecreC { */
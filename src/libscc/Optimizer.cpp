@@ -11,9 +11,33 @@
 #include "analysis/ReachableReturns.h"
 #include "analysis/ReachableUses.h"
 
+#include <algorithm>
+#include <iterator>
+
 namespace SecreC {
 
-bool optimizeCode (ICode& code) {
+namespace /* anonymous */ {
+
+void addAnalysisStats (OptimizerStats& stats, const char* name,
+                       const DataFlowAnalysisRunner::Statistics& runnerStats)
+{
+    auto it = std::find_if (stats.analyses.begin (), stats.analyses.end (),
+        [name](const OptimizerStats::Analysis& a) { return a.name == name; });
+    if (it == stats.analyses.end ()) {
+        stats.analyses.emplace_back ();
+        it = std::prev (stats.analyses.end ());
+        it->name = name;
+    }
+
+    it->runs += runnerStats.runs;
+    it->rounds += runnerStats.rounds;
+    it->blocks += runnerStats.blocks;
+    it->time += runnerStats.time;
+}
+
+} // namespace anonymous
+
+bool optimizeCode (ICode& code, bool incremental) {
     ConstantFolding cf;
     DataFlowAnalysisRunner runner;
     LiveMemory lmem;
@@ -34,24 +58,40 @@ bool optimizeCode (ICode& code) {
     inlineCalls (code);
 
     bool changes = false;
+    bool cfgChanged = true;
+    ChangedBlocks changed;
     while (true) {
 
         if (removeUnreachableBlocks (code)) {
             removeEmptyProcedures (code);
             changes = true;
+            cfgChanged = true;
             continue;
         }
 
-        runner.run (code.program ());
+        // Analysis results of the blocks that were not affected by the last
+        // transformation remain valid unless the CFG has been modified:
+        if (cfgChanged || ! incremental)
+            runner.run (code.program ());
+        else
+            runner.update (code.program (), changed);
+
+        cfgChanged = false;
+        changed.clear ();
 
-        if (eliminateConstantExpressions (cf, code) ||
-            eliminateDeadVariables (lva, code) ||
-            eliminateDeadStores (lmem, code) ||
-            eliminateDeadAllocs (ru, code) ||
-            eliminateRedundantCopies (ru, rd, rr, cp, code))
+        if (eliminateConstantExpressions (cf, code, changed) ||
+            eliminateDeadVariables (lva, code, changed) ||
+            eliminateDeadStores (lmem, code, changed) ||
+            eliminateDeadAllocs (ru, code, changed) ||
+            eliminateRedundantCopies (ru, rd, rr, cp, code, changed) ||
+            eliminateCommonSubexpressions (code, changed) ||
+            hoistLoopInvariants (code, changed) ||
+            batchSyscalls (code, changed))
         {
-            if (removeEmptyBlocks (code))
+            if (removeEmptyBlocks (code)) {
                 removeEmptyProcedures (code);
+                cfgChanged = true;
+            }
 
             code.program ().numberInstructions ();
             code.program ().numberBlocks ();
@@ -63,6 +103,14 @@ bool optimizeCode (ICode& code) {
         break;
     }
 
+    OptimizerStats& stats = code.optimizerStats ();
+    addAnalysisStats (stats, "lv", runner.statistics (lva));
+    addAnalysisStats (stats, "cf", runner.statistics (cf));
+    addAnalysisStats (stats, "ru", runner.statistics (ru));
+    addAnalysisStats (stats, "rabled", runner.statistics (rd));
+    addAnalysisStats (stats, "rr", runner.statistics (rr));
+    addAnalysisStats (stats, "cp", runner.statistics (cp));
+    addAnalysisStats (stats, "lm", runner.statistics (lmem));
     return changes;
 }
 
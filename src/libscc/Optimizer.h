@@ -20,37 +20,76 @@
 #ifndef SECREC_OPTIMIZER_H
 #define SECREC_OPTIMIZER_H
 
+#include "OptimizerStats.h"
+
+#include <set>
+#include <vector>
+
 namespace SecreC {
 
+class Block;
 class ConstantFolding;
 class CopyPropagation;
 class ICode;
+class Imop;
 class LiveMemory;
 class LiveVariables;
 class Procedure;
 class ReachableDefinitions;
 class ReachableReturns;
 class ReachableUses;
+class Symbol;
 class SymbolTable;
+class SyscallOperand;
+
+/// Blocks whose instructions were modified without changing the CFG.
+using ChangedBlocks = std::set<const Block*>;
+
+/// Symbols whose value or contents the instruction may overwrite.
+std::vector<const Symbol*> writtenSymbols (const Imop& imop);
+
+/// The system call only computes its results from its arguments.
+bool isPureSyscall (const Imop& imop);
 
-bool eliminateConstantExpressions (const ConstantFolding& cf, ICode& code);
-bool eliminateDeadAllocs (const ReachableUses& ru, ICode& code);
-bool eliminateDeadStores (const LiveMemory& lmem, ICode& code);
-bool eliminateDeadVariables (const LiveVariables& lva, ICode& code);
+/// The operand receives a result of a pure system call.
+bool isSyscallResult (const SyscallOperand& op);
+
+bool eliminateCommonSubexpressions (ICode& code, ChangedBlocks& changed);
+bool hoistLoopInvariants (ICode& code, ChangedBlocks& changed);
+bool batchSyscalls (ICode& code, ChangedBlocks& changed);
+
+bool eliminateConstantExpressions (const ConstantFolding& cf, ICode& code,
+                                   ChangedBlocks& changed);
+bool eliminateDeadAllocs (const ReachableUses& ru, ICode& code,
+                          ChangedBlocks& changed);
+bool eliminateDeadStores (const LiveMemory& lmem, ICode& code,
+                          ChangedBlocks& changed);
+bool eliminateDeadVariables (const LiveVariables& lva, ICode& code,
+                             ChangedBlocks& changed);
 bool eliminateRedundantCopies (const ReachableUses& ru,
                                const ReachableDefinitions& rd,
                                const ReachableReturns& rr,
                                const CopyPropagation& cp,
-                               ICode& code);
+                               ICode& code,
+                               ChangedBlocks& changed);
 
 bool eliminateRedundantCopies (ICode& code);
+bool eliminateCommonSubexpressions (ICode& code);
+bool hoistLoopInvariants (ICode& code);
+bool batchSyscalls (ICode& code);
 bool eliminateDeadVariables (ICode& code);
 bool eliminateConstantExpressions (ICode& code);
 bool removeUnreachableBlocks (ICode& code);
 bool removeEmptyBlocks (ICode& code);
 bool removeEmptyProcedures (ICode& code);
 void inlineCalls (ICode& code);
-bool optimizeCode (ICode& code);
+bool optimizeCode (ICode& code, bool incremental = true);
+
+/// Reorders the instructions of blocks to group independent private operations.
+bool scheduleInstructions (ICode& code);
+
+/// Number of private operations on the longest dependency chain through the procedure.
+unsigned privateCriticalPath (const Procedure& proc);
 
 } /* namespace SecreC { */
 
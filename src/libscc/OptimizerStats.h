@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SECREC_OPTIMIZER_STATS_H
+#define SECREC_OPTIMIZER_STATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace SecreC {
+
+/// Counts of the instructions removed or moved by the optimizer.
+struct OptimizerStats {
+
+    /// Accumulated cost of a data flow analysis that optimizeCode runs.
+    struct Analysis {
+        std::string name;       ///< As given to sca --analysis
+        std::size_t runs = 0u;
+        std::size_t rounds = 0u;
+        std::size_t blocks = 0u;
+        std::chrono::steady_clock::duration time {};
+    };
+
+    unsigned eliminatedPrivateOps = 0u; ///< Private operations and system calls.
+    unsigned eliminatedPublicOps = 0u;
+    unsigned hoistedInstructions = 0u;  ///< Moved out of loops.
+    unsigned batchedSyscalls = 0u;      ///< Scalar system calls merged into vector calls.
+    unsigned vectorSyscalls = 0u;       ///< Vector system calls that replaced them.
+    unsigned scheduledBlocks = 0u;      ///< Blocks with reordered instructions.
+    std::vector<Analysis> analyses;
+};
+
+} /* namespace SecreC { */
+
+#endif /* SECREC_OPTIMIZER_STATS_H */
@@ -48,6 +48,19 @@ extern "C" {
 union YYSTYPE;
 struct YYLTYPE;
 
+#define SECREC_STRBUF_SIZE 2048
+
+/**
+    Per-scanner state passed to the lexer as its extra data. Keeping the
+    string literal buffer here instead of in statics lets several scanners
+    run on different threads at once.
+*/
+struct SecrecScannerState {
+    TYPE_STRINGTABLE table;
+    unsigned strbuflen;
+    char strbuf[SECREC_STRBUF_SIZE];
+};
+
 /**
     Parses SecreC from the standard input.
     \param result pointer where to store the resulting parse tree.
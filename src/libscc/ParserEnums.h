@@ -233,6 +233,7 @@ enum SecrecDataType {
     O(PUSHCREF,                   SyscallParam) \
     O(PUSHREF,                    SyscallParam) \
     O(PUSH,                       SyscallParam) \
+    O(PURE,                       SyscallParam) \
     O(READONLY,                   SyscallParam) \
     O(SYSCALL_RETURN,             SyscallParam) \
     O(DATATYPE_DECL,              DataTypeDecl) \
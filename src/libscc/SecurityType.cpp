@@ -19,13 +19,10 @@
 
 #include "SecurityType.h"
 
+#include "Context.h"
+#include "ContextImpl.h"
 #include "Symbol.h"
 
-#include <boost/flyweight.hpp>
-#include <boost/flyweight/key_value.hpp>
-#include <boost/flyweight/no_locking.hpp>
-#include <boost/flyweight/no_tracking.hpp>
-
 namespace SecreC {
 
 /*******************************************************************************
@@ -49,18 +46,19 @@ void PrivateSecType::print (std::ostream & os) const {
     os << m_name;
 }
 
-const PrivateSecType* PrivateSecType::get (StringRef name,
+const PrivateSecType* PrivateSecType::get (Context& cxt,
+                                           StringRef name,
                                            SymbolKind* kind)
 {
-    using namespace ::boost::flyweights;
-    using PrivateSecTypeFlyweight =
-        flyweight<
-            key_value<std::pair<StringRef, SymbolKind*>, PrivateSecType>,
-            no_locking,
-            no_tracking
-        >;
+    auto& privateSecTypes = cxt.pImpl ()->m_privateSecTypes;
+    const auto key = std::make_pair (name, kind);
+    auto it = privateSecTypes.find (key);
+    if (it == privateSecTypes.end ()) {
+        it = privateSecTypes.emplace (key,
+            std::unique_ptr<PrivateSecType>{new PrivateSecType {name, kind}}).first;
+    }
 
-    return &PrivateSecTypeFlyweight{name, kind}.get();
+    return it->second.get ();
 }
 
 
@@ -27,6 +27,7 @@
 
 namespace SecreC {
 
+class Context;
 class SymbolKind;
 
 /*******************************************************************************
@@ -83,13 +84,6 @@ protected:
 class PrivateSecType : public SecurityType {
 public: /* Methods: */
 
-    // For boost::flyweight
-    PrivateSecType(const std::pair<StringRef, SymbolKind*>& p)
-        : SecurityType (false)
-        , m_name (p.first)
-        , m_kind (p.second)
-    { }
-
     PrivateSecType (StringRef name,
                     SymbolKind* kind)
         : SecurityType (false)
@@ -100,7 +94,7 @@ public: /* Methods: */
     inline StringRef name () const { return m_name; }
     inline SymbolKind* securityKind () const { return m_kind; }
 
-    static const PrivateSecType* get (StringRef name, SymbolKind* kind);
+    static const PrivateSecType* get (Context& cxt, StringRef name, SymbolKind* kind);
 
 protected:
     void print (std::ostream & os) const override;
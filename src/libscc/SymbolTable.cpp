@@ -41,6 +41,36 @@ void printIndent(std::ostream &out, unsigned level, unsigned indent = 4) {
 
 } // anonymous namespace
 
+/*******************************************************************************
+  SymbolTable::ScopedLookupTimer
+*******************************************************************************/
+
+/// Adds a lookup and its duration to the statistics, if they are enabled.
+class SymbolTable::ScopedLookupTimer {
+public: /* Methods: */
+
+    explicit ScopedLookupTimer (SymbolTable& global)
+        : m_global (global.m_timeLookups ? &global : nullptr)
+    {
+        if (m_global != nullptr)
+            m_start = std::chrono::steady_clock::now ();
+    }
+
+    ScopedLookupTimer (const ScopedLookupTimer&) = delete;
+    ScopedLookupTimer& operator = (const ScopedLookupTimer&) = delete;
+
+    ~ScopedLookupTimer () {
+        if (m_global != nullptr) {
+            ++ m_global->m_lookupStats.lookups;
+            m_global->m_lookupStats.time += std::chrono::steady_clock::now () - m_start;
+        }
+    }
+
+private: /* Fields: */
+    SymbolTable* const m_global;
+    std::chrono::steady_clock::time_point m_start;
+};
+
 /*******************************************************************************
   SymbolTable::OtherSymbols
 *******************************************************************************/
@@ -132,6 +162,9 @@ bool SymbolTable::addImport (SymbolTable* st) {
     assert (st != nullptr);
     if (std::find (m_imports.begin (), m_imports.end (), st) == m_imports.end ()) {
         m_imports.push_back (st);
+        st->m_imported = true;
+        if (m_observed)
+            ++ m_global->m_generation;
         return true;
     }
 
@@ -165,6 +198,37 @@ std::vector<SymbolSymbol*> SymbolTable::variablesUpTo (const SymbolTable* end) c
 void SymbolTable::appendSymbol (Symbol* symbol) {
     assert (symbol != nullptr);
     m_table.emplace_back (symbol);
+    m_index[IndexKey (symbol->symbolType (), symbol->name ())].push_back (symbol);
+
+    // Variables do not take part in resolving procedures or types. Other
+    // declarations may only change earlier lookups if some lookup has gone
+    // through this table. Quantifiers bound in the scope of a new template
+    // instance change nothing. Procedures and templates only change the
+    // lookups of their name.
+    if (symbol->symbolType () != SYM_SYMBOL) {
+        if (m_observed) {
+            if (isOverloadable (symbol->symbolType ()))
+                ++ m_global->m_nameGenerations[symbol->name ()];
+            else
+                ++ m_global->m_generation;
+        }
+
+        ++ m_declarations;
+    }
+}
+
+unsigned SymbolTable::generation (StringRef name) const {
+    const auto it = m_global->m_nameGenerations.find (name);
+    return m_global->m_generation +
+        (it != m_global->m_nameGenerations.end () ? it->second : 0u);
+}
+
+const SymbolTable* SymbolTable::declarationScope () const {
+    const SymbolTable* c = this;
+    while (! c->isDeclarationScope ())
+        c = c->m_parent;
+
+    return c;
 }
 
 void SymbolTable::appendOtherSymbol (Symbol* symbol) {
@@ -182,6 +246,7 @@ SymbolSymbol *SymbolTable::appendTemporary (const TypeNonVoid* type) {
 }
 
 Symbol *SymbolTable::find (SymbolCategory type, StringRef name) const {
+    const ScopedLookupTimer timer (*m_global);
     for (const SymbolTable* c = this; c != nullptr; c = c->m_parent) {
         const std::vector<Symbol*>& syms = c->findFromCurrentScope (type, name);
         if (syms.empty ()) continue;
@@ -201,6 +266,7 @@ SymbolTable::findPrefixed(SymbolCategory type, StringRef prefix) const {
 }
 
 std::vector<Symbol* > SymbolTable::findAll (SymbolCategory type, StringRef name) const {
+    const ScopedLookupTimer timer (*m_global);
     std::vector<Symbol* > out;
     for (const SymbolTable* c = this; c != nullptr; c = c->m_parent) {
         const std::vector<Symbol*>& syms = c->findFromCurrentScope (type, name);
@@ -211,10 +277,28 @@ std::vector<Symbol* > SymbolTable::findAll (SymbolCategory type, StringRef name)
 }
 
 std::vector<Symbol*> SymbolTable::findFromCurrentScope (SymbolCategory type, StringRef name) const {
-    return findFromCurrentScope (
-        [=](Symbol* s) {
-            return s->symbolType () == type && s->name () == name;
-        });
+    using boost::adaptors::reverse;
+
+    if (! m_global->m_indexed) {
+        return findFromCurrentScope (
+            [=](Symbol* s) {
+                return s->symbolType () == type && s->name () == name;
+            });
+    }
+
+    // Same order as the predicate based lookup: most recent import first and
+    // most recent declaration first within each of the imported tables.
+    std::vector<Symbol*> r;
+    const IndexKey key (type, name);
+    for (SymbolTable* import : reverse (m_imports)) {
+        import->m_observed = true;
+        auto it = import->m_index.find (key);
+        if (it != import->m_index.end ()) {
+            r.insert (r.end (), it->second.rbegin (), it->second.rend ());
+        }
+    }
+
+    return r;
 }
 
 SymbolTable *SymbolTable::newScope () {
@@ -25,8 +25,11 @@
 #include "TreeNodeFwd.h"
 
 #include <algorithm>
+#include <boost/functional/hash.hpp>
 #include <boost/range/adaptor/reversed.hpp>
+#include <chrono>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 namespace SecreC {
@@ -46,6 +49,44 @@ class SymbolTable {
 private: /* Types: */
     using Table = std::vector<std::unique_ptr<Symbol>>;
     using Scopes = std::vector<std::unique_ptr<SymbolTable>>;
+
+    /**
+     * Key of the per-scope name index. The name refers to the storage of
+     * the indexed symbol, hence symbols must not be renamed after they have
+     * been appended to the table.
+     */
+    struct IndexKey {
+        IndexKey (SymbolCategory category_, StringRef name_)
+            : category (category_)
+            , name (name_)
+        { }
+
+        inline friend bool operator == (const IndexKey& k1, const IndexKey& k2) {
+            return k1.category == k2.category && k1.name == k2.name;
+        }
+
+        inline friend size_t hash_value (const IndexKey& key) {
+            size_t seed = 0;
+            boost::hash_combine (seed, key.category);
+            boost::hash_combine (seed, key.name);
+            return seed;
+        }
+
+        SymbolCategory const category;
+        StringRef const name;
+    };
+
+    /// Symbols of the scope grouped by category and name in declaration order.
+    using Index = std::unordered_map<IndexKey, std::vector<Symbol*>, boost::hash<IndexKey>>;
+
+public: /* Types: */
+
+    /// Lookups by name of all the scopes, counted in the global scope.
+    struct LookupStats {
+        std::size_t lookups = 0u;
+        std::chrono::steady_clock::duration time {};
+    };
+
 public: /* Methods: */
     SymbolTable (StringRef name = "Global");
     explicit SymbolTable(SymbolTable *parent, StringRef name = "Local");
@@ -88,6 +129,32 @@ public: /* Methods: */
     SymbolTable* parent () const { return m_parent; }
     SymbolTable* globalScope () const { return m_global; }
 
+    /**
+     * Innermost enclosing scope that declares something besides variables
+     * or imports modules. Procedures, templates and type names resolve to
+     * the same symbols from this scope as from the current one.
+     */
+    const SymbolTable* declarationScope () const;
+
+    /**
+     * Changes whenever a procedure or a template of the given name is added
+     * to a scope that some lookup has already gone through. Imports and other
+     * declarations, except for variables, change the generation of every name.
+     * Procedures are named with their mangled parameter types.
+     */
+    unsigned generation (StringRef name) const;
+
+    /**
+     * Whether lookups by name use the index of every scope or compare the
+     * names of all the symbols, as before the index. The latter is only for
+     * measuring the index.
+     */
+    void setIndexed (bool indexed) { m_global->m_indexed = indexed; }
+
+    /// Whether to count and time the lookups by name, off by default.
+    void setLookupStats (bool enabled) { m_global->m_timeLookups = enabled; }
+    const LookupStats& lookupStats () const { return m_global->m_lookupStats; }
+
     /**
      * Add imported module for current scope.
      * \retval false if the scope is already imported
@@ -119,6 +186,7 @@ public: /* Methods: */
 
         std::vector<Symbol*> r;
         for (SymbolTable* import : reverse (m_imports)) {
+            import->m_observed = true;
             for (auto const & sym : reverse (import->m_table)) {
                 if (pred(sym.get())) {
                     r.push_back(sym.get());
@@ -132,16 +200,36 @@ public: /* Methods: */
     std::vector<SymbolSymbol*> variablesUpTo (const SymbolTable* end) const;
     std::vector<SymbolSymbol*> variables () const;
 
+private: /* Methods: */
+    bool isDeclarationScope () const {
+        return m_declarations > 0 || m_imports.size () > 1 || m_parent == nullptr;
+    }
+
+    /// Whether overload resolution depends on symbols of the category.
+    static bool isOverloadable (SymbolCategory category) {
+        return category == SYM_PROCEDURE || category == SYM_PROCEDURE_TEMPLATE;
+    }
+
 private: /* Fields: */
     class OtherSymbols;
+    class ScopedLookupTimer;
 
     Table                       m_table;    ///< Symbols.
+    Index                       m_index;    ///< Symbols indexed by category and name.
     SymbolTable* const          m_parent;   ///< Parent scope.
     SymbolTable* const          m_global;   ///< Global scope.
     OtherSymbols* const         m_other;    ///< Temporaries and labels.
     std::vector<SymbolTable* >  m_imports;  ///< STs of imported modules.
     Scopes                      m_scopes;   ///< Local scopes.
     StringRef                   m_name;     ///< Debugging.
+    unsigned                    m_declarations = 0; ///< Number of non-variable symbols.
+    unsigned                    m_generation = 0;   ///< Only used in the global scope.
+    std::unordered_map<StringRef, unsigned> m_nameGenerations; ///< Only used in the global scope.
+    bool                        m_observed = false; ///< Some lookup has gone through the scope.
+    bool                        m_indexed = true;   ///< Only used in the global scope.
+    bool                        m_timeLookups = false; ///< Only used in the global scope.
+    LookupStats                 m_lookupStats;      ///< Only used in the global scope.
+    bool                        m_imported = false; ///< Imported by some other scope.
 };
 
 std::ostream & operator<<(std::ostream & out, const SymbolTable & st);
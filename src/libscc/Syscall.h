@@ -30,6 +30,12 @@ class Symbol;
 enum SyscallAttribute {
     None     = 0x00,
     ReadOnly = 0x01,
+    /**
+     * The operand is the result of a side-effect-free system call. The value
+     * written to it depends only on the system call name and the other,
+     * unmarked, operands, which the system call does not modify.
+     */
+    Pure     = 0x02,
 };
 
 
@@ -80,6 +86,10 @@ public: /* Methods: */
         return false;
     }
 
+    bool isPure() const {
+        return (m_attributeSet & static_cast<unsigned>(Pure)) != 0;
+    }
+
 private: /* Fields: */
     Symbol* const                  m_operand;
     const SyscallPassingConvention m_convention;
@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "SyscallName.h"
+
+#include "Constant.h"
+#include "DataType.h"
+#include "SecurityType.h"
+#include "Symbol.h"
+#include "Types.h"
+
+#include <cassert>
+
+
+namespace SecreC {
+
+namespace /* anonymous */ {
+
+void syscallMangleImopType (std::ostream& os, Imop::Type iType) {
+    switch (iType) {
+    case Imop::CLASSIFY:   os << "classify";    break;
+    case Imop::DECLASSIFY: os << "declassify";  break;
+    case Imop::RELEASE:    os << "delete";      break;
+    case Imop::COPY:       os << "copy";        break;
+    case Imop::STORE:      os << "store";       break;
+    case Imop::LOAD:       os << "load";        break;
+    case Imop::GATHER:     os << "gather";      break;
+    case Imop::SCATTER:    os << "scatter";     break;
+    default:                                    break;
+    }
+}
+
+void syscallMangleSecrecDataType (std::ostream& os, SecrecDataType ty) {
+    switch (ty) {
+    case DATATYPE_BOOL:        os << "bool";         break;
+    case DATATYPE_UINT8:       os << "uint8";        break;
+    case DATATYPE_UINT16:      os << "uint16";       break;
+    case DATATYPE_UINT32:      os << "uint32";       break;
+    case DATATYPE_UINT64:      os << "uint64";       break;
+    case DATATYPE_INT8:        os << "int8";         break;
+    case DATATYPE_INT16:       os << "int16";        break;
+    case DATATYPE_INT32:       os << "int32";        break;
+    case DATATYPE_INT64:       os << "int64";        break;
+    case DATATYPE_FLOAT32:     os << "float32";      break;
+    case DATATYPE_FLOAT64:     os << "float64";      break;
+    default:                                         break;
+    }
+}
+
+void syscallMangleNamespace (std::ostream& os, const TypeNonVoid* tnv) {
+    if (tnv->secrecSecType ()->isPrivate ()) {
+        const auto secTy = static_cast<const PrivateSecType*>(tnv->secrecSecType ());
+        os << secTy->securityKind ()->name () << "::";
+    }
+}
+
+bool isPrivate (const Symbol* sym) {
+    return sym != nullptr && sym->secrecType () != nullptr &&
+           sym->secrecType ()->secrecSecType ()->isPrivate ();
+}
+
+bool isPrivate (const Imop& imop) {
+    for (const Symbol* sym : imop.operands ()) {
+        if (isPrivate (sym))
+            return true;
+    }
+
+    return false;
+}
+
+const Symbol* sizeOf (const Symbol* sym) {
+    if (! sym->isArray ())
+        return nullptr;
+
+    return const_cast<SymbolSymbol*> (static_cast<const SymbolSymbol*> (sym))->getSizeSym ();
+}
+
+} // anonymous namespace
+
+/*******************************************************************************
+  SyscallName
+*******************************************************************************/
+
+SyscallName& SyscallName::operator << (const TypeNonVoid* tnv) {
+    syscallMangleNamespace (m_os, tnv);
+    return *this;
+}
+
+SyscallName& SyscallName::operator << (Imop::Type iType) {
+    syscallMangleImopType (m_os, iType);
+    return *this;
+}
+
+SyscallName& SyscallName::operator << (SecrecDataType ty) {
+    syscallMangleSecrecDataType (m_os, ty);
+    return *this;
+}
+
+SyscallName& SyscallName::operator << (const DataType* ty) {
+    assert(ty);
+    assert (ty->isPrimitive ());
+
+    if (ty->isBuiltinPrimitive ()) {
+        syscallMangleSecrecDataType (m_os, static_cast<const DataTypeBuiltinPrimitive*>(ty)->secrecDataType ());
+    }
+    else {
+        m_os << static_cast<const DataTypeUserPrimitive*> (ty)-> name ();
+    }
+
+    return *this;
+}
+
+std::string SyscallName::tostring (SecrecDataType dType) {
+    SyscallName scname;
+    scname << dType << "_toString";
+    return scname.str ();
+}
+
+std::string SyscallName::tostring (const DataType* dType) {
+    assert(dType);
+    assert (dType->isBuiltinPrimitive ());
+    return tostring (static_cast<const DataTypeBuiltinPrimitive*>(dType)->secrecDataType ());
+}
+
+std::string SyscallName::basic (const TypeNonVoid* ty, const char* name,  bool needDataType, bool needVec) {
+    SyscallName scname;
+    scname << ty << name;
+    if (needDataType) {
+        scname << '_' << ty->secrecDataType ();
+    }
+
+    if (needVec) {
+        scname << "_vec";
+    }
+
+    return scname.str ();
+}
+
+/*******************************************************************************
+  PrivateSyscall
+*******************************************************************************/
+
+// scc's Compiler takes the names of the calls it emits from here.
+std::vector<PrivateSyscall> privateSyscalls (const Imop& imop) {
+    std::vector<PrivateSyscall> out;
+    if (! isPrivate (imop))
+        return out;
+
+    auto emit = [&out](const TypeNonVoid* ty, const char* name, const Symbol* size) {
+        out.push_back (PrivateSyscall {SyscallName::basic (ty, name), ty, size});
+    };
+
+    const Symbol* vecSize = imop.isVectorized () ? imop.operands ().back () : nullptr;
+    switch (imop.type ()) {
+    case Imop::DECLARE:
+        emit (imop.dest ()->secrecType (), "new", nullptr);
+        break;
+    case Imop::ALLOC:
+        emit (imop.dest ()->secrecType (), "new", imop.arg1 ());
+        if (imop.nArgs () == 3) {
+            const bool privateArg = isPrivate (imop.arg2 ());
+            emit (imop.dest ()->secrecType (), privateArg ? "fill" : "init", imop.arg1 ());
+        }
+        break;
+    case Imop::COPY:
+        emit (imop.dest ()->secrecType (), "new", imop.arg2 ());
+        emit (imop.dest ()->secrecType (), "assign", imop.arg2 ());
+        break;
+    case Imop::ASSIGN:
+        if (! imop.dest ()->isString ())
+            emit (imop.dest ()->secrecType (), "assign", vecSize);
+        break;
+    case Imop::CLASSIFY:
+        emit (imop.dest ()->secrecType (), imop.isVectorized () ? "classify" : "init", vecSize);
+        break;
+    case Imop::DECLASSIFY:
+        emit (imop.arg1 ()->secrecType (), "declassify", vecSize);
+        break;
+    case Imop::RELEASE:
+        emit (imop.arg1 ()->secrecType (), "delete", sizeOf (imop.arg1 ()));
+        break;
+    case Imop::LOAD:
+        emit (imop.dest ()->secrecType (), "load", nullptr);
+        break;
+    case Imop::STORE:
+        emit (imop.dest ()->secrecType (), "store", nullptr);
+        break;
+    case Imop::GATHER:
+        emit (imop.dest ()->secrecType (), "gather", imop.arg3 ());
+        break;
+    case Imop::SCATTER:
+        emit (imop.dest ()->secrecType (), "scatter", imop.arg3 ());
+        break;
+    case Imop::SYSCALL: {
+        const TypeNonVoid* ty = nullptr;
+        const Symbol* size = nullptr;
+        for (const SyscallOperand& op : imop.syscallOperands ()) {
+            const Symbol* sym = op.operand ();
+            if (! isPrivate (sym))
+                continue;
+
+            if (ty == nullptr)
+                ty = sym->secrecType ();
+            if (size == nullptr)
+                size = sizeOf (sym);
+        }
+
+        const auto name = static_cast<const ConstantString*> (imop.arg1 ());
+        out.push_back (PrivateSyscall {name->value ().str (), ty, size});
+        break;
+    }
+    default:
+        break;
+    }
+
+    return out;
+}
+
+} // namespace SecreC
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SECREC_SYSCALL_NAME_H
+#define SECREC_SYSCALL_NAME_H
+
+#include "Imop.h"
+#include "ParserEnums.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace SecreC {
+
+class DataType;
+class Symbol;
+class TypeNonVoid;
+
+/*******************************************************************************
+  SyscallName
+*******************************************************************************/
+
+/**
+ * Names of the system calls that implement private operations in the
+ * protection domains, such as "shared3p::declassify_int64_vec".
+ */
+class SyscallName {
+public: /* Methods: */
+    SyscallName () { }
+
+    SyscallName& operator << (const char* name) {
+        m_os << name;
+        return *this;
+    }
+
+    SyscallName& operator << (char c) {
+        m_os << c;
+        return *this;
+    }
+
+    SyscallName& operator << (const std::string& name) {
+        m_os << name;
+        return *this;
+    }
+
+    /// Namespace of the protection domain kind for private types.
+    SyscallName& operator << (const TypeNonVoid* tnv);
+    SyscallName& operator << (Imop::Type iType);
+    SyscallName& operator << (SecrecDataType ty);
+    SyscallName& operator << (const DataType* ty);
+
+    std::string str () const {
+        return m_os.str ();
+    }
+
+    static std::string tostring (SecrecDataType dType);
+    static std::string tostring (const DataType* dType);
+    static std::string basic (const TypeNonVoid* ty, const char* name, bool needDataType = true, bool needVec = true);
+
+private: /* Fields: */
+    std::ostringstream   m_os;
+};
+
+/*******************************************************************************
+  PrivateSyscall
+*******************************************************************************/
+
+/// A system call that scc emits for a private instruction.
+struct PrivateSyscall {
+    std::string        name;
+    const TypeNonVoid* type;   ///< Private type the call operates on.
+    const Symbol*      size;   ///< Number of elements, nullptr for a scalar.
+};
+
+/**
+ * System calls to protection domains that scc emits for the instruction, in
+ * the order they are emitted in. Calls written in the source are included if
+ * they have a private operand.
+ */
+std::vector<PrivateSyscall> privateSyscalls (const Imop& imop);
+
+} // namespace SecreC
+
+#endif // SECREC_SYSCALL_NAME_H
@@ -1645,6 +1645,7 @@ TreeNode * treenode_init(enum SecrecTreeNodeType type, const YYLTYPE * loc) {
     SELECTNODETYPE(PUSH, SyscallParam);
     SELECTNODETYPE(PUSHCREF, SyscallParam);
     SELECTNODETYPE(PUSHREF, SyscallParam);
+    SELECTNODETYPE(PURE, SyscallParam);
     SELECTNODETYPE(SYSCALL_RETURN, SyscallParam);
 
     SELECTEXPR(NONE, None);
@@ -19,6 +19,7 @@
 
 #include "TypeArgument.h"
 
+#include <boost/functional/hash.hpp>
 #include <sharemind/abort.h>
 #include "DataType.h"
 #include "Log.h"
@@ -191,4 +192,16 @@ bool operator<(TypeArgument const & a, TypeArgument const & b) {
     }
 }
 
+size_t hash_value (const TypeArgument& a) {
+    size_t seed = 0;
+    boost::hash_combine (seed, a.m_kind);
+    switch (a.m_kind) {
+    case TA_DIM:  boost::hash_combine (seed, a.un_dimType); break;
+    case TA_SEC:  boost::hash_combine (seed, a.un_secType); break;
+    case TA_DATA: boost::hash_combine (seed, a.un_dataType); break;
+    }
+
+    return seed;
+}
+
 } // namespace SecreC
@@ -23,6 +23,7 @@
 #include "ParserEnums.h"
 
 #include <cassert>
+#include <cstddef>
 #include <iosfwd>
 
 
@@ -116,6 +117,7 @@ public: /* Methods: */
 
     friend bool operator == (const TypeArgument& a, const TypeArgument& b);
     friend bool operator < (const TypeArgument& a, const TypeArgument& b);
+    friend size_t hash_value (const TypeArgument& a);
     friend std::ostream& operator << (std::ostream& os, const TypeArgument& a);
 
 private: /* Fields: */
@@ -135,6 +137,8 @@ inline bool operator != (const TypeArgument& a, const TypeArgument& b) {
 
 bool operator<(TypeArgument const & a, TypeArgument const & b);
 
+size_t hash_value (const TypeArgument& a);
+
 std::ostream& operator << (std::ostream& os, const TypeArgument& a);
 
 TypeArgumentKind quantifierKind (const TreeNodeQuantifier& quant);
@@ -26,6 +26,7 @@
 #include "SymbolTable.h"
 #include "TreeNode.h"
 #include "Types.h"
+#include "typechecker/ResolutionCache.h"
 #include "typechecker/Templates.h"
 
 #include <boost/range.hpp>
@@ -54,10 +55,12 @@ TypeChecker::TypeChecker (OperatorTable& ops, SymbolTable& st, CompileLog& log,
     , m_log (log)
     , m_context (cxt)
     , m_instantiator (new TemplateInstantiator ())
+    , m_resolutionCache (new ResolutionCache ())
 { }
 
 TypeChecker::~TypeChecker () {
     delete m_instantiator;
+    delete m_resolutionCache;
 }
 
 bool TypeChecker::getForInstantiation (InstanceInfo& info) {
@@ -25,6 +25,8 @@
 #include "TreeNodeFwd.h"
 #include "TypeArgument.h"
 
+#include <cstddef>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -37,6 +39,10 @@ class Instantiation;
 class Location;
 class OperatorTable;
 class OverloadableOperator;
+class ResolutionCache;
+struct ResolutionCacheEntry;
+struct ResolutionCacheKey;
+struct ResolutionGeneration;
 class SecurityType;
 class StringRef;
 class SymbolTable;
@@ -71,6 +77,13 @@ public: /* Types: */
 
     using result_type = Status;
 
+    /// Counters of the procedure, operator and cast resolution cache.
+    struct ResolutionStats {
+        std::size_t hits = 0u;
+        std::size_t misses = 0u;
+        std::size_t stale = 0u;    ///< Misses on entries whose name has been redeclared.
+    };
+
 public: /* Methods: */
 
     TypeChecker (OperatorTable& ops, SymbolTable& st, CompileLog& log, Context& cxt);
@@ -186,6 +199,8 @@ public: /* Methods: */
 
     Status checkPublicBooleanScalar (TreeNodeExpr* e);
 
+    const ResolutionStats& resolutionStats () const;
+
 private: /* Methods: */
 
     Status checkTypeApplication (TreeNodeIdentifier* id,
@@ -255,13 +270,13 @@ private: /* Methods: */
     Status findRegularOpDef(SymbolProcedure *& symProc,
                             StringRef name,
                             const TypeProc * callTypeProc,
-                            const TreeNode * errorCxt);
+                            std::string & ambiguity);
 
     Status findRegularProc(SymbolProcedure *& symProc,
                            StringRef name,
                            const TypeContext & tyCxt,
                            const TypeProc * argTypes,
-                           const TreeNode * errorCxt);
+                           std::string & ambiguity);
 
     /**
      * \brief Looks for a best matching procedure or template.
@@ -292,6 +307,44 @@ private: /* Methods: */
                                    const TypeBasic * want,
                                    const TreeNode * errorCxt);
 
+    /**
+     * Uncached variants of the findBestMatching* methods. Instead of logging
+     * ambiguous matches they return \a E_TYPE and describe the candidates
+     * in \a ambiguity.
+     */
+    Status resolveProc(SymbolProcedure *& symProc,
+                       StringRef name,
+                       const TypeContext & tyCxt,
+                       const TypeProc * argTypes,
+                       std::string & ambiguity);
+
+    Status resolveOpDef(SymbolProcedure *& symProc,
+                        StringRef name,
+                        const TypeContext & tyCxt,
+                        const TypeProc * callTypeProc,
+                        std::string & ambiguity);
+
+    Status resolveCastDef(SymbolProcedure *& symProc,
+                          const TypeBasic * arg,
+                          const TypeBasic * want,
+                          std::string & ambiguity);
+
+    ResolutionGeneration resolutionGeneration (const ResolutionCacheKey& key) const;
+
+    const ResolutionCacheEntry* findResolution (const ResolutionCacheKey& key,
+                                                const ResolutionGeneration& generation);
+
+    Status reuseResolution (const ResolutionCacheEntry& entry,
+                            SymbolProcedure *& symProc,
+                            const TreeNode * errorCxt);
+
+    Status storeResolution (ResolutionCacheKey key,
+                            const ResolutionGeneration& generation,
+                            Status status,
+                            SymbolProcedure * symProc,
+                            const std::string & ambiguity,
+                            const TreeNode * errorCxt);
+
     Status checkRedefinitions(const TreeNodeProcDef& proc);
 
 private: /* Fields: */
@@ -301,6 +354,7 @@ private: /* Fields: */
     CompileLog&            m_log;
     Context&               m_context;
     TemplateInstantiator*  m_instantiator;
+    ResolutionCache*       m_resolutionCache;
     std::vector<StringRef> m_structsInProgress;
 };
 
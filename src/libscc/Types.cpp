@@ -32,8 +32,8 @@
 
 #include <boost/flyweight.hpp>
 #include <boost/flyweight/key_value.hpp>
-#include <boost/flyweight/no_locking.hpp>
 #include <boost/flyweight/no_tracking.hpp>
+#include <boost/flyweight/simple_locking.hpp>
 #include <boost/functional/hash.hpp>
 
 namespace SecreC {
@@ -185,7 +185,7 @@ const TypeBasic* TypeBasic::get (const SecurityType* secType,
     using TypeBasicFlyweigh =
         flyweight<key_value<TypeBasic::Key, TypeBasic>,
         no_tracking,
-        no_locking
+        simple_locking
     >;
 
     return &TypeBasicFlyweigh{secType, dataType, dimType}.get();
@@ -247,7 +247,7 @@ const TypeProc* TypeProc::get (const std::vector<const TypeBasic*>& params,
                 TypeProc
             >,
             no_tracking,
-            no_locking
+            simple_locking
         >;
 
     return &TypeProcFlyweigh{params, returnType}.get();
@@ -22,24 +22,36 @@
 #include "Blocks.h"
 #include "Constant.h"
 #include "DataType.h"
+#include "PrettyPrint.h"
 #include "SecurityType.h"
 #include "SymbolTable.h"
 #include "TreeNode.h"
 #include "Types.h"
+#include "VirtualMachineKernels.h"
+#include "VirtualMachineProfile.h"
+#include "VirtualMachineSyscalls.h"
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <map>
+#include <new>
+#include <set>
 #include <sharemind/abort.h>
 #include <sstream>
 #include <stack>
+#include <stdexcept>
 #include <stdint.h>
 #include <string>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 
 #if 0
@@ -71,23 +83,27 @@ union ValueUnion {
     int8_t        un_int8_val;
     bool          un_bool_val;
 
-    ValueUnion*        un_ptr;
+    void*         un_ptr; ///< Packed array of elements of the data type.
     std::string*  un_str_val;
 };
 
+/// Value type and the type of array elements of each data type.
 template <SecrecDataType ty> struct secrec_type_traits;
-template <> struct secrec_type_traits<DATATYPE_FLOAT64> { using type = double; };
-template <> struct secrec_type_traits<DATATYPE_FLOAT32> { using type = float; };
-template <> struct secrec_type_traits<DATATYPE_UINT64> { using type = uint64_t; };
-template <> struct secrec_type_traits<DATATYPE_UINT32> { using type = uint32_t; };
-template <> struct secrec_type_traits<DATATYPE_UINT16> { using type = uint16_t; };
-template <> struct secrec_type_traits<DATATYPE_UINT8> { using type = uint8_t; };
-template <> struct secrec_type_traits<DATATYPE_INT64> { using type = int64_t; };
-template <> struct secrec_type_traits<DATATYPE_INT32> { using type = int32_t; };
-template <> struct secrec_type_traits<DATATYPE_INT16> { using type = int16_t; };
-template <> struct secrec_type_traits<DATATYPE_INT8> { using type = int8_t; };
-template <> struct secrec_type_traits<DATATYPE_STRING> { using type = const std::string&; };
-template <> struct secrec_type_traits<DATATYPE_BOOL> { using type = bool; };
+template <> struct secrec_type_traits<DATATYPE_FLOAT64> { using type = double; using element = double; };
+template <> struct secrec_type_traits<DATATYPE_FLOAT32> { using type = float; using element = float; };
+template <> struct secrec_type_traits<DATATYPE_UINT64> { using type = uint64_t; using element = uint64_t; };
+template <> struct secrec_type_traits<DATATYPE_UINT32> { using type = uint32_t; using element = uint32_t; };
+template <> struct secrec_type_traits<DATATYPE_UINT16> { using type = uint16_t; using element = uint16_t; };
+template <> struct secrec_type_traits<DATATYPE_UINT8> { using type = uint8_t; using element = uint8_t; };
+template <> struct secrec_type_traits<DATATYPE_INT64> { using type = int64_t; using element = int64_t; };
+template <> struct secrec_type_traits<DATATYPE_INT32> { using type = int32_t; using element = int32_t; };
+template <> struct secrec_type_traits<DATATYPE_INT16> { using type = int16_t; using element = int16_t; };
+template <> struct secrec_type_traits<DATATYPE_INT8> { using type = int8_t; using element = int8_t; };
+template <> struct secrec_type_traits<DATATYPE_STRING> { using type = const std::string&; using element = std::string*; };
+template <> struct secrec_type_traits<DATATYPE_BOOL> { using type = bool; using element = bool; };
+
+template <SecrecDataType ty>
+using element_t = typename secrec_type_traits<ty>::element;
 
 /// Get value based on the data type.
 template <SecrecDataType ty> typename secrec_type_traits<ty>::type getValue (const ValueUnion&);
@@ -118,6 +134,27 @@ inline void assignValue (ValueUnion& v, int8_t r) { v.un_int8_val = r; }
 inline void assignValue (ValueUnion& v, bool r) { v.un_bool_val = r; }
 inline void assignValue (ValueUnion& v, const std::string& r) { v.un_str_val = new std::string (r); }
 
+/// Get and set array elements.
+template <SecrecDataType ty>
+inline ValueUnion loadElement (element_t<ty> x) {
+    ValueUnion v;
+    assignValue (v, x);
+    return v;
+}
+
+template <>
+inline ValueUnion loadElement<DATATYPE_STRING> (std::string* x) {
+    ValueUnion v;
+    v.un_str_val = x;
+    return v;
+}
+
+template <SecrecDataType ty>
+inline void storeElement (element_t<ty>& x, const ValueUnion& v) { x = getValue<ty> (v); }
+
+template <>
+inline void storeElement<DATATYPE_STRING> (std::string*& x, const ValueUnion& v) { x = v.un_str_val; }
+
 /// Statically typed value casting.
 template <SecrecDataType toTy, SecrecDataType fromTy >
 void castValue (ValueUnion& dest, const ValueUnion& from) {
@@ -175,32 +212,94 @@ private:
     }
 };
 
+/// Stack of frame slots. Every frame is a contiguous range of slots.
+class SlotStack {
+
+public:
+
+    SlotStack () : m_bptr (nullptr), m_offset (0), m_size (0) { }
+
+    SlotStack(SlotStack &&) = delete;
+    SlotStack(SlotStack const &) = delete;
+
+    ~SlotStack () { free (m_bptr); }
+
+    SlotStack & operator=(SlotStack &&) = delete;
+    SlotStack & operator=(SlotStack const &) = delete;
+
+    ValueUnion* at (size_t offset) { return m_bptr + offset; }
+
+    /// Allocates n zeroed slots and returns the offset of the first one.
+    size_t allocate (size_t n) {
+        if (m_offset + n > m_size)
+            increase_size (m_offset + n);
+        const size_t base = m_offset;
+        if (n > 0)
+            memset (m_bptr + base, 0, n * sizeof (ValueUnion));
+        m_offset += n;
+        return base;
+    }
+
+    /// Releases all slots from the given offset upwards.
+    void release (size_t offset) {
+        assert (offset <= m_offset);
+        m_offset = offset;
+    }
+
+private:
+    ValueUnion*   m_bptr;
+    size_t   m_offset;
+    size_t   m_size;
+
+    void increase_size (size_t minSize) {
+        const size_t newSize = std::max (minSize, ((m_size + 1) * 3) / 2);
+        TRACE("RESIZE FRAME STACK TO %zu\n", newSize);
+        auto * newBPtr =
+                static_cast<ValueUnion *>(
+                    realloc(m_bptr, newSize * sizeof(ValueUnion)));
+        if (newBPtr == nullptr)
+            throw std::bad_alloc ();
+        m_bptr = newBPtr;
+        m_size = newSize;
+    }
+};
+
 struct Instruction;
+struct ExecutionContext;
+class Profiler;
+struct SyscallSite;
+
+/// Index of a symbol in its frame or in the global store.
+using SlotIndex = uint32_t;
 
 /**
  * Virtual machine symbol. May be either IR symbol, or pointer to some other
- * instruction.  Additinally has a tag for if it's local or global symbol.
+ * instruction.  Additinally has a tag for if it's local or global symbol, and
+ * the index of its slot in the frame or in the global store.
  */
 struct VMSym {
     bool isLocal : 1;
+    SlotIndex slot;
     union {
         const Symbol* un_sym;
         Instruction* un_inst;
+        SyscallSite* un_syscall;
     };
 
     VMSym () { }
 
-    VMSym (bool isLocal_, Symbol const * sym)
+    VMSym (bool isLocal_, SlotIndex slot_, Symbol const * sym)
         : isLocal(isLocal_)
+        , slot(slot_)
         , un_sym(sym)
     {}
 };
 
-/// Very naive implementation of a memory store.
-using Store = std::map<const Symbol*, ValueUnion>;
+/// Global symbols and constants, indexed by slot.
+using Store = std::vector<ValueUnion>;
 
 /// Type of instantiated callback.
-using CallbackTy = int (*)(const Instruction*);
+using CallbackTy = int (*)(const Instruction*, ExecutionContext&);
 
 /// Instructions are composed of callback, and 4 arguments.
 struct Instruction {
@@ -216,37 +315,12 @@ struct Instruction {
     { }
 };
 
-/// Each frame has local store, old instruction pointer, and pointer to previous frame.
+/// Each frame has old instruction pointer and the offset of its slots.
 struct Frame {
-    Store                     m_local;
-    const Instruction* const  m_old_ip;
-    Frame*                    m_prev_frame;
-
-    Frame(const Instruction* old_ip)
-        : m_old_ip (old_ip)
-        , m_prev_frame(nullptr)
-    { }
-
-private:
-
-    Frame (const Frame&);
-    Frame& operator = (const Frame&);
+    const Instruction*  m_old_ip;
+    size_t              m_base;
 };
 
-/**
- * State of the interpreter.
- * We have:
- * - stack for function arguments and return values
- * - frame stack
- * - one register for temporary values, for example constants are stored in it
- * - store for global variables
- */
-
-ValueStack m_stack;
-Frame* m_frames = nullptr;
-Store m_global;
-std::uint64_t m_fpuState = 0u;
-
 void free_store (Store& store) {
     // TODO: not actually releasing any dynamically allocated memory
     // This is not a serious issue as this VM is only used for testing
@@ -254,36 +328,69 @@ void free_store (Store& store) {
     store.clear();
 }
 
-inline void push_frame (const Instruction* old_ip) {
-    auto new_frame = new (std::nothrow) Frame (old_ip);
-    new_frame->m_prev_frame = m_frames;
-    m_frames = new_frame;
-}
+/**
+ * State of the interpreter. Every run has its own context which is passed
+ * through all the callbacks.
+ * We have:
+ * - stack for function arguments and return values
+ * - frame stack, and slots of the frames
+ * - slots of the current frame
+ * - store for global variables and constants
+ * - streams for the output of the program
+ * - profiler, if the run is profiled
+ */
+struct ExecutionContext {
+    ValueStack          m_stack;
+    std::vector<Frame>  m_frames;
+    SlotStack           m_slots;
+    ValueUnion*         m_locals = nullptr;
+    Store               m_global;
+    std::uint64_t       m_fpuState = 0u;
+    std::uint64_t       m_instructionCount = 0u;
+    std::ostream&       m_out;
+    std::ostream&       m_err;
+    Profiler*           m_profiler = nullptr;
+    bool                m_reportSyscalls = false;
+
+    ExecutionContext (std::ostream& out, std::ostream& err)
+        : m_out (out)
+        , m_err (err)
+    { }
 
-inline void pop_frame (void) {
-    assert (m_frames != nullptr && "No frames to pop!");
-    Frame* temp = m_frames;
-    m_frames = temp->m_prev_frame;
-    free_store (temp->m_local);
-    delete temp;
-}
+    ExecutionContext (const ExecutionContext&) = delete;
+    ExecutionContext& operator = (const ExecutionContext&) = delete;
 
-// Force to not inline to make output assembler nicer.
-ValueUnion& lookup (VMSym sym) __attribute__ ((noinline));
-ValueUnion& lookup (VMSym sym)  {
-    TRACE ("%s ", (sym.isLocal ? "LOCAL" : "GLOBAL"));
-    Store& store = sym.isLocal ? m_frames->m_local : m_global;
-    assert (sym.un_sym != nullptr);
-    return store[sym.un_sym];
-}
+    ~ExecutionContext () {
+        // Program might exit from within a procedure, and if that
+        // happens we nee to unwind all the frames to clear the memory.
+        while (! m_frames.empty ()) {
+            pop_frame ();
+        }
 
-// Force to not inline to make output assembler nicer.
-void storeSym (VMSym sym, ValueUnion val) __attribute__ ((noinline));
-void storeSym (VMSym sym, ValueUnion val) {
-    Store& store = sym.isLocal ? m_frames->m_local : m_global;
-    assert (sym.un_sym != nullptr);
-    store[sym.un_sym] = val;
-}
+        free_store (m_global);
+    }
+
+    inline void push_frame (const Instruction* old_ip, SlotIndex size) {
+        m_frames.push_back (Frame { old_ip, m_slots.allocate (size) });
+        m_locals = m_slots.at (m_frames.back ().m_base);
+    }
+
+    inline void pop_frame (void) {
+        assert (! m_frames.empty () && "No frames to pop!");
+        m_slots.release (m_frames.back ().m_base);
+        m_frames.pop_back ();
+        m_locals = m_frames.empty () ? nullptr : m_slots.at (m_frames.back ().m_base);
+    }
+
+    inline ValueUnion& lookup (VMSym sym) {
+        TRACE ("%s ", (sym.isLocal ? "LOCAL" : "GLOBAL"));
+        return sym.isLocal ? m_locals[sym.slot] : m_global[sym.slot];
+    }
+
+    inline void storeSym (VMSym sym, ValueUnion val) {
+        lookup (sym) = val;
+    }
+};
 
 // Quick and dirty solution.
 template <SecrecDataType fromTy >
@@ -308,6 +415,37 @@ void castValueDyn (const DataType* dataType, ValueUnion& dest, const ValueUnion&
     }
 }
 
+template <SecrecDataType toTy, SecrecDataType fromTy >
+void castArray (void* dest, const void* from, size_t n) {
+    using type = element_t<toTy>;
+    auto* d = static_cast<type*>(dest);
+    auto* f = static_cast<const element_t<fromTy>*>(from);
+    for (size_t i = 0; i < n; ++ i)
+        d[i] = static_cast<type>(f[i]);
+}
+
+template <SecrecDataType fromTy >
+void castArrayDyn (const DataType* dataType, void* dest, const void* from, size_t n) {
+    assert (dataType != nullptr && dataType->isBuiltinPrimitive ());
+    SecrecDataType toTy = static_cast<const DataTypeBuiltinPrimitive*>(dataType)->secrecDataType ();
+    switch (toTy) {
+    case DATATYPE_BOOL:   castArray<DATATYPE_BOOL,fromTy>(dest, from, n); break;
+    case DATATYPE_INT8:   castArray<DATATYPE_INT8,fromTy>(dest, from, n); break;
+    case DATATYPE_UINT8:  castArray<DATATYPE_UINT8,fromTy>(dest, from, n); break;
+    case DATATYPE_INT16:  castArray<DATATYPE_INT16,fromTy>(dest, from, n); break;
+    case DATATYPE_UINT16: castArray<DATATYPE_UINT16,fromTy>(dest, from, n); break;
+    case DATATYPE_INT32:  castArray<DATATYPE_INT32,fromTy>(dest, from, n); break;
+    case DATATYPE_UINT32: castArray<DATATYPE_UINT32,fromTy>(dest, from, n); break;
+    case DATATYPE_INT64:  castArray<DATATYPE_INT64,fromTy>(dest, from, n); break;
+    case DATATYPE_UINT64: castArray<DATATYPE_UINT64,fromTy>(dest, from, n); break;
+    case DATATYPE_FLOAT32: castArray<DATATYPE_FLOAT32,fromTy>(dest, from, n); break;
+    case DATATYPE_FLOAT64: castArray<DATATYPE_FLOAT64,fromTy>(dest, from, n); break;
+    default:
+        assert (false);
+        exit (1);
+    }
+}
+
 
 /**
  * Macros to simplify code generation:
@@ -316,20 +454,21 @@ void castValueDyn (const DataType* dataType, ValueUnion& dest, const ValueUnion&
 /// Just to make vim syntax highlighter quiet
 #define BLOCK(CODE) { CODE }
 
-#define FETCH(name,i) ValueUnion & name = lookup((ip)->args[i])
+#define FETCH(name,i) ValueUnion & name = cxt.lookup((ip)->args[i])
 
 // Note that returns after callback explicitly tell compiler that callbacks
 // don't return. That should make tail call detection trivial.
-#define NEXT do { return ((ip + 1)->callback (ip + 1)); } while (0)
+#define NEXT do { return ((ip + 1)->callback (ip + 1, cxt)); } while (0)
 
-#define CUR do { return ip->callback (ip); } while (0)
+#define CUR do { return ip->callback (ip, cxt); } while (0)
 
 #define MKCALLBACK_(NAME, PDEST, PDN, PARG1, P1N, PARG2, P2N, PARG3, P3N, ...) \
     template <SecrecDataType ty = DATATYPE_UNDEFINED> \
-    inline int NAME##_callback (const Instruction* ip) \
+    inline int NAME##_callback (const Instruction* ip, ExecutionContext& cxt) \
     BLOCK( \
         TRACE("%p: ", (void*) ip); \
         TRACE("%s ",#NAME); \
+        ++ cxt.m_instructionCount; \
         PP_IF (PDEST, FETCH (PDN, 0); ) \
         PP_IF (PARG1, FETCH (P1N, 1); TRACE("0x%lx ", P1N.un_uint_val);) \
         PP_IF (PARG2, FETCH (P2N, 2); TRACE("0x%lx ", P2N.un_uint_val);) \
@@ -343,40 +482,110 @@ void castValueDyn (const DataType* dataType, ValueUnion& dest, const ValueUnion&
     MKCALLBACK_(NAME, PDEST, dest, PARG1, arg1, PARG2, arg2, PARG3, arg3, \
                 __VA_ARGS__)
 
-#define DECLOP1(NAME,...) \
+/**
+ * Vectorized operations work on packed arrays. The destination elements are
+ * of type DESTTY. Binary operations use the SIMD kernel KERNEL if it is
+ * defined on the argument type, otherwise the operation is applied one
+ * element at a time.
+ */
+
+#define DECLOP1(NAME,DESTTY,...) \
     MKCALLBACK(NAME, 1, 1, 0, 0, __VA_ARGS__) \
     MKCALLBACK_(NAME ## _vec, 1, dest_, 1, arg1_, 1, arg2_, 0,, BLOCK( \
         const size_t s = arg2_.un_uint_val; \
-        ValueUnion* desti = dest_.un_ptr; \
-        ValueUnion* end = dest_.un_ptr + s; \
-        ValueUnion* arg1i = arg1_.un_ptr; \
+        auto* desti = static_cast<element_t<DESTTY>*>(dest_.un_ptr); \
+        auto* end = desti + s; \
+        auto* arg1i = static_cast<const element_t<ty>*>(arg1_.un_ptr); \
         for (; desti != end; ++ desti, ++ arg1i) \
         BLOCK( \
-            ValueUnion& dest = *desti; \
-            ValueUnion arg1 = *arg1i; \
+            ValueUnion dest; \
+            ValueUnion arg1 = loadElement<ty>(*arg1i); \
             __VA_ARGS__ \
+            storeElement<DESTTY>(*desti, dest); \
         ) \
     ) \
     )
 
-#define DECLOP2(NAME,...) \
+#define DECLOP2(NAME,DESTTY,KERNEL,...) \
     MKCALLBACK(NAME, 1, 1, 1, 0, __VA_ARGS__) \
     MKCALLBACK_(NAME ## _vec, 1, dest_, 1, arg1_, 1, arg2_, 1, arg3_, BLOCK( \
         const size_t s = arg3_.un_uint_val; \
-        ValueUnion* desti = dest_.un_ptr; \
-        ValueUnion* end = dest_.un_ptr + s; \
-        ValueUnion* arg1i = arg1_.un_ptr; \
-        ValueUnion* arg2i = arg2_.un_ptr; \
+        auto* desti = static_cast<element_t<DESTTY>*>(dest_.un_ptr); \
+        auto* end = desti + s; \
+        auto* arg1i = static_cast<const element_t<ty>*>(arg1_.un_ptr); \
+        auto* arg2i = static_cast<const element_t<ty>*>(arg2_.un_ptr); \
+        if (! runKernel<KERNEL>(desti, arg1i, arg2i, s)) \
         for (; desti != end; ++ desti, ++ arg1i, ++ arg2i) \
         BLOCK( \
-            ValueUnion& dest = *desti; \
-            ValueUnion arg1 = *arg1i; \
-            ValueUnion arg2 = *arg2i; \
+            ValueUnion dest; \
+            ValueUnion arg1 = loadElement<ty>(*arg1i); \
+            ValueUnion arg2 = loadElement<ty>(*arg2i); \
             __VA_ARGS__ \
+            storeElement<DESTTY>(*desti, dest); \
         ) \
     ) \
     )
 
+/**
+ * SIMD kernels of vectorized binary operations. Each kernel declares the
+ * element types it is defined on.
+ */
+
+template <typename T>
+using is_kernel_numeric = std::integral_constant<bool,
+    std::is_arithmetic<T>::value && ! std::is_same<T, bool>::value>;
+
+template <typename T>
+using is_kernel_integer = std::integral_constant<bool,
+    std::is_integral<T>::value && ! std::is_same<T, bool>::value>;
+
+template <typename T>
+using is_kernel_bool = std::is_same<T, bool>;
+
+struct NoKernel {
+    template <typename T> using supports = std::false_type;
+    template <typename D, typename T>
+    static void run (D*, const T*, const T*, size_t) { }
+};
+
+#define DECLKERNEL(NAME, FUN, SUPPORTS) \
+    struct NAME { \
+        template <typename T> using supports = SUPPORTS<T>; \
+        template <typename D, typename T> \
+        static void run (D* dest, const T* x, const T* y, size_t n) { \
+            VMKernels::FUN (dest, x, y, n); \
+        } \
+    };
+
+DECLKERNEL (AddKernel,  add,  is_kernel_numeric)
+DECLKERNEL (SubKernel,  sub,  is_kernel_numeric)
+DECLKERNEL (MulKernel,  mul,  is_kernel_numeric)
+DECLKERNEL (BandKernel, band, is_kernel_integer)
+DECLKERNEL (BorKernel,  bor,  is_kernel_integer)
+DECLKERNEL (XorKernel,  bxor, is_kernel_integer)
+DECLKERNEL (EqKernel,   eq,   is_kernel_numeric)
+DECLKERNEL (NeKernel,   ne,   is_kernel_numeric)
+DECLKERNEL (LtKernel,   lt,   is_kernel_numeric)
+DECLKERNEL (LeKernel,   le,   is_kernel_numeric)
+DECLKERNEL (GtKernel,   gt,   is_kernel_numeric)
+DECLKERNEL (GeKernel,   ge,   is_kernel_numeric)
+DECLKERNEL (LandKernel, land, is_kernel_bool)
+DECLKERNEL (LorKernel,  lor,  is_kernel_bool)
+
+/// Runs the kernel if it is defined on the element type, returns false otherwise.
+template <typename Kernel, typename D, typename T>
+inline typename std::enable_if<Kernel::template supports<T>::value, bool>::type
+runKernel (D* dest, const T* x, const T* y, size_t n) {
+    Kernel::run (dest, x, y, n);
+    return true;
+}
+
+template <typename Kernel, typename D, typename T>
+inline typename std::enable_if<! Kernel::template supports<T>::value, bool>::type
+runKernel (D*, const T*, const T*, size_t) {
+    return false;
+}
+
 /// build instruction body for conditional jump
 #define JUMPCOND(COND) \
     const Instruction* newIp = ip + 1; \
@@ -391,29 +600,38 @@ void castValueDyn (const DataType* dataType, ValueUnion& dest, const ValueUnion&
  */
 
 //DECLOP1 (DECLARE, (void) dest; (void) arg1)
-DECLOP1 (ASSIGN, assignValue (dest, getValue<ty>(arg1));)
-DECLOP1 (CLASSIFY, assignValue (dest, getValue<ty>(arg1));)
-DECLOP1 (DECLASSIFY, assignValue (dest, getValue<ty>(arg1));)
-DECLOP1 (CAST, castValueDyn<ty>(ip->args[0].un_sym->secrecType ()->secrecDataType (), dest, arg1);)
-DECLOP1 (UINV, assignValue (dest, ~getValue<ty>(arg1));)
-DECLOP1 (UNEG, assignValue (dest, !getValue<DATATYPE_BOOL>(arg1));)
-DECLOP2 (LAND, assignValue (dest, arg1.un_bool_val && arg2.un_bool_val);)
-DECLOP2 (LOR,  assignValue (dest, arg1.un_bool_val || arg2.un_bool_val);)
-DECLOP2 (BAND, assignValue (dest, getValue<ty>(arg1) & getValue<ty>(arg2));)
-DECLOP2 (BOR,  assignValue (dest, getValue<ty>(arg1) | getValue<ty>(arg2));)
-DECLOP2 (XOR,  assignValue (dest, getValue<ty>(arg1) ^ getValue<ty>(arg2));)
-DECLOP1 (UMINUS, assignValue (dest, -getValue<ty>(arg1));)
-DECLOP2 (EQ,  assignValue (dest, getValue<ty>(arg1) == getValue<ty>(arg2));)
-DECLOP2 (NE,  assignValue (dest, getValue<ty>(arg1) != getValue<ty>(arg2));)
-DECLOP2 (ADD, assignValue (dest, getValue<ty>(arg1) +  getValue<ty>(arg2));)
-DECLOP2 (SUB, assignValue (dest, getValue<ty>(arg1) -  getValue<ty>(arg2));)
-DECLOP2 (MUL, assignValue (dest, getValue<ty>(arg1) *  getValue<ty>(arg2));)
-DECLOP2 (DIV, assignValue (dest, getValue<ty>(arg1) /  getValue<ty>(arg2));)
-DECLOP2 (MOD, assignValue (dest, getValue<ty>(arg1) %  getValue<ty>(arg2));)
-DECLOP2 (LE,  assignValue (dest, getValue<ty>(arg1) <= getValue<ty>(arg2));)
-DECLOP2 (LT,  assignValue (dest, getValue<ty>(arg1) <  getValue<ty>(arg2));)
-DECLOP2 (GE,  assignValue (dest, getValue<ty>(arg1) >= getValue<ty>(arg2));)
-DECLOP2 (GT,  assignValue (dest, getValue<ty>(arg1) >  getValue<ty>(arg2));)
+DECLOP1 (ASSIGN, ty, assignValue (dest, getValue<ty>(arg1));)
+DECLOP1 (CLASSIFY, ty, assignValue (dest, getValue<ty>(arg1));)
+DECLOP1 (DECLASSIFY, ty, assignValue (dest, getValue<ty>(arg1));)
+DECLOP1 (UINV, ty, assignValue (dest, ~getValue<ty>(arg1));)
+DECLOP1 (UNEG, DATATYPE_BOOL, assignValue (dest, !getValue<DATATYPE_BOOL>(arg1));)
+DECLOP2 (LAND, DATATYPE_BOOL, LandKernel, assignValue (dest, arg1.un_bool_val && arg2.un_bool_val);)
+DECLOP2 (LOR,  DATATYPE_BOOL, LorKernel,  assignValue (dest, arg1.un_bool_val || arg2.un_bool_val);)
+DECLOP2 (BAND, ty, BandKernel, assignValue (dest, getValue<ty>(arg1) & getValue<ty>(arg2));)
+DECLOP2 (BOR,  ty, BorKernel,  assignValue (dest, getValue<ty>(arg1) | getValue<ty>(arg2));)
+DECLOP2 (XOR,  ty, XorKernel,  assignValue (dest, getValue<ty>(arg1) ^ getValue<ty>(arg2));)
+DECLOP1 (UMINUS, ty, assignValue (dest, -getValue<ty>(arg1));)
+DECLOP2 (EQ,  DATATYPE_BOOL, EqKernel,  assignValue (dest, getValue<ty>(arg1) == getValue<ty>(arg2));)
+DECLOP2 (NE,  DATATYPE_BOOL, NeKernel,  assignValue (dest, getValue<ty>(arg1) != getValue<ty>(arg2));)
+DECLOP2 (ADD, ty,            AddKernel, assignValue (dest, getValue<ty>(arg1) +  getValue<ty>(arg2));)
+DECLOP2 (SUB, ty,            SubKernel, assignValue (dest, getValue<ty>(arg1) -  getValue<ty>(arg2));)
+DECLOP2 (MUL, ty,            MulKernel, assignValue (dest, getValue<ty>(arg1) *  getValue<ty>(arg2));)
+DECLOP2 (DIV, ty,            NoKernel,  assignValue (dest, getValue<ty>(arg1) /  getValue<ty>(arg2));)
+DECLOP2 (MOD, ty,            NoKernel,  assignValue (dest, getValue<ty>(arg1) %  getValue<ty>(arg2));)
+DECLOP2 (LE,  DATATYPE_BOOL, LeKernel,  assignValue (dest, getValue<ty>(arg1) <= getValue<ty>(arg2));)
+DECLOP2 (LT,  DATATYPE_BOOL, LtKernel,  assignValue (dest, getValue<ty>(arg1) <  getValue<ty>(arg2));)
+DECLOP2 (GE,  DATATYPE_BOOL, GeKernel,  assignValue (dest, getValue<ty>(arg1) >= getValue<ty>(arg2));)
+DECLOP2 (GT,  DATATYPE_BOOL, GtKernel,  assignValue (dest, getValue<ty>(arg1) >  getValue<ty>(arg2));)
+
+/// The element type of the destination of a cast is only known at run time.
+MKCALLBACK(CAST, 1, 1, 0, 0,
+    castValueDyn<ty>(ip->args[0].un_sym->secrecType ()->secrecDataType (), dest, arg1);
+)
+
+MKCALLBACK(CAST_vec, 1, 1, 1, 0,
+    castArrayDyn<ty>(ip->args[0].un_sym->secrecType ()->secrecDataType (),
+                     dest.un_ptr, arg1.un_ptr, arg2.un_uint_val);
+)
 
 
 /**
@@ -428,12 +646,12 @@ MKCALLBACK(JF,  0, 1, 0, 0, JUMPCOND (!arg1.un_bool_val))
  */
 
 MKCALLBACK (ERROR, 1, 0, 0, 0,
-    fprintf (stderr, "%s\n", dest.un_str_val->c_str());
+    cxt.m_err << *dest.un_str_val << std::endl;
     return EXIT_FAILURE;
 )
 
 MKCALLBACK (PRINT, 1, 0, 0, 0,
-    fprintf (stdout, "%s\n", dest.un_str_val->c_str());
+    cxt.m_out << *dest.un_str_val << '\n';
 )
 
 MKCALLBACK (TOSTRING, 1, 1, 0, 0,
@@ -443,7 +661,7 @@ MKCALLBACK (TOSTRING, 1, 1, 0, 0,
 )
 
 MKCALLBACK(CALL, 0, 0, 0, 0,
-    push_frame (ip + 1);
+    cxt.push_frame (ip + 1, ip->args[1].slot);
     ip = ip->args[0].un_inst;
     CUR;
 )
@@ -451,9 +669,9 @@ MKCALLBACK(CALL, 0, 0, 0, 0,
 MKCALLBACK(RETCLEAN, 0, 0, 0, 0, { })
 
 MKCALLBACK(RETVOID, 0, 0, 0, 0,
-    assert (m_frames != nullptr);
-    const Instruction* new_i = m_frames->m_old_ip;
-    pop_frame();
+    assert (! cxt.m_frames.empty ());
+    const Instruction* new_i = cxt.m_frames.back ().m_old_ip;
+    cxt.pop_frame();
     ip = new_i;
     CUR;
 )
@@ -470,25 +688,25 @@ MKCALLBACK(STRLEN, 1, 1, 0, 0,
 )
 
 MKCALLBACK(GETFPUSTATE, 1, 0, 0, 0,
-    dest.un_uint_val = m_fpuState;
+    dest.un_uint_val = cxt.m_fpuState;
 )
 
 MKCALLBACK(SETFPUSTATE, 1, 0, 0, 0,
-    m_fpuState = getValue<DATATYPE_UINT64>(dest);
+    cxt.m_fpuState = getValue<DATATYPE_UINT64>(dest);
 )
 
 MKCALLBACK(PUSH, 0, 1, 0, 0,
-    m_stack.push(arg1);
+    cxt.m_stack.push(arg1);
 )
 
 MKCALLBACK(PARAM, 1, 0, 0, 0,
-    m_stack.top(dest);
-    m_stack.pop();
+    cxt.m_stack.top(dest);
+    cxt.m_stack.pop();
 )
 
 MKCALLBACK(POP, 1, 0, 0, 0,
-    m_stack.top(dest);
-    m_stack.pop();
+    cxt.m_stack.top(dest);
+    cxt.m_stack.pop();
 )
 
 MKCALLBACK(JUMP, 0, 0, 0, 0,
@@ -497,17 +715,19 @@ MKCALLBACK(JUMP, 0, 0, 0, 0,
 )
 
 MKCALLBACK(ALLOC, 1, 1, 1, 0,
-    const ValueUnion& v = arg2;
-    const unsigned n = arg1.un_uint_val;
-    dest.un_ptr = static_cast<ValueUnion *>(malloc(sizeof(ValueUnion) * n));
-    for (ValueUnion* it(dest.un_ptr); it < dest.un_ptr + n; ++ it)
-      *it = v;
+    using T = element_t<ty>;
+    const size_t n = arg1.un_uint_val;
+    T v;
+    storeElement<ty>(v, arg2);
+    T* const arr = static_cast<T*>(malloc (sizeof (T) * n));
+    std::fill (arr, arr + n, v);
+    dest.un_ptr = arr;
 )
 
 MKCALLBACK(COPY, 1, 1, 1, 0,
     const size_t n = arg2.un_uint_val;
-    dest.un_ptr = static_cast<ValueUnion*>(malloc (sizeof (ValueUnion) * n));
-    memcpy (dest.un_ptr, arg1.un_ptr, sizeof (ValueUnion) * n);
+    dest.un_ptr = malloc (sizeof (element_t<ty>) * n);
+    memcpy (dest.un_ptr, arg1.un_ptr, sizeof (element_t<ty>) * n);
 )
 
 MKCALLBACK(RELEASE, 1, 0, 0, 0,
@@ -525,7 +745,9 @@ MKCALLBACK(RELEASE, 1, 0, 0, 0,
 )
 
 template <SecrecDataType ty>
-ValueUnion loadArray (ValueUnion& arg, uint64_t index) { return arg.un_ptr[index]; }
+ValueUnion loadArray (ValueUnion& arg, uint64_t index) {
+    return loadElement<ty>(static_cast<const element_t<ty>*>(arg.un_ptr)[index]);
+}
 
 template <>
 ValueUnion loadArray<DATATYPE_STRING>(ValueUnion& arg, uint64_t index) {
@@ -535,12 +757,12 @@ ValueUnion loadArray<DATATYPE_STRING>(ValueUnion& arg, uint64_t index) {
 }
 
 MKCALLBACK(LOAD, 0, 1, 1, 0,
-    storeSym (ip->args[0], loadArray<ty>(arg1, arg2.un_uint_val));
+    cxt.storeSym (ip->args[0], loadArray<ty>(arg1, arg2.un_uint_val));
 )
 
 template <SecrecDataType ty>
 void storeArray (ValueUnion& dest, uint64_t i, ValueUnion v) {
-    dest.un_ptr[i] = v;
+    storeElement<ty>(static_cast<element_t<ty>*>(dest.un_ptr)[i], v);
 }
 
 template <>
@@ -552,6 +774,102 @@ MKCALLBACK(STORE, 1, 1, 1, 0,
     storeArray<ty>(dest, arg1.un_uint_val, arg2);
 )
 
+MKCALLBACK(GATHER, 1, 1, 1, 1,
+    using T = element_t<ty>;
+    const uint64_t n = arg3.un_uint_val;
+    const auto* offsets = static_cast<const uint64_t*>(arg2.un_ptr);
+    for (uint64_t i = 0; i < n; ++ i)
+        static_cast<T*>(dest.un_ptr)[i] = static_cast<const T*>(arg1.un_ptr)[offsets[i]];
+)
+
+MKCALLBACK(SCATTER, 1, 1, 1, 1,
+    using T = element_t<ty>;
+    const uint64_t n = arg3.un_uint_val;
+    const auto* offsets = static_cast<const uint64_t*>(arg1.un_ptr);
+    for (uint64_t i = 0; i < n; ++ i)
+        static_cast<T*>(dest.un_ptr)[offsets[i]] = static_cast<const T*>(arg2.un_ptr)[i];
+)
+
+/**
+ * System calls are emulated by SyscallEmulator. The calls are counted per call
+ * stack so that they can be accounted to every procedure on the stack.
+ */
+struct SyscallSite {
+    struct Operand {
+        VMSym value;
+        VMSym size; ///< Number of elements, if the operand is an array.
+    };
+
+    using Stack = std::vector<const Instruction*>; ///< Return addresses of the frames.
+
+    struct Calls {
+        uint64_t calls;
+        uint64_t elements;
+    };
+
+    std::string name;
+    const SyscallEmulator::Handler* handler; ///< nullptr if the system call is not emulated.
+    const Imop* imop;
+    std::vector<Operand> operands;
+    SyscallArguments arguments;
+    std::map<Stack, Calls> calls;
+    Stack stack;
+};
+
+bool callSyscall (SyscallSite& site, ExecutionContext& cxt) {
+    if (site.handler == nullptr) {
+        cxt.m_err << "System call \"" << site.name << "\" is not emulated." << std::endl;
+        return false;
+    }
+
+    uint64_t elements = 0u;
+    for (size_t i = 0; i < site.operands.size (); ++ i) {
+        SyscallArgument& arg = site.arguments[i];
+        ValueUnion& value = cxt.lookup (site.operands[i].value);
+        if (arg.dataType == DATATYPE_STRING) {
+            arg.data = value.un_str_val;
+            arg.size = value.un_str_val != nullptr ? value.un_str_val->size () : 0u;
+        }
+        else if (arg.isArray) {
+            arg.data = value.un_ptr;
+            arg.size = cxt.lookup (site.operands[i].size).un_uint_val;
+        }
+        else {
+            arg.data = &value;
+            arg.size = 1u;
+        }
+
+        elements = std::max<uint64_t> (elements, arg.size);
+    }
+
+    try {
+        (*site.handler) (site.arguments);
+    }
+    catch (const std::exception& e) {
+        cxt.m_err << "System call \"" << site.name << "\" failed: " << e.what () << std::endl;
+        return false;
+    }
+
+    if (! cxt.m_reportSyscalls)
+        return true;
+
+    site.stack.clear ();
+    for (const Frame& frame : cxt.m_frames)
+        site.stack.push_back (frame.m_old_ip);
+
+    auto it = site.calls.find (site.stack);
+    if (it == site.calls.end ())
+        it = site.calls.emplace (site.stack, SyscallSite::Calls { 0u, 0u }).first;
+    ++ it->second.calls;
+    it->second.elements += elements;
+    return true;
+}
+
+MKCALLBACK(SYSCALL, 0, 0, 0, 0,
+    if (! callSyscall (*ip->args[0].un_syscall, cxt))
+        return EXIT_FAILURE;
+)
+
 MKCALLBACK(NOP, 0, 0, 0, 0, { })
 
 MKCALLBACK(END, 0, 0, 0, 0, return EXIT_SUCCESS; )
@@ -614,6 +932,12 @@ MKCALLBACK(END, 0, 0, 0, 0, return EXIT_SUCCESS; )
     } else {\
         SET_SPECIALIZE_CALLBACK(NAME, SWITCHER);\
     }} while (0)
+#define SET_BOOL_CALLBACK_V(NAME) do {\
+    if (isVec) {\
+        SET_CALLBACK(NAME ## _vec, DATATYPE_BOOL);\
+    } else {\
+        SET_SIMPLE_CALLBACK(NAME);\
+    }} while (0)
 #define SIMPLE_CALLBACK(NAME) GET_CALLBACK(NAME,)
 #define SET_SIMPLE_CALLBACK_V(NAME) do {\
     if (isVec) {\
@@ -627,6 +951,33 @@ bool matchTypes (const Type* ty1, const Type* ty2) {
            ty1->secrecSecType () == ty2->secrecSecType ();
 }
 
+/**
+ * Data type the values of the symbol are emulated with. Private values of
+ * user defined types are emulated with their public type.
+ */
+SecrecDataType emulatedDataType (const Symbol* sym) {
+    const DataType* dataType = sym->secrecType()->secrecDataType();
+    assert (dataType != nullptr);
+
+    if (dataType->isBuiltinPrimitive()) {
+        return static_cast<const DataTypeBuiltinPrimitive*>(dataType)->secrecDataType();
+    }
+
+    if (dataType->isUserPrimitive()) {
+        const SecurityType* sec = sym->secrecType()->secrecSecType();
+        assert(sec->isPrivate());
+        SymbolKind* kind = static_cast<const PrivateSecType*>(sec)->securityKind();
+        const auto pubTy = kind->findType (static_cast<const DataTypeUserPrimitive*> (dataType)->name ())->publicType;
+        if (pubTy) {
+            return pubTy.get()->secrecDataType();
+        }
+
+        SHAREMIND_ABORT("ICE: Attemping to emulate private only values.");
+    }
+
+    return DATATYPE_UNDEFINED;
+}
+
 /**
  * Select instruction based on intermediate operator.
  * Does not handle multi-callback operators.
@@ -663,51 +1014,22 @@ CallbackTy getCallback (const Imop& imop) {
     case Imop::CLASSIFY:
     case Imop::DECLASSIFY:
     case Imop::ASSIGN:
-    case Imop::LOAD: {
-        const DataType* dataType = imop.arg1()->secrecType()->secrecDataType();
-        assert (dataType != nullptr);
-
-        if (dataType->isBuiltinPrimitive()) {
-            ty = static_cast<const DataTypeBuiltinPrimitive*>(dataType)->secrecDataType();
-        }
-        else if (dataType->isUserPrimitive()) {
-            const SecurityType* sec = imop.arg1()->secrecType()->secrecSecType();
-            assert(sec->isPrivate());
-            SymbolKind* kind = static_cast<const PrivateSecType*>(sec)->securityKind();
-            const auto pubTy = kind->findType (static_cast<const DataTypeUserPrimitive*> (dataType)->name ())->publicType;
-            if (pubTy) {
-                ty = pubTy.get()->secrecDataType();
-            }
-            else {
-                SHAREMIND_ABORT("ICE: Attemping to emulate private only values.");
-            }
-        }
-    }
+    case Imop::LOAD:
+        ty = emulatedDataType (imop.arg1 ());
+        break;
+    // Arrays are packed by the element type of the destination:
+    case Imop::STORE:
+    case Imop::ALLOC:
+    case Imop::COPY:
+    case Imop::GATHER:
+    case Imop::SCATTER:
+        assert (imop.dest()->secrecType()->secrecDataType()->isPrimitive ());
+        ty = emulatedDataType (imop.dest ());
+        break;
     default:
         break;
     }
 
-    if (imop.type () == Imop::STORE) {
-        const DataType* dataType = imop.dest()->secrecType()->secrecDataType();
-        assert (dataType != nullptr && dataType->isPrimitive ());
-
-        if (dataType->isBuiltinPrimitive ()) {
-            ty = static_cast<const DataTypeBuiltinPrimitive*>(dataType)->secrecDataType ();
-        }
-        else {
-            const SecurityType* sec = imop.dest()->secrecType()->secrecSecType();
-            assert (sec->isPrivate ());
-            SymbolKind* kind = static_cast<const PrivateSecType*>(sec)->securityKind();
-            const auto pubTy = kind->findType (static_cast<const DataTypeUserPrimitive*> (dataType)->name ())->publicType;
-            if (pubTy) {
-                ty = pubTy.get()->secrecDataType();
-            }
-            else {
-                SHAREMIND_ABORT("ICE: Attemping to emulate private only values.");
-            }
-        }
-    }
-
     if (imop.type () == Imop::ASSIGN) {
         if (! matchTypes (imop.dest ()->secrecType (), imop.arg1 ()->secrecType ())) {
             std::cerr << imop << " // " << TreeNode::typeName (imop.creator ()->type ()) << std::endl;
@@ -723,9 +1045,9 @@ CallbackTy getCallback (const Imop& imop) {
     case Imop::CLASSIFY:   SET_SPECIALIZE_CALLBACK_V(CLASSIFY,SWITCH_ANY); break;
     case Imop::DECLASSIFY: SET_SPECIALIZE_CALLBACK_V(DECLASSIFY,SWITCH_ANY); break;
     case Imop::CAST:       SET_SPECIALIZE_CALLBACK_V(CAST,SWITCH_NONSTRING); break;
-    case Imop::UNEG:       SET_SIMPLE_CALLBACK_V(UNEG); break;
-    case Imop::LAND:       SET_SIMPLE_CALLBACK_V(LAND); break;
-    case Imop::LOR:        SET_SIMPLE_CALLBACK_V(LOR); break;
+    case Imop::UNEG:       SET_BOOL_CALLBACK_V(UNEG); break;
+    case Imop::LAND:       SET_BOOL_CALLBACK_V(LAND); break;
+    case Imop::LOR:        SET_BOOL_CALLBACK_V(LOR); break;
     case Imop::BAND:       SET_SPECIALIZE_CALLBACK_V(BAND,SWITCH_INTEGRAL); break;
     case Imop::BOR:        SET_SPECIALIZE_CALLBACK_V(BOR,SWITCH_INTEGRAL); break;
     case Imop::XOR:        SET_SPECIALIZE_CALLBACK_V(XOR,SWITCH_INTEGRAL); break;
@@ -749,11 +1071,13 @@ CallbackTy getCallback (const Imop& imop) {
     case Imop::ERROR:      SET_SIMPLE_CALLBACK(ERROR); break;
     case Imop::PARAM:      SET_SIMPLE_CALLBACK(PARAM); break;
     case Imop::RETCLEAN:   SET_SIMPLE_CALLBACK(RETCLEAN); break;
-    case Imop::ALLOC:      SET_SIMPLE_CALLBACK(ALLOC); break;
-    case Imop::COPY:       SET_SIMPLE_CALLBACK(COPY); break;
+    case Imop::ALLOC:      SET_SPECIALIZE_CALLBACK(ALLOC,SWITCH_ANY); break;
+    case Imop::COPY:       SET_SPECIALIZE_CALLBACK(COPY,SWITCH_ANY); break;
     case Imop::RELEASE:    SET_SIMPLE_CALLBACK(RELEASE); break;
     case Imop::STORE:      SET_SPECIALIZE_CALLBACK(STORE,SWITCH_ANY); break;
     case Imop::LOAD:       SET_SPECIALIZE_CALLBACK(LOAD,SWITCH_ANY); break;
+    case Imop::GATHER:     SET_SPECIALIZE_CALLBACK(GATHER,SWITCH_ANY); break;
+    case Imop::SCATTER:    SET_SPECIALIZE_CALLBACK(SCATTER,SWITCH_ANY); break;
     case Imop::END:        SET_SIMPLE_CALLBACK(END); break;
     case Imop::PRINT:      SET_SIMPLE_CALLBACK(PRINT); break;
     case Imop::DOMAINID:   SET_SIMPLE_CALLBACK(DOMAINID); break;
@@ -789,12 +1113,10 @@ void storeConstantInt (ValueUnion& out, const Symbol* c) {
     assignValue (out, static_cast<type>(value));
 }
 
-void storeConstant (VMSym sym, const Symbol* c) {
+void storeConstant (ValueUnion& out, const Symbol* c) {
     const DataType* dataType = c->secrecType ()->secrecDataType ();
     assert (dataType != nullptr && dataType->isBuiltinPrimitive ());
     SecrecDataType dtype = static_cast<const DataTypeBuiltinPrimitive*>(dataType)->secrecDataType ();
-    Store& store = sym.isLocal ? m_frames->m_local : m_global;
-    ValueUnion& out = store[sym.un_sym];
     switch (dtype) {
     case DATATYPE_STRING: storeConstantString(out, c); break;
     case DATATYPE_BOOL: storeConstantInt<DATATYPE_BOOL>(out, c); break;
@@ -829,8 +1151,9 @@ void storeConstant (VMSym sym, const Symbol* c) {
 
 
 /**
- * Compiler, only non-trivial thing it does is tracking of jump locations
- * because some intermediate code instructions compile into multiple callbacks.
+ * Compiler, only non-trivial things it does are tracking of jump locations
+ * because some intermediate code instructions compile into multiple callbacks,
+ * and assigning every symbol a fixed slot in its frame or in the global store.
  */
 class Compiler {
 
@@ -838,29 +1161,53 @@ public: /* Types: */
 
     using Instructions = std::vector<Instruction>;
 
+    struct Code {
+        Instructions instructions;
+        SlotIndex entryFrameSize; ///< Number of slots of the first procedure.
+        std::vector<const Imop*> origins; ///< Intermediate instruction of every instruction.
+        std::vector<std::unique_ptr<SyscallSite> > syscalls;
+    };
+
 private: /* Types: */
 
     using JumpDestinations =
             std::vector<std::pair<Instructions::size_type, Imop const *> >;
+    using SlotMap = std::unordered_map<const Symbol*, SlotIndex>;
     struct UnlinkedCode {
         Instructions instructions;
+        std::vector<const Imop*> origins;
         JumpDestinations jumpDestinations;
+        std::vector<Instructions::size_type> callSites;
+        std::vector<std::unique_ptr<SyscallSite> > syscalls;
     };
 
 public: /* Methods: */
 
-    static Instructions runOn (const Program& pr) {
+    /**
+     * Compiles the program, constants are stored into the given global store.
+     * System calls are bound to their emulations.
+     */
+    static Code runOn (const Program& pr, Store& global, const SyscallEmulator& emulator) {
         assert (! pr.empty ());
-        UnlinkedCode code;
+        Compiler compiler (global, emulator);
+        UnlinkedCode & code = compiler.m_code;
         std::map<Imop const *, std::size_t> imopAddresses;
+
+        // Start instruction and frame size of each procedure:
+        std::vector<std::pair<std::size_t, SlotIndex> > frames;
         for (const auto & func : pr) {
+            compiler.m_localSlots.clear();
+            frames.emplace_back(code.instructions.size(), 0u);
             for (const auto & block : func) {
                 assert (! block.empty ());
                 for (const auto & imop : block) {
                     imopAddresses.emplace(&imop, code.instructions.size());
-                    compileInstruction(code, imop);
+                    compiler.compileInstruction(imop);
+                    code.origins.resize(code.instructions.size(), &imop);
                 }
             }
+
+            frames.back().second = compiler.m_localSlots.size();
         }
 
         auto & is = code.instructions;
@@ -870,42 +1217,73 @@ public: /* Methods: */
             assert(it != imopAddresses.end());
             is[jumpDestination.first].args[0].un_inst = is.data() + it->second;
         }
-        return std::move(code.instructions);
+
+        // Calls allocate the frame of the procedure they jump into:
+        for (auto const callSite : code.callSites) {
+            Instruction & i = is[callSite];
+            const std::size_t target = i.args[0].un_inst - is.data();
+            auto const it(std::upper_bound(frames.begin(), frames.end(),
+                                           std::make_pair(target, ~SlotIndex(0u))));
+            assert(it != frames.begin());
+            i.args[1].slot = std::prev(it)->second;
+        }
+
+        return Code { std::move(code.instructions), frames.front().second,
+                      std::move(code.origins), std::move(code.syscalls) };
     }
 
 private:
 
-    static VMSym toVMSym (const Symbol* sym) {
+    Compiler (Store& global, const SyscallEmulator& emulator)
+        : m_global (global)
+        , m_emulator (emulator)
+    { }
+
+    VMSym toVMSym (const Symbol* sym) {
         assert (sym != nullptr);
-        VMSym out (true, sym );
 
         switch (sym->symbolType()) {
+        case SYM_LABEL:
+            return VMSym (true, 0u, sym);
         case SYM_SYMBOL:
             if (static_cast<SymbolSymbol const*>(sym)->scopeType() == SymbolSymbol::GLOBAL)
-                out.isLocal = false;
+                return VMSym (false, globalSlot (sym), sym);
             break;
         case SYM_CONSTANT:
-            out.isLocal = false;
-            storeConstant (out, sym);
+            return VMSym (false, globalSlot (sym), sym);
         default: break;
         }
 
-        return out;
+        const auto it = m_localSlots.emplace (sym, m_localSlots.size ()).first;
+        return VMSym (true, it->second, sym);
+    }
+
+    /// Slot of the global symbol, constants are stored when first seen.
+    SlotIndex globalSlot (const Symbol* sym) {
+        const auto r = m_globalSlots.emplace (sym, m_global.size ());
+        if (r.second) {
+            m_global.emplace_back ();
+            if (sym->symbolType () == SYM_CONSTANT)
+                storeConstant (m_global.back (), sym);
+        }
+
+        return r.first->second;
     }
 
-    //void compileInstruction (Instruction& i, const Imop& imop) {
-    static void compileInstruction (UnlinkedCode & code, const Imop& imop) {
+    void compileInstruction (const Imop& imop) {
+        UnlinkedCode & code = m_code;
         // handle multi instruction IR instructions
         switch (imop.type ()) {
-        case Imop::CALL: return compileCall(code, imop);
-        case Imop::RETURN: return compileReturn(code, imop);
+        case Imop::CALL: return compileCall(imop);
+        case Imop::RETURN: return compileReturn(imop);
+        case Imop::SYSCALL: return compileSyscall(imop);
         default:
             break;
         }
 
         Instruction i;
         auto appendSymbolArg =
-                [it = i.args.begin(), end = i.args.end()](Symbol const * symbol)
+                [this, it = i.args.begin(), end = i.args.end()](Symbol const * symbol)
                         mutable
                 {
                     assert(it != end);
@@ -945,8 +1323,9 @@ private:
     }
 
     /// compile Imop::CALL instruction
-    static void compileCall (UnlinkedCode & code, const Imop& imop) {
+    void compileCall (const Imop& imop) {
         assert (imop.type () == Imop::CALL);
+        UnlinkedCode & code = m_code;
 
         Imop::OperandConstIterator it, itBegin, itEnd;
 
@@ -977,9 +1356,10 @@ private:
         assert (it != itEnd && *it == nullptr &&
             "Malformed CALL instruction!");
 
-        // CALL
+        // CALL, the frame size is filled in when linking
         Instruction i (SIMPLE_CALLBACK(CALL));
         emitInstruction (code, i, targetImop);
+        code.callSites.push_back (code.instructions.size () - 1);
 
         // pop return values
         for (++ it; it != itEnd; ++ it) {
@@ -991,8 +1371,9 @@ private:
 
 
     /// compile Imop::RETURN instruction
-    static void compileReturn (UnlinkedCode & code, const Imop& imop) {
+    void compileReturn (const Imop& imop) {
         assert (imop.type () == Imop::RETURN);
+        UnlinkedCode & code = m_code;
 
         assert (imop.operandsBegin () != imop.operandsEnd () &&
                 "Malformed RETURN instruction!");
@@ -1013,6 +1394,41 @@ private:
         emitInstruction (code, i);
     }
 
+    /// compile Imop::SYSCALL instruction
+    void compileSyscall (const Imop& imop) {
+        assert (imop.isSyscall ());
+        std::unique_ptr<SyscallSite> site (new SyscallSite ());
+        site->name = static_cast<const ConstantString*>(imop.arg1 ())->value ().str ();
+        site->handler = m_emulator.find (site->name);
+        site->imop = &imop;
+
+        for (const SyscallOperand& op : imop.syscallOperands ()) {
+            Symbol* sym = op.operand ();
+            SyscallSite::Operand operand;
+            operand.value = toVMSym (sym);
+
+            SyscallArgument arg;
+            arg.convention = op.passingConvention ();
+            arg.dataType = emulatedDataType (sym);
+            arg.isPrivate = sym->secrecType ()->secrecSecType ()->isPrivate ();
+            arg.isArray = sym->isArray ();
+            arg.data = nullptr;
+            arg.size = 0u;
+            if (arg.isArray) {
+                assert (dynamic_cast<SymbolSymbol*>(sym) != nullptr);
+                operand.size = toVMSym (static_cast<SymbolSymbol*>(sym)->getSizeSym ());
+            }
+
+            site->operands.push_back (operand);
+            site->arguments.push_back (arg);
+        }
+
+        Instruction i (SIMPLE_CALLBACK(SYSCALL));
+        i.args[0].un_syscall = site.get ();
+        m_code.syscalls.push_back (std::move (site));
+        emitInstruction (m_code, i);
+    }
+
     static void emitInstruction(UnlinkedCode & code, Instruction i)
     { code.instructions.emplace_back(std::move(i)); }
 
@@ -1030,25 +1446,286 @@ private:
         }
     }
 
+private: /* Fields: */
+
+    Store& m_global;
+    const SyscallEmulator& m_emulator;
+    UnlinkedCode m_code;
+    SlotMap m_globalSlots;
+    SlotMap m_localSlots; ///< Slots of the procedure being compiled.
 };
 
 
+/**
+ * Names of procedures and source locations in reports:
+ */
+
+const SymbolProcedure* procedureOfImop (const Imop& imop) {
+    const Block* block = imop.block ();
+    assert (block != nullptr && block->proc () != nullptr);
+    return block->proc ()->name ();
+}
+
+std::string procedureName (const SymbolProcedure* proc) {
+    if (proc == nullptr)
+        return "<entry>";
+
+    std::ostringstream os;
+    os << proc->procedureName () << '(';
+    const auto procType = static_cast<const TypeProc*>(proc->secrecType ());
+    bool first = true;
+    for (const TypeBasic* argType : procType->paramTypes ()) {
+        if (! first)
+            os << ", ";
+        first = false;
+        os << PrettyPrint (argType);
+    }
+
+    os << ')';
+    return os.str ();
+}
+
+std::string locationName (const Imop& imop) {
+    if (imop.creator () == nullptr)
+        return "<unknown>";
+
+    const Location& loc = imop.creator ()->location ();
+    std::ostringstream os;
+    os << loc.filename () << ':' << loc.firstLine ();
+    return os.str ();
+}
+
+/**
+ * Accounts the system calls of the run. Calls are accounted to the procedure
+ * and the location of the system call, and to the procedures and the
+ * locations of the calls on the stack.
+ */
+void reportSyscalls (const Compiler::Code& code,
+                     const SyscallCostTable* costs,
+                     SyscallReport& report)
+{
+    const Instruction* const base = code.instructions.data ();
+    for (const auto& site : code.syscalls) {
+        const Imop* imop = site->imop;
+        const SyscallCostTable::Cost* cost = costs ? costs->find (site->name) : nullptr;
+        for (const auto& calls : site->calls) {
+            std::set<std::string> procedures { procedureName (procedureOfImop (*imop)) };
+            std::set<std::string> locations { locationName (*imop) };
+            for (const Instruction* ret : calls.first) {
+                if (ret == nullptr)
+                    continue;
+
+                // Frames return to the instruction after the call:
+                const Imop& call = *code.origins[(ret - 1) - base];
+                procedures.insert (procedureName (procedureOfImop (call)));
+                locations.insert (locationName (call));
+            }
+
+            report.addCalls (site->name, procedures, locations,
+                             calls.second.calls, calls.second.elements, cost);
+        }
+    }
+}
+
+/**
+ * Profiling replaces the callbacks of all instructions with PROFILE_callback,
+ * which accounts the time since the previous instruction to it and then calls
+ * the original callback. The call stack is tracked as a tree of procedures so
+ * that the time can be reported per stack.
+ */
+int PROFILE_callback (const Instruction* ip, ExecutionContext& cxt);
+
+class Profiler {
+
+private: /* Types: */
+
+    using Clock = std::chrono::steady_clock;
+
+    enum class Kind : uint8_t { Plain, Call, Return };
+
+    struct InstructionProfile {
+        CallbackTy callback;
+        Kind kind = Kind::Plain;
+        int8_t sizeArg = -1; ///< Argument holding the number of elements, if any.
+        const SymbolProcedure* callee = nullptr;
+        VirtualMachineProfile::Counters counters;
+    };
+
+    struct StackNode {
+        size_t parent;
+        const SymbolProcedure* proc;
+        uint64_t nanoseconds;
+    };
+
+public: /* Methods: */
+
+    explicit Profiler (Compiler::Code& code)
+        : m_code (code)
+        , m_instructions (code.instructions.size ())
+        , m_stack { StackNode { 0u, nullptr, 0u } }
+        , m_node (0u)
+        , m_lastNode (0u)
+        , m_last (nullptr)
+    {
+        for (size_t k = 0; k < m_instructions.size (); ++ k) {
+            Instruction& i = code.instructions[k];
+            InstructionProfile& p = m_instructions[k];
+            const Imop& imop = *code.origins[k];
+            p.callback = i.callback;
+            i.callback = &PROFILE_callback;
+
+            if (p.callback == SIMPLE_CALLBACK(CALL)) {
+                p.kind = Kind::Call;
+                p.callee = procedureOf (i.args[0].un_inst - code.instructions.data ());
+            }
+            else if (p.callback == SIMPLE_CALLBACK(RETVOID)) {
+                p.kind = Kind::Return;
+            }
+            else if (imop.isVectorized ()) {
+                p.sizeArg = imop.nArgs () - 1;
+            }
+            else if (imop.type () == Imop::ALLOC) {
+                p.sizeArg = 1;
+            }
+            else if (imop.type () == Imop::COPY) {
+                p.sizeArg = 2;
+            }
+        }
+    }
+
+    /// Accounts the instruction and returns its original callback.
+    inline CallbackTy enter (const Instruction* ip, ExecutionContext& cxt) {
+        const auto now = Clock::now ();
+        account (now);
+
+        InstructionProfile& p = m_instructions[ip - m_code.instructions.data ()];
+        ++ p.counters.executions;
+        if (p.sizeArg >= 0)
+            p.counters.elements += cxt.lookup (ip->args[p.sizeArg]).un_uint_val;
+
+        m_last = &p;
+        m_lastNode = m_node;
+        m_lastTime = now;
+
+        // The call or return takes effect from the next instruction on:
+        if (p.kind == Kind::Call) {
+            m_node = child (m_node, p.callee);
+        }
+        else if (p.kind == Kind::Return) {
+            m_node = m_stack[m_node].parent;
+        }
+
+        return p.callback;
+    }
+
+    /// Accounts the last instruction and stores the profile.
+    void finish (VirtualMachineProfile& profile) {
+        account (Clock::now ());
+        m_last = nullptr;
+
+        std::map<const SymbolProcedure*, std::string> names;
+        auto nameOf = [&names](const SymbolProcedure* proc) -> const std::string& {
+            auto it = names.find (proc);
+            if (it == names.end ())
+                it = names.emplace (proc, procedureName (proc)).first;
+            return it->second;
+        };
+
+        for (size_t k = 0; k < m_instructions.size (); ++ k) {
+            const InstructionProfile& p = m_instructions[k];
+            if (p.counters.executions == 0u)
+                continue;
+
+            const Imop& imop = *m_code.origins[k];
+            profile.addInstruction (Imop::typeName (imop.type ()),
+                                    nameOf (procedureOf (k)),
+                                    locationName (imop), p.counters);
+        }
+
+        for (size_t n = 0; n < m_stack.size (); ++ n) {
+            std::string stack = nameOf (m_stack[n].proc);
+            for (size_t a = n; a != 0u; ) {
+                a = m_stack[a].parent;
+                stack = nameOf (m_stack[a].proc) + ';' + stack;
+            }
+
+            profile.addStack (stack, m_stack[n].nanoseconds);
+        }
+    }
+
+private:
+
+    inline void account (Clock::time_point now) {
+        if (m_last != nullptr) {
+            const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    now - m_lastTime).count ();
+            m_last->counters.nanoseconds += ns;
+            m_stack[m_lastNode].nanoseconds += ns;
+        }
+    }
+
+    size_t child (size_t parent, const SymbolProcedure* proc) {
+        const auto r = m_children.emplace (std::make_pair (parent, proc), m_stack.size ());
+        if (r.second)
+            m_stack.push_back (StackNode { parent, proc, 0u });
+        return r.first->second;
+    }
+
+    const SymbolProcedure* procedureOf (size_t index) const {
+        return procedureOfImop (*m_code.origins[index]);
+    }
+
+private: /* Fields: */
+
+    const Compiler::Code& m_code;
+    std::vector<InstructionProfile> m_instructions;
+    std::vector<StackNode> m_stack; ///< Tree of call stacks, the root is the entry procedure.
+    std::map<std::pair<size_t, const SymbolProcedure*>, size_t> m_children;
+    size_t m_node; ///< Stack of the next instruction.
+    size_t m_lastNode;
+    InstructionProfile* m_last;
+    Clock::time_point m_lastTime;
+};
+
+int PROFILE_callback (const Instruction* ip, ExecutionContext& cxt) {
+    return cxt.m_profiler->enter (ip, cxt) (ip, cxt);
+}
+
 } // namespace anonymous
 
+VirtualMachine::VirtualMachine ()
+    : VirtualMachine (std::cout, std::cerr)
+{ }
+
 int VirtualMachine::run (const Program& pr) {
-    auto const code(Compiler::runOn(pr));
+    ExecutionContext cxt (m_out, m_err);
+    auto code(Compiler::runOn(pr, cxt.m_global,
+                              m_syscallEmulator ? *m_syscallEmulator
+                                                : *SyscallEmulator::standard ()));
+    auto const & is = code.instructions;
+
+    std::unique_ptr<Profiler> profiler;
+    m_profile.reset ();
+    if (m_profiling) {
+        profiler.reset (new Profiler (code));
+        cxt.m_profiler = profiler.get ();
+    }
+
+    cxt.m_reportSyscalls = m_syscallReporting;
 
     // execute
-    push_frame (nullptr);
-    int status = code.front().callback(code.data());
+    cxt.push_frame (nullptr, code.entryFrameSize);
+    int status = is.front().callback(is.data(), cxt);
+    m_executed = cxt.m_instructionCount;
 
-    // Program might exit from within a procedure, and if that
-    // happens we nee to unwind all the frames to clear the memory.
-    while (m_frames != nullptr) {
-        pop_frame ();
+    if (profiler) {
+        m_profile.reset (new VirtualMachineProfile ());
+        profiler->finish (*m_profile);
     }
 
-    free_store (m_global);
+    m_syscallReport = SyscallReport ();
+    if (m_syscallReporting)
+        reportSyscalls (code, m_syscallCosts.get (), m_syscallReport);
 
     return status;
 }
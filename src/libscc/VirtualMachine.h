@@ -20,14 +20,78 @@
 #ifndef SECREC_VIRTUAL_MACHINE_H
 #define SECREC_VIRTUAL_MACHINE_H
 
+#include "VirtualMachineProfile.h"
+#include "VirtualMachineSyscalls.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <utility>
+
 namespace SecreC {
 
 class Program;
 
+/**
+ * Reference interpreter of the intermediate code. All state of a run is local
+ * to it, so separate instances can evaluate programs on separate threads.
+ */
 class VirtualMachine {
 public:
-    inline VirtualMachine () { }
+    /// Prints the output of the program to standard output and errors to standard error.
+    VirtualMachine ();
+
+    inline VirtualMachine (std::ostream& out, std::ostream& err)
+        : m_out (out)
+        , m_err (err)
+        , m_executed (0)
+        , m_profiling (false)
+        , m_syscallReporting (false)
+    { }
+
     int run (const Program&);
+
+    /// Number of instructions executed by the last run.
+    std::uint64_t executedInstructions () const { return m_executed; }
+
+    /**
+     * Enables profiling of the following runs. Runs are slower when
+     * profiling, but otherwise profiling has no cost.
+     */
+    void setProfiling (bool enabled) { m_profiling = enabled; }
+
+    /// Profile of the last run, or nullptr if it was not profiled.
+    const VirtualMachineProfile* profile () const { return m_profile.get (); }
+
+    /// System calls are emulated by SyscallEmulator::standard () unless set otherwise.
+    void setSyscallEmulator (std::shared_ptr<const SyscallEmulator> emulator) {
+        m_syscallEmulator = std::move (emulator);
+    }
+
+    /// Costs of system calls used in the report, by default the costs are not known.
+    void setSyscallCosts (std::shared_ptr<const SyscallCostTable> costs) {
+        m_syscallCosts = std::move (costs);
+    }
+
+    /**
+     * Enables accounting system calls to their call stacks in the following
+     * runs. Without it the report of a run is empty.
+     */
+    void setSyscallReporting (bool enabled) { m_syscallReporting = enabled; }
+
+    /// System calls made by the last run.
+    const SyscallReport& syscallReport () const { return m_syscallReport; }
+
+private:
+    std::ostream& m_out;
+    std::ostream& m_err;
+    std::uint64_t m_executed;
+    bool m_profiling;
+    bool m_syscallReporting;
+    std::unique_ptr<VirtualMachineProfile> m_profile;
+    std::shared_ptr<const SyscallEmulator> m_syscallEmulator;
+    std::shared_ptr<const SyscallCostTable> m_syscallCosts;
+    SyscallReport m_syscallReport;
 };
 
 } /* namespace SecreC { */
@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "VirtualMachineKernels.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+
+namespace SecreC {
+namespace VMKernels {
+
+namespace /* anonymous */ {
+
+template <typename T, std::size_t Bytes>
+struct Vector {
+    typedef T type __attribute__ ((vector_size (Bytes)));
+};
+
+/**
+ * Kernels over vectors of BYTES bytes. Elements that do not fill a whole
+ * vector at the end of the array are handled one at a time.
+ */
+
+#define BINARY_KERNEL(NAME, TARGET, BYTES, OP) \
+    template <typename T> \
+    TARGET void NAME (T* dest, const T* x, const T* y, std::size_t n) { \
+        using V = typename Vector<T, BYTES>::type; \
+        constexpr std::size_t L = BYTES / sizeof (T); \
+        std::size_t i = 0; \
+        for (; i + L <= n; i += L) { \
+            V a, b; \
+            std::memcpy (&a, x + i, sizeof (V)); \
+            std::memcpy (&b, y + i, sizeof (V)); \
+            const V r = a OP b; \
+            std::memcpy (dest + i, &r, sizeof (V)); \
+        } \
+        for (; i < n; ++ i) \
+            dest[i] = static_cast<T> (x[i] OP y[i]); \
+    }
+
+#define COMPARE_KERNEL(NAME, TARGET, BYTES, OP) \
+    template <typename T> \
+    TARGET void NAME (bool* dest, const T* x, const T* y, std::size_t n) { \
+        using V = typename Vector<T, BYTES>::type; \
+        constexpr std::size_t L = BYTES / sizeof (T); \
+        std::size_t i = 0; \
+        /* Narrowing 64-bit lane masks to bytes costs more than it saves: */ \
+        if (sizeof (T) < 8) { \
+            for (; i + L <= n; i += L) { \
+                V a, b; \
+                std::memcpy (&a, x + i, sizeof (V)); \
+                std::memcpy (&b, y + i, sizeof (V)); \
+                const auto m = a OP b; \
+                for (std::size_t j = 0; j < L; ++ j) \
+                    dest[i + j] = m[j] != 0; \
+            } \
+        } \
+        for (; i < n; ++ i) \
+            dest[i] = x[i] OP y[i]; \
+    }
+
+/* Booleans are bytes that are either 0 or 1: */
+#define LOGIC_KERNEL(NAME, TARGET, BYTES, VOP, OP) \
+    TARGET void NAME (bool* dest, const bool* x, const bool* y, std::size_t n) { \
+        using V = Vector<std::uint8_t, BYTES>::type; \
+        static_assert (sizeof (bool) == 1, "Booleans are assumed to be bytes."); \
+        std::size_t i = 0; \
+        for (; i + BYTES <= n; i += BYTES) { \
+            V a, b; \
+            std::memcpy (&a, x + i, sizeof (V)); \
+            std::memcpy (&b, y + i, sizeof (V)); \
+            const V r = a VOP b; \
+            std::memcpy (dest + i, &r, sizeof (V)); \
+        } \
+        for (; i < n; ++ i) \
+            dest[i] = x[i] OP y[i]; \
+    }
+
+#define DEFINE_KERNELS(TARGET, BYTES) \
+    BINARY_KERNEL (add, TARGET, BYTES, +) \
+    BINARY_KERNEL (sub, TARGET, BYTES, -) \
+    BINARY_KERNEL (mul, TARGET, BYTES, *) \
+    BINARY_KERNEL (band, TARGET, BYTES, &) \
+    BINARY_KERNEL (bor, TARGET, BYTES, |) \
+    BINARY_KERNEL (bxor, TARGET, BYTES, ^) \
+    COMPARE_KERNEL (eq, TARGET, BYTES, ==) \
+    COMPARE_KERNEL (ne, TARGET, BYTES, !=) \
+    COMPARE_KERNEL (lt, TARGET, BYTES, <) \
+    COMPARE_KERNEL (le, TARGET, BYTES, <=) \
+    COMPARE_KERNEL (gt, TARGET, BYTES, >) \
+    COMPARE_KERNEL (ge, TARGET, BYTES, >=) \
+    LOGIC_KERNEL (land, TARGET, BYTES, &, &&) \
+    LOGIC_KERNEL (lor, TARGET, BYTES, |, ||)
+
+/**
+ * Element at a time kernels, used if SIMD is not available or is disabled.
+ */
+
+namespace portable {
+
+#define PORTABLE_KERNEL(NAME, D, T, EXPR) \
+    inline void NAME (D* dest, const T* x, const T* y, std::size_t n) { \
+        for (std::size_t i = 0; i < n; ++ i) \
+            dest[i] = EXPR; \
+    }
+
+#define PORTABLE_BINARY_KERNEL(NAME, OP) \
+    template <typename T> PORTABLE_KERNEL (NAME, T, T, static_cast<T> (x[i] OP y[i]))
+#define PORTABLE_COMPARE_KERNEL(NAME, OP) \
+    template <typename T> PORTABLE_KERNEL (NAME, bool, T, x[i] OP y[i])
+
+PORTABLE_BINARY_KERNEL (add, +)
+PORTABLE_BINARY_KERNEL (sub, -)
+PORTABLE_BINARY_KERNEL (mul, *)
+PORTABLE_BINARY_KERNEL (band, &)
+PORTABLE_BINARY_KERNEL (bor, |)
+PORTABLE_BINARY_KERNEL (bxor, ^)
+PORTABLE_COMPARE_KERNEL (eq, ==)
+PORTABLE_COMPARE_KERNEL (ne, !=)
+PORTABLE_COMPARE_KERNEL (lt, <)
+PORTABLE_COMPARE_KERNEL (le, <=)
+PORTABLE_COMPARE_KERNEL (gt, >)
+PORTABLE_COMPARE_KERNEL (ge, >=)
+PORTABLE_KERNEL (land, bool, bool, x[i] && y[i])
+PORTABLE_KERNEL (lor, bool, bool, x[i] || y[i])
+
+} // namespace portable
+
+#if defined (__x86_64__)
+
+/* SSE2 is part of the x86-64 baseline: */
+namespace sse2 { DEFINE_KERNELS (, 16) }
+
+namespace avx2 { DEFINE_KERNELS (__attribute__ ((target ("avx2"))), 32) }
+
+#endif
+
+InstructionSet bestInstructionSet () {
+#if defined (__x86_64__)
+    __builtin_cpu_init ();
+    if (__builtin_cpu_supports ("avx2"))
+        return InstructionSet::AVX2;
+
+    return InstructionSet::SSE2;
+#else
+    return InstructionSet::Portable;
+#endif
+}
+
+InstructionSet detectInstructionSet () {
+    const InstructionSet best = bestInstructionSet ();
+    const char* requested = std::getenv ("SECREC_VM_SIMD");
+    if (requested == nullptr)
+        return best;
+
+    for (InstructionSet set : { InstructionSet::Portable, InstructionSet::SSE2, InstructionSet::AVX2 }) {
+        if (std::strcmp (requested, instructionSetName (set)) == 0)
+            return set < best ? set : best;
+    }
+
+    return best;
+}
+
+} // namespace anonymous
+
+InstructionSet instructionSet () {
+    static const InstructionSet set = detectInstructionSet ();
+    return set;
+}
+
+const char* instructionSetName (InstructionSet set) {
+    switch (set) {
+    case InstructionSet::Portable: return "portable";
+    case InstructionSet::SSE2:     return "sse2";
+    case InstructionSet::AVX2:     return "avx2";
+    }
+
+    return "unknown";
+}
+
+#if defined (__x86_64__)
+#define DISPATCH(NAME, ...) do { \
+        switch (instructionSet ()) { \
+        case InstructionSet::AVX2: avx2::NAME (__VA_ARGS__); return; \
+        case InstructionSet::SSE2: sse2::NAME (__VA_ARGS__); return; \
+        case InstructionSet::Portable: break; \
+        } \
+        portable::NAME (__VA_ARGS__); \
+    } while (0)
+#else
+#define DISPATCH(NAME, ...) portable::NAME (__VA_ARGS__)
+#endif
+
+#define DEFINE_TEMPLATE_KERNEL(NAME, D) \
+    template <typename T> \
+    void NAME (D* dest, const T* x, const T* y, std::size_t n) { \
+        DISPATCH (NAME, dest, x, y, n); \
+    }
+
+DEFINE_TEMPLATE_KERNEL (add, T)
+DEFINE_TEMPLATE_KERNEL (sub, T)
+DEFINE_TEMPLATE_KERNEL (mul, T)
+DEFINE_TEMPLATE_KERNEL (band, T)
+DEFINE_TEMPLATE_KERNEL (bor, T)
+DEFINE_TEMPLATE_KERNEL (bxor, T)
+DEFINE_TEMPLATE_KERNEL (eq, bool)
+DEFINE_TEMPLATE_KERNEL (ne, bool)
+DEFINE_TEMPLATE_KERNEL (lt, bool)
+DEFINE_TEMPLATE_KERNEL (le, bool)
+DEFINE_TEMPLATE_KERNEL (gt, bool)
+DEFINE_TEMPLATE_KERNEL (ge, bool)
+
+void land (bool* dest, const bool* x, const bool* y, std::size_t n) {
+    DISPATCH (land, dest, x, y, n);
+}
+
+void lor (bool* dest, const bool* x, const bool* y, std::size_t n) {
+    DISPATCH (lor, dest, x, y, n);
+}
+
+#define INSTANTIATE_NUMERIC(T) \
+    template void add<T> (T*, const T*, const T*, std::size_t); \
+    template void sub<T> (T*, const T*, const T*, std::size_t); \
+    template void mul<T> (T*, const T*, const T*, std::size_t); \
+    template void eq<T> (bool*, const T*, const T*, std::size_t); \
+    template void ne<T> (bool*, const T*, const T*, std::size_t); \
+    template void lt<T> (bool*, const T*, const T*, std::size_t); \
+    template void le<T> (bool*, const T*, const T*, std::size_t); \
+    template void gt<T> (bool*, const T*, const T*, std::size_t); \
+    template void ge<T> (bool*, const T*, const T*, std::size_t);
+
+#define INSTANTIATE_INTEGER(T) \
+    INSTANTIATE_NUMERIC (T) \
+    template void band<T> (T*, const T*, const T*, std::size_t); \
+    template void bor<T> (T*, const T*, const T*, std::size_t); \
+    template void bxor<T> (T*, const T*, const T*, std::size_t);
+
+INSTANTIATE_INTEGER (std::int8_t)
+INSTANTIATE_INTEGER (std::int16_t)
+INSTANTIATE_INTEGER (std::int32_t)
+INSTANTIATE_INTEGER (std::int64_t)
+INSTANTIATE_INTEGER (std::uint8_t)
+INSTANTIATE_INTEGER (std::uint16_t)
+INSTANTIATE_INTEGER (std::uint32_t)
+INSTANTIATE_INTEGER (std::uint64_t)
+INSTANTIATE_NUMERIC (float)
+INSTANTIATE_NUMERIC (double)
+
+} /* namespace VMKernels */
+} /* namespace SecreC */
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SECREC_VIRTUAL_MACHINE_KERNELS_H
+#define SECREC_VIRTUAL_MACHINE_KERNELS_H
+
+#include <cstddef>
+
+/**
+ * Kernels of the vectorized VirtualMachine instructions over packed arrays.
+ * On x86-64 they use SSE2, or AVX2 if the processor supports it.
+ */
+
+namespace SecreC {
+namespace VMKernels {
+
+enum class InstructionSet { Portable, SSE2, AVX2 };
+
+/**
+ * \returns the instruction set the kernels use. It is the best one that the
+ * processor supports, unless it is restricted with the SECREC_VM_SIMD
+ * environment variable to "portable", "sse2" or "avx2".
+ */
+InstructionSet instructionSet ();
+
+const char* instructionSetName (InstructionSet set);
+
+/**
+ * Arithmetic kernels compute dest[i] = x[i] op y[i] for i < n. They are
+ * defined for all integer and floating point types.
+ */
+template <typename T> void add (T* dest, const T* x, const T* y, std::size_t n);
+template <typename T> void sub (T* dest, const T* x, const T* y, std::size_t n);
+template <typename T> void mul (T* dest, const T* x, const T* y, std::size_t n);
+
+/**
+ * Bitwise kernels are defined for all integer types.
+ */
+template <typename T> void band (T* dest, const T* x, const T* y, std::size_t n);
+template <typename T> void bor (T* dest, const T* x, const T* y, std::size_t n);
+template <typename T> void bxor (T* dest, const T* x, const T* y, std::size_t n);
+
+/**
+ * Comparison kernels are defined for all integer and floating point types.
+ */
+template <typename T> void eq (bool* dest, const T* x, const T* y, std::size_t n);
+template <typename T> void ne (bool* dest, const T* x, const T* y, std::size_t n);
+template <typename T> void lt (bool* dest, const T* x, const T* y, std::size_t n);
+template <typename T> void le (bool* dest, const T* x, const T* y, std::size_t n);
+template <typename T> void gt (bool* dest, const T* x, const T* y, std::size_t n);
+template <typename T> void ge (bool* dest, const T* x, const T* y, std::size_t n);
+
+void land (bool* dest, const bool* x, const bool* y, std::size_t n);
+void lor (bool* dest, const bool* x, const bool* y, std::size_t n);
+
+} /* namespace VMKernels */
+} /* namespace SecreC */
+
+#endif // SECREC_VIRTUAL_MACHINE_KERNELS_H
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "VirtualMachineProfile.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <vector>
+
+namespace SecreC {
+
+namespace /* anonymous */ {
+
+void writeTable (std::ostream& os,
+                 const char* title,
+                 const VirtualMachineProfile::CounterMap& counters,
+                 const VirtualMachineProfile::Counters& total,
+                 std::size_t maxRows)
+{
+    using Row = VirtualMachineProfile::CounterMap::value_type;
+    std::vector<const Row*> rows;
+    rows.reserve (counters.size ());
+    for (const auto& row : counters)
+        rows.push_back (&row);
+
+    std::stable_sort (rows.begin (), rows.end (), [](const Row* a, const Row* b) {
+        return a->second.nanoseconds > b->second.nanoseconds;
+    });
+
+    os << title;
+    if (rows.size () > maxRows) {
+        os << " (top " << maxRows << " of " << rows.size () << ')';
+        rows.resize (maxRows);
+    }
+
+    os << ":\n"
+       << std::setw (12) << "time (ms)" << std::setw (8) << "%"
+       << std::setw (14) << "executions" << std::setw (14) << "elements"
+       << "  name\n";
+
+    for (const Row* row : rows) {
+        const auto& c = row->second;
+        const double percent = total.nanoseconds == 0u ? 0.0
+            : 100.0 * c.nanoseconds / total.nanoseconds;
+        os << std::setw (12) << c.nanoseconds / 1e6
+           << std::setw (8) << percent
+           << std::setw (14) << c.executions
+           << std::setw (14) << c.elements
+           << "  " << row->first << '\n';
+    }
+
+    os << '\n';
+}
+
+} // namespace anonymous
+
+void VirtualMachineProfile::addInstruction (const std::string& type,
+                                            const std::string& procedure,
+                                            const std::string& location,
+                                            const Counters& counters)
+{
+    m_instructions[type] += counters;
+    m_procedures[procedure] += counters;
+    m_locations[location] += counters;
+    m_total += counters;
+}
+
+void VirtualMachineProfile::addStack (const std::string& stack,
+                                      std::uint64_t nanoseconds)
+{
+    m_stacks[stack] += nanoseconds;
+}
+
+void VirtualMachineProfile::writeReport (std::ostream& os,
+                                         std::size_t maxRows) const
+{
+    const auto flags = os.flags ();
+    const auto precision = os.precision ();
+    os << std::fixed << std::setprecision (2);
+    os << "Executed " << m_total.executions << " instructions in "
+       << m_total.nanoseconds / 1e6 << " ms, vectorized instructions processed "
+       << m_total.elements << " elements.\n\n";
+    writeTable (os, "Instructions", m_instructions, m_total, maxRows);
+    writeTable (os, "Procedures (self time)", m_procedures, m_total, maxRows);
+    writeTable (os, "Source locations", m_locations, m_total, maxRows);
+    os.flags (flags);
+    os.precision (precision);
+}
+
+void VirtualMachineProfile::writeCollapsedStacks (std::ostream& os) const {
+    for (const auto& stack : m_stacks) {
+        if (stack.second > 0u)
+            os << stack.first << ' ' << stack.second << '\n';
+    }
+}
+
+} /* namespace SecreC */
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SECREC_VIRTUAL_MACHINE_PROFILE_H
+#define SECREC_VIRTUAL_MACHINE_PROFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <string>
+
+namespace SecreC {
+
+/**
+ * Where a profiled run of the VirtualMachine spent its time. Times are in
+ * nanoseconds and include the dispatch of the instruction and the overhead
+ * of measuring it.
+ */
+class VirtualMachineProfile {
+public: /* Types: */
+
+    struct Counters {
+        std::uint64_t executions = 0u;
+        std::uint64_t nanoseconds = 0u;
+        std::uint64_t elements = 0u; ///< Elements processed by vectorized instructions.
+
+        Counters& operator += (const Counters& other) {
+            executions += other.executions;
+            nanoseconds += other.nanoseconds;
+            elements += other.elements;
+            return *this;
+        }
+    };
+
+    using CounterMap = std::map<std::string, Counters>;
+
+public: /* Methods: */
+
+    /**
+     * Accounts the executions of a single instruction.
+     * \param type name of the intermediate code instruction
+     * \param procedure procedure the instruction belongs to
+     * \param location source location the instruction was generated from
+     */
+    void addInstruction (const std::string& type,
+                         const std::string& procedure,
+                         const std::string& location,
+                         const Counters& counters);
+
+    /// Accounts time spent in procedures of the stack, outermost first, separated by ';'.
+    void addStack (const std::string& stack, std::uint64_t nanoseconds);
+
+    const CounterMap& instructions () const { return m_instructions; }
+    const CounterMap& procedures () const { return m_procedures; }
+    const CounterMap& locations () const { return m_locations; }
+    const Counters& total () const { return m_total; }
+
+    /// Writes tables of instruction types, procedures and source locations sorted by time.
+    void writeReport (std::ostream& os, std::size_t maxRows = 20u) const;
+
+    /// Writes the stacks in the collapsed format that flame graph tools read.
+    void writeCollapsedStacks (std::ostream& os) const;
+
+private: /* Fields: */
+
+    CounterMap                             m_instructions;
+    CounterMap                             m_procedures;
+    CounterMap                             m_locations;
+    std::map<std::string, std::uint64_t>   m_stacks;
+    Counters                               m_total;
+};
+
+} /* namespace SecreC */
+
+#endif // SECREC_VIRTUAL_MACHINE_PROFILE_H
@@ -0,0 +1,450 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "VirtualMachineSyscalls.h"
+
+#include "Misc.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace SecreC {
+
+namespace /* anonymous */ {
+
+using Handler = SyscallEmulator::Handler;
+
+#define FOR_INTEGER_TYPES(F) \
+    F (DATATYPE_INT8) F (DATATYPE_INT16) F (DATATYPE_INT32) F (DATATYPE_INT64) \
+    F (DATATYPE_UINT8) F (DATATYPE_UINT16) F (DATATYPE_UINT32) F (DATATYPE_UINT64)
+
+#define FOR_NUMERIC_TYPES(F) \
+    FOR_INTEGER_TYPES (F) F (DATATYPE_FLOAT32) F (DATATYPE_FLOAT64)
+
+#define FOR_ALL_TYPES(F) \
+    FOR_NUMERIC_TYPES (F) F (DATATYPE_BOOL)
+
+template <SecrecDataType ty> struct element;
+template <> struct element<DATATYPE_BOOL> { using type = bool; };
+template <> struct element<DATATYPE_INT8> { using type = int8_t; };
+template <> struct element<DATATYPE_INT16> { using type = int16_t; };
+template <> struct element<DATATYPE_INT32> { using type = int32_t; };
+template <> struct element<DATATYPE_INT64> { using type = int64_t; };
+template <> struct element<DATATYPE_UINT8> { using type = uint8_t; };
+template <> struct element<DATATYPE_UINT16> { using type = uint16_t; };
+template <> struct element<DATATYPE_UINT32> { using type = uint32_t; };
+template <> struct element<DATATYPE_UINT64> { using type = uint64_t; };
+template <> struct element<DATATYPE_FLOAT32> { using type = float; };
+template <> struct element<DATATYPE_FLOAT64> { using type = double; };
+
+template <SecrecDataType ty>
+using element_t = typename element<ty>::type;
+
+std::string syscallName (const std::string& kind,
+                         const char* op,
+                         SecrecDataType ty)
+{
+    return kind + "::" + op + '_' + SecrecFundDataTypeToString (ty) + "_vec";
+}
+
+void checkArity (const SyscallArguments& args, std::size_t n) {
+    if (args.size () != n) {
+        std::ostringstream os;
+        os << "Expected " << n << " operands, got " << args.size () << '.';
+        throw std::runtime_error (os.str ());
+    }
+}
+
+/// Elements of the operand, checked to be of the given type and size.
+template <SecrecDataType ty>
+element_t<ty>* elements (const SyscallArguments& args,
+                         std::size_t i,
+                         std::size_t size)
+{
+    const SyscallArgument& arg = args[i];
+    if (arg.dataType != ty || arg.data == nullptr) {
+        std::ostringstream os;
+        os << "Operand " << i << " is of type "
+           << SecrecFundDataTypeToString (arg.dataType) << ", expected "
+           << SecrecFundDataTypeToString (ty) << '.';
+        throw std::runtime_error (os.str ());
+    }
+
+    if (arg.size != size) {
+        std::ostringstream os;
+        os << "Operand " << i << " has " << arg.size
+           << " elements, expected " << size << '.';
+        throw std::runtime_error (os.str ());
+    }
+
+    return arg.elements<element_t<ty> >();
+}
+
+/// out[i] = op (x[i], y[i])
+template <SecrecDataType ty, SecrecDataType outTy, typename Op>
+Handler binary (Op op) {
+    return [op](SyscallArguments& args) {
+        checkArity (args, 4u);
+        const std::size_t n = args[1].size;
+        const auto x = elements<ty>(args, 1u, n);
+        const auto y = elements<ty>(args, 2u, n);
+        const auto out = elements<outTy>(args, 3u, n);
+        for (std::size_t i = 0; i < n; ++ i)
+            out[i] = op (x[i], y[i]);
+    };
+}
+
+/// out[i] = op (x[i])
+template <SecrecDataType ty, SecrecDataType outTy, typename Op>
+Handler unary (Op op) {
+    return [op](SyscallArguments& args) {
+        checkArity (args, 3u);
+        const std::size_t n = args[1].size;
+        const auto x = elements<ty>(args, 1u, n);
+        const auto out = elements<outTy>(args, 2u, n);
+        for (std::size_t i = 0; i < n; ++ i)
+            out[i] = op (x[i]);
+    };
+}
+
+/// out[0] = op (... op (op (init, x[0]), x[1]) ...)
+template <SecrecDataType ty, typename Op>
+Handler reduction (element_t<ty> init, Op op) {
+    return [init, op](SyscallArguments& args) {
+        checkArity (args, 3u);
+        const std::size_t n = args[1].size;
+        const auto x = elements<ty>(args, 1u, n);
+        auto acc = init;
+        for (std::size_t i = 0; i < n; ++ i)
+            acc = op (acc, x[i]);
+        *elements<ty>(args, 2u, 1u) = acc;
+    };
+}
+
+/// Copies between public and private values.
+template <SecrecDataType ty>
+Handler copy (bool toPrivate) {
+    return [toPrivate](SyscallArguments& args) {
+        checkArity (args, 3u);
+        if (args[1].isPrivate == toPrivate || args[2].isPrivate != toPrivate)
+            throw std::runtime_error (toPrivate
+                ? "Expected a public operand and a private result."
+                : "Expected a private operand and a public result.");
+        const std::size_t n = args[1].size;
+        const auto x = elements<ty>(args, 1u, n);
+        std::copy (x, x + n, elements<ty>(args, 2u, n));
+    };
+}
+
+template <SecrecDataType ty>
+Handler randomize () {
+    return [](SyscallArguments& args) {
+        checkArity (args, 2u);
+        // Every thread evaluates its own programs:
+        thread_local std::mt19937_64 generator;
+        const auto out = elements<ty>(args, 1u, args[1].size);
+        for (std::size_t i = 0; i < args[1].size; ++ i)
+            out[i] = static_cast<element_t<ty> >(generator ());
+    };
+}
+
+template <typename T>
+T checkDivisor (T y) {
+    if (y == T (0))
+        throw std::runtime_error ("Division by zero.");
+    return y;
+}
+
+/*
+ * The smallest signed value divided by -1 does not fit the type. Private
+ * integers wrap around, so the quotient wraps to the dividend itself and the
+ * remainder is zero:
+ */
+template <typename T>
+bool overflowsDivision (T x, T y) {
+    return std::is_signed<T>::value &&
+           x == std::numeric_limits<T>::min () && y == static_cast<T>(-1);
+}
+
+template <typename T>
+T divide (T x, T y, std::false_type) {
+    if (overflowsDivision (x, checkDivisor (y)))
+        return x;
+    return static_cast<T>(x / y);
+}
+
+template <typename T>
+T divide (T x, T y, std::true_type) { return x / y; }
+
+template <SecrecDataType ty>
+void defineArithmetic (SyscallEmulator& e, const std::string& kind) {
+    using T = element_t<ty>;
+    e.define (syscallName (kind, "add", ty), binary<ty, ty>([](T x, T y) { return static_cast<T>(x + y); }));
+    e.define (syscallName (kind, "sub", ty), binary<ty, ty>([](T x, T y) { return static_cast<T>(x - y); }));
+    e.define (syscallName (kind, "mul", ty), binary<ty, ty>([](T x, T y) { return static_cast<T>(x * y); }));
+    e.define (syscallName (kind, "div", ty), binary<ty, ty>([](T x, T y) {
+        return divide (x, y, std::is_floating_point<T> ());
+    }));
+    e.define (syscallName (kind, "min", ty), binary<ty, ty>([](T x, T y) { return std::min (x, y); }));
+    e.define (syscallName (kind, "max", ty), binary<ty, ty>([](T x, T y) { return std::max (x, y); }));
+    e.define (syscallName (kind, "neg", ty), unary<ty, ty>([](T x) { return static_cast<T>(- x); }));
+    e.define (syscallName (kind, "sum", ty), reduction<ty>(T (0), [](T x, T y) { return static_cast<T>(x + y); }));
+    e.define (syscallName (kind, "product", ty), reduction<ty>(T (1), [](T x, T y) { return static_cast<T>(x * y); }));
+}
+
+template <SecrecDataType ty>
+void defineIntegerOnly (SyscallEmulator& e, const std::string& kind) {
+    using T = element_t<ty>;
+    e.define (syscallName (kind, "mod", ty), binary<ty, ty>([](T x, T y) {
+        if (overflowsDivision (x, checkDivisor (y)))
+            return T (0);
+        return static_cast<T>(x % y);
+    }));
+}
+
+template <SecrecDataType ty>
+void defineBitwise (SyscallEmulator& e, const std::string& kind) {
+    using T = element_t<ty>;
+    e.define (syscallName (kind, "and", ty), binary<ty, ty>([](T x, T y) { return static_cast<T>(x & y); }));
+    e.define (syscallName (kind, "or", ty), binary<ty, ty>([](T x, T y) { return static_cast<T>(x | y); }));
+    e.define (syscallName (kind, "xor", ty), binary<ty, ty>([](T x, T y) { return static_cast<T>(x ^ y); }));
+}
+
+template <SecrecDataType ty>
+void defineComparisons (SyscallEmulator& e, const std::string& kind) {
+    using T = element_t<ty>;
+    e.define (syscallName (kind, "eq", ty), binary<ty, DATATYPE_BOOL>([](T x, T y) { return x == y; }));
+    e.define (syscallName (kind, "ne", ty), binary<ty, DATATYPE_BOOL>([](T x, T y) { return x != y; }));
+    e.define (syscallName (kind, "lt", ty), binary<ty, DATATYPE_BOOL>([](T x, T y) { return x < y; }));
+    e.define (syscallName (kind, "lte", ty), binary<ty, DATATYPE_BOOL>([](T x, T y) { return x <= y; }));
+    e.define (syscallName (kind, "gt", ty), binary<ty, DATATYPE_BOOL>([](T x, T y) { return x > y; }));
+    e.define (syscallName (kind, "gte", ty), binary<ty, DATATYPE_BOOL>([](T x, T y) { return x >= y; }));
+}
+
+template <SecrecDataType ty>
+void defineCommon (SyscallEmulator& e, const std::string& kind) {
+    using T = element_t<ty>;
+    e.define (syscallName (kind, "classify", ty), copy<ty>(true));
+    e.define (syscallName (kind, "declassify", ty), copy<ty>(false));
+    e.define (syscallName (kind, "randomize", ty), randomize<ty>());
+
+#define DEFINE_CONVERSION(TO) \
+    e.define (kind + "::conv_" + SecrecFundDataTypeToString (ty) + "_to_" \
+                + SecrecFundDataTypeToString (TO) + "_vec", \
+              unary<ty, TO>([](T x) { return static_cast<element_t<TO> >(x); }));
+    FOR_ALL_TYPES (DEFINE_CONVERSION)
+#undef DEFINE_CONVERSION
+}
+
+/// Matches the name against the pattern where '*' matches any characters.
+bool matchPattern (const char* pattern, const char* name) {
+    if (*pattern == '\0')
+        return *name == '\0';
+
+    if (*pattern == '*') {
+        for (const char* rest = name; ; ++ rest) {
+            if (matchPattern (pattern + 1, rest))
+                return true;
+            if (*rest == '\0')
+                return false;
+        }
+    }
+
+    return *pattern == *name && matchPattern (pattern + 1, name + 1);
+}
+
+void writeTable (std::ostream& os,
+                 const char* title,
+                 const SyscallReport::CounterMap& counters,
+                 std::size_t maxRows)
+{
+    using Row = SyscallReport::CounterMap::value_type;
+    std::vector<const Row*> rows;
+    rows.reserve (counters.size ());
+    for (const auto& row : counters)
+        rows.push_back (&row);
+
+    std::stable_sort (rows.begin (), rows.end (), [](const Row* a, const Row* b) {
+        if (a->second.rounds != b->second.rounds)
+            return a->second.rounds > b->second.rounds;
+        return a->second.bytes > b->second.bytes;
+    });
+
+    os << title;
+    if (rows.size () > maxRows) {
+        os << " (top " << maxRows << " of " << rows.size () << ')';
+        rows.resize (maxRows);
+    }
+
+    os << ":\n"
+       << std::setw (10) << "rounds" << std::setw (14) << "bytes"
+       << std::setw (10) << "calls" << std::setw (14) << "elements"
+       << "  name\n";
+
+    for (const Row* row : rows) {
+        const auto& c = row->second;
+        os << std::setw (10) << c.rounds
+           << std::setw (14) << c.bytes
+           << std::setw (10) << c.calls
+           << std::setw (14) << c.elements
+           << "  " << row->first << '\n';
+    }
+
+    os << '\n';
+}
+
+} // namespace anonymous
+
+/*******************************************************************************
+  SyscallEmulator
+*******************************************************************************/
+
+void SyscallEmulator::define (const std::string& name, Handler handler) {
+    m_handlers[name] = std::move (handler);
+}
+
+const SyscallEmulator::Handler* SyscallEmulator::find (const std::string& name) const {
+    const auto it = m_handlers.find (name);
+    return it == m_handlers.end () ? nullptr : &it->second;
+}
+
+void SyscallEmulator::defineShared3p (const std::string& kind) {
+#define DEFINE_ALL(TY) defineCommon<TY>(*this, kind);
+#define DEFINE_NUMERIC(TY) \
+    defineArithmetic<TY>(*this, kind); \
+    defineComparisons<TY>(*this, kind);
+#define DEFINE_INTEGER(TY) \
+    defineIntegerOnly<TY>(*this, kind); \
+    defineBitwise<TY>(*this, kind);
+
+    FOR_ALL_TYPES (DEFINE_ALL)
+    FOR_NUMERIC_TYPES (DEFINE_NUMERIC)
+    FOR_INTEGER_TYPES (DEFINE_INTEGER)
+    defineBitwise<DATATYPE_BOOL>(*this, kind);
+    defineComparisons<DATATYPE_BOOL>(*this, kind);
+    define (syscallName (kind, "inv", DATATYPE_BOOL),
+            unary<DATATYPE_BOOL, DATATYPE_BOOL>([](bool x) { return ! x; }));
+
+#undef DEFINE_INTEGER
+#undef DEFINE_NUMERIC
+#undef DEFINE_ALL
+}
+
+std::shared_ptr<const SyscallEmulator> SyscallEmulator::standard () {
+    static const std::shared_ptr<const SyscallEmulator> emulator = [] {
+        auto e = std::make_shared<SyscallEmulator>();
+        e->defineShared3p ();
+        return e;
+    }();
+
+    return emulator;
+}
+
+/*******************************************************************************
+  SyscallCostTable
+*******************************************************************************/
+
+void SyscallCostTable::read (std::istream& is) {
+    std::string line;
+    for (unsigned lineNumber = 1u; std::getline (is, line); ++ lineNumber) {
+        std::istringstream ls (line);
+        std::string pattern;
+        if (! (ls >> pattern) || pattern[0] == '#')
+            continue;
+
+        Cost cost;
+        std::string rest;
+        if (! (ls >> cost.rounds >> cost.bytesPerElement)
+                || (! (ls >> cost.bytesPerCall) && ! ls.eof ())
+                || (ls.clear (), ls >> rest))
+        {
+            std::ostringstream os;
+            os << "Line " << lineNumber << " of the system call cost table "
+                  "is not of the form \"PATTERN ROUNDS BYTES_PER_ELEMENT "
+                  "[BYTES_PER_CALL]\".";
+            throw std::runtime_error (os.str ());
+        }
+
+        m_costs.emplace_back (std::move (pattern), cost);
+    }
+}
+
+const SyscallCostTable::Cost* SyscallCostTable::find (const std::string& name) const {
+    for (const auto& entry : m_costs) {
+        if (matchPattern (entry.first.c_str (), name.c_str ()))
+            return &entry.second;
+    }
+
+    return nullptr;
+}
+
+/*******************************************************************************
+  SyscallReport
+*******************************************************************************/
+
+void SyscallReport::addCalls (const std::string& name,
+                              const std::set<std::string>& procedures,
+                              const std::set<std::string>& locations,
+                              std::uint64_t calls,
+                              std::uint64_t elements,
+                              const SyscallCostTable::Cost* cost)
+{
+    Counters counters;
+    counters.calls = calls;
+    counters.elements = elements;
+    if (cost != nullptr) {
+        counters.rounds = calls * cost->rounds;
+        counters.bytes = elements * cost->bytesPerElement + calls * cost->bytesPerCall;
+    }
+    else {
+        m_uncosted.insert (name);
+    }
+
+    m_syscalls[name] += counters;
+    for (const auto& procedure : procedures)
+        m_procedures[procedure] += counters;
+    for (const auto& location : locations)
+        m_locations[location] += counters;
+    m_total += counters;
+}
+
+void SyscallReport::writeReport (std::ostream& os, std::size_t maxRows) const {
+    os << "Made " << m_total.calls << " system calls on " << m_total.elements
+       << " elements, estimated to take " << m_total.rounds << " rounds and "
+       << m_total.bytes << " bytes.\n\n";
+    writeTable (os, "System calls", m_syscalls, maxRows);
+    writeTable (os, "Procedures (inclusive)", m_procedures, maxRows);
+    writeTable (os, "Source locations (inclusive)", m_locations, maxRows);
+
+    if (! m_uncosted.empty ()) {
+        os << "No cost is known for:\n";
+        for (const auto& name : m_uncosted)
+            os << "  " << name << '\n';
+    }
+}
+
+} /* namespace SecreC */
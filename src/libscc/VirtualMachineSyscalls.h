@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SECREC_VIRTUAL_MACHINE_SYSCALLS_H
+#define SECREC_VIRTUAL_MACHINE_SYSCALLS_H
+
+#include "ParserEnums.h"
+#include "Syscall.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * System calls of the VirtualMachine. Private values are emulated with their
+ * public values, so the system calls of protection domains are computed
+ * locally on plaintext. Every call is counted together with the number of
+ * elements it processes, and its cost in communication rounds and bytes is
+ * estimated from a cost table.
+ */
+
+namespace SecreC {
+
+/*******************************************************************************
+  SyscallArgument
+*******************************************************************************/
+
+/// Operand of a system call as seen by its emulation.
+struct SyscallArgument {
+    SyscallPassingConvention convention;
+    SecrecDataType dataType; ///< Public data type the value is emulated with.
+    bool isPrivate;
+    bool isArray;
+    void* data; ///< Packed elements of the value, or the std::string of a string.
+    std::size_t size; ///< Number of elements.
+
+    template <typename T>
+    T* elements () const { return static_cast<T*>(data); }
+};
+
+using SyscallArguments = std::vector<SyscallArgument>;
+
+/*******************************************************************************
+  SyscallEmulator
+*******************************************************************************/
+
+class SyscallEmulator {
+public: /* Types: */
+
+    /// Emulations throw std::runtime_error if the arguments are not valid.
+    using Handler = std::function<void (SyscallArguments&)>;
+
+public: /* Methods: */
+
+    void define (const std::string& name, Handler handler);
+
+    /// \returns nullptr if the system call is not defined.
+    const Handler* find (const std::string& name) const;
+
+    /**
+     * Defines vectorized shared3p style system calls of the given protection
+     * domain kind. The first operand of every call is the domain identifier
+     * and the last one receives the result:
+     * - KIND::{add,sub,mul,div,mod,min,max}_T_vec (pd, x, y, out) for numeric T
+     * - KIND::{and,or,xor}_T_vec (pd, x, y, out) for bool and integer T
+     * - KIND::{eq,ne,lt,lte,gt,gte}_T_vec (pd, x, y, out) where out is bool
+     * - KIND::neg_T_vec (pd, x, out) for numeric T and KIND::inv_bool_vec
+     * - KIND::{sum,product}_T_vec (pd, x, out) where out has one element
+     * - KIND::conv_S_to_T_vec (pd, x, out)
+     * - KIND::classify_T_vec (pd, public x, out)
+     * - KIND::declassify_T_vec (pd, x, public out)
+     * - KIND::randomize_T_vec (pd, out)
+     * Element-wise operations require all vectors to be of the same size.
+     */
+    void defineShared3p (const std::string& kind = "shared3p");
+
+    /// Emulator of the shared3p system calls, used by default.
+    static std::shared_ptr<const SyscallEmulator> standard ();
+
+private: /* Fields: */
+
+    std::map<std::string, Handler> m_handlers;
+};
+
+/*******************************************************************************
+  SyscallCostTable
+*******************************************************************************/
+
+/**
+ * Estimated costs of system calls. The table is read from text with lines of
+ *     PATTERN ROUNDS BYTES_PER_ELEMENT [BYTES_PER_CALL]
+ * where '*' in the PATTERN matches any number of characters of the system
+ * call name. The first matching line applies. Empty lines and lines starting
+ * with '#' are ignored.
+ */
+class SyscallCostTable {
+public: /* Types: */
+
+    struct Cost {
+        std::uint64_t rounds = 0u;
+        std::uint64_t bytesPerElement = 0u;
+        std::uint64_t bytesPerCall = 0u;
+    };
+
+public: /* Methods: */
+
+    /// \throws std::runtime_error if a line is malformed.
+    void read (std::istream& is);
+
+    /// \returns nullptr if no line matches the system call.
+    const Cost* find (const std::string& name) const;
+
+private: /* Fields: */
+
+    std::vector<std::pair<std::string, Cost> > m_costs;
+};
+
+/*******************************************************************************
+  SyscallReport
+*******************************************************************************/
+
+/// System calls made by a run of the VirtualMachine, and their estimated costs.
+class SyscallReport {
+public: /* Types: */
+
+    struct Counters {
+        std::uint64_t calls = 0u;
+        std::uint64_t elements = 0u;
+        std::uint64_t rounds = 0u;
+        std::uint64_t bytes = 0u;
+
+        Counters& operator += (const Counters& other) {
+            calls += other.calls;
+            elements += other.elements;
+            rounds += other.rounds;
+            bytes += other.bytes;
+            return *this;
+        }
+    };
+
+    using CounterMap = std::map<std::string, Counters>;
+
+public: /* Methods: */
+
+    /**
+     * Accounts calls of a system call. The calls are accounted to all
+     * procedures and source locations on their call stack, but only once
+     * to each.
+     * \param cost estimated cost of a call, nullptr if not known
+     */
+    void addCalls (const std::string& name,
+                   const std::set<std::string>& procedures,
+                   const std::set<std::string>& locations,
+                   std::uint64_t calls,
+                   std::uint64_t elements,
+                   const SyscallCostTable::Cost* cost);
+
+    const CounterMap& syscalls () const { return m_syscalls; }
+    const CounterMap& procedures () const { return m_procedures; }
+    const CounterMap& locations () const { return m_locations; }
+    const Counters& total () const { return m_total; }
+
+    /**
+     * Writes tables of system calls, and of procedures and source locations
+     * including the calls made by the procedures they call, sorted by rounds.
+     */
+    void writeReport (std::ostream& os, std::size_t maxRows = 20u) const;
+
+private: /* Fields: */
+
+    CounterMap             m_syscalls;
+    CounterMap             m_procedures;
+    CounterMap             m_locations;
+    Counters               m_total;
+    std::set<std::string>  m_uncosted; ///< System calls without a cost.
+};
+
+} /* namespace SecreC */
+
+#endif // SECREC_VIRTUAL_MACHINE_SYSCALLS_H
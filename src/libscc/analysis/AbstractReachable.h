@@ -22,7 +22,7 @@
 
 #include "../DataflowAnalysis.h"
 #include "../Symbol.h"
-#include "BoostInsertWorkaround.h"
+#include "NumberedSet.h"
 
 #include <boost/interprocess/containers/flat_map.hpp>
 #include <boost/interprocess/containers/flat_set.hpp>
@@ -34,8 +34,71 @@ using boost::adaptors::reverse;
 
 namespace SecreC {
 
-using Reachable = boost::container::flat_set<Imop*>;
-using SymbolReachable = boost::container::flat_map<const Symbol*, Reachable>;
+using Reachable = NumberedSet<Imop>;
+
+/*******************************************************************************
+  SymbolReachable
+*******************************************************************************/
+
+/**
+ * Maps symbols to sets of instructions. New sets share the numbering of the map.
+ */
+class SymbolReachable {
+private: /* Types: */
+    using Map = boost::container::flat_map<const Symbol*, Reachable>;
+
+public: /* Types: */
+    using const_iterator = Map::const_iterator;
+    using iterator = Map::iterator;
+
+public: /* Methods: */
+
+    SymbolReachable ()
+        : m_numbering (nullptr)
+    { }
+
+    explicit SymbolReachable (ImopNumbering& numbering)
+        : m_numbering (&numbering)
+    { }
+
+    Reachable& operator [] (const Symbol* sym) {
+        auto it = m_map.find (sym);
+        if (it == m_map.end ()) {
+            it = m_map.emplace (sym, m_numbering != nullptr
+                                     ? Reachable (*m_numbering)
+                                     : Reachable ()).first;
+        }
+
+        return it->second;
+    }
+
+    const_iterator begin () const { return m_map.begin (); }
+    const_iterator end () const { return m_map.end (); }
+    const_iterator find (const Symbol* sym) const { return m_map.find (sym); }
+    size_t erase (const Symbol* sym) { return m_map.erase (sym); }
+    bool empty () const { return m_map.empty (); }
+    size_t size () const { return m_map.size (); }
+    void clear () { m_map.clear (); }
+
+    size_t memoryUsage () const {
+        size_t bytes = sizeof (*this);
+        for (const auto& it : m_map)
+            bytes += sizeof (it.first) + it.second.memoryUsage ();
+        return bytes;
+    }
+
+    friend bool operator == (const SymbolReachable& a, const SymbolReachable& b) {
+        return a.m_map == b.m_map;
+    }
+
+    friend bool operator != (const SymbolReachable& a, const SymbolReachable& b) {
+        return a.m_map != b.m_map;
+    }
+
+private: /* Fields: */
+    ImopNumbering*  m_numbering;
+    Map             m_map;
+};
 
 /*******************************************************************************
   AbstractReachable
@@ -49,6 +112,11 @@ public: /* Types: */
     using Symbols = boost::container::flat_set<const Symbol*>;
 
     struct BlockInfo {
+        BlockInfo () = default;
+        explicit BlockInfo (ImopNumbering& numbering)
+            : gen (numbering), in (numbering), out (numbering)
+        { }
+
         SymbolReachable gen;
         Symbols kill;
         SymbolReachable in;
@@ -100,7 +168,18 @@ public: /* Methods: */
         const auto it = m_blocks.find(&block);
         if (it != m_blocks.end())
             return it->second.out;
-        return SymbolReachable();
+        return SymbolReachable(m_imops);
+    }
+
+    size_t memoryUsage() const override {
+        size_t bytes = 0;
+        for (const auto& it : m_blocks) {
+            const BlockInfo& info = it.second;
+            bytes += info.gen.memoryUsage() + info.in.memoryUsage() +
+                info.out.memoryUsage() + info.kill.capacity() * sizeof(const Symbol*);
+        }
+
+        return bytes;
     }
 
     static void update(const Imop& imop, SymbolReachable& vals) {
@@ -113,18 +192,23 @@ protected:
 
     virtual void start(const Program& pr) override {
         m_blocks.clear();
-        VisitImop v;
+        m_imops.clear();
+        numberImops(pr, m_imops);
 
         FOREACH_BLOCK (bi, pr) {
-            const Block& block = *bi;
-            BlockInfo& blockInfo = m_blocks[&block];
-            CollectGenKill collector(blockInfo.gen, blockInfo.kill);
-            for (const Imop& imop : reverse(block)) {
-                v(imop, collector);
-            }
+            initBlock(*bi);
         }
     }
 
+    virtual bool startRegion(const Program&, const BlockSet& region) override {
+        for (const Block* block : region) {
+            m_blocks.erase(block);
+            initBlock(*block);
+        }
+
+        return true;
+    }
+
     virtual void startBlock(const Block& b) override {
         findBlock(b).out.clear();
     }
@@ -158,6 +242,16 @@ protected:
 
 private:
 
+    void initBlock(const Block& block) {
+        BlockInfo& blockInfo = m_blocks[&block];
+        blockInfo = BlockInfo(m_imops);
+        CollectGenKill collector(blockInfo.gen, blockInfo.kill);
+        VisitImop v;
+        for (const Imop& imop : reverse(block)) {
+            v(imop, collector);
+        }
+    }
+
     void outToLocal(const Block& from, const Block& to) {
         const SymbolReachable& in = findBlock(from).in;
         SymbolReachable& out = findBlock(to).out;
@@ -170,7 +264,7 @@ private:
 
         for (const auto& it : in) {
             if (it.first->isGlobal()) {
-                insertWorkaround(out[it.first], it.second.begin(), it.second.end());
+                out[it.first] |= it.second;
             }
         }
     }
@@ -187,13 +281,14 @@ private:
 
     void add(SymbolReachable& out, const SymbolReachable& in) {
         for (const auto& it : in) {
-            insertWorkaround(out[it.first], it.second.begin(), it.second.end());
+            out[it.first] |= it.second;
         }
     }
 
 protected: /* Fields: */
 
     BlockInfoMap m_blocks;
+    mutable ImopNumbering m_imops; ///< Extended by the sets handed out to callers
 }; // class AbstractReachable
 
 } // namespace SecreC
@@ -123,8 +123,8 @@ std::string IntValue::toString () const {
     return ss.str ();
 }
 
-SymbolConstant* IntValue::toConstant (Context&, StringTable&, const DataType* t) const  {
-    return ConstantInt::get (t, bits ());
+SymbolConstant* IntValue::toConstant (Context& cxt, StringTable&, const DataType* t) const  {
+    return ConstantInt::get (cxt, t, bits ());
 }
 
 /*******************************************************************************
@@ -178,8 +178,8 @@ std::string FloatValue::toString () const {
     return os.str ();
 }
 
-SymbolConstant* FloatValue::toConstant (Context&, StringTable&, const DataType* t) const {
-    return ConstantFloat::get (t, *this);
+SymbolConstant* FloatValue::toConstant (Context& cxt, StringTable&, const DataType* t) const {
+    return ConstantFloat::get (cxt, t, *this);
 }
 
 /*******************************************************************************
@@ -806,6 +806,11 @@ void ConstantFolding::transfer (SVM& val, const Imop& imop) const {
         for (auto dest : imop.defRange ())
             setVal (val, dest, Value::nac ());
         return;
+    case Imop::GATHER:
+    case Imop::SCATTER:
+        /* Offsets are not tracked: */
+        setVal (val, imop.dest (), Value::nac ());
+        return;
     case Imop::COMMENT:
     case Imop::END:
     case Imop::ERROR:
@@ -938,6 +943,20 @@ void ConstantFolding::start (const Program& program) {
                     addConstant (use);
 }
 
+bool ConstantFolding::startRegion (const Program&, const BlockSet& region) {
+    for (const Block* block : region) {
+        m_ins.erase (block);
+        m_outs.erase (block);
+
+        // Folding introduces new constants:
+        for (const auto& imop : *block)
+            for (const Symbol* use : imop.useRange ())
+                addConstant (use);
+    }
+
+    return true;
+}
+
 void ConstantFolding::startBlock (const Block& block) {
     m_ins[&block].clear ();
 }
@@ -1056,6 +1075,23 @@ size_t ConstantFolding::optimizeBlock (Context& cxt, StringTable& st,
     return replace.size ();
 }
 
+void ConstantFolding::visitBlock (const Block& block,
+                                  const std::function<void (const Imop&, const ValueOf&)>& f) const
+{
+    const auto it = m_ins.find (&block);
+    SVM val = it != m_ins.end () ? it->second : SVM ();
+    const ValueOf valueOf = [this, &val](const Symbol* sym) {
+        if (sym->isConstant () && m_constants.find (sym) == m_constants.end ())
+            return Value::undef ();
+        return getVal (val, sym);
+    };
+
+    for (const Imop& imop : block) {
+        f (imop, valueOf);
+        transfer (val, imop);
+    }
+}
+
 std::string ConstantFolding::toString (const Program& program) const {
     std::ostringstream os;
 
@@ -23,6 +23,7 @@
 #include "../DataflowAnalysis.h"
 
 #include <boost/interprocess/containers/flat_map.hpp>
+#include <functional>
 
 namespace SecreC {
 
@@ -95,6 +96,7 @@ class ConstantFolding final: public ForwardDataFlowAnalysis {
 public: /* Types: */
     using SVM = boost::container::flat_map<const Symbol*, Value>; // symbol to value map
     using BSVM = std::map<const Block*, SVM>; // block to symbol to value map
+    using ValueOf = std::function<Value (const Symbol*)>;
 
 public: /* Methods: */
 
@@ -104,6 +106,7 @@ public: /* Methods: */
     ~ConstantFolding () override;
 
     void start(const Program &bs) override final;
+    bool startRegion(const Program &bs, const BlockSet &region) override final;
     void startBlock(const Block &b) override final;
     void inFrom(const Block &from, Edge::Label label, const Block &to) override final;
     bool finishBlock(const Block &b) override final;
@@ -111,6 +114,13 @@ public: /* Methods: */
 
     size_t optimizeBlock(Context& cxt, StringTable& st, Block& block) const;
 
+    /**
+     * Calls the function on every instruction of the block, with the values
+     * of symbols right before the instruction.
+     */
+    void visitBlock (const Block& block,
+                     const std::function<void (const Imop&, const ValueOf&)>& f) const;
+
     std::string toString (const Program &bs) const override final;
 
 private:
@@ -91,6 +91,15 @@ void CopyPropagation::start(const Program&) {
     m_outs.clear();
 }
 
+bool CopyPropagation::startRegion(const Program&, const BlockSet& region) {
+    for (const Block* block : region) {
+        m_ins.erase(block);
+        m_outs.erase(block);
+    }
+
+    return true;
+}
+
 void CopyPropagation::startBlock(const Block& b) {
     m_ins.erase(&b);
 }
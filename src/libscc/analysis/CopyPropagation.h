@@ -55,6 +55,7 @@ public: /* Methods: */
 protected:
 
     virtual void start(const Program& pr) override;
+    virtual bool startRegion(const Program& pr, const BlockSet& region) override;
     virtual void startBlock(const Block& b) override;
     virtual void inFrom(const Block& from, Edge::Label label, const Block& to) override;
     virtual bool finishBlock(const Block& b) override;
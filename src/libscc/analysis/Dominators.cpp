@@ -207,6 +207,23 @@ void Dominators::calculate(Block * root) {
     }
 }
 
+bool Dominators::dominates(const Block * a, const Block * b) const {
+    const auto it = m_nodes.find(b);
+    if (it == m_nodes.end()) {
+        return false;
+    }
+
+    for (const DominanceNode * node = it->second; ; node = node->parent()) {
+        if (node->block() == a) {
+            return true;
+        }
+
+        if (node->parent() == nullptr || node->parent() == node) {
+            return false;
+        }
+    }
+}
+
 void Dominators::dumpToDot(std::ostream & os) {
     os << "digraph IDOM {\n";
     for (auto const & root : m_roots) {
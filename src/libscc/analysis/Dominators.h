@@ -79,6 +79,14 @@ public: /* Methods: */
 
     void dumpToDot (std::ostream& os);
 
+    /// Dominator tree of each procedure, rooted at its entry block.
+    const std::vector<std::unique_ptr<DominanceNode>>& roots () const {
+        return m_roots;
+    }
+
+    /// Whether every path from the entry of the procedure to \a b passes \a a.
+    bool dominates (const Block* a, const Block* b) const;
+
 private:
 
     DominanceNode* findNode (Block* block) {
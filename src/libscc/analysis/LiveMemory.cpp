@@ -154,10 +154,26 @@ void LiveMemory::start(const Program & pr) {
     m_ins.clear();
 
     FOREACH_BLOCK (bi, pr) {
-        CollectGenKill collector(m_gen[&*bi], m_kill[&*bi]);
-        for (const Imop & imop : reverse (*bi)) {
-            visitImop(imop, collector);
-        }
+        initBlock(*bi);
+    }
+}
+
+bool LiveMemory::startRegion(const Program &, const BlockSet & region) {
+    for (const Block * block : region) {
+        m_gen[block].clear();
+        m_kill[block].clear();
+        m_outs.erase(block);
+        m_ins.erase(block);
+        initBlock(*block);
+    }
+
+    return true;
+}
+
+void LiveMemory::initBlock(const Block & block) {
+    CollectGenKill collector(m_gen[&block], m_kill[&block]);
+    for (const Imop & imop : reverse (block)) {
+        visitImop(imop, collector);
     }
 }
 
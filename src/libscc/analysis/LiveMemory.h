@@ -68,6 +68,7 @@ public: /* Methods: */
 protected:
 
     virtual void start (const Program& pr) override;
+    virtual bool startRegion (const Program& pr, const BlockSet& region) override;
     virtual void startBlock(const Block& b) override;
     virtual void outTo(const Block &from, Edge::Label label, const Block &to) override {
         if (Edge::isGlobal (label))
@@ -81,6 +82,7 @@ protected:
 
 private:
 
+    void initBlock (const Block &block);
     void outToLocal (const Block &from, const Block &to);
     void outToGlobal (const Block &from, const Block &to);
 
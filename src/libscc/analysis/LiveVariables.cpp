@@ -18,7 +18,6 @@
  */
 
 #include "LiveVariables.h"
-#include "BoostInsertWorkaround.h"
 
 #include "../Blocks.h"
 #include "../Misc.h"
@@ -153,16 +152,6 @@ private:
     unsigned m_count;
 };
 
-inline void operator += (LiveVariables::Symbols& out, LiveVariables::Symbols& arg) {
-    insertWorkaround(out, arg.begin(), arg.end());
-}
-
-inline void operator -= (LiveVariables::Symbols& out, const LiveVariables::Symbols& arg) {
-    for (const Symbol* sym : arg) {
-        out.erase(sym);
-    }
-}
-
 } // namespace anonymous
 
 /*******************************************************************************
@@ -176,15 +165,29 @@ void LiveVariables::updateBackwards(const SecreC::Imop & imop, Symbols & live) {
 
 void LiveVariables::start(const Program & pr) {
     m_blocks.clear ();
+    m_symbols.clear ();
+    numberSymbols (pr, m_symbols);
 
     // we need to make sure to allocate all ins and outs
     FOREACH_BLOCK (bi, pr) {
-        const Block & block = *bi;
-        BlockInfo & blockInfo = m_blocks[&block];
-        CollectGenKill collector (blockInfo.gen, blockInfo.kill);
-        for (const Imop & imop : reverse (block)) {
-            visitImop(imop, collector);
-        }
+        initBlock (*bi);
+    }
+}
+
+bool LiveVariables::startRegion(const Program &, const BlockSet & region) {
+    for (const Block * block : region) {
+        initBlock (*block);
+    }
+
+    return true;
+}
+
+void LiveVariables::initBlock(const Block & block) {
+    BlockInfo & blockInfo = m_blocks[&block];
+    blockInfo = BlockInfo (m_symbols);
+    CollectGenKill collector (blockInfo.gen, blockInfo.kill);
+    for (const Imop & imop : reverse (block)) {
+        visitImop(imop, collector);
     }
 }
 
@@ -193,7 +196,7 @@ void LiveVariables::startBlock(const Block & b) {
 }
 
 void LiveVariables::outToLocal(const Block & from, const Block & to) {
-    findBlock (to).out += findBlock (from).in;
+    findBlock (to).out |= findBlock (from).in;
 }
 
 void LiveVariables::outToGlobal(const Block & from, const Block & to) {
@@ -212,10 +215,21 @@ bool LiveVariables::finishBlock(const Block & b) {
     const Symbols & out = blockInfo.out;
     in = out;
     in -= blockInfo.kill;
-    in += blockInfo.gen;
+    in |= blockInfo.gen;
     return old != in;
 }
 
+size_t LiveVariables::memoryUsage() const {
+    size_t bytes = 0;
+    for (const auto & it : m_blocks) {
+        const BlockInfo & info = it.second;
+        bytes += info.gen.memoryUsage() + info.kill.memoryUsage()
+            + info.in.memoryUsage() + info.out.memoryUsage();
+    }
+
+    return bytes;
+}
+
 void LiveVariables::finish() { }
 
 std::string LiveVariables::toString(const Program & pr) const {
@@ -21,8 +21,7 @@
 #define SECREC_LIVE_VARIABLES_H
 
 #include "../DataflowAnalysis.h"
-
-#include <boost/interprocess/containers/flat_set.hpp>
+#include "NumberedSet.h"
 
 namespace SecreC {
 
@@ -37,10 +36,15 @@ namespace SecreC {
 class LiveVariables : public BackwardDataFlowAnalysis {
 public: /* Types: */
 
-    using Symbols = boost::container::flat_set<const Symbol* >;
+    using Symbols = NumberedSet<const Symbol>;
     using BSM = std::map<const Block*, Symbols>;
 
     struct BlockInfo {
+        BlockInfo () = default;
+        explicit BlockInfo (SymbolNumbering& numbering)
+            : gen (numbering), kill (numbering), in (numbering), out (numbering)
+        { }
+
         Symbols gen;
         Symbols kill;
         Symbols in;
@@ -68,9 +72,12 @@ public: /* Methods: */
 
     static void updateBackwards (const Imop& imop, Symbols& live);
 
+    size_t memoryUsage () const override;
+
 protected:
 
     virtual void start (const Program &bs) override;
+    virtual bool startRegion (const Program &bs, const BlockSet& region) override;
     virtual void startBlock(const Block& b) override;
     virtual void outTo(const Block &from, Edge::Label label, const Block &to) override {
         if (Edge::isGlobal (label)) {
@@ -87,6 +94,7 @@ protected:
 
 private:
 
+    void initBlock (const Block &block);
     void outToLocal (const Block &from, const Block &to);
     void outToGlobal (const Block &from, const Block &to);
 
@@ -103,6 +111,7 @@ private:
 private: /* Fields: */
 
     BlockInfoMap m_blocks;
+    mutable SymbolNumbering m_symbols; ///< Extended by the sets handed out to callers
 };
 
 } // namespace SecreC
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "NaturalLoops.h"
+
+#include "Dominators.h"
+#include "../Blocks.h"
+
+#include <algorithm>
+#include <map>
+
+
+namespace SecreC {
+
+/*******************************************************************************
+  NaturalLoop
+*******************************************************************************/
+
+bool NaturalLoop::leavesProcedure (const Block* block) {
+    if (block->empty ())
+        return false;
+
+    switch (block->back ().type ()) {
+    case Imop::RETURN:
+    case Imop::ERROR:
+    case Imop::END:
+        return true;
+    default:
+        return false;
+    }
+}
+
+std::set<Block*> NaturalLoop::exitingBlocks () const {
+    std::set<Block*> out;
+    for (Block* block : m_blocks) {
+        if (leavesProcedure (block)) {
+            out.insert (block);
+            continue;
+        }
+
+        for (const Block::edge_type& edge : block->successors ()) {
+            if (Edge::isLocal (edge.second) && ! contains (edge.first)) {
+                out.insert (block);
+                break;
+            }
+        }
+    }
+
+    return out;
+}
+
+std::set<Block*> NaturalLoop::exitBlocks () const {
+    std::set<Block*> out;
+    for (Block* block : m_blocks) {
+        for (const Block::edge_type& edge : block->successors ()) {
+            if (Edge::isLocal (edge.second) && ! contains (edge.first))
+                out.insert (edge.first);
+        }
+    }
+
+    return out;
+}
+
+/*******************************************************************************
+  NaturalLoops
+*******************************************************************************/
+
+void NaturalLoops::calculate (Program* prog, const Dominators& dominators) {
+    std::map<Block*, NaturalLoop*> byHeader;
+    m_loops.clear ();
+
+    const Program& program = *prog;
+    FOREACH_BLOCK (bi, program) {
+        Block* tail = const_cast<Block*> (&*bi);
+        for (const Block::edge_type& edge : tail->successors ()) {
+            Block* header = edge.first;
+            if (! Edge::isLocal (edge.second) || ! dominators.dominates (header, tail))
+                continue;
+
+            NaturalLoop*& loop = byHeader[header];
+            if (loop == nullptr) {
+                loop = new NaturalLoop (header);
+                m_loops.emplace_back (loop);
+            }
+
+            // Collect the blocks that reach the back edge without the header:
+            std::vector<Block*> todo;
+            if (loop->m_blocks.insert (tail).second)
+                todo.push_back (tail);
+
+            while (! todo.empty ()) {
+                Block* block = todo.back ();
+                todo.pop_back ();
+                for (const Block::edge_type& pred : block->predecessors ()) {
+                    if (Edge::isLocal (pred.second) && loop->m_blocks.insert (pred.first).second)
+                        todo.push_back (pred.first);
+                }
+            }
+        }
+    }
+
+    // A loop nested in another has strictly fewer blocks:
+    std::stable_sort (m_loops.begin (), m_loops.end (),
+        [](const std::unique_ptr<NaturalLoop>& a, const std::unique_ptr<NaturalLoop>& b) {
+            return a->blocks ().size () < b->blocks ().size ();
+        });
+}
+
+} // namespace SecreC
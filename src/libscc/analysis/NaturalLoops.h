@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SECREC_ANALYSIS_NATURAL_LOOPS_H
+#define SECREC_ANALYSIS_NATURAL_LOOPS_H
+
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace SecreC {
+
+class Block;
+class Dominators;
+class Program;
+
+/*******************************************************************************
+  NaturalLoop
+*******************************************************************************/
+
+/**
+ * A natural loop: the header and the blocks that reach one of its back edges
+ * without passing through the header. Loops that share a header are merged.
+ */
+class NaturalLoop {
+    friend class NaturalLoops;
+public: /* Methods: */
+
+    explicit
+    NaturalLoop (Block* header)
+        : m_header (header)
+    {
+        m_blocks.insert (header);
+    }
+
+    Block* header () const { return m_header; }
+    const std::set<Block*>& blocks () const { return m_blocks; }
+    bool contains (const Block* block) const {
+        return m_blocks.count (const_cast<Block*> (block)) != 0;
+    }
+
+    /**
+     * Blocks of the loop with a procedure-local successor outside of it, and
+     * blocks of the loop that return, raise an error or end the program.
+     */
+    std::set<Block*> exitingBlocks () const;
+
+    /**
+     * Blocks outside of the loop with a procedure-local predecessor in it.
+     * Exits through blocks that leave the procedure have no exit block.
+     */
+    std::set<Block*> exitBlocks () const;
+
+    /// The block ends with RETURN, ERROR or END.
+    static bool leavesProcedure (const Block* block);
+
+private: /* Fields: */
+    Block* const      m_header;  ///< Dominates every block of the loop
+    std::set<Block*>  m_blocks;  ///< Blocks of the loop, header included
+}; /* class NaturalLoop { */
+
+/*******************************************************************************
+  NaturalLoops
+*******************************************************************************/
+
+class NaturalLoops {
+private: /* Types: */
+    using LoopList = std::vector<std::unique_ptr<NaturalLoop>>;
+public: /* Methods: */
+    NaturalLoops () { }
+
+    void calculate (Program* prog, const Dominators& dominators);
+
+    /// Loops ordered so that every loop precedes the loops enclosing it.
+    const LoopList& loops () const { return m_loops; }
+
+private: /* Fields: */
+    LoopList m_loops;
+}; /* class NaturalLoops { */
+
+} // namespace SecreC
+
+#endif /* SECREC_ANALYSIS_NATURAL_LOOPS_H */
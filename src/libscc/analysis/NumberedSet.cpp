@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "NumberedSet.h"
+
+#include "../Blocks.h"
+#include "../Symbol.h"
+
+
+namespace SecreC {
+
+void numberSymbols (const Program& program, SymbolNumbering& numbering) {
+    FOREACH_BLOCK (bi, program) {
+        for (const Imop& imop : *bi) {
+            for (const Symbol* sym : imop.defRange ()) {
+                if (sym->symbolType () == SYM_SYMBOL)
+                    numbering.number (sym);
+            }
+
+            for (const Symbol* sym : imop.useRange ()) {
+                if (sym->symbolType () == SYM_SYMBOL)
+                    numbering.number (sym);
+            }
+        }
+    }
+}
+
+void numberImops (const Program& program, ImopNumbering& numbering) {
+    FOREACH_BLOCK (bi, program) {
+        for (const Imop& imop : *bi) {
+            numbering.number (const_cast<Imop*> (&imop));
+        }
+    }
+}
+
+} // namespace SecreC
@@ -0,0 +1,356 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SECREC_NUMBERED_SET_H
+#define SECREC_NUMBERED_SET_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+namespace SecreC {
+
+class Imop;
+class Program;
+class Symbol;
+
+/*******************************************************************************
+  Numbering
+*******************************************************************************/
+
+/**
+ * Assigns dense numbers to objects in the order they are first seen.
+ */
+template <typename T>
+class Numbering {
+public: /* Types: */
+
+    static const unsigned npos = ~0u;
+
+public: /* Methods: */
+
+    unsigned number (T* x) {
+        const auto r = m_numbers.emplace (x, m_values.size ());
+        if (r.second)
+            m_values.push_back (x);
+        return r.first->second;
+    }
+
+    unsigned find (T* x) const {
+        const auto it = m_numbers.find (x);
+        return it != m_numbers.end () ? it->second : npos;
+    }
+
+    T* value (unsigned n) const {
+        assert (n < m_values.size ());
+        return m_values[n];
+    }
+
+    size_t size () const { return m_values.size (); }
+
+    void clear () {
+        m_numbers.clear ();
+        m_values.clear ();
+    }
+
+private: /* Fields: */
+    std::unordered_map<T*, unsigned> m_numbers;
+    std::vector<T*> m_values;
+};
+
+using SymbolNumbering = Numbering<const Symbol>;
+using ImopNumbering = Numbering<Imop>;
+
+/// Numbers the local symbols of the program in the order of their appearance.
+void numberSymbols (const Program& program, SymbolNumbering& numbering);
+
+/// Numbers the instructions of the program in the program order.
+void numberImops (const Program& program, ImopNumbering& numbering);
+
+/*******************************************************************************
+  NumberedSet
+*******************************************************************************/
+
+/**
+ * Set of numbered objects stored as a sparse bit vector: a sorted vector of
+ * 64-bit chunks of which only the non-zero ones are kept. Unions and
+ * differences are computed a chunk at a time. Elements are numbered on
+ * demand, so all sets that are combined must share the numbering. A default
+ * constructed set adopts the numbering of the first set merged into it.
+ *
+ * Copies of the sets an analysis hands out through const accessors still
+ * refer to the numbering of the analysis. Inserting an element it has not
+ * seen, such as a symbol of an instruction added after the analysis ran,
+ * extends that numbering, so analyses keep it in a mutable field.
+ */
+template <typename T>
+class NumberedSet {
+private: /* Types: */
+
+    struct Chunk {
+        unsigned index;
+        uint64_t bits;
+
+        friend bool operator == (const Chunk& a, const Chunk& b) {
+            return a.index == b.index && a.bits == b.bits;
+        }
+    };
+
+    using Chunks = std::vector<Chunk>;
+
+    static const unsigned chunkBits = 64;
+
+public: /* Types: */
+
+    using value_type = T*;
+    using size_type = size_t;
+
+    class const_iterator {
+    public: /* Types: */
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T*;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T* const*;
+        using reference = T*;
+
+    public: /* Methods: */
+
+        const_iterator (const Numbering<T>* numbering,
+                        typename Chunks::const_iterator chunk,
+                        typename Chunks::const_iterator end)
+            : m_numbering (numbering)
+            , m_chunk (chunk)
+            , m_end (end)
+            , m_bits (chunk != end ? chunk->bits : 0)
+        { }
+
+        T* operator * () const {
+            const unsigned bit = static_cast<unsigned> (__builtin_ctzll (m_bits));
+            return m_numbering->value (m_chunk->index * chunkBits + bit);
+        }
+
+        const_iterator& operator ++ () {
+            m_bits &= m_bits - 1;
+            if (m_bits == 0 && ++ m_chunk != m_end)
+                m_bits = m_chunk->bits;
+            return *this;
+        }
+
+        const_iterator operator ++ (int) {
+            const_iterator old = *this;
+            ++ *this;
+            return old;
+        }
+
+        friend bool operator == (const const_iterator& a, const const_iterator& b) {
+            return a.m_chunk == b.m_chunk && a.m_bits == b.m_bits;
+        }
+
+        friend bool operator != (const const_iterator& a, const const_iterator& b) {
+            return ! (a == b);
+        }
+
+    private: /* Fields: */
+        const Numbering<T>*               m_numbering;
+        typename Chunks::const_iterator   m_chunk;
+        typename Chunks::const_iterator   m_end;
+        uint64_t                          m_bits;
+    };
+
+    using iterator = const_iterator;
+
+public: /* Methods: */
+
+    NumberedSet ()
+        : m_numbering (nullptr)
+    { }
+
+    explicit NumberedSet (Numbering<T>& numbering)
+        : m_numbering (&numbering)
+    { }
+
+    const_iterator begin () const {
+        return const_iterator (m_numbering, m_chunks.begin (), m_chunks.end ());
+    }
+
+    const_iterator end () const {
+        return const_iterator (m_numbering, m_chunks.end (), m_chunks.end ());
+    }
+
+    bool empty () const { return m_chunks.empty (); }
+
+    size_t size () const {
+        size_t n = 0;
+        for (const Chunk& c : m_chunks)
+            n += static_cast<size_t> (__builtin_popcountll (c.bits));
+        return n;
+    }
+
+    void clear () { m_chunks.clear (); }
+
+    size_t count (T* x) const {
+        if (m_numbering == nullptr)
+            return 0;
+
+        const unsigned n = m_numbering->find (x);
+        if (n == Numbering<T>::npos)
+            return 0;
+
+        const auto it = findChunk (n / chunkBits);
+        return it != m_chunks.end () && it->index == n / chunkBits &&
+            (it->bits & mask (n)) != 0;
+    }
+
+    void insert (T* x) {
+        assert (m_numbering != nullptr);
+        const unsigned n = m_numbering->number (x);
+        auto it = findChunk (n / chunkBits);
+        if (it == m_chunks.end () || it->index != n / chunkBits)
+            it = m_chunks.insert (it, Chunk {n / chunkBits, 0});
+        it->bits |= mask (n);
+    }
+
+    void erase (T* x) {
+        if (m_numbering == nullptr)
+            return;
+
+        const unsigned n = m_numbering->find (x);
+        if (n == Numbering<T>::npos)
+            return;
+
+        auto it = findChunk (n / chunkBits);
+        if (it != m_chunks.end () && it->index == n / chunkBits) {
+            it->bits &= ~ mask (n);
+            if (it->bits == 0)
+                m_chunks.erase (it);
+        }
+    }
+
+    NumberedSet& operator |= (const NumberedSet& other) {
+        if (m_numbering == nullptr)
+            m_numbering = other.m_numbering;
+
+        assert (other.empty () || m_numbering == other.m_numbering);
+
+        // Update in place if no new chunks are needed:
+        auto it = m_chunks.begin ();
+        bool inPlace = true;
+        for (const Chunk& c : other.m_chunks) {
+            while (it != m_chunks.end () && it->index < c.index)
+                ++ it;
+            if (it == m_chunks.end () || it->index != c.index) {
+                inPlace = false;
+                break;
+            }
+        }
+
+        if (inPlace) {
+            it = m_chunks.begin ();
+            for (const Chunk& c : other.m_chunks) {
+                while (it->index < c.index)
+                    ++ it;
+                it->bits |= c.bits;
+            }
+
+            return *this;
+        }
+
+        Chunks result;
+        result.reserve (m_chunks.size () + other.m_chunks.size ());
+        auto i = m_chunks.begin ();
+        auto j = other.m_chunks.begin ();
+        while (i != m_chunks.end () && j != other.m_chunks.end ()) {
+            if (i->index < j->index) {
+                result.push_back (*i ++);
+            }
+            else if (j->index < i->index) {
+                result.push_back (*j ++);
+            }
+            else {
+                result.push_back (Chunk {i->index, i->bits | j->bits});
+                ++ i;
+                ++ j;
+            }
+        }
+
+        result.insert (result.end (), i, m_chunks.end ());
+        result.insert (result.end (), j, other.m_chunks.end ());
+        m_chunks.swap (result);
+        return *this;
+    }
+
+    NumberedSet& operator -= (const NumberedSet& other) {
+        assert (other.empty () || m_numbering == other.m_numbering);
+
+        auto j = other.m_chunks.begin ();
+        for (Chunk& c : m_chunks) {
+            while (j != other.m_chunks.end () && j->index < c.index)
+                ++ j;
+            if (j == other.m_chunks.end ())
+                break;
+            if (j->index == c.index)
+                c.bits &= ~ j->bits;
+        }
+
+        m_chunks.erase (std::remove_if (m_chunks.begin (), m_chunks.end (),
+                                        [](const Chunk& c) { return c.bits == 0; }),
+                        m_chunks.end ());
+        return *this;
+    }
+
+    friend bool operator == (const NumberedSet& a, const NumberedSet& b) {
+        return a.m_chunks == b.m_chunks;
+    }
+
+    friend bool operator != (const NumberedSet& a, const NumberedSet& b) {
+        return ! (a == b);
+    }
+
+    /// Approximate number of bytes the set occupies.
+    size_t memoryUsage () const {
+        return sizeof (*this) + m_chunks.capacity () * sizeof (Chunk);
+    }
+
+private:
+
+    static uint64_t mask (unsigned n) {
+        return uint64_t (1) << (n % chunkBits);
+    }
+
+    typename Chunks::iterator findChunk (unsigned index) {
+        return std::lower_bound (m_chunks.begin (), m_chunks.end (), index,
+            [](const Chunk& c, unsigned i) { return c.index < i; });
+    }
+
+    typename Chunks::const_iterator findChunk (unsigned index) const {
+        return std::lower_bound (m_chunks.begin (), m_chunks.end (), index,
+            [](const Chunk& c, unsigned i) { return c.index < i; });
+    }
+
+private: /* Fields: */
+    Numbering<T>*  m_numbering; ///< Owned by the analysis, extended by insert
+    Chunks         m_chunks;
+};
+
+} // namespace SecreC
+
+#endif // SECREC_NUMBERED_SET_H
@@ -59,22 +59,35 @@ void ReachableDefinitions::start(const Program& pr) {
     m_outs.clear();
 
     FOREACH_BLOCK (bi, pr) {
-        const Block& block = *bi;
-        Definitions& in = m_ins[&block];
-        m_outs[&block];
+        initBlock(*bi);
+    }
+}
 
-        boost::container::flat_map<const Symbol*, const Imop*> defs;
+bool ReachableDefinitions::startRegion(const Program&, const BlockSet& region) {
+    for (const Block* block : region) {
+        m_ins.erase(block);
+        m_outs.erase(block);
+        initBlock(*block);
+    }
 
-        for (const Imop& imop : reverse(block)) {
-            for (const Symbol* s : imop.defRange ()) {
-                defs[s] = &imop;
-            }
-        }
+    return true;
+}
 
-        for (auto& it : defs) {
-            in.insert (it.second);
+void ReachableDefinitions::initBlock(const Block& block) {
+    Definitions& in = m_ins[&block];
+    m_outs[&block];
+
+    boost::container::flat_map<const Symbol*, const Imop*> defs;
+
+    for (const Imop& imop : reverse(block)) {
+        for (const Symbol* s : imop.defRange ()) {
+            defs[s] = &imop;
         }
     }
+
+    for (auto& it : defs) {
+        in.insert (it.second);
+    }
 }
 
 void ReachableDefinitions::startBlock(const Block&) { }
@@ -40,12 +40,25 @@ void ReachableReturns::start(const Program& pr) {
     m_outs.clear();
 
     FOREACH_BLOCK (bi, pr) {
-        const Block& block = *bi;
-        Returns& in = m_ins[&block];
-        m_outs[&block];
-        for (const Imop& imop : reverse(block)) {
-            update(imop, in);
-        }
+        initBlock(*bi);
+    }
+}
+
+bool ReachableReturns::startRegion(const Program&, const BlockSet& region) {
+    for (const Block* block : region) {
+        m_ins.erase(block);
+        m_outs.erase(block);
+        initBlock(*block);
+    }
+
+    return true;
+}
+
+void ReachableReturns::initBlock(const Block& block) {
+    Returns& in = m_ins[&block];
+    m_outs[&block];
+    for (const Imop& imop : reverse(block)) {
+        update(imop, in);
     }
 }
 
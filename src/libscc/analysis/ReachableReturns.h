@@ -50,11 +50,16 @@ public: /* Methods: */
 protected:
 
     virtual void start(const Program& bs) override;
+    virtual bool startRegion(const Program& pr, const BlockSet& region) override;
     virtual void startBlock(const Block& b) override;
     virtual void outTo(const Block& from, Edge::Label label, const Block& to) override;
     virtual bool finishBlock(const Block& b) override;
     virtual void finish() override;
 
+private: /* Methods: */
+
+    void initBlock(const Block& block);
+
 private: /* Fields: */
 
     BlockMap m_outs;
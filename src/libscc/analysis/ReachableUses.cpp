@@ -35,7 +35,7 @@ std::string ReachableUses::toString(const Program& pr) const {
     ss << "Reachable uses:\n";
 
     FOREACH_BLOCK (bi, pr) {
-        SymbolReachable after;
+        SymbolReachable after (m_imops);
         auto i = m_blocks.find(&*bi);
 
         if (i != m_blocks.end()) {
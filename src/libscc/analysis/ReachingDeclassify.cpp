@@ -80,7 +80,7 @@ void ReachingDeclassify::transferImop(const Imop & imop, PDefs & out) const {
     assert(imop.type() != Imop::DECLASSIFY);
 
     if (!imop.isExpr()) {
-        if (imop.type() != Imop::STORE) {
+        if (imop.type() != Imop::STORE && imop.type() != Imop::SCATTER) {
             return;
         }
     }
@@ -126,6 +126,15 @@ void ReachingDeclassify::transferImop(const Imop & imop, PDefs & out) const {
             break;
         }
 
+    case Imop::SCATTER: {
+            Defs & s = out[imop.arg2()];
+            d.nonsensitive += s.nonsensitive;
+            d.nonsensitive += d.sensitive;
+            d.sensitive = s.sensitive;
+            d.trivial &= s.trivial;
+            break;
+        }
+
     case Imop::ALLOC:
         if (imop.nArgs () == 3 && imop.arg2()->secrecType()->secrecSecType()->isPublic()) {
     case Imop::CLASSIFY:
@@ -135,6 +144,7 @@ void ReachingDeclassify::transferImop(const Imop & imop, PDefs & out) const {
         }
         else {
     case Imop::LOAD:
+    case Imop::GATHER:
     case Imop::COPY:
     case Imop::UMINUS:
     case Imop::UNEG:
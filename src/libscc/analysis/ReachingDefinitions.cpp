@@ -35,14 +35,16 @@ namespace SecreC {
 void ReachingDefinitions::start(const Program &pr) {
     m_ins.clear();
     m_outs.clear();
+    m_imops.clear();
+    numberImops(pr, m_imops);
     makeOuts(*pr.entryBlock(), m_ins[pr.entryBlock()], m_outs[pr.entryBlock()]);
 }
 
 void ReachingDefinitions::updateSDefs(const Imop & imop, ReachingDefinitions::SDefs & defs) {
     for (const Symbol * symbol : imop.defRange()) {
-        ReachingDefinitions::Defs & d = defs[symbol];
-        d.clear();
-        d.insert(&imop);
+        Defs d (m_imops);
+        d.insert(const_cast<Imop *>(&imop));
+        defs[symbol] = std::move(d);
     }
 }
 
@@ -54,14 +56,14 @@ void ReachingDefinitions::inFrom(const Block & from, const Block & to, bool glob
             if ((s->symbolType() == SYM_SYMBOL)
                     && static_cast<const SymbolSymbol *>(s)->scopeType() == SymbolSymbol::GLOBAL)
             {
-                m_ins[&to][s] += r.second;
+                m_ins[&to][s] |= r.second;
             }
         }
     }
     else {
         for (SDefs::const_reference r : m_outs[&from]) {
             const Symbol * s = r.first;
-            m_ins[&to][s] += r.second;
+            m_ins[&to][s] |= r.second;
         }
     }
 }
@@ -76,6 +78,19 @@ bool ReachingDefinitions::makeOuts(const Block & b, const SDefs & in, SDefs & ou
     return old != out;
 }
 
+size_t ReachingDefinitions::memoryUsage() const {
+    size_t bytes = 0;
+    for (const BDM * bdm : {&m_ins, &m_outs}) {
+        for (BDM::const_reference b : *bdm) {
+            for (SDefs::const_reference sdef : b.second) {
+                bytes += sizeof (sdef.first) + sdef.second.memoryUsage();
+            }
+        }
+    }
+
+    return bytes;
+}
+
 std::string ReachingDefinitions::toString(const Program & pr) const {
     std::ostringstream os;
 
@@ -21,6 +21,7 @@
 #define SECREC_REACHING_DEFINITIONS_H
 
 #include "../DataflowAnalysis.h"
+#include "NumberedSet.h"
 
 namespace SecreC {
 
@@ -31,13 +32,13 @@ namespace SecreC {
 class ReachingDefinitions: public ForwardDataFlowAnalysis {
 public: /* Types: */
 
-    using Defs = ImopSet;
+    using Defs = NumberedSet<Imop>;
     using SDefs = std::map<const Symbol*, Defs>;
     using BDM = std::map<const Block*, SDefs>;
 
 public: /* Methods: */
 
-    static void updateSDefs (const Imop& imop, SDefs& defs);
+    void updateSDefs (const Imop& imop, SDefs& defs);
 
     inline const SDefs &getReaching(const Block &b) {
         return m_ins[&b];
@@ -45,6 +46,8 @@ public: /* Methods: */
 
     std::string toString(const Program &program) const override;
 
+    size_t memoryUsage () const override;
+
 protected:
 
     virtual void start(const Program &pr) override;
@@ -64,6 +67,7 @@ private:
 private: /* Fields: */
     BDM           m_ins;
     BDM           m_outs;
+    mutable ImopNumbering m_imops; ///< Extended by the sets handed out to callers
 }; // class ReachingDefinitions
 
 } // namespace SecreC
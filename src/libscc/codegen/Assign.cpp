@@ -22,6 +22,7 @@
 #include "../Constant.h"
 #include "../DataType.h"
 #include "../Misc.h"
+#include "../SecurityType.h"
 #include "../SymbolTable.h"
 #include "../TreeNode.h"
 #include "../TypeChecker.h"
@@ -195,6 +196,11 @@ CGResult CodeGen::cgExprAssign(TreeNodeExprAssign * e) {
         Symbol * resultOffset = m_st->appendTemporary (pubIntTy);
         bool resultScalar = r->secrecType()->isScalar();
 
+        // Plain assignment to a private slice writes the values of "r" with
+        // a single SCATTER over the offsets collected by the loop:
+        const bool useScatter = e->type() == NODE_EXPR_BINARY_ASSIGN && !resultScalar &&
+            destSym->secrecType()->secrecSecType()->isPrivate();
+
         // compute the shape and the size of the result symbol "r"
         {
             unsigned count = 0;
@@ -210,7 +216,10 @@ CGResult CodeGen::cgExprAssign(TreeNodeExprAssign * e) {
         // allocate memory for the result symbol "r"
         if (!resultScalar) {
             const DataType* dt = e->resultType()->secrecDataType();
-            if (dt->isUserPrimitive()) {
+            if (useScatter && eArg2->resultType()->isScalar()) {
+                emplaceImopAfter(result, e, Imop::ALLOC, r, r->getSizeSym(), arg2Result.symbol());
+            }
+            else if (dt->isUserPrimitive()) {
                 emplaceImopAfter(result, e, Imop::ALLOC, r, r->getSizeSym());
             }
             else {
@@ -229,6 +238,15 @@ CGResult CodeGen::cgExprAssign(TreeNodeExprAssign * e) {
         // offset = 0
         pushImopAfter (result, newAssign (e, offset, indexConstant(0)));
 
+        SymbolSymbol * offsets = nullptr;
+        if (useScatter) {
+            if (!eArg2->resultType()->isScalar()) {
+                emplaceImop(e, Imop::ASSIGN, r, arg2Result.symbol(), r->getSizeSym());
+            }
+
+            offsets = newOffsetVector(result, e, r->getSizeSym());
+        }
+
         // Declare temporaries that might require allocation for the inner assignment:
         const TypeBasic * ty = TypeBasic::get(e->resultType()->secrecSecType(),
                                         e->resultType()->secrecDataType());
@@ -264,7 +282,10 @@ CGResult CodeGen::cgExprAssign(TreeNodeExprAssign * e) {
 
         // load and store
         {
-            if (e->type() == NODE_EXPR_BINARY_ASSIGN) {
+            if (useScatter) {
+                emplaceImop(e, Imop::STORE, offsets, offset, old_offset);
+            }
+            else if (e->type() == NODE_EXPR_BINARY_ASSIGN) {
                 if (!eArg2->resultType()->isScalar()) {
                     emplaceImop(e, Imop::LOAD, t1, arg2Result.symbol(), offset);
                     emplaceImop(e, Imop::STORE, destSym, old_offset, t1);
@@ -358,6 +379,11 @@ CGResult CodeGen::cgExprAssign(TreeNodeExprAssign * e) {
             return result;
         }
 
+        if (useScatter) {
+            emplaceImopAfter(result, e, Imop::SCATTER, destSym, offsets, r, r->getSizeSym());
+            releaseTemporary(result, offsets);
+        }
+
         // Free temporaries
         releaseResource (result, t1);
         releaseResource (result, t2);
@@ -235,6 +235,17 @@ CGResult CodeGen::cgExprIndex(TreeNodeExprIndex * e) {
                                e->resultType()->secrecDataType()));
     Symbol * tmp_result2 = m_st->appendTemporary(pubIntTy);
 
+    // Private slices are loaded with a single GATHER over the offsets
+    // collected by the loop:
+    const bool useGather = !isScalar && e->resultType()->secrecSecType()->isPrivate();
+    SymbolSymbol * offsets = nullptr;
+    Symbol * resOffset = nullptr;
+    if (useGather) {
+        offsets = newOffsetVector(result, e, resSym->getSizeSym());
+        resOffset = m_st->appendTemporary(pubIntTy);
+        emplaceImop(e, Imop::ASSIGN, resOffset, indexConstant(0));
+    }
+
     // 3. initialize strides
     std::vector<ArrayStrideInfo > strides;
     strides.push_back(x);
@@ -273,6 +284,10 @@ CGResult CodeGen::cgExprIndex(TreeNodeExprIndex * e) {
         if (isScalar) {
             emplaceImop(e, Imop::LOAD, resSym, x, offset);
         }
+        else if (useGather) {
+            emplaceImop(e, Imop::STORE, offsets, resOffset, offset);
+            emplaceImop(e, Imop::ADD, resOffset, resOffset, indexConstant(1));
+        }
         else {
             emplaceImop(e, Imop::DECLARE, tmp_result);
             emplaceImop(e, Imop::LOAD, tmp_result, x, offset);
@@ -293,6 +308,12 @@ CGResult CodeGen::cgExprIndex(TreeNodeExprIndex * e) {
     }
 
     append(result, exitLoop(loopInfo));
+
+    if (useGather) {
+        emplaceImopAfter(result, e, Imop::GATHER, resSym, x, offsets, resSym->getSizeSym());
+        releaseTemporary(result, offsets);
+    }
+
     releaseTemporary(result, x);
     return result;
 }
@@ -463,6 +484,46 @@ CGResult CodeGen::cgExprCat(TreeNodeExprCat * e) {
 
     allocTemporaryResult(result);
 
+    // Private arguments are moved into the result with one SCATTER each:
+    if (e->resultType()->secrecSecType()->isPrivate()) {
+        for (unsigned side = 0; side < 2; ++ side) {
+            SymbolSymbol * arg = side == 0 ? arg1ResultSymbol : arg2ResultSymbol;
+            SymbolSymbol * offsets = newOffsetVector(result, e, arg->getSizeSym());
+            Symbol * argOffset = m_st->appendTemporary(pubIntTy);
+            emplaceImop(e, Imop::ASSIGN, argOffset, indexConstant(0));
+
+            LoopInfo argLoopInfo;
+            for (SecrecDimType it = 0; it < n; ++ it) {
+                argLoopInfo.push_index(m_st->appendTemporary(pubIntTy));
+            }
+
+            append(result, enterLoop(argLoopInfo, arg));
+            emplaceImopAfter(result, e, Imop::ASSIGN, offset, indexConstant(0));
+            for (SecrecDimType count = 0; count < n; ++ count) {
+                if (side == 1 && count == k) {
+                    emplaceImop(e, Imop::ADD, tmpInt, argLoopInfo.at(count), arg1ResultSymbol->getDim(k));
+                    emplaceImop(e, Imop::MUL, tmpInt, strides[2].at(count), tmpInt);
+                }
+                else {
+                    emplaceImop(e, Imop::MUL, tmpInt, strides[2].at(count), argLoopInfo.at(count));
+                }
+
+                emplaceImop(e, Imop::ADD, offset, offset, tmpInt);
+            }
+
+            emplaceImop(e, Imop::STORE, offsets, argOffset, offset);
+            emplaceImop(e, Imop::ADD, argOffset, argOffset, indexConstant(1));
+            append(result, exitLoop(argLoopInfo));
+
+            emplaceImopAfter(result, e, Imop::SCATTER, resSym, offsets, arg, arg->getSizeSym());
+            releaseTemporary(result, offsets);
+        }
+
+        releaseTemporary(result, arg1ResultSymbol);
+        releaseTemporary(result, arg2ResultSymbol);
+        return result;
+    }
+
     // Allocate memory for the temporary if needed:
     emplaceImopAfter(result, e, Imop::DECLARE, tmp_elem);
 
@@ -695,6 +756,23 @@ Symbol* CodeGen::toVector(CGResult & result,
     return tmp;
 }
 
+// Public vector of array offsets for GATHER and SCATTER.
+SymbolSymbol* CodeGen::newOffsetVector(CGResult & result,
+                                       TreeNodeExpr * e,
+                                       Symbol * size)
+{
+    const TypeBasic* pubIntTy = TypeBasic::getIndexType();
+    const TypeBasic* vecTy = TypeBasic::get(pubIntTy->secrecSecType(), pubIntTy->secrecDataType(), 1);
+    SymbolSymbol* tmp = m_st->appendTemporary(vecTy);
+
+    initShapeSymbols(m_st, tmp);
+    SymbolSymbol* sizeSym = tmp->getSizeSym();
+    emplaceImopAfter(result, e, Imop::ASSIGN, sizeSym, size);
+    tmp->setDim(0u, sizeSym);
+    emplaceImop(e, Imop::ALLOC, tmp, sizeSym, indexConstant(0));
+    return tmp;
+}
+
 CGResult CodeGen::cgOverloadedExpr (TreeNodeExpr* e,
                                     const Type* resTy,
                                     std::vector<Symbol*>& operands,
@@ -1341,8 +1419,8 @@ CGResult CodeGen::cgExprStringFromBytes(TreeNodeExprStringFromBytes * e) {
     emplaceImopAfter(result, e, Imop::ASSIGN, sizeSym, arrSym->getDim(0));
 
     // XXX TODO: giant hack
-    emplaceImop(e, Imop::ALLOC, resSym, sizeSym, ConstantInt::get(DATATYPE_UINT8, 0)); // allocates 1 byte more
-    emplaceImop(e, Imop::STORE, resSym, sizeSym, ConstantInt::get(DATATYPE_UINT8, 0)); // initialize last byte to zero
+    emplaceImop(e, Imop::ALLOC, resSym, sizeSym, ConstantInt::get(getContext(), DATATYPE_UINT8, 0)); // allocates 1 byte more
+    emplaceImop(e, Imop::STORE, resSym, sizeSym, ConstantInt::get(getContext(), DATATYPE_UINT8, 0)); // initialize last byte to zero
 
     /**
      * Copy the data from array to the string:
@@ -1384,7 +1462,7 @@ CGResult CodeGen::cgExprBytesFromString(TreeNodeExprBytesFromString * e) {
     Symbol * strSym = argResult.symbol();
     Symbol * charSym = m_st->appendTemporary(TypeBasic::get(DATATYPE_UINT8));
     Symbol * tempBool = m_st->appendTemporary(TypeBasic::getPublicBoolType());
-    Symbol * zeroByte = ConstantInt::get(DATATYPE_UINT8, 0);
+    Symbol * zeroByte = ConstantInt::get(getContext(), DATATYPE_UINT8, 0);
 
     /**
      * Compute length of the array:
@@ -1615,7 +1693,7 @@ CGResult CodeGen::cgExprFloat(TreeNodeExprFloat * e) {
         return CGResult::ERROR_CONTINUE;
 
     CGResult result;
-    result.setResult(ConstantFloat::get (e->resultType()->secrecDataType(),
+    result.setResult(ConstantFloat::get (getContext (), e->resultType()->secrecDataType(),
                                          e->value ()));
     return result;
 }
@@ -1926,7 +2004,7 @@ CGResult CodeGen::cgExprInt(TreeNodeExprInt * e) {
         return CGResult::ERROR_FATAL;
 
     CGResult result;
-    result.setResult(numericConstant(e->resultType()->secrecDataType(),
+    result.setResult(numericConstant(getContext(), e->resultType()->secrecDataType(),
                                      e->actualValue()));
     return result;
 }
@@ -1945,7 +2023,7 @@ CGResult CodeGen::cgExprBool(TreeNodeExprBool * e) {
         return CGResult::ERROR_CONTINUE;
 
     CGResult result;
-    result.setResult(ConstantInt::getBool (e->value()));
+    result.setResult(ConstantInt::getBool (getContext (), e->value()));
     return result;
 }
 
@@ -1996,7 +2074,7 @@ CGResult CodeGen::cgExprClassify(TreeNodeExprClassify * e) {
 
     if (argSym->isConstant ()) {
         SymbolSymbol* sizeSym = m_st->appendTemporary(TypeBasic::get (DATATYPE_UINT64));
-        Symbol* one = static_cast<Symbol*> (ConstantInt::get(DATATYPE_UINT64, 1));
+        Symbol* one = static_cast<Symbol*> (ConstantInt::get(getContext(), DATATYPE_UINT64, 1));
         pushImopAfter(result, newUnary(e, Imop::ASSIGN, sizeSym, one));
         resSym->setSizeSym (sizeSym);
     }
@@ -2201,7 +2279,7 @@ CGResult CodeGen::cgExprPrefix(TreeNodeExprPrefix * e) {
                                                 resTy->secrecDataType());
     const TypeNonVoid * elemType = TypeBasic::get(e->resultType()->secrecSecType(),
                                                   e->resultType()->secrecDataType());
-    Symbol * one = numericConstant(pubResTy, 1);
+    Symbol * one = numericConstant(getContext(), pubResTy, 1);
     Symbol* const idxOne = indexConstant (1);
     bool classifyOverloaded = false;
 
@@ -2428,7 +2506,7 @@ CGResult CodeGen::cgExprPostfix(TreeNodeExprPostfix * e) {
                                                   e->resultType()->secrecDataType());
     const DataType * pubResTy = dtypeDeclassify(resTy->secrecSecType(),
                                                 resTy->secrecDataType());
-    Symbol* one = numericConstant(pubResTy, 1);
+    Symbol* one = numericConstant(getContext(), pubResTy, 1);
     Symbol* const idxOne = indexConstant (1);
     bool classifyOverloaded = false;
     bool isOverloaded = e->isOverloaded();
@@ -127,7 +127,7 @@ CGStmtResult CodeGen::cgKind(TreeNodeKind * kind) {
             }
             dt = ty;
         } else {
-            dt = DataTypeUserPrimitive::get (tyDecl.typeName ());
+            dt = DataTypeUserPrimitive::get (getContext (), tyDecl.typeName ());
         }
         #pragma GCC diagnostic pop
 
@@ -166,7 +166,7 @@ CGStmtResult CodeGen::cgDomain(TreeNodeDomain * dom) {
 
     st->appendSymbol(new SymbolDomain(
                          idDomain->value(),
-                         PrivateSecType::get(idDomain->value(), kind),
+                         PrivateSecType::get(getContext(), idDomain->value(), kind),
                          &idDomain->location ()));
     return CGStmtResult();
 }
@@ -486,7 +486,7 @@ CGStmtResult CodeGen::cgImport(TreeNodeImport * import, ModuleInfo * modContext)
         result |= CGResult::ERROR_CONTINUE;
         break;
     case ModuleInfo::CGNotStarted:
-        if (!mod->read()) {
+        if (!mod->read(m_modules.cache())) {
             result |= CGResult::ERROR_CONTINUE;
             return result;
         }
@@ -845,6 +845,9 @@ CGStmtResult CodeGen::cgStmtSyscall(TreeNodeStmtSyscall * s) {
         case NODE_PUSH:
             operands.emplace_back(ts.second, Push);
             break;
+        case NODE_PURE:
+            operands.emplace_back(ts.second, Push, Pure);
+            break;
         case NODE_PUSHREF:
             operands.emplace_back(ts.second, PushRef);
             break;
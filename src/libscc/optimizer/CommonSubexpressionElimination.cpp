@@ -0,0 +1,568 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "../analysis/Dominators.h"
+#include "../Blocks.h"
+#include "../Constant.h"
+#include "../Intermediate.h"
+#include "../Optimizer.h"
+#include "../SecurityType.h"
+#include "../Symbol.h"
+#include "../Types.h"
+
+#include <algorithm>
+#include <boost/range/adaptor/reversed.hpp>
+#include <map>
+#include <memory>
+#include <set>
+#include <tuple>
+#include <vector>
+
+
+/**
+ * Common subexpression elimination. The dominator tree of each procedure is
+ * walked with a scoped table of the expressions computed so far. An
+ * instruction that recomputes an expression of a dominating instruction is
+ * replaced with an assignment from the earlier result, provided that no
+ * path between the two writes the operands or the result. Because the
+ * intermediate code is not in SSA form the latter is checked explicitly
+ * over the blocks that lie between the two instructions.
+ *
+ * Private temporaries are usually released right after their last use,
+ * which would make most private results unavailable. If the two
+ * instructions are connected by a straight line of code the releases of the
+ * earlier result are moved after the reuse.
+ */
+
+namespace SecreC {
+
+namespace /* anonymous */ {
+
+using Copies = std::map<const Symbol*, const Symbol*>;
+
+bool isPureExpression (Imop::Type type) {
+    switch (type) {
+    case Imop::CAST:
+    case Imop::CLASSIFY:
+    case Imop::UINV:
+    case Imop::UNEG:
+    case Imop::UMINUS:
+    case Imop::MUL:
+    case Imop::DIV:
+    case Imop::MOD:
+    case Imop::ADD:
+    case Imop::SUB:
+    case Imop::EQ:
+    case Imop::NE:
+    case Imop::LE:
+    case Imop::LT:
+    case Imop::GE:
+    case Imop::GT:
+    case Imop::LAND:
+    case Imop::LOR:
+    case Imop::BAND:
+    case Imop::BOR:
+    case Imop::XOR:
+    case Imop::SHL:
+    case Imop::SHR:
+    case Imop::LOAD:
+    case Imop::GATHER:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool isCommutative (Imop::Type type) {
+    switch (type) {
+    case Imop::MUL:
+    case Imop::ADD:
+    case Imop::EQ:
+    case Imop::NE:
+    case Imop::LAND:
+    case Imop::LOR:
+    case Imop::BAND:
+    case Imop::BOR:
+    case Imop::XOR:
+        return true;
+    default:
+        return false;
+    }
+}
+
+const Symbol* canonical (const Copies& copies, const Symbol* sym) {
+    auto it = copies.find (sym);
+    return it != copies.end () ? it->second : sym;
+}
+
+/*******************************************************************************
+  Expression
+*******************************************************************************/
+
+/**
+ * What an instruction computes: the instruction type, the type of the
+ * result (or the name of the system call) and the operands. The operands
+ * are tagged with the way they are passed to a system call.
+ */
+struct Expression {
+    Imop::Type type;
+    const void* tag;
+    std::vector<std::pair<unsigned, const Symbol*>> operands;
+
+    friend bool operator < (const Expression& a, const Expression& b) {
+        return std::tie (a.type, a.tag, a.operands) <
+               std::tie (b.type, b.tag, b.operands);
+    }
+};
+
+/**
+ * An instruction that computes an expression, the symbols it reads and
+ * the symbols holding the result, along with their sizes if they are
+ * arrays.
+ */
+struct Computation {
+    Imop* imop = nullptr;
+    std::vector<const Symbol*> reads;
+    std::vector<Symbol*> results;
+    std::vector<Symbol*> sizes;
+};
+
+bool describe (Imop& imop, const Copies& copies,
+               Expression& expr, Computation& comp)
+{
+    expr.type = imop.type ();
+    comp.imop = &imop;
+
+    if (imop.type () == Imop::SYSCALL) {
+        if (! isPureSyscall (imop))
+            return false;
+
+        expr.tag = imop.arg1 ();
+        for (const SyscallOperand& op : imop.syscallOperands ()) {
+            Symbol* sym = op.operand ();
+            const unsigned tag = 2u * op.passingConvention () + (isSyscallResult (op) ? 1u : 0u);
+            if (! isSyscallResult (op)) {
+                const Symbol* arg = canonical (copies, sym);
+                expr.operands.emplace_back (tag, arg);
+                comp.reads.push_back (arg);
+                continue;
+            }
+
+            if (sym->isString ())
+                return false;
+
+            Symbol* size = nullptr;
+            if (sym->isArray ())
+                size = static_cast<SymbolSymbol*> (sym)->getSizeSym ();
+
+            const Symbol* sizeArg = size ? canonical (copies, size) : nullptr;
+            expr.operands.emplace_back (tag, sizeArg);
+            if (sizeArg != nullptr)
+                comp.reads.push_back (sizeArg);
+
+            comp.results.push_back (sym);
+            comp.sizes.push_back (size);
+        }
+
+        return ! comp.results.empty ();
+    }
+
+    if (! isPureExpression (imop.type ()) || imop.dest ()->isString ())
+        return false;
+
+    expr.tag = imop.dest ()->secrecType ();
+    for (size_t i = 1; i < imop.nArgs (); ++ i) {
+        const Symbol* arg = canonical (copies, imop.arg (i));
+        expr.operands.emplace_back (0u, arg);
+        comp.reads.push_back (arg);
+    }
+
+    if (isCommutative (imop.type ()) && expr.operands.size () >= 2 &&
+        expr.operands[1] < expr.operands[0])
+    {
+        std::swap (expr.operands[0], expr.operands[1]);
+    }
+
+    comp.results.push_back (imop.dest ());
+    comp.sizes.push_back (imop.isVectorized () ? imop.arg (imop.nArgs () - 1) : nullptr);
+    return true;
+}
+
+/// Forget the copies that an instruction invalidates and record a new one.
+void updateCopies (const Imop& imop, Copies& copies) {
+    auto forget = [&copies](const Symbol* sym) {
+        for (auto it = copies.begin (); it != copies.end (); ) {
+            if (it->first == sym || it->second == sym)
+                it = copies.erase (it);
+            else
+                ++ it;
+        }
+    };
+
+    for (const Symbol* sym : writtenSymbols (imop))
+        forget (sym);
+    if (imop.type () == Imop::CALL) {
+        for (auto it = copies.begin (); it != copies.end (); ) {
+            if (it->first->isGlobal () || it->second->isGlobal ())
+                it = copies.erase (it);
+            else
+                ++ it;
+        }
+    }
+
+    if (imop.type () == Imop::ASSIGN) {
+        const Symbol* source = canonical (copies, imop.arg1 ());
+        if (source != imop.dest ())
+            copies[imop.dest ()] = source;
+    }
+}
+
+/*******************************************************************************
+  CommonSubexpressions
+*******************************************************************************/
+
+class CommonSubexpressions {
+private: /* Types: */
+
+    using Table = std::map<Expression, std::vector<Computation>>;
+
+    enum Kill { NoKill, ReleaseKill, WriteKill };
+
+public: /* Methods: */
+
+    CommonSubexpressions (ICode& code, ChangedBlocks& changed)
+        : m_code (code)
+        , m_changed (changed)
+        , m_exprComment (ConstantString::get (code.context (),
+              "expression removed by common subexpression elimination"))
+        , m_releaseComment (ConstantString::get (code.context (),
+              "release moved by common subexpression elimination"))
+        , m_eliminated (0u)
+    { }
+
+    unsigned eliminated () const { return m_eliminated; }
+
+    void run (const DominanceNode& root) {
+        struct Frame {
+            const DominanceNode* node;
+            size_t child;
+            size_t mark;
+        };
+
+        std::vector<Frame> todo;
+        todo.push_back ({&root, 0u, m_undo.size ()});
+        visitBlock (*root.block ());
+        while (! todo.empty ()) {
+            Frame& top = todo.back ();
+            if (top.child < top.node->children ().size ()) {
+                const DominanceNode* child = top.node->children ()[top.child ++].get ();
+                todo.push_back ({child, 0u, m_undo.size ()});
+                visitBlock (*child->block ());
+                continue;
+            }
+
+            for (size_t n = m_undo.size (); n > top.mark; -- n) {
+                Table::iterator it = m_undo.back ();
+                it->second.pop_back ();
+                if (it->second.empty ())
+                    m_table.erase (it);
+                m_undo.pop_back ();
+            }
+
+            todo.pop_back ();
+        }
+    }
+
+private:
+
+    void visitBlock (Block& block) {
+        Copies copies;
+        for (Block::iterator it = block.begin (); it != block.end (); ) {
+            Imop& imop = *it ++;
+            Expression expr;
+            Computation comp;
+            if (! describe (imop, copies, expr, comp)) {
+                updateCopies (imop, copies);
+                continue;
+            }
+
+            if (reuse (imop, expr, comp, it, copies))
+                continue;
+
+            updateCopies (imop, copies);
+
+            // The result must not overwrite an operand:
+            bool selfReferential = false;
+            for (const Symbol* result : comp.results) {
+                if (std::find (comp.reads.begin (), comp.reads.end (), result) != comp.reads.end ())
+                    selfReferential = true;
+            }
+
+            if (! selfReferential) {
+                auto entry = m_table.emplace (std::move (expr), std::vector<Computation> ()).first;
+                entry->second.push_back (std::move (comp));
+                m_undo.push_back (entry);
+            }
+        }
+    }
+
+    /**
+     * Replaces the instruction with assignments from an earlier computation
+     * of the same expression, if one is available.
+     */
+    bool reuse (Imop& imop, const Expression& expr, const Computation& comp,
+                Block::iterator next, Copies& copies)
+    {
+        auto entry = m_table.find (expr);
+        if (entry == m_table.end ())
+            return false;
+
+        std::vector<Imop*> releases;
+        const Computation* found = nullptr;
+        for (const Computation& earlier : boost::adaptors::reverse (entry->second)) {
+            releases.clear ();
+            if (isAvailable (earlier, imop, releases)) {
+                found = &earlier;
+                break;
+            }
+        }
+
+        if (found == nullptr)
+            return false;
+
+        Block& block = *imop.block ();
+        std::vector<Imop*> newImops;
+        for (size_t i = 0; i < comp.results.size (); ++ i) {
+            Symbol* size = comp.sizes[i];
+            if (comp.results[i] == found->results[i])
+                continue;
+
+            if (size != nullptr)
+                newImops.push_back (new Imop (imop.creator (), Imop::ASSIGN,
+                                              comp.results[i], found->results[i], size));
+            else
+                newImops.push_back (new Imop (imop.creator (), Imop::ASSIGN,
+                                              comp.results[i], found->results[i]));
+        }
+
+        if (newImops.empty ())
+            newImops.push_back (new Imop (imop.creator (), Imop::COMMENT, nullptr, m_exprComment));
+
+        // Extend the lifetime of the earlier result up to this point:
+        for (Imop* release : releases) {
+            newImops.push_back (new Imop (imop.creator (), Imop::RELEASE, nullptr, release->arg1 ()));
+            Imop* comment = new Imop (release->creator (), Imop::COMMENT, nullptr, m_releaseComment);
+            m_changed.insert (release->block ());
+            release->replaceWith (*comment);
+            m_garbage.emplace_back (release);
+        }
+
+        const bool isPrivate = imop.type () == Imop::SYSCALL ||
+            imop.dest ()->secrecType ()->secrecSecType ()->isPrivate ();
+        if (isPrivate)
+            ++ m_code.optimizerStats ().eliminatedPrivateOps;
+        else
+            ++ m_code.optimizerStats ().eliminatedPublicOps;
+
+        imop.replaceWith (*newImops.front ());
+        m_garbage.emplace_back (&imop);
+        for (size_t i = 1; i < newImops.size (); ++ i) {
+            block.insert (next, *newImops[i]);
+            newImops[i]->setBlock (&block);
+        }
+
+        for (const Imop* newImop : newImops)
+            updateCopies (*newImop, copies);
+
+        m_changed.insert (&block);
+        ++ m_eliminated;
+        return true;
+    }
+
+    Kill killOf (const Imop& imop, const Computation& comp) const {
+        auto isResult = [&comp](const Symbol* sym) {
+            return std::find (comp.results.begin (), comp.results.end (), sym) != comp.results.end ();
+        };
+
+        auto isRead = [&comp](const Symbol* sym) {
+            return std::find (comp.reads.begin (), comp.reads.end (), sym) != comp.reads.end ();
+        };
+
+        switch (imop.type ()) {
+        case Imop::RELEASE:
+            return isResult (imop.arg1 ()) ? ReleaseKill : NoKill;
+        case Imop::SETFPUSTATE:
+            return WriteKill;
+        case Imop::CALL:
+            for (const Symbol* sym : comp.reads) {
+                if (sym->isGlobal ())
+                    return WriteKill;
+            }
+
+            for (const Symbol* sym : comp.results) {
+                if (sym->isGlobal ())
+                    return WriteKill;
+            }
+
+            break;
+        default:
+            break;
+        }
+
+        for (const Symbol* sym : writtenSymbols (imop)) {
+            if (isResult (sym) || isRead (sym))
+                return WriteKill;
+        }
+
+        return NoKill;
+    }
+
+    /// Checks the instructions in [begin, end), collecting the releases of the result.
+    bool scan (Block::iterator begin, Block::iterator end, const Computation& comp,
+               std::vector<Imop*>& releases) const
+    {
+        for (Block::iterator it = begin; it != end; ++ it) {
+            switch (killOf (*it, comp)) {
+            case NoKill: break;
+            case ReleaseKill: releases.push_back (&*it); break;
+            case WriteKill: return false;
+            }
+        }
+
+        return true;
+    }
+
+    /// Blocks reachable from the given block without passing through the barrier.
+    template <typename Neighbours>
+    static std::set<Block*> reachable (Block* start, const Block* barrier, Neighbours neighbours) {
+        std::set<Block*> visited;
+        std::vector<Block*> todo {start};
+        while (! todo.empty ()) {
+            Block* block = todo.back ();
+            todo.pop_back ();
+            for (const Block::edge_type& edge : neighbours (*block)) {
+                if (Edge::isLocal (edge.second) && edge.first != barrier &&
+                    visited.insert (edge.first).second)
+                {
+                    todo.push_back (edge.first);
+                }
+            }
+        }
+
+        return visited;
+    }
+
+    /// The only path from the first block to the second is straight.
+    static bool isStraightLine (Block* from, const Block* to) {
+        std::set<const Block*> visited;
+        for (Block* block = from; block != to; ) {
+            Block* next = nullptr;
+            for (const Block::edge_type& edge : block->successors ()) {
+                if (! Edge::isLocal (edge.second))
+                    continue;
+                if (next != nullptr)
+                    return false;
+                next = edge.first;
+            }
+
+            if (next == nullptr || ! visited.insert (next).second)
+                return false;
+
+            unsigned preds = 0u;
+            for (const Block::edge_type& edge : next->predecessors ()) {
+                if (Edge::isLocal (edge.second))
+                    ++ preds;
+            }
+
+            if (preds != 1u)
+                return false;
+
+            block = next;
+        }
+
+        return true;
+    }
+
+    /**
+     * Checks that the result of the earlier computation is still valid at
+     * the given instruction, which it dominates. On success the releases of
+     * the result that have to be moved past the instruction are collected.
+     */
+    bool isAvailable (const Computation& earlier, Imop& imop,
+                      std::vector<Imop*>& releases) const
+    {
+        Block* from = earlier.imop->block ();
+        Block* to = imop.block ();
+        Block::iterator start = std::next (Block::s_iterator_to (*earlier.imop));
+        if (from == to)
+            return scan (start, Block::s_iterator_to (imop), earlier, releases);
+
+        if (! scan (start, from->end (), earlier, releases))
+            return false;
+
+        const auto forward = reachable (from, from,
+            [](Block& b) -> const Block::NeighbourMap& { return b.successors (); });
+        const auto backward = reachable (to, from,
+            [](Block& b) -> const Block::NeighbourMap& { return b.predecessors (); });
+
+        for (Block* block : forward) {
+            if (block == to || backward.count (block) == 0)
+                continue;
+            if (! scan (block->begin (), block->end (), earlier, releases))
+                return false;
+        }
+
+        // The block of the instruction is only passed through in a loop:
+        Block::iterator end = backward.count (to) ? to->end () : Block::s_iterator_to (imop);
+        if (! scan (to->begin (), end, earlier, releases))
+            return false;
+
+        return releases.empty () || isStraightLine (from, to);
+    }
+
+private: /* Fields: */
+    ICode&                           m_code;
+    ChangedBlocks&                   m_changed;
+    ConstantString* const            m_exprComment;
+    ConstantString* const            m_releaseComment;
+    Table                            m_table;
+    std::vector<Table::iterator>     m_undo;
+    std::vector<std::unique_ptr<Imop>> m_garbage;
+    unsigned                         m_eliminated;
+};
+
+} // namespace anonymous
+
+bool eliminateCommonSubexpressions (ICode& code, ChangedBlocks& changed) {
+    Dominators dominators;
+    dominators.calculate (&code.program ());
+
+    CommonSubexpressions cse (code, changed);
+    for (const auto& root : dominators.roots ())
+        cse.run (*root);
+
+    return cse.eliminated () > 0u;
+}
+
+bool eliminateCommonSubexpressions (ICode& code) {
+    ChangedBlocks changed;
+    return eliminateCommonSubexpressions (code, changed);
+}
+
+} // namespace SecreC
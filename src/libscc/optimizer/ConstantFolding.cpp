@@ -33,7 +33,9 @@
 
 namespace SecreC {
 
-bool eliminateConstantExpressions (const ConstantFolding& cf, ICode& code) {
+bool eliminateConstantExpressions (const ConstantFolding& cf, ICode& code,
+                                   ChangedBlocks& changed)
+{
     size_t replaced = 0;
     auto& prog = code.program ();
     auto& cxt = code.context ();
@@ -41,7 +43,11 @@ bool eliminateConstantExpressions (const ConstantFolding& cf, ICode& code) {
 
     for (auto& proc : prog) {
         for (auto& block : proc) {
-            replaced += cf.optimizeBlock (cxt, st, block);
+            const size_t n = cf.optimizeBlock (cxt, st, block);
+            if (n > 0)
+                changed.insert (&block);
+
+            replaced += n;
         }
     }
 
@@ -54,9 +60,10 @@ bool eliminateConstantExpressions (ICode& code) {
     runner.addAnalysis (cf);
 
     bool changes = false;
+    ChangedBlocks changed;
     while (true) {
         runner.run (code.program ());
-        if (! eliminateConstantExpressions (cf, code))
+        if (! eliminateConstantExpressions (cf, code, changed))
             break;
 
         changes = true;
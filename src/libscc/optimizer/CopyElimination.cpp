@@ -66,21 +66,21 @@ CopyPropagation::Copies getCopies (const Imop* i, const CopyPropagation& cp) {
 
 SymbolReachable getUses (const Imop* i, const ReachableUses& ru) {
     return getInfo<ReachableUses, SymbolReachable>
-        (i, [ru](const Block& block) { return ru.reachableOnExit (block); });
+        (i, [&ru](const Block& block) { return ru.reachableOnExit (block); });
 }
 
 ReachableDefinitions::Definitions
 getDefinitions (const Imop* i, const ReachableDefinitions& rd)
 {
     return getInfo<ReachableDefinitions, ReachableDefinitions::Definitions>
-        (i, [rd](const Block& block) { return rd.definitionsOnExit (block); });
+        (i, [&rd](const Block& block) { return rd.definitionsOnExit (block); });
 }
 
 ReachableReturns::Returns getReturns (const Imop* i,
                                       const ReachableReturns& rr)
 {
     return getInfo<ReachableReturns, ReachableReturns::Returns>
-        (i, [rr](const Block& block) { return rr.returnsOnExit (block); });
+        (i, [&rr](const Block& block) { return rr.returnsOnExit (block); });
 }
 
 } // namespace anonymous
@@ -94,7 +94,8 @@ bool eliminateRedundantCopies (const ReachableUses& ru,
                                const ReachableDefinitions& rd,
                                const ReachableReturns& rr,
                                const CopyPropagation& cp,
-                               ICode& code)
+                               ICode& code,
+                               ChangedBlocks& changed)
 {
     Program& program = code.program ();
     boost::container::flat_set<const Imop*> releases;
@@ -179,6 +180,7 @@ bool eliminateRedundantCopies (const ReachableUses& ru,
                 Symbol* arg = use->arg (i);
                 if (arg != nullptr && arg == dest) {
                     use->setArg (i, newArg);
+                    changed.insert (use->block ());
                 }
             }
         }
@@ -227,6 +229,7 @@ bool eliminateRedundantCopies (const ReachableUses& ru,
             Imop* release = new Imop (nullptr, Imop::RELEASE, nullptr, arg);
             kill->block ()->insert (blockIterator (*kill), *release);
             release->setBlock (kill->block ());
+            changed.insert (kill->block ());
         }
     }
 
@@ -236,6 +239,7 @@ bool eliminateRedundantCopies (const ReachableUses& ru,
         //copy->block ()->erase (blockIterator (*copy));
         //delete copy;
         Imop* newImop = new Imop (copy->creator (), Imop::COMMENT, nullptr, copyComment);
+        changed.insert (copy->block ());
         const_cast<Imop*> (copy)->replaceWith (*newImop);
         ++ changes;
     }
@@ -246,6 +250,7 @@ bool eliminateRedundantCopies (const ReachableUses& ru,
         if (imop->type () == Imop::RELEASE) {
             //delete imop;
             Imop* newImop = new Imop (imop->creator (), Imop::COMMENT, nullptr, releaseComment);
+            changed.insert (imop->block ());
             const_cast<Imop*> (imop)->replaceWith (*newImop);
             ++ changes;
         }
@@ -268,8 +273,10 @@ bool eliminateRedundantCopies (ICode& code) {
             .addAnalysis (copyPropagation)
             .run (program);
 
+    ChangedBlocks changed;
     return eliminateRedundantCopies (reachableUses, reachableDefinitions,
-                                     reachableReturns, copyPropagation, code);
+                                     reachableReturns, copyPropagation, code,
+                                     changed);
 }
 
 } // namespace SecreC
@@ -28,7 +28,9 @@
 
 namespace SecreC {
 
-bool eliminateDeadAllocs (const ReachableUses& ru, ICode& code) {
+bool eliminateDeadAllocs (const ReachableUses& ru, ICode& code,
+                          ChangedBlocks& changed)
+{
     std::set<Imop*> replace;
     Program& program = code.program ();
     ConstantString* relComment =
@@ -68,6 +70,7 @@ bool eliminateDeadAllocs (const ReachableUses& ru, ICode& code) {
     for (auto i : replace) {
         ConstantString* comment = i->type () == Imop::ALLOC ? allocComment : relComment;
         Imop* newImop = new Imop (i->creator (), Imop::COMMENT, nullptr, comment);
+        changed.insert (i->block ());
         i->replaceWith (*newImop);
         delete i;
     }
@@ -28,7 +28,9 @@
 
 namespace SecreC {
 
-bool eliminateDeadStores (const LiveMemory& lmem, ICode& code) {
+bool eliminateDeadStores (const LiveMemory& lmem, ICode& code,
+                          ChangedBlocks& changed)
+{
     Program& program = code.program ();
     std::vector<std::pair<std::unique_ptr<Imop>, Imop*>> replace;
 
@@ -44,6 +46,7 @@ bool eliminateDeadStores (const LiveMemory& lmem, ICode& code) {
                                           ConstantString::get (code.context (),
                                                                "eliminated dead store"));
                 replace.emplace_back (std::unique_ptr<Imop> (const_cast<Imop*> (&imop)), newImop);
+                changed.insert (&block);
             } else {
                 LiveMemory::update (imop, values);
             }
@@ -50,7 +50,9 @@ inline bool mayEliminate (const Imop& imop) {
 
 } // namespace anonymous
 
-bool eliminateDeadVariables (const LiveVariables& lva, ICode& code) {
+bool eliminateDeadVariables (const LiveVariables& lva, ICode& code,
+                             ChangedBlocks& changed)
+{
     Program& program = code.program ();
     std::vector<std::pair<std::unique_ptr<Imop>, Imop*>> replace;
 
@@ -63,6 +65,7 @@ bool eliminateDeadVariables (const LiveVariables& lva, ICode& code) {
                                           ConstantString::get (code.context (),
                                                                "dead variable eliminated"));
                 replace.emplace_back (std::unique_ptr<Imop> (const_cast<Imop*> (&imop)), newImop);
+                changed.insert (&block);
             } else {
                 LiveVariables::updateBackwards (imop, live);
             }
@@ -81,9 +84,10 @@ bool eliminateDeadVariables (ICode& code) {
     runner.addAnalysis(lva);
 
     bool changes = false;
+    ChangedBlocks changed;
     while (true) {
         runner.run (code.program ());
-        if (! eliminateDeadVariables (lva, code))
+        if (! eliminateDeadVariables (lva, code, changed))
             break;
 
         changes = true;
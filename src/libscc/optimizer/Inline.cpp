@@ -380,6 +380,8 @@ private: /* Methods: */
             case Imop::SHR:
             case Imop::STORE:
             case Imop::LOAD:
+            case Imop::GATHER:
+            case Imop::SCATTER:
             case Imop::COPY:
             case Imop::PRINT:
             case Imop::SYSCALL:
@@ -557,6 +559,7 @@ void inlineCalls (ICode& code) {
     removeUnreachableBlocks (code);
     removeEmptyProcedures (code);
     code.program ().numberInstructions ();
+    code.program ().numberBlocks ();
 }
 
 } /* namespace SecreC */
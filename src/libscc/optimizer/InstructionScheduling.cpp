@@ -0,0 +1,382 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "../Blocks.h"
+#include "../Intermediate.h"
+#include "../Optimizer.h"
+#include "../SecurityType.h"
+#include "../Symbol.h"
+#include "../Types.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <tuple>
+#include <vector>
+
+
+/**
+ * Scheduling of instructions by the depth of private operations. Every
+ * private operation costs at least one round of communication, and
+ * independent operations are only combined into one round if nothing
+ * dependent on one of them is issued in between. The instructions of a
+ * block are ordered by the number of private operations on the longest
+ * dependency chain leading to them, so that the private operations of one
+ * round are issued next to each other.
+ */
+
+namespace SecreC {
+
+namespace /* anonymous */ {
+
+bool isPrivateSymbol (const Symbol* sym) {
+    return sym != nullptr && sym->symbolType () == SYM_SYMBOL &&
+           sym->secrecType ()->secrecSecType ()->isPrivate ();
+}
+
+/// Operations that add to the depth of private computation.
+bool isPrivateOperation (const Imop& imop) {
+    switch (imop.type ()) {
+    case Imop::DECLARE:
+    case Imop::ASSIGN:
+    case Imop::CLASSIFY: // of public values needs no communication
+    case Imop::STORE:
+    case Imop::LOAD:
+    case Imop::GATHER:
+    case Imop::SCATTER:
+    case Imop::ALLOC:
+    case Imop::COPY:
+    case Imop::RELEASE:
+    case Imop::PARAM:
+    case Imop::DOMAINID:
+    case Imop::COMMENT:
+        return false;
+    default:
+        break;
+    }
+
+    if (! imop.isExpr () && imop.type () != Imop::SYSCALL)
+        return false;
+
+    return std::any_of (imop.operandsBegin (), imop.operandsEnd (), isPrivateSymbol);
+}
+
+/// System call that has no effect on the public state.
+bool isPrivateSyscall (const Imop& imop) {
+    for (const SyscallOperand& op : imop.syscallOperands ()) {
+        if (op.passingConvention () == Return)
+            return false;
+        if (op.passingConvention () == PushRef && ! isPrivateSymbol (op.operand ()))
+            return false;
+    }
+
+    return true;
+}
+
+/// Instructions that have to stay in the order they were issued in.
+bool hasSideEffects (const Imop& imop) {
+    switch (imop.type ()) {
+    case Imop::PARAM:
+    case Imop::PRINT:
+    case Imop::ERROR:
+        return true;
+    case Imop::DIV:
+    case Imop::MOD:
+        // Public division by zero terminates the program:
+        return ! isPrivateSymbol (imop.dest ());
+    case Imop::SYSCALL:
+        return ! isPrivateSyscall (imop);
+    default:
+        return false;
+    }
+}
+
+/// Instructions that no other instruction can be moved across.
+bool isBarrier (const Imop& imop) {
+    return imop.isTerminator () ||
+           imop.type () == Imop::RETCLEAN ||
+           imop.type () == Imop::SETFPUSTATE;
+}
+
+/*******************************************************************************
+  DependencyGraph
+*******************************************************************************/
+
+/**
+ * Dependencies between the instructions of a block. Comments are kept in
+ * front of the instruction following them.
+ */
+class DependencyGraph {
+public: /* Types: */
+
+    struct Node {
+        std::vector<Imop*> imops;       ///< Instruction with the comments around it.
+        Imop* instruction = nullptr;
+        std::vector<size_t> preds;
+        unsigned depth = 0u;    ///< Private operations on the longest chain ending here.
+        bool isPrivate = false;
+    };
+
+public: /* Methods: */
+
+    explicit DependencyGraph (Block& block) {
+        std::vector<Imop*> comments;
+        for (Imop& imop : block) {
+            if (imop.isComment ()) {
+                comments.push_back (&imop);
+                continue;
+            }
+
+            m_nodes.emplace_back ();
+            Node& node = m_nodes.back ();
+            node.imops.swap (comments);
+            node.imops.push_back (&imop);
+            node.instruction = &imop;
+            node.isPrivate = isPrivateOperation (imop);
+        }
+
+        if (! comments.empty ()) {
+            if (m_nodes.empty ())
+                m_nodes.emplace_back ();
+            Node& node = m_nodes.back ();
+            node.imops.insert (node.imops.end (), comments.begin (), comments.end ());
+        }
+
+        for (size_t i = 0; i < m_nodes.size (); ++ i)
+            addDependencies (i);
+    }
+
+    const std::vector<Node>& nodes () const { return m_nodes; }
+
+    unsigned depth () const {
+        unsigned out = 0u;
+        for (const Node& node : m_nodes)
+            out = std::max (out, node.depth);
+        return out;
+    }
+
+private:
+
+    static std::set<const Symbol*> reads (const Imop& imop) {
+        std::set<const Symbol*> out;
+        for (const Symbol* sym : imop.operands ()) {
+            if (sym != nullptr && ! sym->isConstant ())
+                out.insert (sym);
+        }
+
+        // System calls get the sizes of arrays implicitly:
+        if (imop.type () == Imop::SYSCALL) {
+            for (const SyscallOperand& op : imop.syscallOperands ()) {
+                if (! op.operand ()->isArray ())
+                    continue;
+                if (const Symbol* size = static_cast<SymbolSymbol*> (op.operand ())->getSizeSym ())
+                    out.insert (size);
+            }
+        }
+
+        return out;
+    }
+
+    static std::vector<const Symbol*> writes (const Imop& imop) {
+        std::vector<const Symbol*> out = writtenSymbols (imop);
+        if (imop.type () == Imop::RELEASE)
+            out.push_back (imop.arg1 ());
+        return out;
+    }
+
+    void addDependency (size_t from, size_t to) {
+        if (from != to)
+            m_nodes[to].preds.push_back (from);
+    }
+
+    void addDependencies (size_t i) {
+        Node& node = m_nodes[i];
+        if (node.instruction == nullptr) // a block with only comments
+            return;
+
+        const Imop& imop = *node.instruction;
+
+        // The first instruction may be the target of a label or a procedure:
+        if (i == 0u || isBarrier (imop)) {
+            for (size_t j = m_lastBarrier; j < i; ++ j)
+                addDependency (j, i);
+            m_lastBarrier = i;
+        }
+        else {
+            addDependency (m_lastBarrier, i);
+        }
+
+        if (hasSideEffects (imop)) {
+            if (m_lastEffect != NONE)
+                addDependency (m_lastEffect, i);
+            m_lastEffect = i;
+        }
+
+        const std::set<const Symbol*> rs = reads (imop);
+        const std::vector<const Symbol*> ws = writes (imop);
+        for (const Symbol* sym : rs) {
+            auto it = m_lastWriter.find (sym);
+            if (it != m_lastWriter.end ())
+                addDependency (it->second, i);
+        }
+
+        for (const Symbol* sym : ws) {
+            auto it = m_lastWriter.find (sym);
+            if (it != m_lastWriter.end ())
+                addDependency (it->second, i);
+
+            std::vector<size_t>& readers = m_readers[sym];
+            for (size_t reader : readers)
+                addDependency (reader, i);
+            readers.clear ();
+            m_lastWriter[sym] = i;
+        }
+
+        for (const Symbol* sym : rs) {
+            if (std::find (ws.begin (), ws.end (), sym) == ws.end ())
+                m_readers[sym].push_back (i);
+        }
+
+        for (size_t pred : node.preds)
+            node.depth = std::max (node.depth, m_nodes[pred].depth);
+        if (node.isPrivate)
+            ++ node.depth;
+    }
+
+private: /* Fields: */
+    static constexpr size_t NONE = ~ size_t (0);
+
+    std::vector<Node>                              m_nodes;
+    std::map<const Symbol*, size_t>                m_lastWriter;
+    std::map<const Symbol*, std::vector<size_t>>   m_readers;
+    size_t                                         m_lastBarrier = 0u;
+    size_t                                         m_lastEffect = NONE;
+};
+
+constexpr size_t DependencyGraph::NONE;
+
+/**
+ * List scheduling with the priority (depth, kind, original position): every
+ * instruction is issued as soon as all the private operations it depends on
+ * are. Private operations of the same depth go before the public and
+ * bookkeeping instructions of that depth, grouped by their kind. As the depth
+ * of an instruction is never less than of the ones it depends on, and
+ * only the private operations among them increase it, the order respects
+ * all the dependencies.
+ */
+bool scheduleBlock (Block& block) {
+    const DependencyGraph graph (block);
+    const auto& nodes = graph.nodes ();
+
+    std::vector<size_t> order (nodes.size ());
+    for (size_t i = 0; i < order.size (); ++ i)
+        order[i] = i;
+
+    auto key = [&nodes](size_t i) {
+        const auto& node = nodes[i];
+        return std::make_tuple (node.depth, ! node.isPrivate,
+                                node.isPrivate ? node.instruction->type () : Imop::DECLARE, i);
+    };
+
+    std::sort (order.begin (), order.end (),
+        [&key](size_t a, size_t b) { return key (a) < key (b); });
+
+    if (std::is_sorted (order.begin (), order.end ()))
+        return false;
+
+    for (size_t i : order) {
+        for (Imop* imop : nodes[i].imops) {
+            imop->unlink ();
+            block.push_back (*imop);
+        }
+    }
+
+    return true;
+}
+
+} // namespace anonymous
+
+bool scheduleInstructions (ICode& code) {
+    unsigned scheduled = 0u;
+    for (Procedure& proc : code.program ()) {
+        for (Block& block : proc) {
+            if (scheduleBlock (block))
+                ++ scheduled;
+        }
+    }
+
+    if (scheduled > 0u)
+        code.program ().numberInstructions ();
+
+    code.optimizerStats ().scheduledBlocks += scheduled;
+    return scheduled > 0u;
+}
+
+unsigned privateCriticalPath (const Procedure& proc) {
+    struct Frame {
+        const Block* block;
+        Block::neighbour_const_iterator next;
+    };
+
+    // Depth-first search over the procedure-local edges:
+    std::vector<const Block*> postorder;
+    std::set<const Block*> visited {proc.entry ()};
+    std::vector<Frame> stack {Frame {proc.entry (), proc.entry ()->succ_begin ()}};
+    while (! stack.empty ()) {
+        Frame& frame = stack.back ();
+        if (frame.next == frame.block->succ_end ()) {
+            postorder.push_back (frame.block);
+            stack.pop_back ();
+            continue;
+        }
+
+        const Block::edge_type& edge = *frame.next ++;
+        const Block* succ = edge.first;
+        if (Edge::isLocal (edge.second) && visited.insert (succ).second)
+            stack.push_back (Frame {succ, succ->succ_begin ()});
+    }
+
+    std::map<const Block*, size_t> position;
+    for (size_t i = 0; i < postorder.size (); ++ i)
+        position[postorder[i]] = i;
+
+    // Longest path in reverse postorder, back edges go to later blocks:
+    unsigned out = 0u;
+    std::map<const Block*, unsigned> pathDepth;
+    for (auto it = postorder.rbegin (); it != postorder.rend (); ++ it) {
+        const Block* block = *it;
+        const DependencyGraph graph (const_cast<Block&> (*block));
+        const unsigned depth = pathDepth[block] + graph.depth ();
+        out = std::max (out, depth);
+        for (const Block::edge_type& edge : block->successors ()) {
+            if (! Edge::isLocal (edge.second) ||
+                position[edge.first] >= position[block])
+            {
+                continue;
+            }
+
+            unsigned& succDepth = pathDepth[edge.first];
+            succDepth = std::max (succDepth, depth);
+        }
+    }
+
+    return out;
+}
+
+} // namespace SecreC
@@ -0,0 +1,442 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "../analysis/Dominators.h"
+#include "../analysis/NaturalLoops.h"
+#include "../Blocks.h"
+#include "../Intermediate.h"
+#include "../Optimizer.h"
+#include "../SecurityType.h"
+#include "../Symbol.h"
+#include "../Types.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+
+/**
+ * Loop-invariant code motion. Natural loops are processed innermost first
+ * and every pure instruction whose operands are not modified in the loop is
+ * moved to the end of the block that is the only way into the loop header.
+ * Hoisted instructions land in the enclosing loop, if any, and are
+ * considered again when that loop is processed.
+ *
+ * The intermediate code is not in SSA form, so the instruction must be the
+ * only one in the loop that writes its destination, and every use of the
+ * destination in the loop must see that write. A temporary that is
+ * declared and released on every iteration is declared once before the
+ * loop and released on every exit from it instead.
+ *
+ * Instructions that may fail, and vectorized ones whose operands are only
+ * known to be of the right size when some in-loop check has passed, are
+ * only hoisted from blocks that are executed before the loop is left. The
+ * loop is also left by returning, by a failed assertion and by the end of
+ * the program, so the checks guarding these exits stay in front of them.
+ */
+
+namespace SecreC {
+
+namespace /* anonymous */ {
+
+bool isHoistable (Imop::Type type) {
+    switch (type) {
+    case Imop::ASSIGN:
+    case Imop::CAST:
+    case Imop::CLASSIFY:
+    case Imop::UINV:
+    case Imop::UNEG:
+    case Imop::UMINUS:
+    case Imop::MUL:
+    case Imop::DIV:
+    case Imop::MOD:
+    case Imop::ADD:
+    case Imop::SUB:
+    case Imop::EQ:
+    case Imop::NE:
+    case Imop::LE:
+    case Imop::LT:
+    case Imop::GE:
+    case Imop::GT:
+    case Imop::LAND:
+    case Imop::LOR:
+    case Imop::BAND:
+    case Imop::BOR:
+    case Imop::XOR:
+    case Imop::SHL:
+    case Imop::SHR:
+    case Imop::LOAD:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool mayFail (const Imop& imop) {
+    switch (imop.type ()) {
+    case Imop::DIV:
+    case Imop::MOD:
+    case Imop::LOAD:
+        return true;
+    default:
+        return imop.isVectorized ();
+    }
+}
+
+bool isAllocation (const Imop& imop) {
+    return imop.type () == Imop::DECLARE || imop.type () == Imop::ALLOC;
+}
+
+bool references (const Imop& imop, const Symbol* sym) {
+    return std::find (imop.operandsBegin (), imop.operandsEnd (), sym) != imop.operandsEnd ();
+}
+
+bool needsRelease (const Symbol* sym) {
+    return sym->isArray () || sym->secrecType ()->secrecSecType ()->isPrivate ();
+}
+
+/*******************************************************************************
+  LoopInvariants
+*******************************************************************************/
+
+class LoopInvariants {
+private: /* Types: */
+
+    using ImopMap = std::map<const Symbol*, std::vector<Imop*>>;
+
+public: /* Methods: */
+
+    LoopInvariants (ICode& code, const Dominators& dominators,
+                    const NaturalLoop& loop, ChangedBlocks& changed)
+        : m_code (code)
+        , m_dominators (dominators)
+        , m_loop (loop)
+        , m_changed (changed)
+        , m_preheader (nullptr)
+        , m_hasCall (false)
+        , m_setsFpuState (false)
+        , m_dedicatedExits (true)
+    { }
+
+    unsigned run () {
+        m_preheader = findPreheader ();
+        if (m_preheader == nullptr)
+            return 0u;
+
+        collect ();
+        if (m_setsFpuState)
+            return 0u;
+
+        std::vector<Block*> blocks (m_loop.blocks ().begin (), m_loop.blocks ().end ());
+        std::sort (blocks.begin (), blocks.end (),
+            [](const Block* a, const Block* b) { return a->dfn () < b->dfn (); });
+
+        // Hoisting an instruction can make the ones that read its result invariant:
+        unsigned hoisted = 0u;
+        for (bool progress = true; progress; ) {
+            progress = false;
+            for (Block* block : blocks) {
+                std::vector<Imop*> candidates;
+                for (Imop& imop : *block) {
+                    if (isHoistable (imop.type ()))
+                        candidates.push_back (&imop);
+                }
+
+                for (Imop* imop : candidates) {
+                    if (tryHoist (*imop)) {
+                        ++ hoisted;
+                        progress = true;
+                    }
+                }
+            }
+        }
+
+        m_code.optimizerStats ().hoistedInstructions += hoisted;
+        return hoisted;
+    }
+
+private:
+
+    /// The block outside of the loop that only leads to the header.
+    Block* findPreheader () const {
+        Block* header = m_loop.header ();
+        Block* preheader = nullptr;
+        for (const Block::edge_type& edge : header->predecessors ()) {
+            if (! Edge::isLocal (edge.second) || m_loop.contains (edge.first))
+                continue;
+            if (preheader != nullptr)
+                return nullptr;
+            preheader = edge.first;
+        }
+
+        if (preheader == nullptr || preheader->empty ())
+            return nullptr;
+
+        for (const Block::edge_type& edge : preheader->successors ()) {
+            if (edge.first != header)
+                return nullptr;
+        }
+
+        const Imop& last = preheader->back ();
+        if (last.isTerminator () && last.type () != Imop::JUMP)
+            return nullptr;
+
+        return preheader;
+    }
+
+    void collect () {
+        for (Block* block : m_loop.blocks ()) {
+            for (Imop& imop : *block) {
+                switch (imop.type ()) {
+                case Imop::RELEASE: m_releases[imop.arg1 ()].push_back (&imop); break;
+                case Imop::CALL: m_hasCall = true; break;
+                case Imop::SETFPUSTATE: m_setsFpuState = true; break;
+                default: break;
+                }
+
+                for (const Symbol* sym : writtenSymbols (imop))
+                    m_writes[sym].push_back (&imop);
+            }
+        }
+
+        for (Block& block : *m_loop.header ()->proc ()) {
+            if (m_loop.contains (&block))
+                continue;
+            for (const Imop& imop : block)
+                m_usedOutside.insert (imop.operandsBegin (), imop.operandsEnd ());
+        }
+
+        m_exiting = m_loop.exitingBlocks ();
+        m_exits = m_loop.exitBlocks ();
+        // Temporaries can not be released on exits that leave the procedure:
+        for (const Block* exiting : m_exiting) {
+            if (NaturalLoop::leavesProcedure (exiting))
+                m_dedicatedExits = false;
+        }
+
+        // Exits that are only entered from the loop, and not by returning from a call:
+        for (const Block* exit : m_exits) {
+            for (const Block::edge_type& edge : exit->predecessors ()) {
+                if ((edge.second & Edge::CallPass) != 0 ||
+                    (Edge::isLocal (edge.second) && ! m_loop.contains (edge.first)))
+                {
+                    m_dedicatedExits = false;
+                }
+            }
+        }
+    }
+
+    /// The symbol has the same value on every iteration of the loop.
+    bool isInvariant (const Symbol* sym) const {
+        if (sym->isConstant ())
+            return true;
+
+        if (m_hasCall && sym->isGlobal ())
+            return false;
+
+        auto rel = m_releases.find (sym);
+        if (rel != m_releases.end () && ! rel->second.empty ())
+            return false;
+
+        auto it = m_writes.find (sym);
+        if (it == m_writes.end ())
+            return true;
+
+        for (const Imop* writer : it->second) {
+            if (m_hoisted.count (writer) == 0)
+                return false;
+        }
+
+        return true;
+    }
+
+    /// The declaration of the destination in the same block, if it precedes the instruction.
+    Imop* findAllocation (Imop& imop) const {
+        Block& block = *imop.block ();
+        for (Block::iterator it = Block::s_iterator_to (imop); it != block.begin (); ) {
+            Imop& prev = *(-- it);
+            if (! references (prev, imop.dest ()))
+                continue;
+
+            if (isAllocation (prev) && prev.dest () == imop.dest ())
+                return &prev;
+
+            break;
+        }
+
+        return nullptr;
+    }
+
+    bool dominatesExits (const Block* block) const {
+        for (const Block* exiting : m_exiting) {
+            if (! m_dominators.dominates (block, exiting))
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Every use of the destination in the loop sees the value written by the instruction.
+    bool reachesAllUses (const Imop& imop, const Imop* alloc) const {
+        const Symbol* dest = imop.dest ();
+        const Block* defBlock = imop.block ();
+        for (const Block* block : m_loop.blocks ()) {
+            for (const Imop& use : *block) {
+                if (&use == &imop || &use == alloc)
+                    continue;
+                if (use.type () == Imop::RELEASE || ! references (use, dest))
+                    continue;
+
+                if (block == defBlock) {
+                    if (use.index () < imop.index ())
+                        return false;
+                }
+                else if (! m_dominators.dominates (defBlock, block)) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool tryHoist (Imop& imop) {
+        Symbol* dest = imop.dest ();
+        if (dest == nullptr || dest->isGlobal () || dest->isString ())
+            return false;
+
+        for (size_t i = 1; i < imop.nArgs (); ++ i) {
+            const Symbol* arg = imop.arg (i);
+            if (arg != nullptr && (arg == dest || ! isInvariant (arg)))
+                return false;
+        }
+
+        Imop* alloc = findAllocation (imop);
+        if (alloc != nullptr) {
+            for (size_t i = 1; i < alloc->nArgs (); ++ i) {
+                const Symbol* arg = alloc->arg (i);
+                if (arg != nullptr && ! isInvariant (arg))
+                    return false;
+            }
+        }
+
+        for (const Imop* writer : m_writes[dest]) {
+            if (writer != &imop && writer != alloc)
+                return false;
+        }
+
+        if (! reachesAllUses (imop, alloc))
+            return false;
+
+        // The value is seen after the loop, or computing it may fail:
+        const bool usedOutside = m_usedOutside.count (dest) != 0;
+        if ((usedOutside || mayFail (imop)) && ! dominatesExits (imop.block ()))
+            return false;
+
+        std::vector<Imop*>& releases = m_releases[dest];
+        if (releases.empty ()) {
+            if (alloc != nullptr && needsRelease (dest))
+                return false;
+        }
+        else if (alloc == nullptr || usedOutside || ! m_dedicatedExits) {
+            return false;
+        }
+
+        if (alloc != nullptr)
+            moveToPreheader (*alloc);
+
+        moveToPreheader (imop);
+
+        // Release the temporary once, on the way out of the loop:
+        if (! releases.empty ()) {
+            for (Imop* release : releases) {
+                m_changed.insert (release->block ());
+                std::unique_ptr<Imop> garbage (release);
+                release->unlink ();
+            }
+
+            releases.clear ();
+            for (Block* exit : m_exits) {
+                Imop* release = new Imop (imop.creator (), Imop::RELEASE, nullptr, dest);
+                exit->insert (exit->begin (), *release);
+                release->setBlock (exit);
+                m_changed.insert (exit);
+            }
+        }
+
+        return true;
+    }
+
+    void moveToPreheader (Imop& imop) {
+        m_changed.insert (imop.block ());
+        m_hoisted.insert (&imop);
+        imop.unlink ();
+
+        Block::iterator pos = m_preheader->end ();
+        if (m_preheader->back ().type () == Imop::JUMP)
+            pos = Block::s_iterator_to (m_preheader->back ());
+
+        m_preheader->insert (pos, imop);
+        imop.setBlock (m_preheader);
+        m_changed.insert (m_preheader);
+    }
+
+private: /* Fields: */
+    ICode&                    m_code;
+    const Dominators&         m_dominators;
+    const NaturalLoop&        m_loop;
+    ChangedBlocks&            m_changed;
+    Block*                    m_preheader;
+    ImopMap                   m_writes;
+    ImopMap                   m_releases;
+    std::set<const Symbol*>   m_usedOutside;
+    std::set<const Imop*>     m_hoisted;
+    std::set<Block*>          m_exiting;
+    std::set<Block*>          m_exits;
+    bool                      m_hasCall;
+    bool                      m_setsFpuState;
+    bool                      m_dedicatedExits;
+};
+
+} // namespace anonymous
+
+bool hoistLoopInvariants (ICode& code, ChangedBlocks& changed) {
+    Dominators dominators;
+    dominators.calculate (&code.program ());
+
+    NaturalLoops loops;
+    loops.calculate (&code.program (), dominators);
+
+    unsigned hoisted = 0u;
+    for (const auto& loop : loops.loops ()) {
+        LoopInvariants invariants (code, dominators, *loop, changed);
+        hoisted += invariants.run ();
+    }
+
+    return hoisted > 0u;
+}
+
+bool hoistLoopInvariants (ICode& code) {
+    ChangedBlocks changed;
+    return hoistLoopInvariants (code, changed);
+}
+
+} // namespace SecreC
@@ -0,0 +1,383 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "../Blocks.h"
+#include "../Constant.h"
+#include "../DataType.h"
+#include "../Intermediate.h"
+#include "../Optimizer.h"
+#include "../SecurityType.h"
+#include "../Symbol.h"
+#include "../SymbolTable.h"
+#include "../Types.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+
+/**
+ * Batching of scalar private system calls. After inlining, private
+ * arithmetic leaves straight-line code with many system calls that compute
+ * the same element-wise operation on private scalars, each costing its own
+ * round of communication. Isomorphic calls that do not depend on each other
+ * are grouped, their private operands are stored into vectors, the
+ * operation is performed once on the vectors and the results are loaded
+ * back.
+ *
+ * A call is delayed until the last call of its group. This is only valid if
+ * no instruction in between reads what the call writes or writes what it
+ * reads. Private operands that are not read-only are considered to be both
+ * read and written by the call, and operands marked pure only written. Other
+ * operands of calls with pure operands are only read.
+ */
+
+namespace SecreC {
+
+namespace /* anonymous */ {
+
+/**
+ * System calls named KIND::OP_TYPE_vec, with the element-wise operations of
+ * the shared3p protection domain kind. On operands of one element they
+ * compute the same as on a vector of them.
+ */
+bool isElementwise (StringRef name) {
+    static const std::set<std::string> ops {
+        "add", "sub", "mul", "div", "mod", "min", "max",
+        "and", "or", "xor",
+        "eq", "ne", "lt", "lte", "gt", "gte",
+        "neg", "inv", "conv"
+    };
+
+    const std::string str = name.str ();
+    const std::string suffix = "_vec";
+    const size_t sep = str.find ("::");
+    if (sep == std::string::npos || str.size () < sep + 2 + suffix.size () ||
+        str.compare (str.size () - suffix.size (), suffix.size (), suffix) != 0)
+    {
+        return false;
+    }
+
+    const size_t begin = sep + 2;
+    const size_t end = str.find ('_', begin);
+    return ops.count (str.substr (begin, end - begin)) != 0;
+}
+
+bool isPrivate (const Symbol* sym) {
+    return sym->secrecType ()->secrecSecType ()->isPrivate ();
+}
+
+/**
+ * The private operand may be written by the system call. If some operands
+ * are marked pure, the call writes only those.
+ */
+bool isOutput (const Imop& call, const SyscallOperand& op) {
+    const SyscallOperands& ops = call.syscallOperands ();
+    if (std::any_of (ops.begin (), ops.end (), [](const SyscallOperand& o) { return o.isPure (); }))
+        return op.isPure ();
+
+    return ! op.isReadOnly ();
+}
+
+/// The private operand may be read by the system call.
+bool isInput (const SyscallOperand& op) {
+    return ! op.isPure ();
+}
+
+/**
+ * A system call that can be batched: an element-wise operation of a
+ * protection domain, with the domain identifier as the only public operand
+ * and private scalars as the rest.
+ */
+bool isBatchable (const Imop& imop) {
+    if (imop.type () != Imop::SYSCALL || imop.dest () != nullptr)
+        return false;
+
+    const auto name = static_cast<const ConstantString*> (imop.arg1 ());
+    if (! isElementwise (name->value ()))
+        return false;
+
+    const SyscallOperands& ops = imop.syscallOperands ();
+    if (ops.size () < 2 || ops.front ().passingConvention () != Push ||
+        isPrivate (ops.front ().operand ()) ||
+        ! ops.front ().operand ()->secrecType ()->isScalar ())
+    {
+        return false;
+    }
+
+    bool hasOutput = false;
+    std::set<const Symbol*> outputs;
+    for (auto it = std::next (ops.begin ()); it != ops.end (); ++ it) {
+        const Symbol* sym = it->operand ();
+        if (it->passingConvention () != Push || ! isPrivate (sym) ||
+            ! sym->secrecType ()->isScalar () ||
+            ! sym->secrecType ()->secrecDataType ()->isPrimitive ())
+        {
+            return false;
+        }
+
+        if (isOutput (imop, *it)) {
+            if (! outputs.insert (sym).second)
+                return false;
+            hasOutput = true;
+        }
+    }
+
+    return hasOutput;
+}
+
+bool references (const Imop& imop, const Symbol* sym) {
+    return std::find (imop.operandsBegin (), imop.operandsEnd (), sym) != imop.operandsEnd ();
+}
+
+/*******************************************************************************
+  SyscallBatcher
+*******************************************************************************/
+
+class SyscallBatcher {
+private: /* Types: */
+
+    using Group = std::vector<Imop*>;
+
+public: /* Methods: */
+
+    SyscallBatcher (ICode& code, ChangedBlocks& changed)
+        : m_code (code)
+        , m_changed (changed)
+        , m_batched (0u)
+    { }
+
+    unsigned batched () const { return m_batched; }
+
+    void run (Block& block) {
+        std::vector<Group> open;
+        m_domains.clear ();
+
+        for (Block::iterator it = block.begin (); it != block.end (); ) {
+            Imop& imop = *it ++;
+
+            // Calls that can not be delayed past the instruction are issued before it:
+            for (auto g = open.begin (); g != open.end (); ) {
+                if (conflicts (imop, *g)) {
+                    flush (*g);
+                    g = open.erase (g);
+                }
+                else {
+                    ++ g;
+                }
+            }
+
+            updateDomains (imop);
+            if (! isBatchable (imop))
+                continue;
+
+            auto g = std::find_if (open.begin (), open.end (),
+                [&](const Group& group) { return isomorphic (*group.front (), imop); });
+            if (g != open.end ())
+                g->push_back (&imop);
+            else
+                open.push_back (Group {&imop});
+        }
+
+        for (Group& group : open)
+            flush (group);
+    }
+
+private:
+
+    void updateDomains (const Imop& imop) {
+        for (const Symbol* sym : writtenSymbols (imop))
+            m_domains.erase (sym);
+
+        if (imop.type () == Imop::DOMAINID)
+            m_domains[imop.dest ()] = imop.arg1 ();
+    }
+
+    /// Both symbols identify the same protection domain.
+    bool sameDomain (const Symbol* a, const Symbol* b) const {
+        if (a == b)
+            return true;
+
+        auto ia = m_domains.find (a);
+        auto ib = m_domains.find (b);
+        return ia != m_domains.end () && ib != m_domains.end () &&
+               ia->second == ib->second;
+    }
+
+    bool isomorphic (const Imop& a, const Imop& b) const {
+        if (a.arg1 () != b.arg1 ())
+            return false;
+
+        const SyscallOperands& opsA = a.syscallOperands ();
+        const SyscallOperands& opsB = b.syscallOperands ();
+        if (opsA.size () != opsB.size () ||
+            ! sameDomain (opsA.front ().operand (), opsB.front ().operand ()))
+        {
+            return false;
+        }
+
+        for (size_t i = 1; i < opsA.size (); ++ i) {
+            if (opsA[i].attributeSet () != opsB[i].attributeSet () ||
+                opsA[i].operand ()->secrecType () != opsB[i].operand ()->secrecType ())
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /// The system call can not be moved past the instruction.
+    static bool conflicts (const Imop& imop, const Imop& call) {
+        for (const Symbol* sym : writtenSymbols (imop)) {
+            if (references (call, sym))
+                return true;
+        }
+
+        if (imop.type () == Imop::RELEASE && references (call, imop.arg1 ()))
+            return true;
+
+        for (const SyscallOperand& op : call.syscallOperands ()) {
+            if (isPrivate (op.operand ()) && isOutput (call, op) && references (imop, op.operand ()))
+                return true;
+            if (imop.type () == Imop::CALL && op.operand ()->isGlobal ())
+                return true;
+        }
+
+        return false;
+    }
+
+    static bool conflicts (const Imop& imop, const Group& group) {
+        for (const Imop* call : group) {
+            if (conflicts (imop, *call))
+                return true;
+        }
+
+        return false;
+    }
+
+    /// Replaces the calls of the group with a single call on vectors.
+    void flush (Group& group) {
+        const size_t count = group.size ();
+        if (count < 2)
+            return;
+
+        Context& cxt = m_code.context ();
+        SymbolTable& symbols = m_code.symbols ();
+        Imop& last = *group.back ();
+        Block& block = *last.block ();
+        const Block::iterator pos = blockIterator (last);
+        auto emit = [&](Imop* imop) {
+            block.insert (pos, *imop);
+            imop->setBlock (&block);
+        };
+
+        TreeNode* creator = last.creator ();
+        SymbolSymbol* size = symbols.appendTemporary (TypeBasic::getIndexType ());
+        emit (new Imop (creator, Imop::DECLARE, size));
+        emit (new Imop (creator, Imop::ASSIGN, size,
+                        ConstantInt::get (cxt, DATATYPE_UINT64, count)));
+
+        const SyscallOperands& ops = last.syscallOperands ();
+        SyscallOperands operands;
+        std::vector<std::pair<size_t, SymbolSymbol*>> vectors;
+        operands.emplace_back (ops.front ().operand (), Push, ops.front ().attributeSet ());
+        for (size_t i = 1; i < ops.size (); ++ i) {
+            const TypeNonVoid* ty = ops[i].operand ()->secrecType ();
+            SymbolSymbol* vec = symbols.appendTemporary (
+                TypeBasic::get (ty->secrecSecType (), ty->secrecDataType (), 1));
+            vec->setDim (0, size);
+            vec->setSizeSym (size);
+
+            const DataType* dataType = ty->secrecDataType ();
+            if (dataType->isUserPrimitive ())
+                dataType = dtypeDeclassify (ty->secrecSecType (), dataType);
+
+            if (dataType != nullptr)
+                emit (new Imop (creator, Imop::ALLOC, vec, size, defaultConstant (cxt, dataType)));
+            else
+                emit (new Imop (creator, Imop::ALLOC, vec, size));
+
+            if (isInput (ops[i])) {
+                for (size_t j = 0; j < count; ++ j) {
+                    Symbol* elem = group[j]->syscallOperands ()[i].operand ();
+                    emit (new Imop (creator, Imop::STORE, vec,
+                                    ConstantInt::get (cxt, DATATYPE_UINT64, j), elem));
+                }
+            }
+
+            operands.emplace_back (vec, Push, ops[i].attributeSet ());
+            vectors.emplace_back (i, vec);
+        }
+
+        emit (new Imop (creator, static_cast<ConstantString*> (last.arg1 ()), std::move (operands)));
+
+        for (const auto& v : vectors) {
+            if (! isOutput (last, ops[v.first]))
+                continue;
+
+            for (size_t j = 0; j < count; ++ j) {
+                Symbol* elem = group[j]->syscallOperands ()[v.first].operand ();
+                emit (new Imop (creator, Imop::LOAD, elem, v.second,
+                                ConstantInt::get (cxt, DATATYPE_UINT64, j)));
+            }
+        }
+
+        for (const auto& v : vectors)
+            emit (new Imop (creator, Imop::RELEASE, nullptr, v.second));
+
+        for (Imop* call : group) {
+            m_changed.insert (call->block ());
+            std::unique_ptr<Imop> garbage (call);
+            call->unlink ();
+        }
+
+        m_code.optimizerStats ().batchedSyscalls += count;
+        ++ m_code.optimizerStats ().vectorSyscalls;
+        m_batched += count;
+    }
+
+private: /* Fields: */
+    ICode&                                  m_code;
+    ChangedBlocks&                          m_changed;
+    std::map<const Symbol*, const Symbol*>  m_domains; ///< Results of DOMAINID in the block.
+    unsigned                                m_batched;
+};
+
+} // namespace anonymous
+
+bool batchSyscalls (ICode& code, ChangedBlocks& changed) {
+    SyscallBatcher batcher (code, changed);
+    for (Procedure& proc : code.program ()) {
+        for (Block& block : proc)
+            batcher.run (block);
+    }
+
+    return batcher.batched () > 0u;
+}
+
+bool batchSyscalls (ICode& code) {
+    ChangedBlocks changed;
+    return batchSyscalls (code, changed);
+}
+
+} // namespace SecreC
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "../Imop.h"
+#include "../Optimizer.h"
+
+
+/**
+ * Helpers shared by the optimization passes.
+ */
+
+namespace SecreC {
+
+bool isPureSyscall (const Imop& imop) {
+    bool isPure = false;
+    for (const SyscallOperand& op : imop.syscallOperands ()) {
+        if (op.passingConvention () == PushRef)
+            return false;
+
+        isPure = isPure || op.isPure ();
+    }
+
+    return isPure;
+}
+
+bool isSyscallResult (const SyscallOperand& op) {
+    return op.passingConvention () == Return || op.isPure ();
+}
+
+std::vector<const Symbol*> writtenSymbols (const Imop& imop) {
+    std::vector<const Symbol*> out;
+    switch (imop.type ()) {
+    case Imop::SYSCALL: {
+        const bool isPure = isPureSyscall (imop);
+        for (const SyscallOperand& op : imop.syscallOperands ()) {
+            if (isPure ? isSyscallResult (op) : ! op.isReadOnly ())
+                out.push_back (op.operand ());
+        }
+        break;
+    }
+    case Imop::CALL:
+        for (const Symbol* sym : imop.defRange ())
+            out.push_back (sym);
+        break;
+    case Imop::STORE:
+    case Imop::SCATTER:
+        out.push_back (imop.dest ());
+        break;
+    default:
+        if (imop.isExpr () && imop.dest () != nullptr)
+            out.push_back (imop.dest ());
+        break;
+    }
+
+    return out;
+}
+
+} // namespace SecreC
@@ -88,7 +88,7 @@
 %token INT32 INT64 INT8 KIND MODULE OPERATOR PRINT PUBLIC REF RESHAPE RETURN
 %token SHAPE SIZE STRING STRINGFROMBYTES SYSCALL TEMPLATE TOSTRING TRUE_B UINT UINT16
 %token UINT32 UINT64 UINT8 WHILE VOID SYSCALL_RETURN TYPE STRUCT STRLEN READONLY
-%token GET_FPU_STATE SET_FPU_STATE
+%token GET_FPU_STATE SET_FPU_STATE PURE
 
  /* Identifiers: */
 %token <str> IDENTIFIER
@@ -1040,6 +1040,11 @@ syscall_parameter
       $$ = treenode_init(NODE_READONLY, &@$);
       treenode_appendChild($$, $2);
     }
+  | PURE assignment_expression
+    {
+      $$ = treenode_init(NODE_PURE, &@$);
+      treenode_appendChild($$, $2);
+    }
   | SYSCALL_RETURN identifier
     {
       const struct YYLTYPE loc = treenode_location ($2);
@@ -1666,8 +1671,11 @@ void yyerror(YYLTYPE *loc, yyscan_t yyscanner, TYPE_TREENODE *parseTree,
 int sccparse(TYPE_STRINGTABLE table, const char * filename, TYPE_TREENODEMODULE *result) {
     assert(filename);
     yyscan_t scanner;
+    struct SecrecScannerState state;
     int r;
-    yylex_init_extra(table, &scanner);
+    state.table = table;
+    state.strbuflen = 0;
+    yylex_init_extra(&state, &scanner);
     r = yyparse(scanner, result, filename, table);
     yylex_destroy(scanner);
     return r;
@@ -1676,8 +1684,11 @@ int sccparse(TYPE_STRINGTABLE table, const char * filename, TYPE_TREENODEMODULE
 int sccparse_file(TYPE_STRINGTABLE table, const char * filename, FILE *input, TYPE_TREENODEMODULE *result) {
     assert(filename);
     yyscan_t scanner;
+    struct SecrecScannerState state;
     int r;
-    yylex_init_extra(table, &scanner);
+    state.table = table;
+    state.strbuflen = 0;
+    yylex_init_extra(&state, &scanner);
     yyset_in(input, scanner);
     r = yyparse(scanner, result, filename, table);
     yylex_destroy(scanner);
@@ -1688,6 +1699,7 @@ int sccparse_mem(TYPE_STRINGTABLE table, const char * filename, const void *buf,
     assert(filename);
     FILE *memoryFile;
     yyscan_t scanner;
+    struct SecrecScannerState state;
     int r;
 #ifdef _GNU_SOURCE
     memoryFile = fmemopen((void*) buf, size, "r");
@@ -1702,7 +1714,9 @@ int sccparse_mem(TYPE_STRINGTABLE table, const char * filename, const void *buf,
     rewind(memoryFile);
 #endif
 
-    yylex_init_extra(table, &scanner);
+    state.table = table;
+    state.strbuflen = 0;
+    yylex_init_extra(&state, &scanner);
     yyset_in(memoryFile, scanner);
     r = yyparse(scanner, result, filename, table);
     yylex_destroy(scanner);
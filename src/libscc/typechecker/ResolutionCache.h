@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SECREC_RESOLUTION_CACHE_H
+#define SECREC_RESOLUTION_CACHE_H
+
+#include "../ParserEnums.h"
+#include "../StringRef.h"
+#include "../TypeChecker.h"
+#include "../TypeContext.h"
+
+#include <boost/functional/hash.hpp>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * This file contains the cache of overload resolution results that lets the
+ * type checker skip template unification at call sites that have already
+ * been resolved with the same argument types.
+ */
+
+namespace SecreC {
+
+class DataType;
+class SecurityType;
+class SymbolProcedure;
+class SymbolTable;
+class TypeProc;
+
+/*******************************************************************************
+  ResolutionCacheKey
+*******************************************************************************/
+
+struct ResolutionCacheKey {
+    enum Kind { PROCEDURE, OPERATOR, CAST };
+
+    ResolutionCacheKey (Kind kind_,
+                        StringRef name_,
+                        const SymbolTable* scope_,
+                        const TypeProc* argTypes_,
+                        const TypeContext& tyCxt)
+        : kind (kind_)
+        , name (name_.str ())
+        , scope (scope_)
+        , argTypes (argTypes_)
+        , secType (tyCxt.contextSecType ())
+        , dataType (tyCxt.contextDataType ())
+        , dimType (tyCxt.contextDimType ())
+    { }
+
+    inline friend bool operator == (const ResolutionCacheKey& k1,
+                                    const ResolutionCacheKey& k2)
+    {
+        return k1.kind == k2.kind &&
+            k1.scope == k2.scope &&
+            k1.argTypes == k2.argTypes &&
+            k1.secType == k2.secType &&
+            k1.dataType == k2.dataType &&
+            k1.dimType == k2.dimType &&
+            k1.name == k2.name;
+    }
+
+    inline friend size_t hash_value (const ResolutionCacheKey& key) {
+        size_t seed = 0;
+        boost::hash_combine (seed, key.kind);
+        boost::hash_combine (seed, key.name);
+        boost::hash_combine (seed, key.scope);
+        boost::hash_combine (seed, key.argTypes);
+        boost::hash_combine (seed, key.secType);
+        boost::hash_combine (seed, key.dataType);
+        boost::hash_combine (seed, key.dimType);
+        return seed;
+    }
+
+    Kind const kind;
+    std::string const name;
+    const SymbolTable* const scope; ///< \see SymbolTable::declarationScope
+    const TypeProc* const argTypes;
+    const SecurityType* const secType;
+    const DataType* const dataType;
+    SecrecDimType const dimType;
+};
+
+/*******************************************************************************
+  ResolutionCacheEntry
+*******************************************************************************/
+
+/**
+ * Either the selected procedure (nullptr if nothing matched) or the message
+ * describing the ambiguous candidates.
+ */
+struct ResolutionCacheEntry {
+    SymbolProcedure* proc;
+    std::string ambiguity;
+};
+
+/**
+ * Generations of the symbol and operator tables for the name of a key, taken
+ * before it was resolved. \see SymbolTable::generation
+ */
+struct ResolutionGeneration {
+    unsigned st;
+    unsigned ops;
+
+    inline friend bool operator == (const ResolutionGeneration& g1,
+                                    const ResolutionGeneration& g2)
+    {
+        return g1.st == g2.st && g1.ops == g2.ops;
+    }
+};
+
+/*******************************************************************************
+  ResolutionCache
+*******************************************************************************/
+
+class ResolutionCache {
+public: /* Methods: */
+
+    ResolutionCache () = default;
+    ResolutionCache (const ResolutionCache&) = delete;
+    ResolutionCache& operator = (const ResolutionCache&) = delete;
+
+    /**
+     * \brief Looks up an earlier resolution.
+     * \param generation current generation of the tables for the name of the key
+     * \returns nullptr if the resolution is not cached, or if declarations
+     * of the name have been added since it was cached.
+     */
+    const ResolutionCacheEntry* find (const ResolutionCacheKey& key,
+                                      const ResolutionGeneration& generation)
+    {
+        auto it = m_entries.find (key);
+        if (it == m_entries.end ()) {
+            ++ m_stats.misses;
+            return nullptr;
+        }
+
+        if (! (it->second.first == generation)) {
+            ++ m_stats.misses;
+            ++ m_stats.stale;
+            return nullptr;
+        }
+
+        ++ m_stats.hits;
+        return &it->second.second;
+    }
+
+    /// Replaces the stale entry of the key, if there is one.
+    void insert (ResolutionCacheKey key, const ResolutionGeneration& generation,
+                 ResolutionCacheEntry entry)
+    {
+        auto value = std::make_pair (generation, std::move (entry));
+        auto it = m_entries.find (key);
+        if (it != m_entries.end ())
+            it->second = std::move (value);
+        else
+            m_entries.emplace (std::move (key), std::move (value));
+    }
+
+    const TypeChecker::ResolutionStats& stats () const { return m_stats; }
+
+private: /* Fields: */
+
+    std::unordered_map<ResolutionCacheKey,
+                       std::pair<ResolutionGeneration, ResolutionCacheEntry>,
+                       boost::hash<ResolutionCacheKey> > m_entries;
+    TypeChecker::ResolutionStats m_stats;
+};
+
+} // namespace SecreC
+
+#endif // SECREC_RESOLUTION_CACHE_H
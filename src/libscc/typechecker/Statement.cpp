@@ -256,7 +256,8 @@ TypeChecker::Status TypeChecker::visitStmtSyscall(TreeNodeStmtSyscall * stmt) {
 
     for (TreeNodeSyscallParam& param : stmt->params ()) {
         TreeNodeExpr* e = param.expression ();
-        if (param.type () != NODE_PUSH) {
+        const bool isPush = param.type () == NODE_PUSH || param.type () == NODE_PURE;
+        if (! isPush) {
             e->setContextSecType (PublicSecType::get ());
         }
 
@@ -273,7 +274,7 @@ TypeChecker::Status TypeChecker::visitStmtSyscall(TreeNodeStmtSyscall * stmt) {
             }
         }
 
-        if (param.type () != NODE_PUSH) {
+        if (! isPush) {
             if (e->resultType ()->secrecSecType ()->isPrivate ()) {
                 m_log.fatalInProc(stmt) << "Passing reference to a private value at "
                                         << param.location () << '.';
@@ -281,6 +282,16 @@ TypeChecker::Status TypeChecker::visitStmtSyscall(TreeNodeStmtSyscall * stmt) {
             }
         }
 
+        // The result of a pure syscall is written through a private handle:
+        if (param.type () == NODE_PURE) {
+            if (! e->resultType ()->secrecSecType ()->isPrivate ()) {
+                m_log.fatalInProc(stmt) << "Passing public value as the result of a pure syscall at "
+                                        << param.location () << ". "
+                                        << "Try via __return instead.";
+                return E_TYPE;
+            }
+        }
+
         if (param.type () == NODE_SYSCALL_RETURN) {
             if (hasReturn) {
                 m_log.fatalInProc (stmt) << "Multiple return values specified for syscall at "
@@ -131,7 +131,7 @@ TypeChecker::Status TypeChecker::checkStruct (TreeNodeStructDecl* decl,
     }
 
     TreeNodeIdentifier* id = decl->identifier ();
-    result = DataTypeStruct::get (id->value (), fields, args);
+    result = DataTypeStruct::get (getContext (), id->value (), fields, args);
     return OK;
 }
 
@@ -126,13 +126,15 @@ TypeChecker::Status TypeChecker::visitTemplate(TreeNodeTemplate * templ) {
     SymbolTemplate* s;
     if (body->isOperator () || body->isCast ()) {
         s = new SymbolOperatorTemplate (templ, expectsDataType);
+        s->setName (id->value ());
         m_operators->appendOperator (s);
     } else {
+        // The name has to be known before the symbol is indexed:
         s = new SymbolProcedureTemplate (templ, expectsSecType, expectsDataType, expectsDimType);
+        s->setName (id->value ());
         m_st->appendSymbol (s);
     }
 
-    s->setName (id->value ());
     return OK;
 }
 
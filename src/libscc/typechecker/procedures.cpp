@@ -28,6 +28,7 @@
 #include "../Symbol.h"
 #include "../SymbolTable.h"
 #include "../TreeNode.h"
+#include "../typechecker/ResolutionCache.h"
 #include "../typechecker/Templates.h"
 #include "../TypeChecker.h"
 #include "../TypeUnifier.h"
@@ -623,7 +624,7 @@ TypeChecker::Status TypeChecker::findRegularProc(SymbolProcedure *& symProc,
                                                  StringRef name,
                                                  const TypeContext & tyCxt,
                                                  const TypeProc * argTypes,
-                                                 const TreeNode * errorCxt)
+                                                 std::string & ambiguity)
 {
     assert (argTypes != nullptr);
     symProc = nullptr;
@@ -646,8 +647,7 @@ TypeChecker::Status TypeChecker::findRegularProc(SymbolProcedure *& symProc,
 
         if (symProc != nullptr) {
             symProc = nullptr;
-            m_log.fatalInProc(errorCxt) << "Multiple matching procedures at "
-                                        << errorCxt->location() << '.';
+            ambiguity = "Multiple matching procedures ";
             return E_TYPE;
         }
 
@@ -665,9 +665,28 @@ TypeChecker::Status TypeChecker::findBestMatchingProc(SymbolProcedure *& symProc
 {
     assert(errorCxt);
 
+    ResolutionCacheKey key (ResolutionCacheKey::PROCEDURE, name,
+                            m_st->declarationScope (), argTypes, tyCxt);
+    const ResolutionGeneration generation = resolutionGeneration (key);
+    if (const ResolutionCacheEntry* entry = findResolution (key, generation))
+        return reuseResolution (*entry, symProc, errorCxt);
+
+    std::string ambiguity;
+    const Status status = resolveProc (symProc, name, tyCxt, argTypes, ambiguity);
+    return storeResolution (std::move (key), generation, status, symProc, ambiguity, errorCxt);
+}
+
+TypeChecker::Status TypeChecker::resolveProc(SymbolProcedure *& symProc,
+                                             StringRef name,
+                                             const TypeContext & tyCxt,
+                                             const TypeProc* argTypes,
+                                             std::string & ambiguity)
+{
+    symProc = nullptr;
+
     // Look for regular procedures:
     SymbolProcedure* procTempSymbol = nullptr;
-    TCGUARD (findRegularProc (procTempSymbol, name, tyCxt, argTypes, errorCxt));
+    TCGUARD (findRegularProc (procTempSymbol, name, tyCxt, argTypes, ambiguity));
     if (procTempSymbol != nullptr) {
         symProc = procTempSymbol;
         return OK;
@@ -701,8 +720,7 @@ TypeChecker::Status TypeChecker::findBestMatchingProc(SymbolProcedure *& symProc
             os << i.getTemplate ()->decl ()->location () << ' ';
         }
 
-        m_log.fatalInProc(errorCxt) << os.str() << "at "
-                                    << errorCxt->location() << '.';
+        ambiguity = os.str ();
         return E_TYPE;
     }
 
@@ -726,7 +744,7 @@ bool latticeLeqOp(const TypeNonVoid* a, const TypeNonVoid* b) {
 TypeChecker::Status TypeChecker::findRegularOpDef(SymbolProcedure *& symProc,
                                                   StringRef name,
                                                   const TypeProc * callTypeProc,
-                                                  const TreeNode * errorCxt)
+                                                  std::string & ambiguity)
 {
     assert (callTypeProc != nullptr);
     symProc = nullptr;
@@ -803,8 +821,7 @@ TypeChecker::Status TypeChecker::findRegularOpDef(SymbolProcedure *& symProc,
             os << i->decl ()->location () << ' ';
         }
 
-        m_log.fatalInProc (errorCxt) << os.str () << "at "
-                                     << errorCxt->location () << '.';
+        ambiguity = os.str ();
         return E_TYPE;
     }
 
@@ -822,8 +839,25 @@ TypeChecker::Status TypeChecker::findBestMatchingOpDef(SymbolProcedure *& symPro
 {
     assert (errorCxt);
 
+    ResolutionCacheKey key (ResolutionCacheKey::OPERATOR, name,
+                            m_st->declarationScope (), callTypeProc, tyCxt);
+    const ResolutionGeneration generation = resolutionGeneration (key);
+    if (const ResolutionCacheEntry* entry = findResolution (key, generation))
+        return reuseResolution (*entry, symProc, errorCxt);
+
+    std::string ambiguity;
+    const Status status = resolveOpDef (symProc, name, tyCxt, callTypeProc, ambiguity);
+    return storeResolution (std::move (key), generation, status, symProc, ambiguity, errorCxt);
+}
+
+TypeChecker::Status TypeChecker::resolveOpDef(SymbolProcedure *& symProc,
+                                              StringRef name,
+                                              const TypeContext & tyCxt,
+                                              const TypeProc * callTypeProc,
+                                              std::string & ambiguity)
+{
     // Look for non-templated operator definitions:
-    TCGUARD (findRegularOpDef (symProc, name, callTypeProc, errorCxt));
+    TCGUARD (findRegularOpDef (symProc, name, callTypeProc, ambiguity));
     if (symProc != nullptr)
         return OK;
 
@@ -860,8 +894,7 @@ TypeChecker::Status TypeChecker::findBestMatchingOpDef(SymbolProcedure *& symPro
             os << i.getTemplate ()->decl ()->location () << ' ';
         }
 
-        m_log.fatalInProc(errorCxt) << os.str() << "at "
-                                    << errorCxt->location() << '.';
+        ambiguity = os.str ();
         return E_TYPE;
     }
 
@@ -875,6 +908,26 @@ TypeChecker::Status TypeChecker::findBestMatchingCastDef(SymbolProcedure *& symP
 {
     assert (errorCxt);
 
+    TypeContext wantCxt;
+    wantCxt.setContext (want);
+    ResolutionCacheKey key (ResolutionCacheKey::CAST, "__cast",
+                            m_st->declarationScope (),
+                            TypeProc::get (std::vector<const TypeBasic*> { arg }),
+                            wantCxt);
+    const ResolutionGeneration generation = resolutionGeneration (key);
+    if (const ResolutionCacheEntry* entry = findResolution (key, generation))
+        return reuseResolution (*entry, symProc, errorCxt);
+
+    std::string ambiguity;
+    const Status status = resolveCastDef (symProc, arg, want, ambiguity);
+    return storeResolution (std::move (key), generation, status, symProc, ambiguity, errorCxt);
+}
+
+TypeChecker::Status TypeChecker::resolveCastDef(SymbolProcedure *& symProc,
+                                                const TypeBasic * arg,
+                                                const TypeBasic * want,
+                                                std::string & ambiguity)
+{
     symProc = nullptr;
 
     // Look for non-templated cast definitions:
@@ -923,8 +976,7 @@ TypeChecker::Status TypeChecker::findBestMatchingCastDef(SymbolProcedure *& symP
                 os << i->decl ()->location () << ' ';
             }
 
-            m_log.fatalInProc (errorCxt) << os.str () << "at "
-                                         << errorCxt->location () << '.';
+            ambiguity = os.str ();
             return E_TYPE;
         }
 
@@ -969,8 +1021,7 @@ TypeChecker::Status TypeChecker::findBestMatchingCastDef(SymbolProcedure *& symP
             os << i.getTemplate ()->decl ()->location () << ' ';
         }
 
-        m_log.fatalInProc(errorCxt) << os.str() << "at "
-                                    << errorCxt->location() << '.';
+        ambiguity = os.str ();
         return E_TYPE;
     }
 
@@ -1143,6 +1194,64 @@ bool TypeChecker::unifyCast (Instantiation& inst,
     return true;
 }
 
+// A procedure call depends on the procedures with the same parameter types
+// and the templates of its name, operators and casts on those of their name:
+ResolutionGeneration TypeChecker::resolutionGeneration (const ResolutionCacheKey& key) const {
+    unsigned st = m_st->generation (key.name);
+    if (key.kind == ResolutionCacheKey::PROCEDURE)
+        st += m_st->generation (mangleProcedure (key.name, key.argTypes));
+
+    return ResolutionGeneration { st, m_operators->generation (key.name) };
+}
+
+const ResolutionCacheEntry* TypeChecker::findResolution (const ResolutionCacheKey& key,
+                                                         const ResolutionGeneration& generation)
+{
+    return m_resolutionCache->find (key, generation);
+}
+
+TypeChecker::Status TypeChecker::reuseResolution (const ResolutionCacheEntry& entry,
+                                                  SymbolProcedure *& symProc,
+                                                  const TreeNode * errorCxt)
+{
+    symProc = entry.proc;
+    if (! entry.ambiguity.empty ()) {
+        m_log.fatalInProc (errorCxt) << entry.ambiguity << "at "
+                                     << errorCxt->location () << '.';
+        return E_TYPE;
+    }
+
+    return OK;
+}
+
+// Only successful and ambiguous resolutions are cached. Other errors have
+// already been reported and will stop the type checker anyway.
+TypeChecker::Status TypeChecker::storeResolution (ResolutionCacheKey key,
+                                                  const ResolutionGeneration& generation,
+                                                  Status status,
+                                                  SymbolProcedure * symProc,
+                                                  const std::string & ambiguity,
+                                                  const TreeNode * errorCxt)
+{
+    if (status == OK) {
+        m_resolutionCache->insert (std::move (key), generation,
+                                   ResolutionCacheEntry { symProc, std::string () });
+        return OK;
+    }
+
+    if (status == E_TYPE && ! ambiguity.empty ()) {
+        ResolutionCacheEntry entry { nullptr, ambiguity };
+        m_resolutionCache->insert (std::move (key), generation, entry);
+        return reuseResolution (entry, symProc, errorCxt);
+    }
+
+    return status;
+}
+
+const TypeChecker::ResolutionStats& TypeChecker::resolutionStats () const {
+    return m_resolutionCache->stats ();
+}
+
 TypeChecker::Status TypeChecker::getInstance (SymbolProcedure *& proc,
                                               const Instantiation & inst)
 {
@@ -17,11 +17,20 @@
  * For further information, please contact us at sharemind@cyber.ee.
  */
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <locale>
 #include <memory>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
 
 #include <boost/optional/optional.hpp>
 #include <boost/program_options.hpp>
@@ -31,9 +40,12 @@
 
 #include <libscc/Blocks.h>
 #include <libscc/Context.h>
+#include <libscc/CostReport.h>
 #include <libscc/DataflowAnalysis.h>
 #include <libscc/Intermediate.h>
 #include <libscc/Location.h>
+#include <libscc/ModuleCache.h>
+#include <libscc/ModuleMap.h>
 #include <libscc/Optimizer.h>
 #include <libscc/Parser.h>
 #include <libscc/TreeNode.h>
@@ -66,14 +78,24 @@ struct Configuration {
     bool m_printCFG = false;
     bool m_printDom = false;
     bool m_printIR = false;
+    bool m_printDepth = false;
+    bool m_costReport = false;
     bool m_eval = false;
     bool m_stdin = true;
     bool m_stdout = true;
     bool m_optimize = false;
+    bool m_fullReanalysis = false;
+    bool m_noSymbolIndex = false;
 
     string m_output;
     string m_input;
     vector<string > m_includes;
+    string m_moduleCache;
+    string m_evalParallel;
+    string m_profile;
+    string m_syscallCosts;
+    string m_syscallReport;
+    unsigned m_jobs = 0;
     set<string > m_analysis;
 
     void read (const po::variables_map& vm) {
@@ -85,7 +107,11 @@ struct Configuration {
         m_printCFG = vm.count ("print-cfg");
         m_printIR = vm.count ("print-ir");
         m_printDom = vm.count ("print-dom");
+        m_printDepth = vm.count ("print-depth");
+        m_costReport = vm.count ("cost-report");
         m_optimize = vm.count ("optimize");
+        m_fullReanalysis = vm.count ("full-reanalysis");
+        m_noSymbolIndex = vm.count ("no-symbol-index");
 
         if (vm.count ("output")) {
             m_stdout = false;
@@ -107,6 +133,32 @@ struct Configuration {
         if (!vm.count("no-stdlib"))
             m_includes.push_back (SHAREMIND_STDLIB_PATH);
 
+        if (vm.count ("module-cache")) {
+            m_moduleCache = vm["module-cache"].as<string>();
+        }
+
+        if (vm.count ("eval-parallel")) {
+            m_evalParallel = vm["eval-parallel"].as<string>();
+        }
+
+        if (vm.count ("profile")) {
+            m_eval = true;
+            m_profile = vm["profile"].as<string>();
+        }
+
+        if (vm.count ("syscall-costs")) {
+            m_syscallCosts = vm["syscall-costs"].as<string>();
+        }
+
+        if (vm.count ("syscall-report")) {
+            m_eval = true;
+            m_syscallReport = vm["syscall-report"].as<string>();
+        }
+
+        if (vm.count ("jobs")) {
+            m_jobs = vm["jobs"].as<unsigned>();
+        }
+
         if (vm.count ("analysis")) {
             const vector<string >& v = vm["analysis"].as<vector<string > > ();
             m_analysis.insert (v.begin (), v.end ());
@@ -158,6 +210,26 @@ SecreC::DataFlowAnalysis* getAnalysisByName (const std::string& name) {
     return nullptr;
 }
 
+/// Reads the cost table, returns nullptr and reports the error on failure.
+std::shared_ptr<SecreC::SyscallCostTable> readSyscallCosts (const std::string& path) {
+    std::ifstream in (path);
+    if (! in) {
+        cerr << "Failed to open \"" << path << "\"." << endl;
+        return nullptr;
+    }
+
+    const auto costs = std::make_shared<SecreC::SyscallCostTable> ();
+    try {
+        costs->read (in);
+    }
+    catch (const std::runtime_error& e) {
+        cerr << path << ": " << e.what () << endl;
+        return nullptr;
+    }
+
+    return costs;
+}
+
 int run (const Configuration& cfg) {
     SecreC::TreeNodeModule * parseTree = nullptr;
     std::ostream out (cout.rdbuf ());
@@ -194,7 +266,16 @@ int run (const Configuration& cfg) {
         icode.modules ().addSearchPath (path, cfg.m_verbose);
     }
 
+    if (! cfg.m_moduleCache.empty ()) {
+        icode.modules ().setCacheDirectory (cfg.m_moduleCache);
+    }
+
+    icode.symbols ().setIndexed (! cfg.m_noSymbolIndex);
+    icode.symbols ().setLookupStats (cfg.m_verbose);
+
+    const auto compileStartTime = std::chrono::steady_clock::now ();
     icode.compile (parseTree, SecreC::Location::PathStyle::FullPath);
+    const auto compileEndTime = std::chrono::steady_clock::now ();
     bool bad = icode.status () != SecreC::ICode::OK;
 
     if (bad)
@@ -208,12 +289,54 @@ int run (const Configuration& cfg) {
     SecreC::Program& pr = icode.program ();
 
     if (cfg.m_verbose) {
-        cerr << "Valid intermediate code generated." << endl
+        cerr << "Valid intermediate code generated in "
+             << std::chrono::duration_cast<std::chrono::milliseconds> (compileEndTime - compileStartTime).count ()
+             << " ms." << endl
              << icode.compileLog();
+        cerr << "Overload resolution cache: "
+             << icode.resolutionStats ().hits << " hits, "
+             << icode.resolutionStats ().misses << " misses, "
+             << icode.resolutionStats ().stale << " of them on redeclared names." << endl;
+        cerr << "Symbol lookup: "
+             << icode.symbols ().lookupStats ().lookups << " lookups in "
+             << std::chrono::duration_cast<std::chrono::microseconds> (icode.symbols ().lookupStats ().time).count ()
+             << " us." << endl;
+        if (const SecreC::ModuleCache* cache = icode.modules ().cache ()) {
+            cerr << "Module cache: "
+                 << cache->stats ().hits << " hits, "
+                 << cache->stats ().misses << " misses." << endl;
+        }
     }
 
-    if (cfg.m_optimize)
-        optimizeCode (icode);
+    if (cfg.m_optimize) {
+        const auto startTime = std::chrono::steady_clock::now ();
+        optimizeCode (icode, ! cfg.m_fullReanalysis);
+        scheduleInstructions (icode);
+        if (cfg.m_verbose) {
+            const auto endTime = std::chrono::steady_clock::now ();
+            cerr << "Optimized in "
+                 << std::chrono::duration_cast<std::chrono::milliseconds> (endTime - startTime).count ()
+                 << " ms." << endl;
+            cerr << "Common subexpression elimination: "
+                 << icode.optimizerStats ().eliminatedPrivateOps << " private and "
+                 << icode.optimizerStats ().eliminatedPublicOps << " public operations eliminated." << endl;
+            cerr << "Loop-invariant code motion: "
+                 << icode.optimizerStats ().hoistedInstructions << " instructions hoisted." << endl;
+            cerr << "System call batching: "
+                 << icode.optimizerStats ().batchedSyscalls << " scalar system calls merged into "
+                 << icode.optimizerStats ().vectorSyscalls << " vector calls." << endl;
+            cerr << "Instruction scheduling: "
+                 << icode.optimizerStats ().scheduledBlocks << " blocks reordered." << endl;
+            for (const auto& stats : icode.optimizerStats ().analyses) {
+                cerr << "Analysis \"" << stats.name << "\": "
+                     << stats.runs << " runs, "
+                     << stats.rounds << " rounds, "
+                     << stats.blocks << " blocks visited in "
+                     << std::chrono::duration<double, std::milli> (stats.time).count ()
+                     << " ms." << endl;
+            }
+        }
+    }
 
     if (cfg.m_printST) {
         out << icode.symbols () << endl;
@@ -232,6 +355,38 @@ int run (const Configuration& cfg) {
         return EXIT_SUCCESS;
     }
 
+    if (cfg.m_printDepth) {
+        for (const SecreC::Procedure& proc : pr) {
+            if (proc.name ())
+                out << *proc.name ();
+            else
+                out << "<entry>";
+            out << ": " << SecreC::privateCriticalPath (proc) << endl;
+        }
+
+        return EXIT_SUCCESS;
+    }
+
+    if (cfg.m_costReport) {
+        std::shared_ptr<SecreC::SyscallCostTable> costs;
+        if (! cfg.m_syscallCosts.empty ()) {
+            costs = readSyscallCosts (cfg.m_syscallCosts);
+            if (! costs)
+                return EXIT_FAILURE;
+        }
+
+        SecreC::ConstantFolding cf;
+        SecreC::DataFlowAnalysisRunner runner;
+        runner.addAnalysis (cf);
+        runner.run (pr);
+
+        SecreC::CostReport report;
+        report.compute (pr, cf, costs.get ());
+        report.writeJson (out);
+        out << flush;
+        return EXIT_SUCCESS;
+    }
+
     if (cfg.m_printCFG) {
         pr.toDotty (out);
         out << flush;
@@ -242,25 +397,246 @@ int run (const Configuration& cfg) {
     if (! cfg.m_analysis.empty ()) {
         SecreC::DataFlowAnalysisRunner runner;
         boost::ptr_vector<SecreC::DataFlowAnalysis> analysis;
+        vector<string> names;
         for (const std::string& name : cfg.m_analysis) {
             if (SecreC::DataFlowAnalysis * const a = getAnalysisByName(name)) {
                 analysis.push_back (a);
+                names.push_back (name);
                 runner.addAnalysis (*a);
             }
         }
 
         runner.run (pr);
         out << runner.toString (pr) << endl;
+
+        if (cfg.m_verbose) {
+            for (size_t i = 0; i < analysis.size (); ++ i) {
+                const auto& stats = runner.statistics (analysis[i]);
+                cerr << "Analysis \"" << names[i] << "\": "
+                     << stats.runs << " runs, "
+                     << stats.rounds << " rounds, "
+                     << stats.blocks << " blocks visited in "
+                     << std::chrono::duration<double, std::milli> (stats.time).count ()
+                     << " ms";
+                if (const size_t bytes = analysis[i].memoryUsage ())
+                    cerr << ", results take " << bytes / 1024 << " KiB";
+                cerr << "." << endl;
+            }
+        }
     }
 
     if (cfg.m_eval) {
         SecreC::VirtualMachine eval;
-        return eval.run (pr);
+        eval.setProfiling (! cfg.m_profile.empty ());
+        eval.setSyscallReporting (! cfg.m_syscallReport.empty ());
+        if (! cfg.m_syscallCosts.empty ()) {
+            const auto costs = readSyscallCosts (cfg.m_syscallCosts);
+            if (! costs)
+                return EXIT_FAILURE;
+
+            eval.setSyscallCosts (costs);
+        }
+
+        const auto startTime = std::chrono::steady_clock::now ();
+        const int status = eval.run (pr);
+        if (cfg.m_verbose) {
+            const std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now () - startTime;
+            cerr << "Executed " << eval.executedInstructions ()
+                 << " instructions in "
+                 << std::chrono::duration_cast<std::chrono::milliseconds> (elapsed).count ()
+                 << " ms";
+            if (elapsed.count () > 0.0)
+                cerr << " (" << static_cast<uint64_t> (eval.executedInstructions () / elapsed.count ())
+                     << " instructions/s)";
+            cerr << "." << endl;
+        }
+
+        if (const auto profile = eval.profile ()) {
+            const string stacksFile = cfg.m_profile + ".folded";
+            std::ofstream report (cfg.m_profile);
+            std::ofstream stacks (stacksFile);
+            if (! report || ! stacks) {
+                cerr << "Failed to open \"" << (report ? stacksFile : cfg.m_profile)
+                     << "\" for writing the profile." << endl;
+                return EXIT_FAILURE;
+            }
+
+            profile->writeReport (report);
+            profile->writeCollapsedStacks (stacks);
+        }
+
+        if (! cfg.m_syscallReport.empty ()) {
+            std::ofstream report (cfg.m_syscallReport);
+            if (! report) {
+                cerr << "Failed to open \"" << cfg.m_syscallReport
+                     << "\" for writing the system call report." << endl;
+                return EXIT_FAILURE;
+            }
+
+            eval.syscallReport ().writeReport (report);
+        }
+
+        return status;
     }
 
     return EXIT_SUCCESS;
 }
 
+/*
+ * Compiles and evaluates a single program. Diagnostics and the output of the
+ * program are written to the log.
+ */
+int evalProgram (const Configuration& cfg,
+                 const SecreC::ModuleMap::ModuleFiles& moduleFiles,
+                 const std::shared_ptr<SecreC::ModuleCache>& moduleCache,
+                 const string& input,
+                 std::ostream& log)
+{
+    SecreC::ICode icode;
+    SecreC::TreeNodeModule * parseTree = icode.parseMain (input);
+    if (icode.status () != SecreC::ICode::OK) {
+        log << icode.compileLog ();
+        return EXIT_FAILURE;
+    }
+
+    icode.modules ().addModuleFiles (moduleFiles, false);
+    icode.modules ().setCache (moduleCache);
+    icode.compile (parseTree, SecreC::Location::PathStyle::FullPath);
+    bool bad = icode.status () != SecreC::ICode::OK;
+
+    if (bad)
+        log << "Error generating valid intermediate code." << endl;
+
+    log << icode.compileLog () << endl;
+
+    if (bad)
+        return EXIT_FAILURE;
+
+    if (cfg.m_optimize) {
+        optimizeCode (icode, ! cfg.m_fullReanalysis);
+        scheduleInstructions (icode);
+    }
+
+    SecreC::VirtualMachine eval (log, log);
+    return eval.run (icode.program ());
+}
+
+/*
+ * One program of a parallel evaluation.
+ */
+struct EvalJob {
+    string program;
+    string passPattern; // empty if the program has to succeed
+    bool passed = false;
+    std::chrono::milliseconds::rep elapsed = 0;
+    string log;
+};
+
+/*
+ * Evaluates all programs listed in the file given to --eval-parallel on a pool
+ * of threads. Modules are looked up and parsed once for all the programs.
+ */
+int evalParallel (const Configuration& cfg) {
+    vector<EvalJob> jobs;
+
+    {
+        std::ifstream in (cfg.m_evalParallel);
+        if (! in) {
+            cerr << "Failed to open \"" << cfg.m_evalParallel << "\"." << endl;
+            return EXIT_FAILURE;
+        }
+
+        string line;
+        while (std::getline (in, line)) {
+            std::istringstream ss (line);
+            EvalJob job;
+            if (! (ss >> job.program) || job.program[0] == '#')
+                continue;
+
+            std::getline (ss >> std::ws, job.passPattern);
+            jobs.push_back (std::move (job));
+        }
+    }
+
+    SecreC::ModuleMap::ModuleFiles moduleFiles;
+    for (const string& path : cfg.m_includes) {
+        const auto files = SecreC::ModuleMap::findModuleFiles (path, cfg.m_verbose);
+        moduleFiles.insert (moduleFiles.end (), files.begin (), files.end ());
+    }
+
+    const auto moduleCache = cfg.m_moduleCache.empty ()
+        ? std::make_shared<SecreC::ModuleCache> ()
+        : std::make_shared<SecreC::ModuleCache> (cfg.m_moduleCache);
+
+    unsigned numThreads = cfg.m_jobs;
+    if (numThreads == 0)
+        numThreads = std::max (1u, std::thread::hardware_concurrency ());
+    numThreads = std::min<size_t> (numThreads, std::max<size_t> (jobs.size (), 1u));
+
+    const auto startTime = std::chrono::steady_clock::now ();
+    std::atomic<size_t> next (0u);
+    auto worker = [&] () {
+        for (size_t i = next++; i < jobs.size (); i = next++) {
+            EvalJob& job = jobs[i];
+            std::ostringstream log;
+            const auto jobStartTime = std::chrono::steady_clock::now ();
+            int status = EXIT_FAILURE;
+            try {
+                status = evalProgram (cfg, moduleFiles, moduleCache, job.program, log);
+            }
+            catch (const std::exception& e) {
+                log << "Failed with exception:" << endl << e.what () << endl;
+            }
+            catch (...) {
+                log << "Failed with unknown exception." << endl;
+            }
+
+            job.elapsed = std::chrono::duration_cast<std::chrono::milliseconds> (
+                std::chrono::steady_clock::now () - jobStartTime).count ();
+            job.log = log.str ();
+            if (job.passPattern.empty ())
+                job.passed = status == EXIT_SUCCESS;
+            else
+                job.passed = std::regex_search (job.log, std::regex (job.passPattern));
+        }
+    };
+
+    vector<std::thread> threads;
+    for (unsigned t = 1; t < numThreads; ++ t)
+        threads.emplace_back (worker);
+    worker ();
+    for (std::thread& thread : threads)
+        thread.join ();
+
+    const auto totalTime = std::chrono::duration_cast<std::chrono::milliseconds> (
+        std::chrono::steady_clock::now () - startTime).count ();
+
+    size_t failures = 0;
+    for (const EvalJob& job : jobs) {
+        if (job.passed)
+            continue;
+
+        ++ failures;
+        cerr << job.program << ":" << endl << job.log;
+        if (! job.passPattern.empty ())
+            cerr << "Output did not match \"" << job.passPattern << "\"." << endl;
+    }
+
+    if (cfg.m_verbose || failures > 0) {
+        for (const EvalJob& job : jobs) {
+            cerr << std::setw (8) << job.elapsed << " ms  "
+                 << (job.passed ? "ok     " : "FAILED ") << job.program << endl;
+        }
+    }
+
+    cerr << "Evaluated " << jobs.size () << " programs ("
+         << failures << " failed) in " << totalTime << " ms using "
+         << numThreads << " threads." << endl;
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 } // anonymous namespace
 
 int main(int argc, char *argv[]) {
@@ -284,13 +660,38 @@ int main(int argc, char *argv[]) {
                 ("include,I",  po::value<vector<string > >(),
                  "Directory for module search path.")
                 ("no-stdlib", "Do not look for standard library imports.")
+                ("module-cache", po::value<string>(),
+                 "Directory for caching parsed modules.")
                 ("optimize,O", "Optimize the generated code.")
+                ("full-reanalysis", "Re-analyse the whole program after every optimization step.")
                 ("eval,e", "Evaluate the program")
+                ("eval-parallel", po::value<string>(),
+                 "Evaluate every program listed in the given file on a pool of threads. "
+                 "Each line names a program, optionally followed by a regular expression "
+                 "that its output must match instead of the program succeeding.")
+                ("profile", po::value<string>(),
+                 "Evaluate the program and write where it spent its time to the given "
+                 "file, and its call stacks in the collapsed flame graph format to the "
+                 "file with the suffix \".folded\" appended.")
+                ("syscall-costs", po::value<string>(),
+                 "Estimate the rounds and bytes of the system calls made by the "
+                 "evaluated program from the given cost table.")
+                ("syscall-report", po::value<string>(),
+                 "Evaluate the program and write the system calls it made, and their "
+                 "costs per procedure and source line, to the given file.")
+                ("jobs,j", po::value<unsigned>(),
+                 "Number of programs evaluated in parallel.")
                 ("print-ast", "Print the abstract syntax tree")
                 ("print-st",  "Print the symbol table")
                 ("print-cfg", "Print the control flow graph")
                 ("print-dom", "Print the dominators tree")
                 ("print-ir",  "Print the intermediate representation")
+                ("print-depth", "Print the number of private operations on the "
+                 "critical path of every procedure")
+                ("cost-report", "Print the private system calls of every procedure "
+                 "and of the whole program, with their vector sizes and estimated "
+                 "rounds, as JSON. Rounds are read from --syscall-costs if given. "
+                 "Use with --optimize to count the calls of scc -O.")
                 ("analysis,a", po::value<vector<string > >(),
                  "Run specified analysis. Options are:\n"
                  "\t\"rd\"  -- reaching definitions\n"
@@ -304,6 +705,16 @@ int main(int argc, char *argv[]) {
                  "\t\"cp\"  -- copy propagation\n"
                  "\t\"rr\"  -- reachable returns\n"
                  );
+
+        // Options for the benchmarks, not listed by --help:
+        po::options_description hidden ("Hidden options");
+        hidden.add_options ()
+                ("no-symbol-index", "Look names up by comparing the name of every symbol of a scope.")
+                ;
+
+        po::options_description all;
+        all.add (desc).add (hidden);
+
         po::positional_options_description p;
         p.add("input", -1);
         po::variables_map vm;
@@ -311,7 +722,7 @@ int main(int argc, char *argv[]) {
         try {
             p.add("input", -1);
             po::store(po::command_line_parser(argc, argv).
-                      options (desc).positional (p).run (), vm);
+                      options (all).positional (p).run (), vm);
             po::notify(vm);
         }
         catch (const std::exception& e) {
@@ -327,6 +738,15 @@ int main(int argc, char *argv[]) {
             return EXIT_SUCCESS;
         }
 
+        if (! cfg.m_evalParallel.empty ()) {
+            if (! cfg.m_stdin) {
+                std::cerr << "Input file can not be given with --eval-parallel." << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            return evalParallel (cfg);
+        }
+
         return run (cfg);
     }
     catch (const std::exception& e) {
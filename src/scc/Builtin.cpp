@@ -20,6 +20,7 @@
 #include "Builtin.h"
 
 #include <functional>
+#include <map>
 #include <set>
 #include <sstream>
 #include <libscc/Imop.h>
@@ -45,6 +46,18 @@ void BuiltinFunctions::insert (VMLabel* label, const BuiltinFunction& func) {
         m_functions.emplace(label, func.clone());
 }
 
+void BuiltinFunctions::insert (const std::string& signature, VMLabel* label,
+                               const BuiltinFunction& func)
+{
+    m_signatures.emplace(signature, label);
+    insert(label, func);
+}
+
+VMLabel* BuiltinFunctions::find (const std::string& signature) const {
+    auto const it(m_signatures.find(signature));
+    return it != m_signatures.end() ? it->second : nullptr;
+}
+
 void BuiltinFunctions::generateAll (VMCodeSection& code, VMSymbolTable& st) {
     struct ValueType {
         VMLabel const * label;
@@ -57,11 +70,12 @@ void BuiltinFunctions::generateAll (VMCodeSection& code, VMSymbolTable& st) {
     for (auto & f : m_functions)
         vs.emplace(ValueType{f.first, *f.second});
     for (auto const & v : vs) {
-        VMFunction function(v.label->nameStreamable());
+        VMFunction function(code.arena(), v.label->nameStreamable());
         v.function.get().generate(function, st);
-        code.push_back(function);
+        code.push_back(std::move(function));
     }
     m_functions.clear();
+    m_signatures.clear();
 }
 
 
@@ -79,7 +93,7 @@ void BuiltinAlloc::generate (VMFunction& function, VMSymbolTable& st) {
     auto const lBack = st.getUniqLabel(":back_");
     auto const lOut = st.getUniqLabel(":out_");
 
-    VMBlock entryB;
+    VMBlock entryB (function.arena ());
     entryB.push_new () << "resizestack" << 4;
     entryB.push_new () << "mov imm 0x0" << rOffset;
     entryB.push_new () << "bmul uint64" << rSize << iSize;
@@ -87,18 +101,18 @@ void BuiltinAlloc::generate (VMFunction& function, VMSymbolTable& st) {
     entryB.push_new () << "uinc uint64" << rSize;
     entryB.push_new () << "alloc" << rOut << rSize;
     entryB.push_new () << "udec uint64" << rSize;
-    function.push_back (entryB);
+    function.push_back (std::move (entryB));
 
-    VMBlock middleB(lBack->nameStreamable());
+    VMBlock middleB (function.arena (), lBack->nameStreamable ());
     middleB.push_new () << "jge" << lOut << "uint64" << rOffset << rSize;
     middleB.push_new () << "mov" << rDefault << "mem" << rOut << rOffset << iSize;
     middleB.push_new () << "badd uint64" << rOffset << iSize;
     middleB.push_new () << "jmp" << lBack;
-    function.push_back (middleB);
+    function.push_back (std::move (middleB));
 
-    VMBlock exitB(lOut->nameStreamable());
+    VMBlock exitB (function.arena (), lOut->nameStreamable ());
     exitB.push_new () << "return" << rOut;
-    function.push_back (exitB);
+    function.push_back (std::move (exitB));
 }
 
 /*******************************************************************************
@@ -111,14 +125,13 @@ void BuiltinVArith::generate (VMFunction& function, VMSymbolTable& st) {
     const auto n = imop.nArgs ();
     assert (n > 0);
     assert (imop.isVectorized ());
-    const bool isBool = imop.arg1()->secrecType()->secrecDataType()->isBool();
     const VMDataType argTy = secrecDTypeToVMDType (imop.arg1()->secrecType()->secrecDataType());
     const VMDataType destTy = secrecDTypeToVMDType (imop.dest ()->secrecType ()->secrecDataType ());
     assert (argTy != VM_INVALID && destTy != VM_INVALID);
     VMImm* const argSize = st.getImm (sizeInBytes (argTy));
     VMImm* const destSize = st.getImm (sizeInBytes (destTy));
 
-    VMBlock entryB;
+    VMBlock entryB (function.arena ());
 
     entryB.push_new () << "resizestack" << (2*n + 3);
 
@@ -139,7 +152,7 @@ void BuiltinVArith::generate (VMFunction& function, VMSymbolTable& st) {
     auto const lOut = st.getUniqLabel(":out_");
 
     // jump out if needed
-    VMBlock middleB(lBack->nameStreamable());
+    VMBlock middleB (function.arena (), lBack->nameStreamable ());
     middleB.push_new () << "jge" << lOut << "uint64" << rCount << rSize;
 
     // move arguments to temporaries
@@ -154,32 +167,8 @@ void BuiltinVArith::generate (VMFunction& function, VMSymbolTable& st) {
 
     // perform operation on temporaries
     {
-        char const * name = nullptr;
-        switch (imop.type ()) {
-        case Imop::UMINUS: name = "bneg"; break;
-        case Imop::UNEG  : name = "bnot"; break;
-        case Imop::UINV  : name = isBool ? "bnot" : "binv"; break;
-        case Imop::MUL   : name = "tmul"; break;
-        case Imop::DIV   : name = "tdiv"; break;
-        case Imop::MOD   : name = "tmod"; break;
-        case Imop::ADD   : name = "tadd"; break;
-        case Imop::SUB   : name = "tsub"; break;
-        case Imop::LAND  : name = "ltand"; break;
-        case Imop::LOR   : name = "ltor"; break;
-        case Imop::EQ    : name = "teq"; break;
-        case Imop::NE    : name = "tne"; break;
-        case Imop::LE    : name = "tle"; break;
-        case Imop::LT    : name = "tlt"; break;
-        case Imop::GE    : name = "tge"; break;
-        case Imop::GT    : name = "tgt"; break;
-        case Imop::BOR   : name = "btor"; break;
-        case Imop::XOR   : name = "btxor"; break;
-        case Imop::BAND  : name = "btand"; break;
-        case Imop::SHL   : name = "tshl0"; break;
-        case Imop::SHR   : name = imop.dest()->isSigned() ? "tshr" : "tshr0"; break;
-        default:
-            assert (false && "Not an arithmetic instruction!");
-        }
+        char const * name = instructionName (imop);
+        assert (name != nullptr && "Not an arithmetic instruction!");
 
         VMInstruction instr;
         instr << name << argTy;
@@ -205,12 +194,162 @@ void BuiltinVArith::generate (VMFunction& function, VMSymbolTable& st) {
     // jump back to conditional
     middleB.push_new () << "jmp" << lBack;
 
-    VMBlock returnB(lOut->nameStreamable());
+    VMBlock returnB (function.arena (), lOut->nameStreamable ());
+    returnB.push_new () << "return imm 0x0";
+
+    function.push_back (std::move (entryB));
+    function.push_back (std::move (middleB));
+    function.push_back (std::move (returnB));
+}
+
+const char* BuiltinVArith::instructionName (const SecreC::Imop& imop) {
+    using namespace SecreC;
+    const bool isBool = imop.arg1()->secrecType()->secrecDataType()->isBool();
+    switch (imop.type ()) {
+    case Imop::UMINUS: return "bneg";
+    case Imop::UNEG  : return "bnot";
+    case Imop::UINV  : return isBool ? "bnot" : "binv";
+    case Imop::MUL   : return "tmul";
+    case Imop::DIV   : return "tdiv";
+    case Imop::MOD   : return "tmod";
+    case Imop::ADD   : return "tadd";
+    case Imop::SUB   : return "tsub";
+    case Imop::LAND  : return "ltand";
+    case Imop::LOR   : return "ltor";
+    case Imop::EQ    : return "teq";
+    case Imop::NE    : return "tne";
+    case Imop::LE    : return "tle";
+    case Imop::LT    : return "tlt";
+    case Imop::GE    : return "tge";
+    case Imop::GT    : return "tgt";
+    case Imop::BOR   : return "btor";
+    case Imop::XOR   : return "btxor";
+    case Imop::BAND  : return "btand";
+    case Imop::SHL   : return "tshl0";
+    case Imop::SHR   : return imop.dest()->isSigned() ? "tshr" : "tshr0";
+    default:
+        return nullptr;
+    }
+}
+
+/*******************************************************************************
+  BuiltinVFused
+*******************************************************************************/
+
+void BuiltinVFused::generate (VMFunction& function, VMSymbolTable& st) {
+    assert (! m_steps.empty ());
+    const std::size_t k = m_inputs.size ();
+
+    size_t stackSize = 0;
+    auto nextOnStack = [&stackSize, &st]() {
+        return st.getStack(stackSize ++);
+    };
+
+    VMStack* dest = nextOnStack ();
+    std::vector<VMStack*> args;
+    for (std::size_t i = 0; i < k; ++ i)
+        args.push_back (nextOnStack ());
+
+    VMStack* size = nextOnStack ();
+    VMStack* count = nextOnStack ();
+
+    // One offset for all the arrays with elements of the same size:
+    std::map<unsigned, VMStack*> offsets;
+    auto offsetOf = [&offsets, &nextOnStack](VMDataType ty) {
+        VMStack*& offset = offsets[sizeInBytes (ty)];
+        if (offset == nullptr)
+            offset = nextOnStack ();
+        return offset;
+    };
+
+    // Scalars are used from the argument, elements of arrays are loaded:
+    std::vector<VMStack*> values;
+    for (std::size_t i = 0; i < k; ++ i) {
+        if (m_inputs[i].isScalar) {
+            values.push_back (args[i]);
+        }
+        else {
+            offsetOf (m_inputs[i].type);
+            values.push_back (nextOnStack ());
+        }
+    }
+
+    for (std::size_t i = 0; i < m_steps.size (); ++ i)
+        values.push_back (nextOnStack ());
+
+    VMStack* destOff = offsetOf (m_destType);
+
+    VMBlock entryB (function.arena ());
+    entryB.push_new () << "resizestack" << stackSize;
+    entryB.push_new () << "mov imm 0x0" << count;
+    for (const auto& offset : offsets)
+        entryB.push_new () << "mov imm 0x0" << offset.second;
+
+    auto const lBack = st.getUniqLabel(":back_");
+    auto const lOut = st.getUniqLabel(":out_");
+
+    VMBlock middleB (function.arena (), lBack->nameStreamable ());
+    middleB.push_new () << "jge" << lOut << "uint64" << count << size;
+
+    for (std::size_t i = 0; i < k; ++ i) {
+        if (m_inputs[i].isScalar)
+            continue;
+
+        middleB.push_new ()
+            << "mov mem"
+            << args[i]
+            << offsetOf (m_inputs[i].type)
+            << values[i]
+            << st.getImm (sizeInBytes (m_inputs[i].type));
+    }
+
+    for (std::size_t i = 0; i < m_steps.size (); ++ i) {
+        const Step& step = m_steps[i];
+        VMInstruction instr;
+        instr << step.name << step.argType << values[k + i];
+        for (unsigned arg : step.args) {
+            assert (arg < k + i);
+            instr << values[arg];
+        }
+
+        middleB.push_back (instr);
+    }
+
+    middleB.push_new ()
+        << "mov"
+        << values.back ()
+        << "mem"
+        << dest
+        << destOff
+        << st.getImm (sizeInBytes (m_destType));
+
+    for (const auto& offset : offsets)
+        middleB.push_new () << "badd uint64" << offset.second << st.getImm (offset.first);
+    middleB.push_new () << "uinc uint64" << count;
+    middleB.push_new () << "jmp" << lBack;
+
+    VMBlock returnB (function.arena (), lOut->nameStreamable ());
     returnB.push_new () << "return imm 0x0";
 
-    function.push_back (entryB);
-    function.push_back (middleB);
-    function.push_back (returnB);
+    function.push_back (std::move (entryB));
+    function.push_back (std::move (middleB));
+    function.push_back (std::move (returnB));
+}
+
+std::string BuiltinVFused::signature () const {
+    std::ostringstream os;
+    for (const Input& input : m_inputs)
+        os << (input.isScalar ? 's' : 'a') << dataTypeToStr (input.type) << ' ';
+
+    for (const Step& step : m_steps) {
+        os << '(' << step.name << ' ' << dataTypeToStr (step.argType);
+        for (unsigned arg : step.args)
+            os << ' ' << arg;
+        os << ')';
+    }
+
+    os << ' ' << dataTypeToStr (m_destType);
+    return os.str ();
 }
 
 /*******************************************************************************
@@ -226,7 +365,7 @@ void BuiltinFloatToInt::generate (VMFunction& function, VMSymbolTable& st) {
     VMStack* prevFpuState = st.getStack(2);
     VMStack* fpuState = st.getStack(3);
 
-    VMBlock block;
+    VMBlock block (function.arena ());
     block.push_new () << "resizestack" << 4;
 
     // Set proper FPU state:
@@ -243,7 +382,7 @@ void BuiltinFloatToInt::generate (VMFunction& function, VMSymbolTable& st) {
 
     block.push_new () << "return" << dest;
 
-    function.push_back(block);
+    function.push_back(std::move(block));
 }
 
 
@@ -281,7 +420,7 @@ void BuiltinVCast::generate (VMFunction& function, VMSymbolTable& st) {
 
     ///////////////
     // Entry block:
-    VMBlock entryB;
+    VMBlock entryB (function.arena ());
 
     entryB.push_new () << "resizestack" << stackSize;
 
@@ -298,7 +437,7 @@ void BuiltinVCast::generate (VMFunction& function, VMSymbolTable& st) {
     entryB.push_new () << "jge" << exitL << VM_UINT64 << srcOff << size;
 
 
-    VMBlock middleB(middleL->nameStreamable());
+    VMBlock middleB (function.arena (), middleL->nameStreamable ());
     middleB.push_new () << "mov" << "mem" << src << srcOff << temp << srcSize;
     middleB.push_new () << "convert" << m_src << temp << m_dest << temp;
     middleB.push_new () << "mov" << temp << "mem" << dest << destOff << destSize;
@@ -306,7 +445,7 @@ void BuiltinVCast::generate (VMFunction& function, VMSymbolTable& st) {
     middleB.push_new () << "badd" << VM_UINT64 << destOff << destSize;
     middleB.push_new () << "jlt" << middleL << VM_UINT64 << srcOff << size;
 
-    VMBlock exitB(exitL->nameStreamable());
+    VMBlock exitB (function.arena (), exitL->nameStreamable ());
 
     if (needToRoundToZero) {
         fpuSetState(exitB, prevFpuState);
@@ -314,9 +453,9 @@ void BuiltinVCast::generate (VMFunction& function, VMSymbolTable& st) {
 
     exitB.push_new () << "return imm 0x0";
 
-    function.push_back (entryB)
-            .push_back (middleB)
-            .push_back (exitB);
+    function.push_back (std::move (entryB))
+            .push_back (std::move (middleB))
+            .push_back (std::move (exitB));
     return;
 }
 
@@ -342,14 +481,14 @@ void BuiltinVBoolCast::generate (VMFunction& function, VMSymbolTable& st) {
 
     ///////////////
     // Entry block:
-    VMBlock entryB;
+    VMBlock entryB (function.arena ());
     entryB.push_new () << "resizestack" << 7;
     entryB.push_new () << "mov" << st.getImm (0) << srcOff;
     entryB.push_new () << "mov" << st.getImm (0) << destOff;
     entryB.push_new () << "bmul uint64" << size << srcSize;
     entryB.push_new () << "jge" << exitL << "uint64" << srcOff << size;
 
-    VMBlock middleB(middleL->nameStreamable());
+    VMBlock middleB (function.arena (), middleL->nameStreamable ());
     middleB.push_new () << "mov" << "mem" << src << srcOff << temp << srcSize;
     middleB.push_new () << "tne" << m_src << boolTemp << temp << st.getImm (0);
     middleB.push_new () << "mov" << boolTemp << "mem" << dest << destOff << destElemSize;
@@ -357,12 +496,12 @@ void BuiltinVBoolCast::generate (VMFunction& function, VMSymbolTable& st) {
     middleB.push_new () << "badd uint64" << destOff << destElemSize;
     middleB.push_new () << "jlt" << middleL << "uint64" << srcOff << size;
 
-    VMBlock exitB(exitL->nameStreamable());
+    VMBlock exitB (function.arena (), exitL->nameStreamable ());
     exitB.push_new () << "return imm 0x0";
 
-    function.push_back (entryB)
-            .push_back (middleB)
-            .push_back (exitB);
+    function.push_back (std::move (entryB))
+            .push_back (std::move (middleB))
+            .push_back (std::move (exitB));
     return;
 }
 
@@ -378,7 +517,7 @@ void BuiltinStrAppend::generate (VMFunction& function, VMSymbolTable& st) {
     VMStack* totalSize = st.getStack (2);
     VMStack* dest = st.getStack (3);
 
-    VMBlock block;
+    VMBlock block (function.arena ());
     block.push_new () << "resizestack 0x4";
     block.push_new () << "getcrefsize" << lhs << lhsSize;
     block.push_new () << "getcrefsize" << rhs << rhsSize;
@@ -388,7 +527,7 @@ void BuiltinStrAppend::generate (VMFunction& function, VMSymbolTable& st) {
     block.push_new () << "mov cref 0x0" << st.getImm (0) << "mem" << dest << st.getImm (0) << lhsSize;
     block.push_new () << "mov cref 0x1" << st.getImm (0) << "mem" << dest << lhsSize << rhsSize;
     block.push_new () << "return" << dest;
-    function.push_back (block);
+    function.push_back (std::move (block));
     return;
 }
 
@@ -401,13 +540,13 @@ void BuiltinStrDup::generate (VMFunction& function, VMSymbolTable& st) {
     VMStack* size = st.getStack (0);
     VMStack* dest = st.getStack (1);
 
-    VMBlock block;
+    VMBlock block (function.arena ());
     block.push_new () << "resizestack 0x2";
     block.push_new () << "getcrefsize" << src << size;
     block.push_new () << "alloc" << dest << size;
     block.push_new () << "mov cref 0x0" << st.getImm (0) << "mem" << dest << st.getImm (0) << size;
     block.push_new () << "return" << dest;
-    function.push_back (block);
+    function.push_back (std::move (block));
     return;
 }
 
@@ -425,7 +564,7 @@ void BuiltinBoolToString::generate (VMFunction& function, VMSymbolTable& st) {
     VMStack* dest = st.getStack (4);
     VMLabel* trueL = st.getUniqLabel ();
 
-    VMBlock entryB;
+    VMBlock entryB (function.arena ());
     entryB.push_new () << "resizestack" << 6;
     entryB.push_new () << "mov" << trueLit << label;
     entryB.push_new () << "mov" << st.getImm (5) << size;
@@ -435,13 +574,13 @@ void BuiltinBoolToString::generate (VMFunction& function, VMSymbolTable& st) {
     entryB.push_new () << "mov" << falseLit << label;
     entryB.push_new () << "mov" << st.getImm (6) << size;
 
-    VMBlock exitB(trueL->nameStreamable());
+    VMBlock exitB (function.arena (), trueL->nameStreamable ());
     exitB.push_new () << "alloc" << dest << size;
     exitB.push_new () << "mov" << "mem" << rodata << label << "mem" << dest << st.getImm (0) << size;
     exitB.push_new () << "return" << dest;
 
-    function.push_back (entryB)
-            .push_back (exitB);
+    function.push_back (std::move (entryB))
+            .push_back (std::move (exitB));
     return;
 }
 
@@ -458,7 +597,7 @@ void BuiltinStringCmp::generate (VMFunction& function, VMSymbolTable& st) {
     VMStack* sizeR = st.getStack (5);
     VMStack* temp = st.getStack (6);
 
-    VMBlock entryB;
+    VMBlock entryB (function.arena ());
     entryB.push_new () << "resizestack" << 7;
     entryB.push_new () << "mov" << st.getImm (0) << idx;
     // zero the bytes to use wider subtraction
@@ -471,7 +610,7 @@ void BuiltinStringCmp::generate (VMFunction& function, VMSymbolTable& st) {
     VMLabel* falseL = st.getUniqLabel ();
     VMLabel* trueL = st.getUniqLabel ();
 
-    VMBlock loopB(loopL->nameStreamable());
+    VMBlock loopB (function.arena (), loopL->nameStreamable ());
     loopB.push_new () << "mov cref 0x0" << idx << chrL << st.getImm (1);
     loopB.push_new () << "mov cref 0x1" << idx << chrR << st.getImm (1);
     loopB.push_new () << "tsub" << VM_INT64 << temp << chrL << chrR;
@@ -481,16 +620,16 @@ void BuiltinStringCmp::generate (VMFunction& function, VMSymbolTable& st) {
     loopB.push_new () << "jge" << trueL << VM_UINT64 << idx << sizeR;
     loopB.push_new () << "jmp" << loopL;
 
-    VMBlock trueB(trueL->nameStreamable());
+    VMBlock trueB (function.arena (), trueL->nameStreamable ());
     loopB.push_new () << "tsub" << VM_INT64 << temp << sizeL << sizeR;
 
-    VMBlock falseB(falseL->nameStreamable());
+    VMBlock falseB (function.arena (), falseL->nameStreamable ());
     falseB.push_new () << "return" << temp;
 
-    function.push_back (entryB)
-            .push_back (loopB)
-            .push_back (trueB)
-            .push_back (falseB);
+    function.push_back (std::move (entryB))
+            .push_back (std::move (loopB))
+            .push_back (std::move (trueB))
+            .push_back (std::move (falseB));
 }
 
 
@@ -22,6 +22,8 @@
 
 #include <unordered_map>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "VMValue.h"
 #include "VMCode.h"
@@ -60,12 +62,20 @@ public: /* Methods: */
     /// Add function into the pool
     void insert(VMLabel * label, BuiltinFunction const & func);
 
+    /// Add function into the pool, to be found by its signature
+    void insert(std::string const & signature, VMLabel * label,
+                BuiltinFunction const & func);
+
+    /// Label of the function inserted with the signature, or nullptr
+    VMLabel * find(std::string const & signature) const;
+
     /// Generate bodies of inserted functions
     void generateAll(VMCodeSection & code, VMSymbolTable & st);
 
 private: /* Fields: */
 
     std::unordered_map<VMLabel *, std::unique_ptr<BuiltinFunction>> m_functions;
+    std::unordered_map<std::string, VMLabel *> m_signatures;
 
 };
 
@@ -104,10 +114,60 @@ public: /* Methods: */
     std::unique_ptr<BuiltinFunction> clone() const final override
     { return std::make_unique<BuiltinVArith>(m_imop); }
 
+    /// VM instruction of the elementwise operation, nullptr if there is none
+    static const char* instructionName (const SecreC::Imop& imop);
+
 private: /* Fields: */
     const SecreC::Imop* const m_imop;
 };
 
+/*******************************************************************************
+  BuiltinVFused
+*******************************************************************************/
+
+/**
+ * Builtin loop computing a chain of vectorised arithmetic operations
+ * elementwise, without storing the intermediate results in memory. Takes
+ * the destination, the inputs and the number of elements as arguments.
+ */
+class __attribute__ ((visibility("internal"))) BuiltinVFused final
+    : public BuiltinFunction
+{
+public: /* Types: */
+
+    struct Input {
+        VMDataType type;
+        bool isScalar;  ///< Value used for every element, not an array.
+    };
+
+    struct Step {
+        const char* name;           ///< VM instruction.
+        VMDataType argType;
+        std::vector<unsigned> args; ///< Inputs, followed by the results of steps.
+    };
+
+public: /* Methods: */
+    BuiltinVFused (std::vector<Input> inputs, std::vector<Step> steps,
+                   VMDataType destType)
+        : m_inputs (std::move (inputs))
+        , m_steps (std::move (steps))
+        , m_destType (destType)
+    { }
+
+    void generate(VMFunction & function, VMSymbolTable & st) final override;
+
+    std::unique_ptr<BuiltinFunction> clone() const final override
+    { return std::make_unique<BuiltinVFused>(m_inputs, m_steps, m_destType); }
+
+    /// Equal for the functions that generate the same code
+    std::string signature () const;
+
+private: /* Fields: */
+    const std::vector<Input> m_inputs;
+    const std::vector<Step>  m_steps;
+    const VMDataType         m_destType;
+};
+
 /*******************************************************************************
   BuiltinFloatToInt
 *******************************************************************************/
@@ -20,6 +20,7 @@
 #include "Compiler.h"
 
 #include <iostream>
+#include <iterator>
 
 #include <libscc/Blocks.h>
 #include <libscc/Constant.h>
@@ -27,15 +28,19 @@
 #include <libscc/Intermediate.h>
 #include <libscc/Optimizer.h>
 #include <libscc/SecurityType.h>
+#include <libscc/SyscallName.h>
 #include <libscc/TreeNode.h>
 #include <libscc/Types.h>
 #include <libscc/analysis/LiveVariables.h>
 #include "Builtin.h"
+#include "DebugMap.h"
+#include "Peephole.h"
 #include "RegisterAllocator.h"
 #include "StringLiterals.h"
 #include "SyscallManager.h"
 #include "VMDataType.h"
 #include "VMValue.h"
+#include "VectorFusion.h"
 
 
 namespace SecreCC {
@@ -134,42 +139,6 @@ VMLabel* getProc (VMSymbolTable& st, const Symbol* sym) {
     return static_cast<VMLabel*>(label);
 }
 
-void syscallMangleImopType (std::ostream& os, Imop::Type iType) {
-    switch (iType) {
-    case Imop::CLASSIFY:   os << "classify";    break;
-    case Imop::DECLASSIFY: os << "declassify";  break;
-    case Imop::RELEASE:    os << "delete";      break;
-    case Imop::COPY:       os << "copy";        break;
-    case Imop::STORE:      os << "store";       break;
-    case Imop::LOAD:       os << "load";        break;
-    default:                                    break;
-    }
-}
-
-void syscallMangleSecrecDataType (std::ostream& os, SecrecDataType ty) {
-    switch (ty) {
-    case DATATYPE_BOOL:        os << "bool";         break;
-    case DATATYPE_UINT8:       os << "uint8";        break;
-    case DATATYPE_UINT16:      os << "uint16";       break;
-    case DATATYPE_UINT32:      os << "uint32";       break;
-    case DATATYPE_UINT64:      os << "uint64";       break;
-    case DATATYPE_INT8:        os << "int8";         break;
-    case DATATYPE_INT16:       os << "int16";        break;
-    case DATATYPE_INT32:       os << "int32";        break;
-    case DATATYPE_INT64:       os << "int64";        break;
-    case DATATYPE_FLOAT32:     os << "float32";      break;
-    case DATATYPE_FLOAT64:     os << "float64";      break;
-    default:                                         break;
-    }
-}
-
-void syscallMangleNamespace (std::ostream& os, const TypeNonVoid* tnv) {
-    if (tnv->secrecSecType ()->isPrivate ()) {
-        const auto secTy = static_cast<const PrivateSecType*>(tnv->secrecSecType ());
-        os << secTy->securityKind ()->name () << "::";
-    }
-}
-
 bool isPrivate (const Imop& imop) {
     for (const Symbol* sym : imop.operands ()) {
         if (!sym)
@@ -183,6 +152,17 @@ bool isPrivate (const Imop& imop) {
     return false;
 }
 
+/**
+ * Name of the system call that implements the private instruction. The names
+ * come from privateSyscalls so that the cost report of sca counts exactly
+ * the calls emitted here.
+ */
+std::string privateSyscallName (const Imop& imop, std::size_t index = 0u) {
+    const std::vector<PrivateSyscall> calls = privateSyscalls (imop);
+    assert (index < calls.size ());
+    return calls[index].name;
+}
+
 bool isStringRelated (const Imop& imop) {
     for (const Symbol* sym : imop.operands ()) {
         if (!sym)
@@ -204,102 +184,23 @@ VMLabel* getPD (SyscallManager & scm, const Symbol* sym) {
     return scm.getPd(pty);
 }
 
-class SyscallName {
-public: /* Methods: */
-    SyscallName () { }
-
-    SyscallName& operator << (const char* name) {
-        m_os << name;
-        return *this;
-    }
-
-    SyscallName& operator << (char c) {
-        m_os << c;
-        return *this;
-    }
-
-    SyscallName& operator << (const std::string& name) {
-        m_os << name;
-        return *this;
-    }
-
-    SyscallName& operator << (const TypeNonVoid* tnv) {
-        syscallMangleNamespace (m_os, tnv);
-        return *this;
-    }
-
-    SyscallName& operator << (Imop::Type iType) {
-        syscallMangleImopType (m_os, iType);
-        return *this;
-    }
-
-    SyscallName& operator << (SecrecDataType ty) {
-        syscallMangleSecrecDataType (m_os, ty);
-        return *this;
-    }
-
-
-    SyscallName& operator << (const DataType* ty) {
-        assert(ty);
-        assert (ty->isPrimitive ());
-
-        if (ty->isBuiltinPrimitive ()) {
-            syscallMangleSecrecDataType (m_os, static_cast<const DataTypeBuiltinPrimitive*>(ty)->secrecDataType ());
-        }
-        else {
-            m_os << static_cast<const DataTypeUserPrimitive*> (ty)-> name ();
-        }
-
-        return *this;
-    }
-
-    std::string str () const {
-        return m_os.str ();
-    }
-
-    static std::string tostring (SecrecDataType dType);
-    static std::string tostring (const DataType* dType);
-    static std::string basic (const TypeNonVoid* ty, const char* name, bool needDataType = true, bool needVec = true);
-
-private: /* Fields: */
-    std::ostringstream   m_os;
-};
-
-std::string SyscallName::tostring (SecrecDataType dType) {
-    SyscallName scname;
-    scname << dType << "_toString";
-    return scname.str ();
-}
-
-std::string SyscallName::tostring (const DataType* dType) {
-    assert(dType);
-    assert (dType->isBuiltinPrimitive ());
-    return tostring (static_cast<const DataTypeBuiltinPrimitive*>(dType)->secrecDataType ());
-}
-
-
-std::string SyscallName::basic (const TypeNonVoid* ty, const char* name,  bool needDataType, bool needVec) {
-    SyscallName scname;
-    scname << ty << name;
-    if (needDataType) {
-        scname << '_' << ty->secrecDataType ();
-    }
-
-    if (needVec) {
-        scname << "_vec";
-    }
-
-    return scname.str ();
-}
-
 class Compiler {
 
 public: /* Methods: */
 
-    Compiler(VMLinkingUnit & vmlu, SecreC::ICode & code);
+    Compiler(VMLinkingUnit & vmlu, SecreC::ICode & code,
+             unsigned linearScanThreshold, DebugMap * debugMap);
     Compiler (const Compiler&) = delete;
     Compiler& operator = (const Compiler&) = delete;
 
+    CompilerStats stats () const {
+        CompilerStats out;
+        out.registerAllocator = m_ra.stats ();
+        out.peephole = m_peephole;
+        out.vectorFusion = m_fusion.stats ();
+        return out;
+    }
+
 private:
 
     void cgProcedure (const SecreC::Procedure& blocks);
@@ -322,6 +223,7 @@ private:
     void cgParam (VMBlock& block, const SecreC::Imop& imop);
     void cgReturn (VMBlock& block, const SecreC::Imop& imop);
     void cgArithm (VMBlock& block, const SecreC::Imop& imop);
+    void cgFusedArithm (VMBlock& block, const FusedVectorOp& fused);
     void cgAlloc (VMBlock& block, const SecreC::Imop& imop);
     void cgRelease (VMBlock& block, const SecreC::Imop& imop);
     void cgStore (VMBlock& block, const SecreC::Imop& imop);
@@ -339,8 +241,9 @@ private:
     /**
      * Operations performed through syscalls:
      */
-    void cgNewPrivate (VMBlock& block, const SecreC::Symbol* dest, const SecreC::Symbol* size);
-    void cgNewPrivateScalar (VMBlock& block, const SecreC::Symbol* dest);
+    void cgNewPrivate (VMBlock& block, const SecreC::Symbol* dest, const SecreC::Symbol* size,
+                       const std::string& name);
+    void cgNewPrivateScalar (VMBlock& block, const SecreC::Symbol* dest, const std::string& name);
     void emitSyscall (VMBlock& block, VMValue* dest, const std::string& name);
     void emitSyscall (VMBlock& block, const std::string& name);
     void cgPrivateAssign (VMBlock& block, const SecreC::Imop& imop);
@@ -349,6 +252,8 @@ private:
     void cgPrivateRelease (VMBlock& block, const SecreC::Imop& imop);
     void cgPrivateLoad (VMBlock& block, const SecreC::Imop& imop);
     void cgPrivateStore (VMBlock& block, const SecreC::Imop& imop);
+    void cgGather (VMBlock& block, const SecreC::Imop& imop);
+    void cgScatter (VMBlock& block, const SecreC::Imop& imop);
 
     /**
      * Convenience operations:
@@ -364,16 +269,20 @@ private:
 private: /* Fields: */
 
     std::shared_ptr<VMCodeSection> m_target;   ///< Target code
-    VMSymbolTable         m_st;       ///< VM symbol table
+    VMSymbolTable&        m_st;       ///< VM symbol table of the linking unit
     unsigned              m_param = 0;///< Current param count
     BuiltinFunctions      m_funcs;    ///< Bult-in functions
     RegisterAllocator     m_ra;       ///< Register allocator
     SyscallManager        m_scm;      ///< The syscall manager
     StringLiterals        m_strLit;   ///< String literals
+    PeepholeStats         m_peephole; ///< Peephole optimizer statistics
+    VectorFusion          m_fusion;   ///< Fused vector operations of the block
 };
 
-Compiler::Compiler(VMLinkingUnit & vmlu, SecreC::ICode & code)
-    : m_ra(m_st)
+Compiler::Compiler(VMLinkingUnit & vmlu, SecreC::ICode & code,
+                   unsigned linearScanThreshold, DebugMap * debugMap)
+    : m_st(vmlu.symbolTable())
+    , m_ra(m_st)
     , m_scm(m_st)
     , m_strLit(m_st)
 {
@@ -381,7 +290,7 @@ Compiler::Compiler(VMLinkingUnit & vmlu, SecreC::ICode & code)
     auto rodataSec(std::make_shared<VMDataSection>(VMDataSection::RODATA));
     auto pdSec(std::make_shared<VMBindingSection>("PDBIND"));
     auto scSec(std::make_shared<VMBindingSection>("BIND"));
-    auto codeSec(std::make_shared<VMCodeSection>());
+    auto codeSec(std::make_shared<VMCodeSection>(vmlu.arena()));
 
     auto lv(std::make_unique<LiveVariables>());
     DataFlowAnalysisRunner ()
@@ -390,6 +299,7 @@ Compiler::Compiler(VMLinkingUnit & vmlu, SecreC::ICode & code)
 
     m_target = codeSec;
     m_ra.init(std::move(lv));
+    m_ra.setLinearScanThreshold(linearScanThreshold);
     m_scm.init(scSec, pdSec);
     m_strLit.init(rodataSec);
 
@@ -410,6 +320,8 @@ Compiler::Compiler(VMLinkingUnit & vmlu, SecreC::ICode & code)
 
     m_funcs.generateAll (*m_target, m_st);
     m_target->setNumGlobals (m_ra.globalCount ());
+    if (debugMap)
+        debugMap->compute (*m_target);
 
     vmlu.addSection(std::move(pdSec));
     vmlu.addSection(std::move(scSec));
@@ -467,19 +379,21 @@ void Compiler::cgProcedure (const Procedure& blocks) {
     else
         label = getProc (m_st, blocks.name ());
     m_param = 0;
-    VMFunction function(label->nameStreamable());
+    VMFunction function(m_target->arena(), label->nameStreamable());
     if (!blocks.name())
         function.setIsStart ();
+    function.setProcedure (&blocks);
 
-    m_ra.enterFunction (function);
+    m_ra.enterFunction (function, blocks);
     for (const Block& block : blocks) {
         if (block.reachable ()) {
             cgBlock (function, block);
         }
     }
 
+    peepholeOptimize (function, m_peephole);
     m_ra.exitFunction (function);
-    m_target->push_back (function);
+    m_target->push_back (std::move (function));
 }
 
 void Compiler::cgBlock (VMFunction& function, const Block& block) {
@@ -487,13 +401,21 @@ void Compiler::cgBlock (VMFunction& function, const Block& block) {
     if (block.hasIncomingJumps())
         nameStreamable = getLabel(m_st, block)->nameStreamable();
 
-    VMBlock vmBlock(nameStreamable);
+    VMBlock vmBlock(function.arena(), nameStreamable);
     m_ra.enterBlock(block);
+    m_fusion.analyse (block, m_ra.liveVariables ());
     for (const Imop& imop : block) {
+        const auto last = vmBlock.empty () ? vmBlock.end () : std::prev (vmBlock.end ());
         cgImop (vmBlock, imop);
+        for (auto it = last == vmBlock.end () ? vmBlock.begin () : std::next (last);
+             it != vmBlock.end (); ++ it)
+        {
+            it->setOrigin (&imop);
+        }
     }
 
-    function.push_back (vmBlock);
+    m_ra.exitBlock(block);
+    function.push_back (std::move (vmBlock));
 }
 
 void Compiler::cgJump (VMBlock& block, const Imop& imop) {
@@ -534,7 +456,7 @@ void Compiler::cgJump (VMBlock& block, const Imop& imop) {
 void Compiler::cgDeclare (VMBlock& block, const Imop& imop) {
     assert (imop.dest ());
     if (imop.dest ()->secrecType ()->secrecSecType ()->isPrivate ()) {
-        cgNewPrivateScalar (block, imop.dest ());
+        cgNewPrivateScalar (block, imop.dest (), privateSyscallName (imop));
     }
 }
 
@@ -950,6 +872,11 @@ void Compiler::cgArithm (VMBlock& block, const Imop& imop) {
     assert (ty != VM_INVALID);
 
     if (imop.isVectorized ()) {
+        if (const FusedVectorOp* fused = m_fusion.find (imop)) {
+            cgFusedArithm (block, *fused);
+            return;
+        }
+
         for (const Symbol* sym : imop.operands ()) {
             block.push_new () << "push" << find (sym);
         }
@@ -980,6 +907,22 @@ void Compiler::cgArithm (VMBlock& block, const Imop& imop) {
     block.push_back (instr);
 }
 
+void Compiler::cgFusedArithm (VMBlock& block, const FusedVectorOp& fused) {
+    for (const Symbol* sym : fused.operands) {
+        m_ra.useSymbol (sym);
+        block.push_new () << "push" << find (sym);
+    }
+
+    const std::string signature = fused.function.signature ();
+    VMLabel* target = m_funcs.find (signature);
+    if (target == nullptr) {
+        target = m_st.getUniqLabel (":fused_vec_");
+        m_funcs.insert (signature, target, fused.function);
+    }
+
+    block.push_new () << "call" << target << "imm";
+}
+
 void Compiler::cgDomainID (VMBlock& block, const Imop& imop) {
     assert(dynamic_cast<SymbolDomain const *>(imop.arg1()));
     const SymbolDomain* dom = static_cast<const SymbolDomain*>(imop.arg1 ());
@@ -1067,8 +1010,8 @@ void Compiler::cgPrint (VMBlock& block, const Imop& imop) {
 
 void Compiler::cgComment(VMBlock & block, const Imop & imop) {
     assert(dynamic_cast<ConstantString const *>(imop.arg1()));
-    block.push_new() << "#" <<
-        static_cast<ConstantString const *>(imop.arg1())->value().str();
+    block.push_new() << "#" << m_target->arena().copy(
+        static_cast<ConstantString const *>(imop.arg1())->value().str());
 }
 
 void Compiler::cgError (VMBlock& block, const Imop& imop) {
@@ -1081,6 +1024,9 @@ void Compiler::cgImop (VMBlock& block, const Imop& imop) {
 
     m_ra.getReg (imop);
 
+    if (m_fusion.isRemoved (imop))
+        return;
+
     if (imop.isJump ()) {
         cgJump (block, imop);
         return;
@@ -1123,6 +1069,12 @@ void Compiler::cgImop (VMBlock& block, const Imop& imop) {
     case Imop::STORE:
         cgStore (block, imop);
         return;
+    case Imop::GATHER:
+        cgGather (block, imop);
+        return;
+    case Imop::SCATTER:
+        cgScatter (block, imop);
+        return;
     case Imop::CALL:
         cgCall (block, imop);
         return;
@@ -1175,37 +1127,37 @@ void Compiler::cgImop (VMBlock& block, const Imop& imop) {
  */
 
 
-void Compiler::cgNewPrivateScalar (VMBlock& block, const Symbol* dest) {
+void Compiler::cgNewPrivateScalar (VMBlock& block, const Symbol* dest, const std::string& name) {
     VMValue* d = find (dest);
-    const TypeNonVoid* ty = dest->secrecType ();
     block.push_new () << "push" << getPD (m_scm, dest);
     block.push_new () << "push" << m_st.getImm (1);
-    emitSyscall (block, d, SyscallName::basic (ty, "new"));
+    emitSyscall (block, d, name);
 }
 
-void Compiler::cgNewPrivate (VMBlock& block, const Symbol* dest, const Symbol* size) {
+void Compiler::cgNewPrivate (VMBlock& block, const Symbol* dest, const Symbol* size,
+                             const std::string& name)
+{
     VMValue* d = find (dest);
-    const TypeNonVoid* ty = dest->secrecType ();
     block.push_new () << "push" << getPD (m_scm, dest);
     block.push_new () << "push" << find (size);
-    emitSyscall (block, d, SyscallName::basic (ty, "new"));
+    emitSyscall (block, d, name);
 }
 
 void Compiler::cgPrivateAssign (VMBlock& block, const Imop& imop) {
-    const TypeNonVoid* ty = imop.dest ()->secrecType ();
     block.push_new () << "push" << getPD (m_scm, imop.dest ());
     block.push_new () << "push" << find (imop.arg1 ());
     block.push_new () << "push" << find (imop.dest ());
-    emitSyscall (block, SyscallName::basic (ty, "assign"));
+    emitSyscall (block, privateSyscallName (imop));
 }
 
 void Compiler::cgPrivateCopy (VMBlock& block, const Imop& imop) {
-    const TypeNonVoid* ty = imop.dest ()->secrecType ();
-    cgNewPrivate (block, imop.dest (), imop.arg2 ());
+    const std::vector<PrivateSyscall> calls = privateSyscalls (imop);
+    assert (calls.size () == 2u);
+    cgNewPrivate (block, imop.dest (), imop.arg2 (), calls[0].name);
     block.push_new () << "push" << getPD (m_scm, imop.dest ());
     block.push_new () << "push" << find (imop.arg1 ());
     block.push_new () << "push" << find (imop.dest ());
-    emitSyscall (block, SyscallName::basic (ty, "assign"));
+    emitSyscall (block, calls[1].name);
 }
 
 void Compiler::cgClassify (VMBlock& block, const Imop& imop) {
@@ -1213,19 +1165,18 @@ void Compiler::cgClassify (VMBlock& block, const Imop& imop) {
     assert (imop.dest ()->secrecType ()->secrecSecType ()->isPrivate ());
     assert (imop.arg1 ()->secrecType ()->secrecSecType ()->isPublic ());
 
-    const TypeNonVoid* ty = imop.dest ()->secrecType ();
     if (imop.isVectorized ()) {
         block.push_new () << "push" << getPD (m_scm, imop.dest ());
         block.push_new () << "push" << find (imop.dest ());
         block.push_new () << "pushcref" << "mem" << find (imop.arg1 ());
-        emitSyscall (block, SyscallName::basic (ty, "classify"));
     }
     else {
         block.push_new () << "push" << getPD (m_scm, imop.dest ());
         block.push_new () << "push" << find (imop.arg1 ());
         block.push_new () << "push" << find (imop.dest ());
-        emitSyscall (block, SyscallName::basic (ty, "init"));
     }
+
+    emitSyscall (block, privateSyscallName (imop));
 }
 
 void Compiler::cgDeclassify (VMBlock& block, const Imop& imop) {
@@ -1265,59 +1216,90 @@ void Compiler::cgDeclassify (VMBlock& block, const Imop& imop) {
         block.push_new () << "pushrefpart" << find (imop.dest ()) << m_st.getImm (0) << m_st.getImm (size);
     }
 
-    emitSyscall (block, SyscallName::basic (ty, "declassify"));
+    emitSyscall (block, privateSyscallName (imop));
 }
 
 void Compiler::cgPrivateAlloc (VMBlock& block, const Imop& imop) {
-    const TypeNonVoid* ty = imop.dest ()->secrecType ();
+    const std::vector<PrivateSyscall> calls = privateSyscalls (imop);
     VMLabel* pd = getPD (m_scm, imop.dest ());
-    cgNewPrivate (block, imop.dest (), imop.arg1 ());
+    cgNewPrivate (block, imop.dest (), imop.arg1 (), calls.at (0).name);
 
     if (imop.nArgs () == 3) {
-        // Has default value
+        // Has default value, filled from a private or initialized from a public one
+        assert (calls.size () == 2u);
         block.push_new () << "push" << pd;
         block.push_new () << "push" << find (imop.arg2 ());
         block.push_new () << "push" << find (imop.dest ());
-        const bool privateArg = imop.arg2 ()->secrecType ()->secrecSecType ()->isPrivate ();
-        emitSyscall (block, SyscallName::basic (ty, privateArg ? "fill" : "init"));
+        emitSyscall (block, calls[1].name);
     }
 }
 
 void Compiler::cgPrivateRelease (VMBlock& block, const Imop& imop) {
-    const TypeNonVoid* ty = imop.arg1 ()->secrecType ();
     block.push_new () << "push" << getPD (m_scm, imop.arg1 ());
     block.push_new () << "push" << find (imop.arg1 ());
-    emitSyscall (block, SyscallName::basic (ty, "delete"));
+    emitSyscall (block, privateSyscallName (imop));
 }
 
 void Compiler::cgPrivateLoad (VMBlock& block, const Imop& imop) {
-    const TypeNonVoid* ty = imop.dest ()->secrecType ();
     block.push_new () << "push" << getPD (m_scm, imop.dest ());
     block.push_new () << "push" << find (imop.arg1 ());
     block.push_new () << "push" << find (imop.arg2 ());
     block.push_new () << "push" << find (imop.dest ());
-    emitSyscall (block, SyscallName::basic (ty, "load"));
+    emitSyscall (block, privateSyscallName (imop));
 }
 
 void Compiler::cgPrivateStore (VMBlock& block, const Imop& imop) {
-    const TypeNonVoid* ty = imop.dest ()->secrecType ();
     block.push_new () << "push" << getPD (m_scm, imop.dest ());
     block.push_new () << "push" << find (imop.arg2 ());
     block.push_new () << "push" << find (imop.arg1 ());
     block.push_new () << "push" << find (imop.dest ());
-    emitSyscall (block, SyscallName::basic (ty, "store"));
+    emitSyscall (block, privateSyscallName (imop));
+}
+
+/**
+ * Gather and scatter pass the public offset vector by reference so that the
+ * whole slice is moved with a single syscall.
+ */
+
+void Compiler::cgGather (VMBlock& block, const Imop& imop) {
+    assert (imop.type () == Imop::GATHER);
+    assert (imop.dest ()->secrecType ()->secrecSecType ()->isPrivate ());
+    assert (imop.arg2 ()->secrecType ()->secrecSecType ()->isPublic ());
+    block.push_new () << "push" << getPD (m_scm, imop.dest ());
+    block.push_new () << "push" << find (imop.arg1 ());
+    block.push_new () << "pushcref" << "mem" << find (imop.arg2 ());
+    block.push_new () << "push" << find (imop.dest ());
+    emitSyscall (block, privateSyscallName (imop));
+}
+
+void Compiler::cgScatter (VMBlock& block, const Imop& imop) {
+    assert (imop.type () == Imop::SCATTER);
+    assert (imop.dest ()->secrecType ()->secrecSecType ()->isPrivate ());
+    assert (imop.arg1 ()->secrecType ()->secrecSecType ()->isPublic ());
+    block.push_new () << "push" << getPD (m_scm, imop.dest ());
+    block.push_new () << "push" << find (imop.arg2 ());
+    block.push_new () << "pushcref" << "mem" << find (imop.arg1 ());
+    block.push_new () << "push" << find (imop.dest ());
+    emitSyscall (block, privateSyscallName (imop));
 }
 
 } // anonymous namespace
 
-void compile(VMLinkingUnit & vmlu, SecreC::ICode & code, bool optimize) {
+void compile(VMLinkingUnit & vmlu, SecreC::ICode & code, bool optimize,
+             unsigned linearScanThreshold,
+             CompilerStats * stats,
+             DebugMap * debugMap)
+{
     if (optimize) {
         optimizeCode(code);
+        scheduleInstructions(code);
     } else {
         removeUnreachableBlocks(code);
         eliminateDeadVariables(code);
     }
-    Compiler(vmlu, code);
+    const Compiler compiler(vmlu, code, linearScanThreshold, debugMap);
+    if (stats)
+        *stats = compiler.stats ();
 }
 
 } // namespace SecreCC
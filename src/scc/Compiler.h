@@ -20,12 +20,33 @@
 #ifndef CODEGEN_H
 #define CODEGEN_H
 
+#include "Peephole.h"
+#include "RegisterAllocator.h"
+#include "VectorFusion.h"
+
 namespace SecreC { class ICode; }
 namespace SecreCC {
 
+class DebugMap;
 class VMLinkingUnit;
 
-void compile(VMLinkingUnit & vmlu, SecreC::ICode & code, bool optimize);
+struct __attribute__ ((visibility("internal"))) CompilerStats {
+    RegisterAllocatorStats registerAllocator;
+    PeepholeStats          peephole;
+    VectorFusionStats      vectorFusion;
+};
+
+/**
+ * \param linearScanThreshold procedures of at least this many instructions
+ *        get their registers allocated by linear scan
+ * \param stats if not nullptr, set to the statistics of code generation
+ * \param debugMap if not nullptr, set to the map from the generated code to
+ *        the source
+ */
+void compile(VMLinkingUnit & vmlu, SecreC::ICode & code, bool optimize,
+             unsigned linearScanThreshold,
+             CompilerStats * stats = nullptr,
+             DebugMap * debugMap = nullptr);
 
 } // namespace SecreCC
 
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "DebugMap.h"
+
+#include "VMCode.h"
+
+#include <libscc/Blocks.h>
+#include <libscc/Imop.h>
+#include <libscc/Location.h>
+#include <libscc/Symbol.h>
+#include <libscc/TreeNode.h>
+
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+
+
+namespace SecreCC {
+
+namespace /* anonymous */ {
+
+std::string procedureName (const SecreC::Procedure* proc) {
+    if (proc == nullptr)
+        return std::string ();
+    if (proc->name () == nullptr)
+        return "<entry>";
+    return proc->name ()->procedureName ().str ();
+}
+
+DebugMap::Source sourceOf (const SecreC::Location* loc) {
+    DebugMap::Source out;
+    if (loc != nullptr) {
+        out.file = loc->filename ();
+        out.line = loc->firstLine ();
+        out.column = loc->firstColumn ();
+    }
+
+    return out;
+}
+
+bool operator == (const DebugMap::Source& a, const DebugMap::Source& b) {
+    return a.file == b.file && a.line == b.line && a.column == b.column;
+}
+
+void writeString (std::ostream& os, const std::string& str) {
+    os << '"';
+    for (char c : str) {
+        switch (c) {
+        case '"':  os << "\\\""; break;
+        case '\\': os << "\\\\"; break;
+        case '\n': os << "\\n";  break;
+        case '\t': os << "\\t";  break;
+        default:
+            if (static_cast<unsigned char> (c) < 0x20) {
+                os << "\\u" << std::hex << std::setw (4) << std::setfill ('0')
+                   << static_cast<int> (c) << std::dec << std::setfill (' ');
+            }
+            else {
+                os << c;
+            }
+        }
+    }
+
+    os << '"';
+}
+
+void writeSource (std::ostream& os, const DebugMap::Source& source) {
+    if (source.file.empty ())
+        return;
+
+    os << ", \"file\": ";
+    writeString (os, source.file);
+    os << ", \"line\": " << source.line
+       << ", \"column\": " << source.column;
+}
+
+} // anonymous namespace
+
+/*******************************************************************************
+  DebugMap
+*******************************************************************************/
+
+void DebugMap::compute (const VMCodeSection& code) {
+    m_functions.clear ();
+    m_ranges.clear ();
+
+    std::size_t offset = code.resizeStack ().codeBlocks ();
+
+    for (const VMFunction& function : code) {
+        std::ostringstream label;
+        function.name ()->streamTo (label);
+
+        Function f;
+        f.label = label.str ();
+        f.procedure = procedureName (function.procedure ());
+        f.offset = offset;
+        if (function.procedure () != nullptr && function.procedure ()->name () != nullptr)
+            f.source = sourceOf (function.procedure ()->name ()->location ());
+        m_functions.push_back (f);
+
+        offset += function.resizeStack ().codeBlocks ();
+
+        for (const VMBlock& block : function) {
+            for (const VMInstruction& instr : block) {
+                const std::size_t size = instr.codeBlocks ();
+                const SecreC::Imop* imop = instr.origin ();
+                if (size == 0u || imop == nullptr || imop->creator () == nullptr) {
+                    offset += size;
+                    continue;
+                }
+
+                const Source source = sourceOf (&imop->creator ()->location ());
+                if (! m_ranges.empty () && m_ranges.back ().end == offset &&
+                    m_ranges.back ().function == f.label &&
+                    m_ranges.back ().source == source)
+                {
+                    m_ranges.back ().end += size;
+                }
+                else {
+                    m_ranges.push_back (Range {offset, offset + size, f.label,
+                                               f.procedure, source});
+                }
+
+                offset += size;
+            }
+        }
+    }
+}
+
+void DebugMap::writeJson (std::ostream& os) const {
+    os << "{\n  \"functions\": [";
+    bool first = true;
+    for (const Function& f : m_functions) {
+        os << (first ? "\n" : ",\n") << "    {\"label\": ";
+        first = false;
+        writeString (os, f.label);
+        os << ", \"offset\": " << f.offset;
+        if (! f.procedure.empty ()) {
+            os << ", \"procedure\": ";
+            writeString (os, f.procedure);
+        }
+
+        writeSource (os, f.source);
+        os << '}';
+    }
+
+    os << (first ? "],\n" : "\n  ],\n") << "  \"instructions\": [";
+    first = true;
+    for (const Range& r : m_ranges) {
+        os << (first ? "\n" : ",\n") << "    {\"begin\": " << r.begin
+           << ", \"end\": " << r.end << ", \"function\": ";
+        first = false;
+        writeString (os, r.function);
+        os << ", \"procedure\": ";
+        writeString (os, r.procedure);
+        writeSource (os, r.source);
+        os << '}';
+    }
+
+    os << (first ? "]\n" : "\n  ]\n") << "}\n";
+}
+
+} // namespace SecreCC
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef DEBUG_MAP_H
+#define DEBUG_MAP_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+
+namespace SecreCC {
+
+class VMCodeSection;
+
+/*******************************************************************************
+  DebugMap
+*******************************************************************************/
+
+/**
+ * Map from the generated code back to the SecreC source, for attributing
+ * samples of a running program to source lines. Offsets are positions in the
+ * code blocks of the assembled code section, starting from 0, as the VM
+ * counts them: an instruction takes a block for its opcode and one for each
+ * of its arguments. Labels, comments and directives take none.
+ */
+class __attribute__ ((visibility("internal"))) DebugMap {
+public: /* Types: */
+
+    struct Source {
+        std::string file;           ///< Empty if the source is unknown.
+        std::size_t line = 0u;
+        std::size_t column = 0u;
+    };
+
+    struct Function {
+        std::string label;
+        std::string procedure;      ///< Empty for builtin functions.
+        std::size_t offset;         ///< Code block of the first instruction.
+        Source      source;         ///< Definition of the procedure.
+    };
+
+    /// Consecutive instructions generated from the same source location.
+    struct Range {
+        std::size_t begin;
+        std::size_t end;            ///< One past the last code block.
+        std::string function;       ///< Label of the enclosing function.
+        std::string procedure;
+        Source      source;
+    };
+
+public: /* Methods: */
+
+    /// Run after the code section is complete, while the intermediate code is alive.
+    void compute (const VMCodeSection& code);
+
+    const std::vector<Function>& functions () const { return m_functions; }
+    const std::vector<Range>& ranges () const { return m_ranges; }
+
+    /// Writes the map as a JSON object.
+    void writeJson (std::ostream& os) const;
+
+private: /* Fields: */
+    std::vector<Function>   m_functions;
+    std::vector<Range>      m_ranges;
+};
+
+} // namespace SecreCC
+
+#endif // DEBUG_MAP_H
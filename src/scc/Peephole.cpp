@@ -0,0 +1,424 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "Peephole.h"
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "VMCode.h"
+
+
+namespace SecreCC {
+
+namespace /* anonymous */ {
+
+typedef VMBlock::iterator Iter;
+
+/*******************************************************************************
+  Instructions
+*******************************************************************************/
+
+bool isComment (const VMInstruction& instr) {
+    return instr.opcode () == VMInstruction::COMMENT;
+}
+
+bool isMove (const VMInstruction& instr) {
+    return instr.size () == 3u && instr.opcode () == VMInstruction::MOV &&
+           instr.value (1u) && instr.value (2u);
+}
+
+/// "jmp L"
+bool isUnconditionalJump (const VMInstruction& instr) {
+    return instr.size () == 2u && instr.opcode () == VMInstruction::JMP &&
+           instr.isLabel (1u);
+}
+
+/// "jnz L type R" or "jz L type R"
+bool isConditionalJump (const VMInstruction& instr) {
+    return instr.size () == 4u &&
+           (instr.opcode () == VMInstruction::JNZ ||
+            instr.opcode () == VMInstruction::JZ) &&
+           instr.isLabel (1u);
+}
+
+bool isJump (const VMInstruction& instr) {
+    return isUnconditionalJump (instr) || isConditionalJump (instr);
+}
+
+/// Instructions that never continue with the next one.
+bool isTerminator (const VMInstruction& instr) {
+    return isUnconditionalJump (instr) ||
+           instr.opcode () == VMInstruction::RETURN ||
+           instr.opcode () == VMInstruction::HALT;
+}
+
+bool isReferenced (Iter first, Iter last, const OStreamable* value) {
+    return std::any_of (first, last, [&value](const VMInstruction& instr) {
+        return instr.refersTo (value);
+    });
+}
+
+/*******************************************************************************
+  Patterns
+*******************************************************************************/
+
+/**
+ * A rewrite of the instructions starting at the iterator. If it applies, the
+ * iterator is left at the first instruction that may start another match.
+ */
+typedef bool (*Rewrite) (VMBlock& block, Iter& it, PeepholeStats& stats);
+
+/**
+ * mov imm C T; jnz L type T  =>  jmp L     (C != 0)
+ * mov imm C T; jnz L type T  =>            (C == 0)
+ * and the other way round for jz. Constants loaded for jumps by the code
+ * generator. As the jump ends the block, the temporary is dead after it.
+ */
+bool foldConstantJump (VMBlock& block, Iter& it, PeepholeStats& stats) {
+    const Iter next = std::next (it);
+    if (next == block.end ())
+        return false;
+
+    const VMInstruction& mov = *it;
+    const VMInstruction& jump = *next;
+    if (! isMove (mov) || ! mov.isImmediate (1u) || ! mov.isTemporary (2u) ||
+        ! isConditionalJump (jump) || jump.value (3u) != mov.value (2u) ||
+        isReferenced (std::next (next), block.end (), mov.value (2u)))
+    {
+        return false;
+    }
+
+    const bool taken = (jump.opcode () == VMInstruction::JNZ) == (mov.immediate (1u) != 0u);
+    if (taken) {
+        VMInstruction jmp;
+        jmp << "jmp";
+        jmp.append (jump, 1u);
+        jmp.setOrigin (jump.origin ());
+        *next = jmp;
+        it = block.erase (it);
+        stats.removedInstructions += 1u;
+    }
+    else {
+        block.erase (it);
+        it = block.erase (next);
+        stats.removedInstructions += 2u;
+    }
+
+    return true;
+}
+
+/**
+ * mov X T; mov T Y  =>  mov X Y
+ * if the temporary T is not used afterwards.
+ */
+bool forwardTemporary (VMBlock& block, Iter& it, PeepholeStats& stats) {
+    const Iter next = std::next (it);
+    if (next == block.end ())
+        return false;
+
+    const VMInstruction& first = *it;
+    VMInstruction& second = *next;
+    if (! isMove (first) || ! first.isTemporary (2u) || ! isMove (second) ||
+        second.value (1u) != first.value (2u) ||
+        isReferenced (std::next (next), block.end (), first.value (2u)))
+    {
+        return false;
+    }
+
+    second.setOperand (1u, first, 1u);
+    it = block.erase (it);
+    stats.removedInstructions += 1u;
+    return true;
+}
+
+/// mov X X  =>
+bool removeMoveToItself (VMBlock& block, Iter& it, PeepholeStats& stats) {
+    if (! isMove (*it) || it->value (1u) != it->value (2u))
+        return false;
+
+    it = block.erase (it);
+    stats.removedInstructions += 1u;
+    return true;
+}
+
+const Rewrite patterns[] = {
+    foldConstantJump,
+    forwardTemporary,
+    removeMoveToItself
+};
+
+bool rewriteBlock (VMBlock& block, PeepholeStats& stats) {
+    bool changed = false;
+    for (Iter it = block.begin (); it != block.end (); ) {
+        bool applied = false;
+        for (Rewrite rewrite : patterns) {
+            if (rewrite (block, it, stats)) {
+                applied = true;
+                break;
+            }
+        }
+
+        if (applied)
+            changed = true;
+        else
+            ++ it;
+    }
+
+    return changed;
+}
+
+/*******************************************************************************
+  ControlFlow
+*******************************************************************************/
+
+/**
+ * Jumps between the blocks of a function. Blocks are laid out in order and
+ * fall through to the next one unless they end with a terminator.
+ */
+class ControlFlow {
+public: /* Methods: */
+
+    explicit ControlFlow (VMFunction& function) {
+        for (VMBlock& block : function)
+            m_blocks.push_back (&block);
+
+        for (size_t i = 0; i < m_blocks.size (); ++ i) {
+            if (m_blocks[i]->name ())
+                m_labels[m_blocks[i]->name ().get ()] = i;
+        }
+    }
+
+    bool optimize (PeepholeStats& stats) {
+        bool changed = false;
+        for (size_t i = 0; i < m_blocks.size (); ++ i) {
+            changed = threadJump (i, stats) || changed;
+            changed = invertJumpOverJump (i, stats) || changed;
+            changed = removeJumpToNext (i, stats) || changed;
+        }
+
+        changed = removeUnreachable (stats) || changed;
+        changed = removeLabels (stats) || changed;
+        return changed;
+    }
+
+private:
+
+    static VMInstruction* lastInstruction (VMBlock& block) {
+        for (auto it = block.end (); it != block.begin (); ) {
+            -- it;
+            if (! isComment (*it))
+                return &*it;
+        }
+
+        return nullptr;
+    }
+
+    static bool isEmpty (const VMBlock& block) {
+        return std::all_of (block.begin (), block.end (), isComment);
+    }
+
+    /// The jump, if it is the only instruction of the block.
+    static VMInstruction* onlyJump (VMBlock& block) {
+        VMInstruction* out = nullptr;
+        for (VMInstruction& instr : block) {
+            if (isComment (instr))
+                continue;
+            if (out != nullptr || ! isUnconditionalJump (instr))
+                return nullptr;
+            out = &instr;
+        }
+
+        return out;
+    }
+
+    size_t findBlock (const OStreamable* label) const {
+        auto it = m_labels.find (label);
+        return it == m_labels.end () ? m_blocks.size () : it->second;
+    }
+
+    /**
+     * jmp L1 ... L1: jmp L2  =>  jmp L2 ... L1: jmp L2
+     * Jumps into a cycle of blocks that only jump are left alone.
+     */
+    bool threadJump (size_t i, PeepholeStats& stats) {
+        VMInstruction* jump = lastInstruction (*m_blocks[i]);
+        if (jump == nullptr || ! isJump (*jump))
+            return false;
+
+        const VMInstruction* last = nullptr;
+        std::set<size_t> visited;
+        size_t target = findBlock (jump->label (1u));
+        while (target != m_blocks.size ()) {
+            if (! visited.insert (target).second)
+                return false;
+
+            const VMInstruction* next = onlyJump (*m_blocks[target]);
+            if (next == nullptr)
+                break;
+
+            last = next;
+            target = findBlock (next->label (1u));
+        }
+
+        if (last == nullptr)
+            return false;
+
+        jump->setOperand (1u, *last, 1u);
+        ++ stats.threadedJumps;
+        return true;
+    }
+
+    /**
+     * B: jnz L1 type R        B: jz L2 type R
+     * C: jmp L2           =>  C:
+     * L1:                     L1:
+     * if nothing else jumps to C.
+     */
+    bool invertJumpOverJump (size_t i, PeepholeStats& stats) {
+        if (i + 2u >= m_blocks.size ())
+            return false;
+
+        VMInstruction* jump = lastInstruction (*m_blocks[i]);
+        VMBlock& next = *m_blocks[i + 1u];
+        const VMBlock& after = *m_blocks[i + 2u];
+        if (jump == nullptr || ! isConditionalJump (*jump) || next.name () ||
+            ! after.name () || jump->label (1u) != after.name ().get ())
+        {
+            return false;
+        }
+
+        const VMInstruction* skip = onlyJump (next);
+        if (skip == nullptr)
+            return false;
+
+        VMInstruction inverted;
+        inverted << (jump->opcode () == VMInstruction::JNZ ? "jz" : "jnz");
+        inverted.append (*skip, 1u).append (*jump, 2u).append (*jump, 3u);
+        inverted.setOrigin (jump->origin ());
+        *jump = inverted;
+
+        for (Iter it = next.begin (); it != next.end (); ++ it) {
+            if (! isComment (*it)) {
+                next.erase (it);
+                break;
+            }
+        }
+
+        ++ stats.removedInstructions;
+        return true;
+    }
+
+    /// jmp L  L: ...  =>  L: ...
+    bool removeJumpToNext (size_t i, PeepholeStats& stats) {
+        VMBlock& block = *m_blocks[i];
+        VMInstruction* jump = lastInstruction (block);
+        if (jump == nullptr || ! isJump (*jump))
+            return false;
+
+        for (size_t j = i + 1u; j < m_blocks.size (); ++ j) {
+            const VMBlock& next = *m_blocks[j];
+            if (next.name () && jump->label (1u) == next.name ().get ()) {
+                for (Iter it = block.begin (); it != block.end (); ++ it) {
+                    if (&*it == jump) {
+                        block.erase (it);
+                        break;
+                    }
+                }
+
+                ++ stats.removedInstructions;
+                return true;
+            }
+
+            if (! isEmpty (next))
+                break;
+        }
+
+        return false;
+    }
+
+    /// Blocks without a label after a terminator.
+    bool removeUnreachable (PeepholeStats& stats) {
+        bool changed = false;
+        bool reachable = true;
+        for (VMBlock* block : m_blocks) {
+            if (block->name ())
+                reachable = true;
+
+            if (! reachable && ! isEmpty (*block)) {
+                stats.removedInstructions += std::count_if (block->begin (), block->end (),
+                    [](const VMInstruction& instr) { return ! isComment (instr); });
+                block->clear ();
+                changed = true;
+            }
+
+            const VMInstruction* last = lastInstruction (*block);
+            if (last != nullptr && isTerminator (*last))
+                reachable = false;
+        }
+
+        return changed;
+    }
+
+    bool removeLabels (PeepholeStats& stats) {
+        std::set<const OStreamable*> targets;
+        for (VMBlock* block : m_blocks) {
+            for (const VMInstruction& instr : *block) {
+                for (size_t i = 0; i < instr.size (); ++ i) {
+                    if (instr.isLabel (i))
+                        targets.insert (instr.label (i));
+                }
+            }
+        }
+
+        bool changed = false;
+        for (VMBlock* block : m_blocks) {
+            if (block->name () && targets.count (block->name ().get ()) == 0u) {
+                m_labels.erase (block->name ().get ());
+                block->removeName ();
+                ++ stats.removedLabels;
+                changed = true;
+            }
+        }
+
+        return changed;
+    }
+
+private: /* Fields: */
+    std::vector<VMBlock*>                   m_blocks;
+    std::map<const OStreamable*, size_t>    m_labels;   ///< Block names to positions.
+};
+
+} // anonymous namespace
+
+void peepholeOptimize (VMFunction& function, PeepholeStats& stats) {
+    ControlFlow controlFlow (function);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (VMBlock& block : function)
+            changed = rewriteBlock (block, stats) || changed;
+        changed = controlFlow.optimize (stats) || changed;
+    }
+}
+
+} // namespace SecreCC
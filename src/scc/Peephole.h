@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+
+namespace SecreCC {
+
+class VMFunction;
+
+/*******************************************************************************
+  PeepholeStats
+*******************************************************************************/
+
+struct __attribute__ ((visibility("internal"))) PeepholeStats {
+    unsigned removedInstructions = 0u;
+    unsigned threadedJumps = 0u;    ///< Jumps retargeted past blocks that only jump.
+    unsigned removedLabels = 0u;    ///< Labels that no jump targets any more.
+};
+
+/**
+ * Local clean up of the code generated for a function. Rewrites short
+ * sequences of instructions from a table of patterns, threads jumps through
+ * blocks that only jump, removes jumps to the following block and code that
+ * can not be reached, and drops the labels that are no longer jumped to.
+ * Runs before register allocation, as it relies on knowing which registers
+ * are temporaries.
+ */
+void peepholeOptimize (VMFunction& function, PeepholeStats& stats)
+    __attribute__((visibility("internal")));
+
+} // namespace SecreCC
+
+#endif
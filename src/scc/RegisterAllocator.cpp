@@ -20,9 +20,14 @@
 #include "RegisterAllocator.h"
 
 #include <algorithm>
+#include <functional>
 #include <iostream>
+#include <queue>
+#include <unordered_map>
 #include <boost/interprocess/containers/flat_set.hpp>
 
+#include <libscc/Blocks.h>
+#include <libscc/SecurityType.h>
 #include <libscc/Symbol.h>
 #include <libscc/Constant.h>
 #include <libscc/DataflowAnalysis.h>
@@ -78,6 +83,52 @@ void getImm (VMSymbolTable& st, const Symbol* sym) {
     assert(dynamic_cast<VMImm *>(imm));
 }
 
+/// Instruction that is compiled to a single move between registers.
+bool isRegisterMove (const Imop& imop) {
+    if (imop.type () != Imop::ASSIGN || imop.isVectorized ())
+        return false;
+
+    if (imop.arg1 ()->symbolType () != SYM_SYMBOL ||
+        imop.dest ()->secrecType ()->secrecDataType ()->isString ())
+    {
+        return false;
+    }
+
+    return imop.dest ()->secrecType ()->secrecSecType ()->isPublic () &&
+           imop.arg1 ()->secrecType ()->secrecSecType ()->isPublic ();
+}
+
+VMVReg* findReg (const VMSymbolTable& st, const Symbol* sym) {
+    return sym->symbolType () == SYM_SYMBOL ? dynamic_cast<VMVReg*> (st.find (sym)) : nullptr;
+}
+
+unsigned countInstructions (const Procedure& proc) {
+    unsigned out = 0;
+    for (const Block& block : proc) {
+        if (block.reachable ())
+            out += std::distance (block.begin (), block.end ());
+    }
+
+    return out;
+}
+
+/// Adds the time from construction to destruction to the given total.
+class ScopedTimer {
+public: /* Methods: */
+    explicit ScopedTimer (std::chrono::steady_clock::duration& total)
+        : m_total (total)
+        , m_start (std::chrono::steady_clock::now ())
+    { }
+
+    ~ScopedTimer () {
+        m_total += std::chrono::steady_clock::now () - m_start;
+    }
+
+private: /* Fields: */
+    std::chrono::steady_clock::duration&  m_total;
+    std::chrono::steady_clock::time_point m_start;
+};
+
 template <class T, class U>
 inline std::set<T> &operator-=(std::set<T> &dest, const std::set<U> &src) {
     typedef typename std::set<U >::const_iterator Iter;
@@ -257,10 +308,177 @@ private: /* Fields: */
 };
 
 
+/*******************************************************************************
+  RegisterAllocator::LiveIntervals
+*******************************************************************************/
+
+/**
+ * Live intervals of the local registers of a function. Instructions are
+ * numbered in the order they are generated in and an interval spans from
+ * the first to the last instruction a register is live at, including the
+ * ones it is live through at the start or end of a block. Both ends are
+ * inclusive, so a register defined by an instruction never shares its slot
+ * with an operand of the same instruction, unless the instruction is a move
+ * that is coalesced.
+ */
+class RegisterAllocator::LiveIntervals {
+private: /* Types: */
+
+    struct Interval {
+        VMVReg*  reg;
+        unsigned start;
+        unsigned end;
+        size_t   root;  ///< Interval this one is coalesced into, itself if none.
+    };
+
+    struct Move {
+        VMVReg*  src;
+        VMVReg*  dest;
+        unsigned position;
+    };
+
+public: /* Methods: */
+
+    void extend (VMVReg* reg, unsigned position) {
+        auto it = m_index.find (reg);
+        if (it == m_index.end ()) {
+            m_index.emplace (reg, m_intervals.size ());
+            m_intervals.push_back (Interval {reg, position, position, m_intervals.size ()});
+            return;
+        }
+
+        Interval& interval = m_intervals[it->second];
+        interval.start = std::min (interval.start, position);
+        interval.end = std::max (interval.end, position);
+    }
+
+    void addMove (VMVReg* src, VMVReg* dest, unsigned position) {
+        m_moves.push_back (Move {src, dest, position});
+    }
+
+    /**
+     * Coalesces every move whose source dies and destination is born at the
+     * move, and assigns the lowest free slot to every interval in the order
+     * of their start. Returns the number of slots used.
+     */
+    template <typename SlotSetter>
+    unsigned allocate (SlotSetter setSlot) {
+        for (const Move& move : m_moves) {
+            auto src = m_index.find (move.src);
+            auto dest = m_index.find (move.dest);
+            if (src == m_index.end () || dest == m_index.end ())
+                continue;
+
+            const size_t u = findRoot (src->second);
+            const size_t v = findRoot (dest->second);
+            if (u != v && m_intervals[u].end == move.position &&
+                m_intervals[v].start == move.position)
+            {
+                m_intervals[v].root = u;
+                m_intervals[u].end = m_intervals[v].end;
+            }
+        }
+
+        std::vector<size_t> roots;
+        for (size_t i = 0; i < m_intervals.size (); ++ i) {
+            if (m_intervals[i].root == i)
+                roots.push_back (i);
+        }
+
+        std::sort (roots.begin (), roots.end (), [this](size_t a, size_t b) {
+            return m_intervals[a].start < m_intervals[b].start;
+        });
+
+        typedef std::pair<unsigned, unsigned> EndSlot;
+        std::priority_queue<EndSlot, std::vector<EndSlot>, std::greater<EndSlot>> active;
+        std::priority_queue<unsigned, std::vector<unsigned>, std::greater<unsigned>> free;
+        std::vector<unsigned> slots (m_intervals.size ());
+        unsigned count = 0;
+        for (size_t i : roots) {
+            const Interval& interval = m_intervals[i];
+            while (! active.empty () && active.top ().first < interval.start) {
+                free.push (active.top ().second);
+                active.pop ();
+            }
+
+            unsigned slot = count;
+            if (free.empty ()) {
+                ++ count;
+            }
+            else {
+                slot = free.top ();
+                free.pop ();
+            }
+
+            slots[i] = slot;
+            active.emplace (interval.end, slot);
+        }
+
+        for (size_t i = 0; i < m_intervals.size (); ++ i)
+            setSlot (m_intervals[i].reg, slots[findRoot (i)]);
+
+        m_slots.clear ();
+        for (size_t i : roots)
+            m_slots.emplace_back (slots[i], i);
+
+        return count;
+    }
+
+    /**
+     * Checks the last allocation: intervals that were not coalesced must not
+     * overlap if they share a slot.
+     */
+    bool verify () const {
+        std::vector<std::pair<unsigned, size_t>> bySlot (m_slots);
+        std::sort (bySlot.begin (), bySlot.end (),
+            [this](const std::pair<unsigned, size_t>& a, const std::pair<unsigned, size_t>& b) {
+                return a.first != b.first ? a.first < b.first
+                                          : m_intervals[a.second].start < m_intervals[b.second].start;
+            });
+
+        for (size_t k = 1; k < bySlot.size (); ++ k) {
+            const Interval& prev = m_intervals[bySlot[k - 1].second];
+            const Interval& next = m_intervals[bySlot[k].second];
+            if (bySlot[k - 1].first == bySlot[k].first && prev.end >= next.start)
+                return false;
+        }
+
+        return true;
+    }
+
+    void reset () {
+        m_index.clear ();
+        m_intervals.clear ();
+        m_moves.clear ();
+        m_slots.clear ();
+    }
+
+private:
+
+    size_t findRoot (size_t i) {
+        while (m_intervals[i].root != i) {
+            m_intervals[i].root = m_intervals[m_intervals[i].root].root;
+            i = m_intervals[i].root;
+        }
+
+        return i;
+    }
+
+private: /* Fields: */
+
+    std::unordered_map<VMVReg*, size_t> m_index;
+    std::vector<Interval>               m_intervals;
+    std::vector<Move>                   m_moves;
+    std::vector<std::pair<unsigned, size_t>> m_slots; ///< Slot of every uncoalesced interval.
+};
+
+
 /*******************************************************************************
   RegisterAllocator
 *******************************************************************************/
 
+constexpr unsigned RegisterAllocator::DEFAULT_LINEAR_SCAN_THRESHOLD;
+
 RegisterAllocator::RegisterAllocator(VMSymbolTable & st)
     : m_st(st)
     , m_isGlobal(false)
@@ -271,38 +489,89 @@ RegisterAllocator::~RegisterAllocator() = default;
 void RegisterAllocator::init(std::unique_ptr<SecreC::LiveVariables> lv)
 {
     m_inferenceGraph = std::make_unique<InferenceGraph>();
+    m_liveIntervals = std::make_unique<LiveIntervals>();
     m_lv = std::move(lv);
 }
 
-VMVReg* RegisterAllocator::temporaryReg () {
-    VMVReg* reg = m_st.getVReg (m_isGlobal);
-    m_temporaries.push_back (reg);
+void RegisterAllocator::addToGraph (VMVReg* reg) {
     m_inferenceGraph->addNode (reg);
     for (VMVReg* other : m_live) {
         m_inferenceGraph->addEdge (reg, other);
     }
+}
+
+VMVReg* RegisterAllocator::temporaryReg () {
+    ScopedTimer timer (m_time);
+    VMVReg* reg = m_st.getVReg (m_isGlobal);
+    reg->setTemporary ();
+    m_temporaries.push_back (reg);
+    if (m_isLinearScan && ! reg->isGlobal ())
+        m_liveIntervals->extend (reg, m_position);
+    else
+        addToGraph (reg);
 
     m_live.insert (reg);
     return reg;
 }
 
-void RegisterAllocator::enterFunction (VMFunction& function) {
+void RegisterAllocator::enterFunction (VMFunction& function, const SecreC::Procedure& proc) {
     m_isGlobal = function.isStart ();
+    m_isLinearScan = ! m_isGlobal && countInstructions (proc) >= m_linearScanThreshold;
+    m_position = 0u;
+    m_time = std::chrono::steady_clock::duration::zero ();
 }
 
 void RegisterAllocator::exitFunction (VMFunction& function) {
-    if (!m_isGlobal) {
+    if (m_isGlobal)
+        return;
+
+    const auto startTime = std::chrono::steady_clock::now ();
+    RegisterAllocatorStats::Allocator* stats = &m_stats.graphColoring;
+    if (m_isLinearScan) {
+        stats = &m_stats.linearScan;
+        VMSymbolTable& st = m_st;
+        unsigned numLocals = m_liveIntervals->allocate ([&st](VMVReg* reg, unsigned slot) {
+            reg->setActualReg (*st.getStack (slot));
+        });
+
+        // Registers left over from the global function, if any:
+        numLocals = std::max (numLocals, m_inferenceGraph->colorLocal (m_st));
+        function.setNumLocals (numLocals);
+        assert (m_liveIntervals->verify () && "Live intervals that share a slot overlap!");
+        m_liveIntervals->reset ();
+
+        // Moves between coalesced registers:
+        for (VMBlock& block : function) {
+            for (auto it = block.begin (); it != block.end (); ) {
+                if (it->isRedundantMove ()) {
+                    it = block.erase (it);
+                    ++ m_stats.coalescedMoves;
+                }
+                else {
+                    ++ it;
+                }
+            }
+        }
+    }
+    else {
         function.setNumLocals (m_inferenceGraph->colorLocal (m_st));
-        m_inferenceGraph->resetLocal ();
     }
+
+    m_inferenceGraph->resetLocal ();
+    ++ stats->functions;
+    stats->stackSlots += function.numLocals ();
+    stats->time += m_time + (std::chrono::steady_clock::now () - startTime);
 }
 
 unsigned RegisterAllocator::globalCount () {
+    ScopedTimer timer (m_stats.graphColoring.time);
     return m_inferenceGraph->colorGlobal (m_st);
 }
 
 void RegisterAllocator::enterBlock(SecreC::Block const & secrecBlock) {
+    ScopedTimer timer (m_time);
     auto const & in = m_lv->ins(secrecBlock);
+    ++ m_position;
     m_live.clear ();
     for (const Symbol* sym : in) {
         VMValue* reg = m_st.find (sym);
@@ -312,16 +581,34 @@ void RegisterAllocator::enterBlock(SecreC::Block const & secrecBlock) {
         }
 
         assert(dynamic_cast<VMVReg *>(reg));
-        m_live.insert (static_cast<VMVReg*>(reg));
+        VMVReg* vreg = static_cast<VMVReg*>(reg);
+        if (m_isLinearScan && ! vreg->isGlobal ())
+            m_liveIntervals->extend (vreg, m_position);
+
+        m_live.insert (vreg);
+    }
+}
+
+void RegisterAllocator::exitBlock(SecreC::Block const & secrecBlock) {
+    if (! m_isLinearScan)
+        return;
+
+    ScopedTimer timer (m_time);
+    for (const Symbol* sym : m_lv->liveOnExit (secrecBlock)) {
+        VMVReg* vreg = findReg (m_st, sym);
+        if (vreg != nullptr && ! vreg->isGlobal ())
+            m_liveIntervals->extend (vreg, m_position);
     }
 }
 
 void RegisterAllocator::getReg (const SecreC::Imop& imop) {
+    ScopedTimer timer (m_time);
     for (VMVReg* temp : m_temporaries) {
         m_live.erase (temp);
     }
 
     m_temporaries.clear ();
+    ++ m_position;
 
     for (const Symbol* symbol : imop.useRange ()) {
         switch (symbol->symbolType ()) {
@@ -335,9 +622,37 @@ void RegisterAllocator::getReg (const SecreC::Imop& imop) {
         }
     }
 
+    if (m_isLinearScan) {
+        for (const Symbol* symbol : imop.operands ()) {
+            if (symbol == nullptr)
+                continue;
+
+            VMVReg* vreg = findReg (m_st, symbol);
+            if (vreg != nullptr && ! vreg->isGlobal ())
+                m_liveIntervals->extend (vreg, m_position);
+        }
+    }
+
     for (const Symbol* symbol : imop.defRange ()) {
         defSymbol (symbol);
     }
+
+    if (m_isLinearScan && isRegisterMove (imop)) {
+        VMVReg* src = findReg (m_st, imop.arg1 ());
+        VMVReg* dest = findReg (m_st, imop.dest ());
+        if (src != nullptr && dest != nullptr && ! src->isGlobal () && ! dest->isGlobal ())
+            m_liveIntervals->addMove (src, dest, m_position);
+    }
+}
+
+void RegisterAllocator::useSymbol (const Symbol* symbol) {
+    if (! m_isLinearScan)
+        return; // all the symbols of a block interfere in the graph
+
+    ScopedTimer timer (m_time);
+    VMVReg* vreg = findReg (m_st, symbol);
+    if (vreg != nullptr && ! vreg->isGlobal ())
+        m_liveIntervals->extend (vreg, m_position);
 }
 
 void RegisterAllocator::defSymbol (const Symbol* symbol) {
@@ -349,10 +664,10 @@ void RegisterAllocator::defSymbol (const Symbol* symbol) {
 
     assert(dynamic_cast<VMVReg *>(reg));
     VMVReg* vreg = static_cast<VMVReg*>(reg);
-    m_inferenceGraph->addNode (vreg);
-    for (VMVReg* other : m_live) {
-        m_inferenceGraph->addEdge (vreg, other);
-    }
+    if (m_isLinearScan && ! vreg->isGlobal ())
+        m_liveIntervals->extend (vreg, m_position);
+    else
+        addToGraph (vreg);
 
     m_live.insert (vreg);
 }
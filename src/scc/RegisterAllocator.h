@@ -20,6 +20,7 @@
 #ifndef REGISTER_ALLOCATOR_H
 #define REGISTER_ALLOCATOR_H
 
+#include <chrono>
 #include <set>
 #include <stack>
 #include <memory>
@@ -29,6 +30,7 @@ namespace SecreC {
     class Block;
     class Imop;
     class LiveVariables;
+    class Procedure;
     class Symbol;
 } /* namespace SecreC { */
 
@@ -41,10 +43,33 @@ class VMVReg;
 class VMBlock;
 class VMFunction;
 
+/*******************************************************************************
+  RegisterAllocatorStats
+*******************************************************************************/
+
+struct __attribute__ ((visibility("internal"))) RegisterAllocatorStats {
+    struct Allocator {
+        unsigned functions = 0u;    ///< Number of functions allocated.
+        unsigned stackSlots = 0u;   ///< Sum of the stack slots of the functions.
+        std::chrono::steady_clock::duration time {};
+    };
+
+    Allocator graphColoring;
+    Allocator linearScan;
+    unsigned  coalescedMoves = 0u;  ///< Moves removed by the linear scan.
+};
+
 /*******************************************************************************
   RegisterAllocator
 *******************************************************************************/
 
+/**
+ * Assigns the virtual registers of global symbols to registers and the ones
+ * of local symbols to stack slots. Local registers of a function are
+ * allocated by coloring their interference graph, or, for functions of at
+ * least the linear scan threshold instructions, by a linear scan over their
+ * live intervals that also coalesces register moves.
+ */
 class __attribute__ ((visibility("internal"))) RegisterAllocator {
 public: /* Types: */
 
@@ -52,6 +77,10 @@ public: /* Types: */
     typedef std::set<VMVReg*> RegSet;
     typedef std::vector<VMVReg*> RegStack;
 
+public: /* Constants: */
+
+    static constexpr unsigned DEFAULT_LINEAR_SCAN_THRESHOLD = 1000u;
+
 public: /* Methods: */
 
     RegisterAllocator(VMSymbolTable & st);
@@ -59,30 +88,52 @@ public: /* Methods: */
 
     void init(std::unique_ptr<SecreC::LiveVariables> lv);
 
+    /// Functions with at least this many instructions are allocated by linear scan.
+    void setLinearScanThreshold (unsigned threshold) { m_linearScanThreshold = threshold; }
+
+    const RegisterAllocatorStats& stats () const { return m_stats; }
+
+    const SecreC::LiveVariables& liveVariables () const { return *m_lv; }
+
     VMVReg* temporaryReg ();
 
-    void enterFunction (VMFunction& function);
+    void enterFunction (VMFunction& function, const SecreC::Procedure& proc);
     void exitFunction (VMFunction& function);
     void enterBlock(SecreC::Block const & secrecBlock);
+    void exitBlock(SecreC::Block const & secrecBlock);
 
     unsigned globalCount ();
 
     void getReg (const SecreC::Imop& imop);
 
+    /// The symbol is used by the current instruction, in addition to its operands.
+    void useSymbol (const SecreC::Symbol* symbol);
+
 protected:
 
     void defSymbol (const SecreC::Symbol* symbol);
 
+private:
+
+    void addToGraph (VMVReg* reg);
+
 private: /* Fields: */
 
     class InferenceGraph;
+    class LiveIntervals;
 
     VMSymbolTable &         m_st;
     std::unique_ptr<SecreC::LiveVariables> m_lv; ///< Pointer to live variables.
     std::unique_ptr<InferenceGraph> m_inferenceGraph;
+    std::unique_ptr<LiveIntervals> m_liveIntervals;
     RegSet                  m_live;
     RegStack                m_temporaries;
     bool                    m_isGlobal;
+    bool                    m_isLinearScan = false; ///< Current function is allocated by linear scan.
+    unsigned                m_linearScanThreshold = DEFAULT_LINEAR_SCAN_THRESHOLD;
+    unsigned                m_position = 0u; ///< Instruction in the current function.
+    std::chrono::steady_clock::duration m_time {}; ///< Allocation time of the current function.
+    RegisterAllocatorStats  m_stats;
 };
 
 } // namespace SecreCC
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "VMArena.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+
+namespace SecreCC {
+
+constexpr std::size_t VMArena::chunkSize;
+
+VMArena::VMArena() = default;
+VMArena::~VMArena() = default;
+
+void * VMArena::allocate(std::size_t size, std::size_t align) {
+    assert(align != 0u && (align & (align - 1u)) == 0u);
+    m_bytesAllocated += size;
+
+    auto const address = reinterpret_cast<std::uintptr_t>(m_next);
+    std::size_t const padding = (align - address % align) % align;
+    if (m_next != nullptr
+        && padding + size <= static_cast<std::size_t>(m_end - m_next))
+    {
+        char * const out = m_next + padding;
+        m_next = out + size;
+        return out;
+    }
+
+    // Large requests get a chunk of their own, keeping the current one:
+    if (size + align > chunkSize / 4u) {
+        m_chunks.emplace_back(new char[size + align]);
+        auto const chunk = reinterpret_cast<std::uintptr_t>(m_chunks.back().get());
+        return m_chunks.back().get() + (align - chunk % align) % align;
+    }
+
+    m_chunks.emplace_back(new char[chunkSize]);
+    char * const chunk = m_chunks.back().get();
+    m_end = chunk + chunkSize;
+    auto const start = reinterpret_cast<std::uintptr_t>(chunk);
+    char * const out = chunk + (align - start % align) % align;
+    m_next = out + size;
+    return out;
+}
+
+char const * VMArena::copy(std::string const & str) {
+    auto const out = static_cast<char *>(allocate(str.size() + 1u, 1u));
+    std::memcpy(out, str.c_str(), str.size() + 1u);
+    return out;
+}
+
+} // namespace SecreCC {
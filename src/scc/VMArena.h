@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef VM_ARENA_H
+#define VM_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+namespace SecreCC {
+
+/******************************************************************
+  VMArena
+******************************************************************/
+
+/**
+ * Bump allocator for the code of a linking unit. Blocks, functions and the
+ * keywords that are not string literals are allocated from it and released
+ * all at once with the linking unit, individual deallocations are ignored.
+ */
+class __attribute__ ((visibility("internal"))) VMArena {
+
+public: /* Types: */
+
+    /// Allocator for the standard containers that allocate from an arena.
+    template <typename T>
+    class Allocator {
+
+        template <typename U> friend class Allocator;
+
+    public: /* Types: */
+
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+    public: /* Methods: */
+
+        Allocator(VMArena & arena) noexcept : m_arena(&arena) {}
+
+        template <typename U>
+        Allocator(Allocator<U> const & other) noexcept
+            : m_arena(other.m_arena)
+        {}
+
+        T * allocate(std::size_t n) {
+            return static_cast<T *>(m_arena->allocate(n * sizeof(T),
+                                                      alignof(T)));
+        }
+
+        void deallocate(T *, std::size_t) noexcept {}
+
+        VMArena & arena() const noexcept { return *m_arena; }
+
+        template <typename U>
+        bool operator==(Allocator<U> const & other) const noexcept
+        { return m_arena == other.m_arena; }
+
+        template <typename U>
+        bool operator!=(Allocator<U> const & other) const noexcept
+        { return m_arena != other.m_arena; }
+
+    private: /* Fields: */
+
+        VMArena * m_arena;
+
+    };
+
+public: /* Methods: */
+
+    VMArena();
+    VMArena(VMArena const &) = delete;
+    VMArena & operator=(VMArena const &) = delete;
+    ~VMArena();
+
+    void * allocate(std::size_t size, std::size_t align);
+
+    /// Null terminated copy of the string that lives as long as the arena.
+    char const * copy(std::string const & str);
+
+    /// Bytes handed out, not counting the unused ends of chunks.
+    std::size_t bytesAllocated() const noexcept { return m_bytesAllocated; }
+
+private: /* Fields: */
+
+    static constexpr std::size_t chunkSize = 64u * 1024u;
+
+    std::vector<std::unique_ptr<char[]>> m_chunks;
+    char * m_next = nullptr;
+    char * m_end = nullptr;
+    std::size_t m_bytesAllocated = 0u;
+
+}; /* class VMArena { */
+
+} /* namespace SecreCC { */
+
+#endif
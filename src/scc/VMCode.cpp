@@ -19,7 +19,8 @@
 
 #include "VMCode.h"
 
-#include <boost/io/ios_state.hpp>
+#include "VMSymbolTable.h"
+
 #include <cassert>
 #include <ostream>
 #include <iterator>
@@ -44,14 +45,21 @@ std::ostream& operator << (std::ostream& os, const VMBlock& block) {
   VMFunction
 *******************************************************************************/
 
+VMInstruction VMFunction::resizeStack () const {
+    VMInstruction instr;
+    if (numLocals () != 0) {
+        assert (! isStart () && "Must not have local registers in global scope");
+        instr << "resizestack" << static_cast<std::uint64_t> (numLocals ());
+    }
+
+    return instr;
+}
+
 std::ostream& operator << (std::ostream& os, const VMFunction& function) {
     function.m_name->streamTo(os) << '\n';
-    if (function.numLocals () != 0) {
-        assert (! function.isStart ()
-                && "Must not have local registers in global scope");
-        boost::io::ios_flags_saver saver(os);
-        os << "resizestack 0x" << std::hex  << function.numLocals () << '\n';
-    }
+    const VMInstruction resize = function.resizeStack ();
+    if (resize.size () != 0u)
+        os << resize << '\n';
 
     std::copy (function.begin (), function.end (),
                std::ostream_iterator<VMBlock>(os, "\n"));
@@ -109,11 +117,18 @@ std::ostream & VMDataSection::printBodyV (std::ostream& os) const {
   VMCodeSection
 *******************************************************************************/
 
+VMInstruction VMCodeSection::resizeStack () const {
+    VMInstruction instr;
+    if (numGlobals () > 0)
+        instr << "resizestack" << static_cast<std::uint64_t> (numGlobals ());
+
+    return instr;
+}
+
 std::ostream& VMCodeSection::printBodyV (std::ostream& os) const {
-    if (numGlobals () > 0) {
-        boost::io::ios_flags_saver saver(os);
-        os << "resizestack 0x" << std::hex << numGlobals () << '\n';
-    }
+    const VMInstruction resize = resizeStack ();
+    if (resize.size () != 0u)
+        os << resize << '\n';
 
     std::copy (begin (), end (), std::ostream_iterator<VMFunction>(os, "\n"));
     return os;
@@ -123,7 +138,10 @@ std::ostream& VMCodeSection::printBodyV (std::ostream& os) const {
   VMLinkingUnit
 *******************************************************************************/
 
-VMLinkingUnit::VMLinkingUnit() = default;
+VMLinkingUnit::VMLinkingUnit()
+    : m_symbolTable(std::make_unique<VMSymbolTable>())
+{}
+
 VMLinkingUnit::~VMLinkingUnit() = default;
 
 void VMLinkingUnit::addSection(std::shared_ptr<VMSection> section) {
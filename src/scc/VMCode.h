@@ -20,6 +20,7 @@
 #ifndef VM_CODE_H
 #define VM_CODE_H
 
+#include "VMArena.h"
 #include "VMInstruction.h"
 
 #include <list>
@@ -31,29 +32,39 @@
 #include "VMDataType.h"
 
 
+namespace SecreC { class Procedure; }
 namespace SecreCC {
 
+class VMSymbolTable;
+
 /*******************************************************************************
   VMBlock
 *******************************************************************************/
 
 /**
- * Basic block of VM code instructions.
+ * Basic block of VM code instructions. The instructions are allocated from
+ * the arena of the linking unit, blocks are moved rather than copied.
  */
 class __attribute__ ((visibility("internal"))) VMBlock {
 public: /* Types: */
 
-    typedef std::list<VMInstruction > InstList;
+    typedef std::list<VMInstruction, VMArena::Allocator<VMInstruction> > InstList;
     typedef InstList::iterator iterator;
     typedef InstList::const_iterator const_iterator;
 
 public: /* Methods: */
 
-    VMBlock() noexcept {}
-    VMBlock(std::shared_ptr<OStreamable> name) noexcept
+    explicit VMBlock(VMArena & arena,
+                     std::shared_ptr<OStreamable> name = nullptr) noexcept
         : m_name(std::move(name))
+        , m_instructions(InstList::allocator_type(arena))
     {}
 
+    VMBlock(VMBlock &&) = default;
+    VMBlock(VMBlock const &) = delete;
+    VMBlock & operator=(VMBlock &&) = default;
+    VMBlock & operator=(VMBlock const &) = delete;
+
     iterator begin () { return m_instructions.begin (); }
     iterator end () { return m_instructions.end (); }
     const_iterator begin () const { return m_instructions.begin (); }
@@ -63,15 +74,26 @@ public: /* Methods: */
     }
 
     VMInstruction& push_new (void) {
-        m_instructions.push_back (VMInstruction ());
+        m_instructions.emplace_back ();
         return m_instructions.back ();
     }
 
+    iterator erase (iterator i) {
+        return m_instructions.erase (i);
+    }
+
+    bool empty () const { return m_instructions.empty (); }
+    void clear () { m_instructions.clear (); }
+
+    /// Label of the block, nullptr if no jump targets it.
+    const std::shared_ptr<OStreamable>& name () const { return m_name; }
+    void removeName () { m_name.reset (); }
+
     friend std::ostream& operator << (std::ostream& os, const VMBlock& block);
 
 private: /* Fields: */
 
-    std::shared_ptr<OStreamable> const m_name;
+    std::shared_ptr<OStreamable> m_name;
     InstList                     m_instructions;
 };
 
@@ -85,20 +107,38 @@ private: /* Fields: */
 class __attribute__ ((visibility("internal"))) VMFunction {
 public: /* Types: */
 
-    typedef std::list<VMBlock > BlockList;
+    typedef std::list<VMBlock, VMArena::Allocator<VMBlock> > BlockList;
     typedef BlockList::iterator iterator;
     typedef BlockList::const_iterator const_iterator;
 
 public: /* Methods: */
 
-    explicit VMFunction(std::shared_ptr<OStreamable> name)
-        : m_name(std::move(name))
+    VMFunction(VMArena & arena, std::shared_ptr<OStreamable> name)
+        : m_blocks(BlockList::allocator_type(arena))
+        , m_name(std::move(name))
         , m_isStart (false)
         , m_numLocals (0)
     {}
 
+    VMFunction(VMFunction &&) = default;
+    VMFunction(VMFunction const &) = delete;
+    VMFunction & operator=(VMFunction &&) = default;
+    VMFunction & operator=(VMFunction const &) = delete;
+
+    /// Arena to allocate the blocks of the function from.
+    VMArena & arena () const { return m_blocks.get_allocator ().arena (); }
+
+    const std::shared_ptr<OStreamable>& name () const { return m_name; }
+
+    /// Procedure the function was generated for, nullptr for builtins.
+    const SecreC::Procedure* procedure () const { return m_procedure; }
+    void setProcedure (const SecreC::Procedure* proc) { m_procedure = proc; }
+
     unsigned numLocals () const { return m_numLocals; }
     void setNumLocals (unsigned n) { m_numLocals = n; }
+
+    /// "resizestack" for the local registers, empty if there are none.
+    VMInstruction resizeStack () const;
     void setIsStart () { m_isStart = true; }
     bool isStart () const { return m_isStart; }
 
@@ -106,8 +146,8 @@ public: /* Methods: */
     iterator end () { return m_blocks.end (); }
     const_iterator begin () const { return m_blocks.begin (); }
     const_iterator end () const { return m_blocks.end (); }
-    VMFunction& push_back (const VMBlock& b) {
-        m_blocks.push_back (b);
+    VMFunction& push_back (VMBlock&& b) {
+        m_blocks.push_back (std::move (b));
         return *this;
     }
 
@@ -116,7 +156,8 @@ public: /* Methods: */
 private: /* Fields: */
 
    BlockList       m_blocks;  ///< VM blocks that define this function.
-   std::shared_ptr<OStreamable> const m_name; ///< Name of the function.
+   std::shared_ptr<OStreamable> m_name; ///< Name of the function.
+   const SecreC::Procedure* m_procedure = nullptr;
    bool            m_isStart; ///< Special function to mark the start of the byte code.
    unsigned        m_numLocals; ///< Number of local registers, either "reg" or "stack".
 };
@@ -262,30 +303,30 @@ class __attribute__ ((visibility("internal"))) VMCodeSection final
 {
 public: /* Types: */
 
-    typedef std::list<VMFunction > FunctionList;
+    typedef std::list<VMFunction, VMArena::Allocator<VMFunction> > FunctionList;
     typedef FunctionList::iterator iterator;
     typedef FunctionList::const_iterator const_iterator;
 
 public: /* Methods: */
 
-    VMCodeSection ()
+    explicit VMCodeSection (VMArena& arena)
         : VMSection ("TEXT")
+        , m_functions (FunctionList::allocator_type (arena))
         , m_numGlobals (0)
     { }
 
+    VMArena& arena () const { return m_functions.get_allocator ().arena (); }
+
     unsigned numGlobals () const { return m_numGlobals; }
     void setNumGlobals (unsigned n) { m_numGlobals = n; }
+
+    /// "resizestack" for the global registers, empty if there are none.
+    VMInstruction resizeStack () const;
     iterator begin () { return m_functions.begin (); }
     iterator end () { return m_functions.end (); }
     const_iterator begin () const { return m_functions.begin (); }
     const_iterator end () const { return m_functions.end (); }
-    void push_back (const VMFunction& f) { m_functions.push_back (f); }
-
-    /**
-     * \todo VMFunction is not that light-weight class. Should probably
-     * use the intrusive boost lists again, but this really is not the
-     * current bottle neck.
-     */
+    void push_back (VMFunction&& f) { m_functions.push_back (std::move (f)); }
 
 protected:
 
@@ -301,6 +342,11 @@ private: /* Fields: */
   VMLinkingUnit
 *******************************************************************************/
 
+/**
+ * The sections of the generated code, together with the arena the code is
+ * allocated from and the symbol table that owns the values the instructions
+ * refer to.
+ */
 class __attribute__ ((visibility("internal"))) VMLinkingUnit {
 
 public: /* Methods: */
@@ -315,11 +361,17 @@ public: /* Methods: */
 
     void addSection(std::shared_ptr<VMSection> section);
 
+    VMArena & arena() noexcept { return m_arena; }
+    VMSymbolTable & symbolTable() noexcept { return *m_symbolTable; }
+
     friend std::ostream &
     operator<<(std::ostream & os, VMLinkingUnit const & code);
 
 private: /* Fields: */
 
+    /// Declared before the sections, as the code refers to both of them.
+    VMArena m_arena;
+    std::unique_ptr<VMSymbolTable> m_symbolTable;
     std::vector<std::shared_ptr<VMSection>> m_sections;
 
 };
@@ -19,59 +19,243 @@
 
 #include "VMInstruction.h"
 
+#include <boost/io/ios_state.hpp>
+#include <cstring>
 #include <ostream>
-#include <sharemind/Concat.h>
 #include <sstream>
 #include "VMValue.h"
 
 
 namespace SecreCC {
 
-using sharemind::concat;
+namespace {
 
-VMInstruction & VMInstruction::operator<<(OStreamableString str) {
-    m_operands.emplace_back(
-                std::make_shared<OStreamableString>(std::move(str)));
+struct Mnemonic {
+    char const * name;
+    VMInstruction::Opcode opcode;
+};
+
+Mnemonic const mnemonics[] = {
+    { "#", VMInstruction::COMMENT },
+    { "mov", VMInstruction::MOV },
+    { "jmp", VMInstruction::JMP },
+    { "jz", VMInstruction::JZ },
+    { "jnz", VMInstruction::JNZ },
+    { "call", VMInstruction::CALL },
+    { "return", VMInstruction::RETURN },
+    { "halt", VMInstruction::HALT }
+};
+
+VMInstruction::Opcode classify(char const * keyword) {
+    // Keywords may carry operands, as in "return imm 0x0":
+    std::size_t const n = std::strcspn(keyword, " ");
+    for (auto const & m : mnemonics) {
+        if (std::strlen(m.name) == n && std::strncmp(keyword, m.name, n) == 0)
+            return m.opcode;
+    }
+
+    return VMInstruction::OTHER;
+}
+
+/// Numbers and labels in a keyword, as in "mov imm 0x0".
+std::size_t keywordArguments(char const * keyword) {
+    std::size_t out = 0u;
+    bool atWord = true;
+    for (char const * c = keyword; *c != '\0'; ++c) {
+        if (*c == ' ') {
+            atWord = true;
+            continue;
+        }
+
+        if (atWord && ((*c >= '0' && *c <= '9') || *c == '-' || *c == ':'))
+            ++out;
+        atWord = false;
+    }
+
+    return out;
+}
+
+} // anonymous namespace
+
+constexpr std::size_t VMInstruction::maxOperands;
+
+VMInstruction & VMInstruction::operator<<(char const * keyword) {
+    assert(keyword);
+    if (m_size == 0u)
+        m_opcode = classify(keyword);
+
+    Operand & op = push();
+    op.kind = Operand::KEYWORD;
+    op.valueKind = Operand::OTHER;
+    op.keyword = keyword;
     return *this;
 }
 
 VMInstruction & VMInstruction::operator<<(VMValue const & val) {
-    m_operands.emplace_back(val.streamable());
+    Operand::ValueKind valueKind = Operand::OTHER;
+    if (auto const vreg = dynamic_cast<VMVReg const *>(&val)) {
+        if (vreg->isTemporary())
+            valueKind = Operand::TEMPORARY;
+    } else if (dynamic_cast<VMImm const *>(&val)) {
+        valueKind = Operand::IMMEDIATE;
+    } else if (dynamic_cast<VMLabel const *>(&val)) {
+        valueKind = Operand::LABEL;
+    }
+
+    Operand & op = push();
+    op.kind = Operand::VALUE;
+    op.valueKind = valueKind;
+    op.value = val.streamable().get();
     return *this;
 }
 
 VMInstruction & VMInstruction::operator<<(std::uint64_t const n) {
-    struct Streamable: OStreamable {
-        Streamable(std::uint64_t const value) noexcept : m_value(value) {}
-        std::ostream & streamTo(std::ostream & os) const final override
-        { return os << "0x" << std::hex << m_value; }
-        std::uint64_t m_value;
-    };
-
-    m_operands.emplace_back(std::make_shared<Streamable>(n));
+    Operand & op = push();
+    op.kind = Operand::NUMBER;
+    op.valueKind = Operand::OTHER;
+    op.number = n;
     return *this;
 }
 
 VMInstruction & VMInstruction::operator<<(VMDataType const ty) {
-    struct Streamable: OStreamable {
-        Streamable(VMDataType const dataType) noexcept : m_dataType(dataType) {}
-        std::ostream & streamTo(std::ostream & os) const final override
-        { return os << dataTypeToStr(m_dataType); }
-        VMDataType m_dataType;
-    };
-
-    m_operands.emplace_back(std::make_shared<Streamable>(ty));
+    Operand & op = push();
+    op.kind = Operand::DATATYPE;
+    op.valueKind = Operand::OTHER;
+    op.number = ty;
+    return *this;
+}
+
+bool VMInstruction::isImmediate(std::size_t i) const {
+    return i < m_size
+        && m_operands[i].kind == Operand::VALUE
+        && m_operands[i].valueKind == Operand::IMMEDIATE;
+}
+
+bool VMInstruction::isLabel(std::size_t i) const {
+    return i < m_size
+        && m_operands[i].kind == Operand::VALUE
+        && m_operands[i].valueKind == Operand::LABEL;
+}
+
+bool VMInstruction::isTemporary(std::size_t i) const {
+    return i < m_size
+        && m_operands[i].kind == Operand::VALUE
+        && m_operands[i].valueKind == Operand::TEMPORARY;
+}
+
+std::uint64_t VMInstruction::immediate(std::size_t i) const {
+    assert(isImmediate(i));
+    // Immediates are written as "imm 0x...":
+    std::ostringstream oss;
+    m_operands[i].value->streamTo(oss);
+    return std::stoull(oss.str().substr(4u), nullptr, 16);
+}
+
+OStreamable const * VMInstruction::value(std::size_t i) const {
+    if (i < m_size && m_operands[i].kind == Operand::VALUE)
+        return m_operands[i].value;
+    return nullptr;
+}
+
+OStreamable const * VMInstruction::label(std::size_t i) const {
+    assert(isLabel(i));
+    return VMLabel::nameOf(m_operands[i].value);
+}
+
+bool VMInstruction::refersTo(OStreamable const * value) const {
+    for (std::size_t i = 0u; i < m_size; ++i) {
+        if (m_operands[i].kind == Operand::VALUE && m_operands[i].value == value)
+            return true;
+    }
+
+    return false;
+}
+
+VMInstruction & VMInstruction::append(VMInstruction const & other, std::size_t i) {
+    assert(i < other.m_size);
+    if (m_size == 0u && other.m_operands[i].kind == Operand::KEYWORD)
+        m_opcode = classify(other.m_operands[i].keyword);
+
+    push() = other.m_operands[i];
     return *this;
 }
 
+void VMInstruction::setOperand(std::size_t i, VMInstruction const & other, std::size_t j) {
+    assert(i < m_size);
+    assert(j < other.m_size);
+    if (i == 0u)
+        m_opcode = other.m_operands[j].kind == Operand::KEYWORD
+                 ? classify(other.m_operands[j].keyword)
+                 : OTHER;
+
+    m_operands[i] = other.m_operands[j];
+}
+
+bool VMInstruction::isRedundantMove() const {
+    if (m_size != 3u
+        || m_opcode != MOV
+        || m_operands[1u].kind != Operand::VALUE
+        || m_operands[2u].kind != Operand::VALUE)
+        return false;
+
+    if (m_operands[1u].value == m_operands[2u].value)
+        return true;
+
+    // Distinct virtual registers are redundant if allocated to the same place:
+    std::ostringstream src;
+    std::ostringstream dest;
+    m_operands[1u].value->streamTo(src);
+    m_operands[2u].value->streamTo(dest);
+    return src.str() == dest.str();
+}
+
+std::size_t VMInstruction::codeBlocks() const {
+    if (m_size == 0u || m_opcode == COMMENT)
+        return 0u;
+
+    std::size_t out = 1u;
+    for (std::size_t i = 0u; i < m_size; ++i) {
+        auto const & op = m_operands[i];
+        switch (op.kind) {
+        case Operand::KEYWORD:
+            out += keywordArguments(op.keyword);
+            break;
+        case Operand::VALUE: // "imm 0x...", "imm :label", "reg 0x..." or "stack 0x..."
+        case Operand::NUMBER:
+            ++out;
+            break;
+        case Operand::DATATYPE:
+            break;
+        }
+    }
+
+    return out;
+}
+
 std::ostream & operator<<(std::ostream & os, VMInstruction const & instr) {
-    auto it = instr.m_operands.begin();
-    auto const end = instr.m_operands.end();
-    if (it != end) {
-        (*it)->streamTo(os);
-        while (++it != end)
-            (*it)->streamTo(os << ' ');
+    for (std::size_t i = 0u; i < instr.m_size; ++i) {
+        if (i != 0u)
+            os << ' ';
+
+        auto const & op = instr.m_operands[i];
+        switch (op.kind) {
+        case VMInstruction::Operand::KEYWORD:
+            os << op.keyword;
+            break;
+        case VMInstruction::Operand::VALUE:
+            op.value->streamTo(os);
+            break;
+        case VMInstruction::Operand::NUMBER: {
+            boost::io::ios_flags_saver saver(os);
+            os << "0x" << std::hex << op.number;
+            break;
+        }
+        case VMInstruction::Operand::DATATYPE:
+            os << dataTypeToStr(static_cast<VMDataType>(op.number));
+            break;
+        }
     }
+
     return os;
 }
 
@@ -21,15 +21,15 @@
 #define VMINSTRUCTION_H
 
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <iosfwd>
-#include <memory>
-#include <string>
-#include <vector>
+#include <stdexcept>
 #include "OStreamable.h"
 #include "VMDataType.h"
 
 
+namespace SecreC { class Imop; }
 namespace SecreCC {
 
 class VMValue;
@@ -40,9 +40,31 @@ class VMValue;
 
 class __attribute__ ((visibility("internal"))) VMInstruction {
 
+public: /* Types: */
+
+    /// Instructions that the passes over the generated code look for.
+    enum Opcode : std::uint8_t {
+        OTHER,
+        COMMENT,
+        MOV,
+        JMP,
+        JZ,
+        JNZ,
+        CALL,
+        RETURN,
+        HALT
+    };
+
+    /// The longest instructions are the calls to the builtin functions.
+    static constexpr std::size_t maxOperands = 8u;
+
 public: /* Methods: */
 
-    VMInstruction & operator<<(OStreamableString str);
+    /**
+     * Keywords are not copied, they have to be string literals or strings
+     * copied to the arena of the linking unit.
+     */
+    VMInstruction & operator<<(char const * keyword);
     VMInstruction & operator<<(VMValue const & val);
     VMInstruction & operator<<(uint64_t const n);
     VMInstruction & operator<<(VMDataType const ty);
@@ -52,14 +74,85 @@ public: /* Methods: */
         return *this << *val;
     }
 
+    /// Classified by the first keyword of the instruction.
+    Opcode opcode() const noexcept { return m_opcode; }
+
+    /// Intermediate instruction the code was generated for, nullptr if none.
+    SecreC::Imop const * origin() const noexcept { return m_origin; }
+    void setOrigin(SecreC::Imop const * imop) noexcept { m_origin = imop; }
+
+    /// Whether it is a "mov" of a value to itself, only meaningful after register allocation.
+    bool isRedundantMove() const;
+
+    /**
+     * Size of the assembled instruction: a code block for the opcode and one
+     * for every argument. Comments and empty instructions take none.
+     */
+    std::size_t codeBlocks() const;
+
+    /**
+     * Inspection and rewriting of operands, by their position, for the
+     * peephole optimizer:
+     */
+    std::size_t size() const noexcept { return m_size; }
+    bool isImmediate(std::size_t i) const;
+    bool isLabel(std::size_t i) const;
+    bool isTemporary(std::size_t i) const;
+
+    /// Value of an immediate operand.
+    std::uint64_t immediate(std::size_t i) const;
+
+    /// The value the operand refers to, nullptr if it is not a value.
+    OStreamable const * value(std::size_t i) const;
+
+    /// Name of the label the operand refers to, as used for the blocks.
+    OStreamable const * label(std::size_t i) const;
+
+    /// Whether the instruction refers to the same value as the operand.
+    bool refersTo(OStreamable const * value) const;
+
+    /// Copies an operand of another instruction to the end of this one.
+    VMInstruction & append(VMInstruction const & other, std::size_t i);
+    void setOperand(std::size_t i, VMInstruction const & other, std::size_t j);
+
+private: /* Types: */
+
+    /**
+     * Operands are stored inline. Values are owned by the symbol table of the
+     * linking unit, as virtual registers only get their name after register
+     * allocation.
+     */
+    struct Operand {
+        enum Kind : std::uint8_t { KEYWORD, VALUE, NUMBER, DATATYPE };
+        enum ValueKind : std::uint8_t { OTHER, IMMEDIATE, LABEL, TEMPORARY };
+
+        Kind kind;
+        ValueKind valueKind;
+        union {
+            std::uint64_t number;
+            char const * keyword;
+            OStreamable const * value;
+        };
+    };
+
 private: /* Methods: */
 
+    /// \throws std::logic_error if the instruction already has maxOperands.
+    Operand & push() {
+        if (m_size >= maxOperands)
+            throw std::logic_error("Too many operands in a VM instruction!");
+        return m_operands[m_size++];
+    }
+
     friend std::ostream & operator<<(std::ostream & o,
                                      VMInstruction const & instr);
 
 private: /* Fields: */
 
-    std::vector<std::shared_ptr<OStreamable const>> m_operands;
+    Operand m_operands[maxOperands];
+    SecreC::Imop const * m_origin = nullptr;
+    std::uint8_t m_size = 0u;
+    Opcode m_opcode = OTHER;
 };
 
 std::ostream& operator << (std::ostream& o, const VMInstruction& instr)
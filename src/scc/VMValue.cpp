@@ -80,6 +80,12 @@ std::string const & VMLabel::name() const noexcept {
                 *streamable()).m_nameStreamable.m_value;
 }
 
+OStreamable const *
+VMLabel::nameOf(OStreamable const * streamable) noexcept {
+    assert(dynamic_cast<LabelStreamable const *>(streamable));
+    return &static_cast<LabelStreamable const *>(streamable)->m_nameStreamable;
+}
+
 VMVReg::VMVReg(bool const isGlobal)
     : VMValue(std::make_shared<OStreamableString>(std::string()))
     , m_isGlobal(isGlobal)
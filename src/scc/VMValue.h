@@ -103,6 +103,9 @@ public: /* Methods: */
     std::shared_ptr<OStreamable> nameStreamable() const noexcept;
     std::string const & name() const noexcept;
 
+    /// Name streamable of the label with the given streamable.
+    static OStreamable const * nameOf(OStreamable const * streamable) noexcept;
+
 };
 
 /******************************************************************
@@ -122,9 +125,14 @@ public: /* Methods: */
     bool isGlobal() const noexcept { return m_isGlobal; }
     void setActualReg(VMValue const & reg);
 
+    /// Temporaries only hold values within the code of a single instruction.
+    bool isTemporary() const noexcept { return m_isTemporary; }
+    void setTemporary() noexcept { m_isTemporary = true; }
+
 private: /* Fields: */
 
     bool m_isGlobal;
+    bool m_isTemporary = false;
     std::string m_value;
 
 };
@@ -0,0 +1,414 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+#include "VectorFusion.h"
+
+#include <algorithm>
+#include <cassert>
+#include <libscc/Blocks.h>
+#include <libscc/Optimizer.h>
+#include <libscc/SecurityType.h>
+#include <libscc/Symbol.h>
+#include <libscc/Types.h>
+#include <libscc/analysis/LiveVariables.h>
+
+#include "VMDataType.h"
+
+
+namespace SecreCC {
+
+using namespace SecreC;
+
+namespace /* anonymous */ {
+
+VMDataType elementType (const Symbol* sym) {
+    return secrecDTypeToVMDType (sym->secrecType ()->secrecDataType ());
+}
+
+bool isPublic (const Symbol* sym) {
+    return sym->secrecType ()->secrecSecType ()->isPublic ();
+}
+
+const Symbol* vectorSize (const Imop& imop) {
+    return imop.operands ().back ();
+}
+
+/// Public vectorised arithmetic with all the arguments of the same type.
+bool isFusable (const Imop& imop) {
+    if (! imop.isExpr () || ! imop.isVectorized () ||
+            BuiltinVArith::instructionName (imop) == nullptr)
+    {
+        return false;
+    }
+
+    const VMDataType argTy = elementType (imop.arg1 ());
+    if (argTy == VM_INVALID || elementType (imop.dest ()) == VM_INVALID)
+        return false;
+
+    for (size_t i = 0; i + 1 < imop.nArgs (); ++ i) {
+        const Symbol* sym = imop.arg (i);
+        if (! sym->isArray () || ! isPublic (sym))
+            return false;
+        if (i > 0 && elementType (sym) != argTy)
+            return false;
+    }
+
+    return true;
+}
+
+/// Symbols whose values or memory the instruction changes.
+std::vector<const Symbol*> writes (const Imop& imop) {
+    std::vector<const Symbol*> out = writtenSymbols (imop);
+    for (const Symbol* sym : imop.defRange ())
+        out.push_back (sym);
+    if (imop.type () == Imop::RELEASE)
+        out.push_back (imop.arg1 ());
+    return out;
+}
+
+/*******************************************************************************
+  Chain
+*******************************************************************************/
+
+/**
+ * Fused operation rooted at an instruction of the block. The producers of
+ * the arguments are fused in recursively, so the chain is an expression tree
+ * evaluated by the steps in postorder.
+ */
+class Chain {
+private: /* Types: */
+
+    struct Operand {
+        bool isStep;
+        unsigned index;
+    };
+
+    struct Step {
+        size_t position;
+        std::vector<Operand> args;
+    };
+
+    struct Input {
+        const Symbol* array;
+        const Symbol* scalar;   ///< Value of every element, if it is a broadcast.
+    };
+
+public: /* Types: */
+
+    using Positions = std::map<const Symbol*, std::vector<size_t>>;
+
+public: /* Methods: */
+
+    Chain (const std::vector<const Imop*>& imops, const Positions& refs,
+           const LiveVariables::Symbols& liveIn,
+           const LiveVariables::Symbols& liveOut,
+           const std::set<const Imop*>& removed, size_t root)
+        : m_imops (imops)
+        , m_refs (refs)
+        , m_liveIn (liveIn)
+        , m_liveOut (liveOut)
+        , m_removed (removed)
+        , m_root (root)
+        , m_size (vectorSize (*imops[root]))
+    {
+        visit (root);
+        findBroadcasts ();
+    }
+
+    /// Fusing is valid, and saves more than the call of a single operation.
+    bool isProfitable () const {
+        if (! isValid ())
+            return false;
+
+        return m_steps.size () > 1u ||
+            std::any_of (m_inputs.begin (), m_inputs.end (),
+                         [](const Input& input) { return input.scalar != nullptr; });
+    }
+
+    /// Instructions that need no code, except the root.
+    std::vector<const Imop*> removed () const {
+        std::vector<const Imop*> out;
+        for (size_t i : m_removedAllocs)
+            out.push_back (m_imops[i]);
+        for (const Step& step : m_steps) {
+            if (step.position != m_root)
+                out.push_back (m_imops[step.position]);
+        }
+
+        return out;
+    }
+
+    size_t fusedInstructions () const { return m_steps.size () - 1u; }
+    size_t removedArrays () const { return m_removedArrays; }
+
+    FusedVectorOp fused () const {
+        const Imop& root = *m_imops[m_root];
+        std::vector<BuiltinVFused::Input> inputs;
+        std::vector<const Symbol*> operands {root.dest ()};
+        for (const Input& input : m_inputs) {
+            inputs.push_back (BuiltinVFused::Input {elementType (input.array), input.scalar != nullptr});
+            operands.push_back (input.scalar != nullptr ? input.scalar : input.array);
+        }
+
+        operands.push_back (m_size);
+
+        std::vector<BuiltinVFused::Step> steps;
+        for (const Step& step : m_steps) {
+            const Imop& imop = *m_imops[step.position];
+            std::vector<unsigned> args;
+            for (const Operand& arg : step.args)
+                args.push_back (arg.isStep ? m_inputs.size () + arg.index : arg.index);
+            steps.push_back (BuiltinVFused::Step {BuiltinVArith::instructionName (imop),
+                                                  elementType (imop.arg1 ()),
+                                                  std::move (args)});
+        }
+
+        return FusedVectorOp {BuiltinVFused (std::move (inputs), std::move (steps),
+                                             elementType (root.dest ())),
+                              std::move (operands)};
+    }
+
+private:
+
+    bool isMember (size_t i) const {
+        return std::any_of (m_steps.begin (), m_steps.end (),
+                            [i](const Step& step) { return step.position == i; });
+    }
+
+    Operand visit (size_t i) {
+        const Imop& imop = *m_imops[i];
+        Step step {i, {}};
+        for (size_t j = 1; j + 1 < imop.nArgs (); ++ j) {
+            const Symbol* arg = imop.arg (j);
+            size_t producer = 0u;
+            if (isIntermediate (imop, i, arg, producer))
+                step.args.push_back (visit (producer));
+            else
+                step.args.push_back (input (arg));
+        }
+
+        m_steps.push_back (std::move (step));
+        return Operand {true, static_cast<unsigned> (m_steps.size () - 1u)};
+    }
+
+    Operand input (const Symbol* sym) {
+        for (size_t i = 0; i < m_inputs.size (); ++ i) {
+            if (m_inputs[i].array == sym)
+                return Operand {false, static_cast<unsigned> (i)};
+        }
+
+        m_inputs.push_back (Input {sym, nullptr});
+        return Operand {false, static_cast<unsigned> (m_inputs.size () - 1u)};
+    }
+
+    /**
+     * The argument is the result of the previous instruction referring to it,
+     * and is only released after the user.
+     */
+    bool isIntermediate (const Imop& user, size_t i, const Symbol* sym, size_t& producer) {
+        if (sym->isGlobal () || sym == user.dest () || m_liveOut.count (sym) > 0)
+            return false;
+        if (std::count (user.operandsBegin () + 1, user.operandsEnd (), sym) != 1)
+            return false;
+
+        const std::vector<size_t>& refs = m_refs.at (sym);
+        const auto it = std::lower_bound (refs.begin (), refs.end (), i);
+        assert (it != refs.end () && *it == i);
+        if (it == refs.begin ())
+            return false;
+
+        producer = *(it - 1);
+        const Imop& imop = *m_imops[producer];
+        if (! isFusable (imop) || imop.dest () != sym || vectorSize (imop) != m_size ||
+                m_removed.count (&imop) > 0)
+        {
+            return false;
+        }
+
+        if (std::find (imop.operandsBegin () + 1, imop.operandsEnd (), sym) != imop.operandsEnd ())
+            return false;
+
+        if (! onlyReleases (sym, it + 1, refs.end ()))
+            return false;
+
+        // Not allocated at all if nothing else refers to it:
+        if (it - 1 == refs.begin () + 1 && isAllocOf (refs.front (), sym) &&
+                m_liveIn.count (sym) == 0)
+        {
+            m_removedAllocs.push_back (refs.front ());
+            m_removedAllocs.insert (m_removedAllocs.end (), it + 1, refs.end ());
+            ++ m_removedArrays;
+        }
+
+        return true;
+    }
+
+    bool onlyReleases (const Symbol* sym, std::vector<size_t>::const_iterator begin,
+                       std::vector<size_t>::const_iterator end) const
+    {
+        return std::all_of (begin, end, [this, sym](size_t i) {
+            const Imop& imop = *m_imops[i];
+            return imop.type () == Imop::RELEASE && imop.arg1 () == sym;
+        });
+    }
+
+    bool isAllocOf (size_t i, const Symbol* sym) const {
+        const Imop& imop = *m_imops[i];
+        return imop.type () == Imop::ALLOC && imop.dest () == sym;
+    }
+
+    /// Arrays allocated in the block to hold a scalar in every element.
+    void findBroadcasts () {
+        const Imop& root = *m_imops[m_root];
+        for (Input& input : m_inputs) {
+            const Symbol* sym = input.array;
+            if (sym->isGlobal () || sym == root.dest () || m_liveOut.count (sym) > 0)
+                continue;
+
+            const std::vector<size_t>& refs = m_refs.at (sym);
+            const size_t alloc = refs.front ();
+            const Imop& imop = *m_imops[alloc];
+            if (! isAllocOf (alloc, sym) || imop.nArgs () != 3 || imop.arg1 () != m_size)
+                continue;
+
+            const Symbol* value = imop.arg2 ();
+            if (value->isArray () || ! isPublic (value) || elementType (value) != elementType (sym))
+                continue;
+
+            std::vector<size_t> releases;
+            bool onlyFused = true;
+            for (auto it = refs.begin () + 1; it != refs.end () && onlyFused; ++ it) {
+                if (onlyReleases (sym, it, it + 1))
+                    releases.push_back (*it);
+                else
+                    onlyFused = isMember (*it);
+            }
+
+            if (! onlyFused || isWritten (value, alloc))
+                continue;
+
+            input.scalar = value;
+            m_removedAllocs.push_back (alloc);
+            m_removedAllocs.insert (m_removedAllocs.end (), releases.begin (), releases.end ());
+            ++ m_removedArrays;
+        }
+    }
+
+    /// The symbol is written after the position, before the root.
+    bool isWritten (const Symbol* sym, size_t from) const {
+        if (sym->isConstant ())
+            return false;
+
+        for (size_t i = from + 1; i < m_root; ++ i) {
+            const std::vector<const Symbol*> ws = writes (*m_imops[i]);
+            if (std::find (ws.begin (), ws.end (), sym) != ws.end ())
+                return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * Arrays are read at the root instead of the fused instructions, nothing
+     * in between may change them.
+     */
+    bool isValid () const {
+        size_t first = m_root;
+        for (const Step& step : m_steps)
+            first = std::min (first, step.position);
+
+        for (size_t i = first + 1; i < m_root; ++ i) {
+            const Imop& imop = *m_imops[i];
+            if (isMember (i))
+                continue;
+            if (imop.type () == Imop::CALL || imop.type () == Imop::SYSCALL)
+                return false;
+
+            for (const Symbol* sym : writes (imop)) {
+                for (const Input& input : m_inputs) {
+                    if (input.scalar == nullptr && input.array == sym)
+                        return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+private: /* Fields: */
+    const std::vector<const Imop*>&  m_imops;
+    const Positions&                 m_refs;
+    const LiveVariables::Symbols&    m_liveIn;
+    const LiveVariables::Symbols&    m_liveOut;
+    const std::set<const Imop*>&     m_removed;
+    const size_t                     m_root;
+    const Symbol* const              m_size;
+    std::vector<Step>                m_steps;
+    std::vector<Input>               m_inputs;
+    std::vector<size_t>              m_removedAllocs; ///< And the releases of the arrays.
+    size_t                           m_removedArrays = 0u;
+};
+
+} // namespace anonymous
+
+/*******************************************************************************
+  VectorFusion
+*******************************************************************************/
+
+void VectorFusion::analyse (const Block& block, const LiveVariables& lv) {
+    m_fused.clear ();
+    m_removed.clear ();
+
+    std::vector<const Imop*> imops;
+    Chain::Positions refs;
+    for (const Imop& imop : block) {
+        for (const Symbol* sym : imop.operands ()) {
+            if (sym == nullptr || sym->symbolType () != SYM_SYMBOL)
+                continue;
+
+            std::vector<size_t>& positions = refs[sym];
+            if (positions.empty () || positions.back () != imops.size ())
+                positions.push_back (imops.size ());
+        }
+
+        imops.push_back (&imop);
+    }
+
+    // Later instructions first, to fuse the longest chains:
+    for (size_t i = imops.size (); i -- > 0; ) {
+        const Imop& imop = *imops[i];
+        if (! isFusable (imop) || m_removed.count (&imop) > 0)
+            continue;
+
+        const Chain chain (imops, refs, lv.ins (block), lv.liveOnExit (block), m_removed, i);
+        if (! chain.isProfitable ())
+            continue;
+
+        for (const Imop* removed : chain.removed ())
+            m_removed.insert (removed);
+
+        m_fused.emplace (&imop, chain.fused ());
+        m_stats.fusedInstructions += chain.fusedInstructions ();
+        m_stats.removedArrays += chain.removedArrays ();
+        ++ m_stats.loops;
+    }
+}
+
+} // namespace SecreCC
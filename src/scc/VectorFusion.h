@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+#ifndef VECTOR_FUSION_H
+#define VECTOR_FUSION_H
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "Builtin.h"
+
+namespace SecreC {
+    class Block;
+    class Imop;
+    class LiveVariables;
+    class Symbol;
+} /* namespace SecreC { */
+
+namespace SecreCC {
+
+/*******************************************************************************
+  VectorFusionStats
+*******************************************************************************/
+
+struct __attribute__ ((visibility("internal"))) VectorFusionStats {
+    unsigned fusedInstructions = 0u;  ///< Computed in the loop of another instruction.
+    unsigned loops = 0u;              ///< Fused loops called.
+    unsigned removedArrays = 0u;      ///< Intermediate and broadcast arrays not allocated.
+};
+
+/*******************************************************************************
+  FusedVectorOp
+*******************************************************************************/
+
+struct __attribute__ ((visibility("internal"))) FusedVectorOp {
+    BuiltinVFused function;
+    std::vector<const SecreC::Symbol*> operands; ///< Destination, inputs and size.
+};
+
+/*******************************************************************************
+  VectorFusion
+*******************************************************************************/
+
+/**
+ * Finds the chains of public vectorised arithmetic instructions of a block
+ * that can be computed in a single loop. An instruction is fused into the
+ * one using its result if both operate on the same number of elements and
+ * the result is dead after it, only released. Arrays that are allocated
+ * just to hold a scalar for every element are replaced by the scalar. The
+ * intermediate and broadcast arrays are not allocated at all if nothing else
+ * refers to them.
+ */
+class __attribute__ ((visibility("internal"))) VectorFusion {
+public: /* Methods: */
+
+    /// Forgets the chains of the previous block.
+    void analyse (const SecreC::Block& block, const SecreC::LiveVariables& lv);
+
+    /// The instruction needs no code, it is a part of a fused operation.
+    bool isRemoved (const SecreC::Imop& imop) const {
+        return m_removed.count (&imop) > 0;
+    }
+
+    /// Fused operation that replaces the instruction, or nullptr
+    const FusedVectorOp* find (const SecreC::Imop& imop) const {
+        auto const it = m_fused.find (&imop);
+        return it != m_fused.end () ? &it->second : nullptr;
+    }
+
+    const VectorFusionStats& stats () const { return m_stats; }
+
+private: /* Fields: */
+    std::map<const SecreC::Imop*, FusedVectorOp>  m_fused;
+    std::set<const SecreC::Imop*>                 m_removed;
+    VectorFusionStats                             m_stats;
+};
+
+} // namespace SecreCC
+
+#endif
@@ -18,26 +18,38 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstring>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
 #include <limits>
 #include <locale>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include <boost/optional.hpp>
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/iostreams/stream.hpp>
 #include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
 #include <boost/iostreams/device/file.hpp>
 #include <boost/iostreams/stream_buffer.hpp>
 
+#include <sys/resource.h>
+
 #include <libscc/Blocks.h>
 #include <libscc/Context.h>
 #include <libscc/Intermediate.h>
 #include <libscc/Location.h>
+#include <libscc/ModuleCache.h>
+#include <libscc/ModuleMap.h>
 #include <libscc/StringTable.h>
 #include <libscc/TreeNode.h>
 
@@ -47,6 +59,7 @@
 #include <sharemind/PotentiallyVoidTypeInfo.h>
 
 #include "Compiler.h"
+#include "DebugMap.h"
 #include "VMCode.h"
 
 using namespace std;
@@ -87,12 +100,26 @@ struct ProgramOptions {
     bool                     showHelp = false;
     bool                     verbose = false;
     bool                     assembleOnly = false;
+    bool                     assembleViaFile = false;
     bool                     optimize = false;
     bool                     syntaxOnly = false;
     LocationPathStyle        runtimeErrorPathStyle = LocationPathStyle::FileName;
     boost::optional<string>  output; // nothing if cout
+    boost::optional<string>  debugMap; // nothing if not written
     boost::optional<string>  input; // nothing if cin
     vector<string>           includes;
+    boost::optional<string>  moduleCache; // nothing if disabled
+    boost::optional<string>  batch; // nothing if compiling a single input
+    unsigned                 jobs = 0; // 0 if hardware concurrency
+    unsigned                 linearScanThreshold = RegisterAllocator::DEFAULT_LINEAR_SCAN_THRESHOLD;
+};
+
+/*
+ * Read-only state shared by all compilations of a process.
+ */
+struct SharedState {
+    SecreC::ModuleMap::ModuleFiles     moduleFiles;
+    std::shared_ptr<SecreC::ModuleCache> moduleCache; // null if disabled
 };
 
 
@@ -108,13 +135,30 @@ bool readProgramOptions(int argc, char * argv[], ProgramOptions & opts) {
             ("include,I", po::value<vector<string> >(), "Directory for module search path.")
             ("assemble,S", "Output assembly.")
             ("output,o", po::value<string>(), "Output file.")
+            ("debug-map", po::value<string>(),
+             "Write a JSON map from the code block offsets of the instructions of the code section to the source locations and procedures they were generated for.")
             ("input", po::value<string>(), "Input file.")
             ("no-stdlib", "Do not look for standard library imports.")
+            ("module-cache", po::value<string>(), "Directory for caching parsed modules.")
+            ("batch", po::value<string>(),
+             "Compile every program listed in the given file. Each line names an input and optionally an output file.")
+            ("jobs,j", po::value<unsigned>(), "Number of programs compiled in parallel in batch mode.")
             ("optimize,O", "Optimize the generated code.")
+            ("linear-scan-threshold", po::value<unsigned>(),
+             "Allocate the registers of procedures with at least this many instructions by linear scan instead of graph coloring (0 for all procedures).")
             ("syntax-only", "Parse and type check only. Do not generate code.")
             ("runtime-error-path-style", po::value<string>()->default_value("filename"),
              "Control how paths in SecreC runtime error messages are displayed. Either \"filename\" or \"fullpath\".")
             ;
+    // Options for the tests, not listed by --help:
+    po::options_description hidden ("Hidden options");
+    hidden.add_options ()
+            ("assemble-via-file", "Assemble the bytecode from a temporary assembly file instead of memory.")
+            ;
+
+    po::options_description all;
+    all.add (desc).add (hidden);
+
     po::positional_options_description p;
     p.add("input", -1);
     po::variables_map vm;
@@ -122,7 +166,7 @@ bool readProgramOptions(int argc, char * argv[], ProgramOptions & opts) {
     try {
 
         po::store(po::command_line_parser(argc, argv)
-                      .options(desc)
+                      .options(all)
                       .positional(p)
                       .style(po::command_line_style::default_style ^ po::command_line_style::allow_guessing)
                       .run(),
@@ -137,6 +181,7 @@ bool readProgramOptions(int argc, char * argv[], ProgramOptions & opts) {
 
         opts.verbose = vm.count("verbose") > 0u;
         opts.assembleOnly = vm.count("assemble") > 0u;
+        opts.assembleViaFile = vm.count("assemble-via-file") > 0u;
         opts.optimize = vm.count ("optimize") > 0u;
         opts.syntaxOnly = vm.count("syntax-only") > 0u;
 
@@ -158,6 +203,9 @@ bool readProgramOptions(int argc, char * argv[], ProgramOptions & opts) {
         if (vm.count("input"))
             opts.input = vm["input"].as<string>();
 
+        if (vm.count("debug-map"))
+            opts.debugMap = vm["debug-map"].as<string>();
+
         if (vm.count ("include"))
             opts.includes = vm["include"].as<vector<string> >();
 
@@ -167,6 +215,23 @@ bool readProgramOptions(int argc, char * argv[], ProgramOptions & opts) {
         if (!vm.count("no-stdlib"))
             opts.includes.push_back (SHAREMIND_STDLIB_PATH);
 
+        if (vm.count("module-cache"))
+            opts.moduleCache = vm["module-cache"].as<string>();
+
+        if (vm.count("linear-scan-threshold"))
+            opts.linearScanThreshold = vm["linear-scan-threshold"].as<unsigned>();
+
+        if (vm.count("batch"))
+            opts.batch = vm["batch"].as<string>();
+
+        if (vm.count("jobs"))
+            opts.jobs = vm["jobs"].as<unsigned>();
+
+        if (opts.batch && (opts.input || opts.output || opts.debugMap)) {
+            cerr << "Input, output and debug map files can not be given in batch mode." << endl;
+            return false;
+        }
+
         return true;
     }
     catch (const std::exception & e) {
@@ -181,10 +246,11 @@ bool readProgramOptions(int argc, char * argv[], ProgramOptions & opts) {
  */
 class Output {
 public: /* Methods: */
-    Output (const ProgramOptions& opts)
+    Output (const ProgramOptions& opts, std::ostream& log)
         : m_os (cout.rdbuf ())
         , m_fileBuf()
         , m_opts (opts)
+        , m_log (log)
         , m_fileOpened (false)
     { }
 
@@ -201,8 +267,8 @@ public: /* Methods: */
 
             m_fileBuf.open (m_opts.output.get (), mode);
             if (! m_fileBuf.is_open ()) {
-                cerr << "Failed to open output file \""
-                     << m_opts.output.get () << "\"." << endl;
+                m_log << "Failed to open output file \""
+                      << m_opts.output.get () << "\"." << endl;
                 m_os.setstate(ios::failbit);
                 return m_os;
             }
@@ -217,59 +283,389 @@ private: /* Fields: */
     std::ostream m_os;
     io::stream_buffer<io::file_sink> m_fileBuf;
     const ProgramOptions& m_opts;
+    std::ostream& m_log;
     bool m_fileOpened;
 };
 
-bool assemble(sharemind::Executable & exe,
-              VMLinkingUnit const & vmlu)
+/*
+ * Time spent in the steps of assembling the bytecode. libas has no entry
+ * point that accepts tokens or sections built by the caller, so the assembly
+ * is printed and tokenized before it is assembled. These times show what
+ * emitting the bytecode directly could save.
+ */
+struct AssemblyTimes {
+    std::size_t bytes = 0u; ///< Size of the printed assembly
+    std::chrono::steady_clock::duration print {};
+    std::chrono::steady_clock::duration tokenize {};
+    std::chrono::steady_clock::duration assemble {};
+};
+
+/*
+ * Tokenize and assemble the printed assembly.
+ */
+void assembleText(sharemind::Executable & exe,
+                  const char * data,
+                  std::size_t size,
+                  AssemblyTimes & times)
+{
+    const auto startTime = std::chrono::steady_clock::now ();
+    auto tokens = sharemind::Assembler::tokenize(data, size);
+    const auto tokenizedTime = std::chrono::steady_clock::now ();
+    exe = sharemind::Assembler::assemble(std::move(tokens));
+    const auto endTime = std::chrono::steady_clock::now ();
+
+    times.bytes = size;
+    times.tokenize = tokenizedTime - startTime;
+    times.assemble = endTime - tokenizedTime;
+}
+
+/*
+ * Assemble from a copy of the assembly kept in memory. This only avoids the
+ * temporary file: the text is still printed and tokenized by libas.
+ */
+void assemble(sharemind::Executable & exe, VMLinkingUnit const & vmlu,
+              AssemblyTimes & times)
+{
+    std::vector<char> text;
+
+    const auto startTime = std::chrono::steady_clock::now ();
+    {
+        io::stream<io::back_insert_device<std::vector<char> > > out (text);
+        out << vmlu << flush;
+    }
+
+    times.print = std::chrono::steady_clock::now () - startTime;
+    assembleText(exe, text.data(), text.size(), times);
+}
+
+/*
+ * Assemble through a temporary file. Slower, but the bytecode must be
+ * identical to the one assembled in memory.
+ */
+bool assembleViaFile(sharemind::Executable & exe,
+                     VMLinkingUnit const & vmlu,
+                     AssemblyTimes & times,
+                     std::ostream & log)
 {
     fs::path p = fs::temp_directory_path () / fs::unique_path ();
     ScopedRemovePath scopedRemove (p);
 
+    const auto startTime = std::chrono::steady_clock::now ();
     {
         io::stream<io::file_sink > fout (p.string ());
 
         if (! fout.is_open ()) {
-            cerr << "Failed to open a temporary file \"" << p
-                 << "\" for buffering!" << endl;
+            log << "Failed to open a temporary file \"" << p
+                << "\" for buffering!" << endl;
             return false;
         }
 
         fout << vmlu << flush;
 
         if (fout.bad ()) {
-            cerr << "Writing to a temporary file \"" << p << "\" failed!" << endl;
+            log << "Writing to a temporary file \"" << p << "\" failed!" << endl;
             return false;
         }
     }
 
+    times.print = std::chrono::steady_clock::now () - startTime;
+
     io::stream<io::mapped_file_source > fin (p.string ());
     if (! fin.is_open ()) {
-        cerr << "Failed to mmap a temporary file \"" << p
-             << "\" for reading!" << endl;
+        log << "Failed to mmap a temporary file \"" << p
+            << "\" for reading!" << endl;
         return false;
     }
 
-    exe = sharemind::Assembler::assemble(
-              sharemind::Assembler::tokenize(fin->data(), fin->size()));
+    assembleText(exe, fin->data(), fin->size(), times);
     return true;
 }
 
 /*
  * Compile the actual bytecode executable.
  */
-bool compileExecutable (Output& output, const VMLinkingUnit& vmlu) {
+bool compileExecutable (Output& output, const VMLinkingUnit& vmlu,
+                        const ProgramOptions& opts, std::ostream& log)
+{
     sharemind::Executable exe;
-    if (!assemble(exe, vmlu))
-        return false;
+    AssemblyTimes times;
+    if (opts.assembleViaFile) {
+        if (!assembleViaFile(exe, vmlu, times, log))
+            return false;
+    }
+    else {
+        assemble(exe, vmlu, times);
+    }
+
+    if (opts.verbose) {
+        const auto ms = [](std::chrono::steady_clock::duration d) {
+            return std::chrono::duration<double, std::milli> (d).count ();
+        };
+
+        log << "Assembly: " << times.bytes << " bytes printed in "
+            << ms (times.print) << " ms, tokenized in "
+            << ms (times.tokenize) << " ms, assembled in "
+            << ms (times.assemble) << " ms." << endl;
+    }
 
     if (!(output.getStream() << exe)) {
-        cerr << "Writing bytecode to output failed." << endl;
+        log << "Writing bytecode to output failed." << endl;
         return false;
     }
     return true;
 }
 
+/*
+ * Compile a single program. Diagnostics are written to the log.
+ */
+bool compileProgram (const ProgramOptions& opts, const SharedState& shared,
+                     std::ostream& log)
+{
+    VMLinkingUnit vmlu;
+
+    {
+        SecreC::ICode icode;
+
+        /* Parse the program: */
+        SecreC::TreeNodeModule * parseTree = icode.parseMain (opts.input);
+        if (icode.status () != SecreC::ICode::OK) {
+            log << icode.compileLog ();
+            return false;
+        }
+
+        /* Collect possible include files: */
+        icode.modules ().addModuleFiles (shared.moduleFiles, opts.verbose);
+        icode.modules ().setCache (shared.moduleCache);
+
+        /* TODO: We should split type checking and compilation entirely. */
+        /* Translate to intermediate code: */
+        icode.compile (parseTree, opts.runtimeErrorPathStyle);
+
+        bool bad = icode.status () != SecreC::ICode::OK;
+
+        if (bad)
+            log << "Error generating valid intermediate code." << endl;
+
+        log << icode.compileLog () << endl;
+
+        if (bad)
+            return false;
+
+        if (opts.verbose) {
+            log << "Overload resolution cache: "
+                << icode.resolutionStats ().hits << " hits, "
+                << icode.resolutionStats ().misses << " misses, "
+                << icode.resolutionStats ().stale << " of them on redeclared names." << endl;
+            if (const SecreC::ModuleCache* cache = icode.modules ().cache ()) {
+                log << "Module cache: "
+                    << cache->stats ().hits << " hits, "
+                    << cache->stats ().misses << " misses." << endl;
+            }
+        }
+
+        if (opts.syntaxOnly)
+            return true;
+
+        /* Compile: */
+        CompilerStats compilerStats;
+        DebugMap debugMap;
+        compile(vmlu, icode, opts.optimize, opts.linearScanThreshold, &compilerStats,
+                opts.debugMap ? &debugMap : nullptr);
+
+        if (opts.debugMap) {
+            std::ofstream out (opts.debugMap.get ());
+            debugMap.writeJson (out);
+            if (! out) {
+                log << "Failed to write debug map \""
+                    << opts.debugMap.get () << "\"." << endl;
+                return false;
+            }
+        }
+
+        if (opts.verbose) {
+            const auto printAllocator = [&log](const char* name,
+                                              const RegisterAllocatorStats::Allocator& stats)
+            {
+                log << "Register allocation (" << name << "): "
+                    << stats.functions << " procedures, "
+                    << stats.stackSlots << " stack slots in "
+                    << std::chrono::duration<double, std::milli> (stats.time).count ()
+                    << " ms." << endl;
+            };
+
+            const RegisterAllocatorStats& raStats = compilerStats.registerAllocator;
+            printAllocator ("graph coloring", raStats.graphColoring);
+            printAllocator ("linear scan", raStats.linearScan);
+            log << "Move coalescing: "
+                << raStats.coalescedMoves << " moves removed." << endl;
+
+            const PeepholeStats& peephole = compilerStats.peephole;
+            log << "Peephole optimization: "
+                << peephole.removedInstructions << " instructions removed, "
+                << peephole.threadedJumps << " jumps threaded, "
+                << peephole.removedLabels << " labels removed." << endl;
+
+            const VectorFusionStats& fusion = compilerStats.vectorFusion;
+            log << "Vector fusion: "
+                << fusion.fusedInstructions << " operations fused into "
+                << fusion.loops << " loops, "
+                << fusion.removedArrays << " arrays not allocated." << endl;
+
+            // The maximum resident set size is reported in kilobytes:
+            struct rusage usage;
+            if (getrusage(RUSAGE_SELF, &usage) == 0) {
+                log << "Peak memory: " << usage.ru_maxrss << " KiB, "
+                    << vmlu.arena().bytesAllocated()
+                    << " bytes of generated code." << endl;
+            }
+        }
+
+        if (opts.verbose && opts.optimize) {
+            const SecreC::OptimizerStats& stats = icode.optimizerStats ();
+            log << "Common subexpression elimination: "
+                << stats.eliminatedPrivateOps << " private and "
+                << stats.eliminatedPublicOps << " public operations eliminated." << endl;
+            log << "Loop-invariant code motion: "
+                << stats.hoistedInstructions << " instructions hoisted." << endl;
+            log << "System call batching: "
+                << stats.batchedSyscalls << " scalar system calls merged into "
+                << stats.vectorSyscalls << " vector calls." << endl;
+            log << "Instruction scheduling: "
+                << stats.scheduledBlocks << " blocks reordered." << endl;
+            for (const auto& analysis : stats.analyses) {
+                log << "Analysis \"" << analysis.name << "\": "
+                    << analysis.runs << " runs, "
+                    << analysis.rounds << " rounds, "
+                    << analysis.blocks << " blocks visited in "
+                    << std::chrono::duration<double, std::milli> (analysis.time).count ()
+                    << " ms." << endl;
+            }
+        }
+    }
+
+    /* Output: */
+    Output output (opts, log);
+    if (opts.assembleOnly) {
+        output.getStream() << vmlu << endl;
+        return true;
+    }
+
+    return compileExecutable (output, vmlu, opts, log);
+}
+
+/*
+ * One program of a batch.
+ */
+struct BatchJob {
+    string input;
+    string output;
+    bool   ok = false;
+    std::chrono::milliseconds::rep elapsed = 0;
+    string log;
+};
+
+/*
+ * Read the batch file. Each non-empty line that does not start with '#'
+ * names an input file and optionally an output file. By default the output
+ * is written next to the input.
+ */
+bool readBatchFile (const ProgramOptions& opts, vector<BatchJob>& jobs) {
+    std::ifstream in (opts.batch.get ());
+    if (! in) {
+        cerr << "Failed to open batch file \"" << opts.batch.get () << "\"." << endl;
+        return false;
+    }
+
+    string line;
+    while (std::getline (in, line)) {
+        std::istringstream ss (line);
+        BatchJob job;
+        if (! (ss >> job.input) || job.input[0] == '#')
+            continue;
+
+        if (! (ss >> job.output)) {
+            job.output = fs::path (job.input)
+                .replace_extension (opts.assembleOnly ? ".s" : ".sb").string ();
+        }
+
+        jobs.push_back (std::move (job));
+    }
+
+    return true;
+}
+
+/*
+ * Compile all programs of the batch on a pool of threads and report the time
+ * spent on each of them.
+ */
+bool compileBatch (const ProgramOptions& opts, const SharedState& shared) {
+    vector<BatchJob> jobs;
+    if (! readBatchFile (opts, jobs))
+        return false;
+
+    unsigned numThreads = opts.jobs;
+    if (numThreads == 0)
+        numThreads = std::max (1u, std::thread::hardware_concurrency ());
+    numThreads = std::min<size_t> (numThreads, std::max<size_t> (jobs.size (), 1u));
+
+    const auto startTime = std::chrono::steady_clock::now ();
+    std::atomic<size_t> next (0u);
+    auto worker = [&] () {
+        for (size_t i = next++; i < jobs.size (); i = next++) {
+            BatchJob& job = jobs[i];
+            ProgramOptions jobOpts = opts;
+            jobOpts.input = job.input;
+            jobOpts.output = job.output;
+
+            std::ostringstream log;
+            const auto jobStartTime = std::chrono::steady_clock::now ();
+            try {
+                job.ok = compileProgram (jobOpts, shared, log);
+            }
+            catch (const std::exception& e) {
+                log << "Failed with exception:" << endl << e.what () << endl;
+            }
+            catch (...) {
+                log << "Failed with unknown exception." << endl;
+            }
+
+            job.elapsed = std::chrono::duration_cast<std::chrono::milliseconds> (
+                std::chrono::steady_clock::now () - jobStartTime).count ();
+            job.log = log.str ();
+        }
+    };
+
+    vector<std::thread> threads;
+    for (unsigned t = 1; t < numThreads; ++ t)
+        threads.emplace_back (worker);
+    worker ();
+    for (std::thread& thread : threads)
+        thread.join ();
+
+    const auto totalTime = std::chrono::duration_cast<std::chrono::milliseconds> (
+        std::chrono::steady_clock::now () - startTime).count ();
+
+    size_t failures = 0;
+    for (const BatchJob& job : jobs) {
+        if (! job.ok)
+            ++ failures;
+
+        if (job.log.find_first_not_of (" \n") != string::npos)
+            cerr << job.input << ":" << endl << job.log;
+    }
+
+    for (const BatchJob& job : jobs) {
+        cerr << std::setw (8) << job.elapsed << " ms  "
+             << (job.ok ? "ok     " : "FAILED ") << job.input << endl;
+    }
+
+    cerr << "Compiled " << jobs.size () << " programs ("
+         << failures << " failed) in " << totalTime << " ms using "
+         << numThreads << " threads." << endl;
+
+    return failures == 0;
+}
+
 } // anonymous namespace
 
 
@@ -293,56 +689,22 @@ int main (int argc, char *argv[]) {
         if (opts.showHelp)
             return EXIT_SUCCESS;
 
-        VMLinkingUnit vmlu;
-
-        {
-            SecreC::ICode icode;
-
-            /* Parse the program: */
-            SecreC::TreeNodeModule * parseTree = icode.parseMain (opts.input);
-            if (icode.status () != SecreC::ICode::OK) {
-                std::cerr << icode.compileLog ();
-                return EXIT_FAILURE;
-            }
-
-            /* Collect possible include files: */
-            for (const string& name : opts.includes) {
-                icode.modules ().addSearchPath (name, opts.verbose);
-            }
-
-            /* TODO: We should split type checking and compilation entirely. */
-            /* Translate to intermediate code: */
-            icode.compile (parseTree, opts.runtimeErrorPathStyle);
-
-            bool bad = icode.status () != SecreC::ICode::OK;
-
-            if (bad)
-                cerr << "Error generating valid intermediate code." << endl;
-
-            cerr << icode.compileLog () << endl;
-
-            if (bad)
-                return EXIT_FAILURE;
-
-            if (opts.syntaxOnly)
-                return EXIT_SUCCESS;
-
-            /* Compile: */
-            compile(vmlu, icode, opts.optimize);
+        /* Collect possible include files once for all programs: */
+        SharedState shared;
+        for (const string& name : opts.includes) {
+            const auto files = SecreC::ModuleMap::findModuleFiles (name, opts.verbose);
+            shared.moduleFiles.insert (shared.moduleFiles.end (), files.begin (), files.end ());
         }
 
-        /* Output: */
-        Output output (opts);
-        if (opts.assembleOnly) {
-            output.getStream() << vmlu << endl;
-        }
-        else {
-            if (! compileExecutable (output, vmlu)) {
-                return EXIT_FAILURE;
-            }
-        }
+        if (opts.moduleCache)
+            shared.moduleCache = std::make_shared<SecreC::ModuleCache> (*opts.moduleCache);
+        else if (opts.batch)
+            shared.moduleCache = std::make_shared<SecreC::ModuleCache> ();
+
+        if (opts.batch)
+            return compileBatch (opts, shared) ? EXIT_SUCCESS : EXIT_FAILURE;
 
-        return EXIT_SUCCESS;
+        return compileProgram (opts, shared, cerr) ? EXIT_SUCCESS : EXIT_FAILURE;
     }
     catch (const std::exception& e) {
         cerr << "Failed with exception:" << endl;
@@ -28,7 +28,7 @@ syn keyword	scModifier	template domain kind dim type module import public operat
 syn keyword	scConstant	true false
 
 syn keyword	scSupport	cat size shape reshape tostring assert declassify
-syn keyword	scSupport	__domainid __syscall __ref __cref __return __bytes_from_string __string_from_bytes
+syn keyword	scSupport	__domainid __syscall __pure __ref __cref __return __bytes_from_string __string_from_bytes
 
 syn match	scNumber	"\<\(0x\x\+\|0o\o\+\|\d\+\)\(i8\|i16\|i32\|i64\|u8\|u16\|u32\|u64\|f32\|f64\)\="
 syn match	scNumber	"\<\d\+\.\d\+\(f32\|f64\)\="
@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+/*
+ * Measures the throughput of the packed SIMD kernels of the VirtualMachine
+ * against element at a time loops over the unpacked 8-byte value slots that
+ * arrays used to be stored in. Both are checked to compute the same results.
+ *
+ * Usage: benchmark-libscc-kernels [--check]
+ *
+ * With --check only the results of every kernel are compared against the
+ * portable definitions. Set SECREC_VM_SIMD to "portable", "sse2" or "avx2"
+ * to restrict the instruction set.
+ */
+
+#include <libscc/VirtualMachineKernels.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace SecreC;
+
+/// Array element as it was stored before arrays were packed.
+template <typename T>
+union Slot {
+    T        value;
+    uint64_t raw;
+};
+
+/*
+ * Each operation pairs the element at a time reference, which is what the
+ * portable kernels compute, with the dispatching kernel under test.
+ */
+
+#define BINARY_OP(STRUCT, NAME, OP) \
+    struct STRUCT { \
+        static const char* name () { return #NAME; } \
+        template <typename T> static T apply (T x, T y) { return static_cast<T> (x OP y); } \
+        template <typename T> static void kernel (T* d, const T* x, const T* y, size_t n) { VMKernels::NAME (d, x, y, n); } \
+    };
+
+#define COMPARE_OP(STRUCT, NAME, OP) \
+    struct STRUCT { \
+        static const char* name () { return #NAME; } \
+        template <typename T> static bool apply (T x, T y) { return x OP y; } \
+        template <typename T> static void kernel (bool* d, const T* x, const T* y, size_t n) { VMKernels::NAME (d, x, y, n); } \
+    };
+
+#define LOGIC_OP(STRUCT, NAME, OP) \
+    struct STRUCT { \
+        static const char* name () { return #NAME; } \
+        static bool apply (bool x, bool y) { return x OP y; } \
+        static void kernel (bool* d, const bool* x, const bool* y, size_t n) { VMKernels::NAME (d, x, y, n); } \
+    };
+
+BINARY_OP (Add, add, +)
+BINARY_OP (Sub, sub, -)
+BINARY_OP (Mul, mul, *)
+BINARY_OP (BAnd, band, &)
+BINARY_OP (BOr, bor, |)
+BINARY_OP (BXor, bxor, ^)
+COMPARE_OP (Eq, eq, ==)
+COMPARE_OP (Ne, ne, !=)
+COMPARE_OP (Lt, lt, <)
+COMPARE_OP (Le, le, <=)
+COMPARE_OP (Gt, gt, >)
+COMPARE_OP (Ge, ge, >=)
+LOGIC_OP (LAnd, land, &&)
+LOGIC_OP (LOr, lor, ||)
+
+/// Input values, small enough that no arithmetic overflows.
+template <typename T>
+T sample (size_t i, size_t a, size_t b, size_t m) {
+    return static_cast<T> ((i * a + b) % m);
+}
+
+template <>
+bool sample<bool> (size_t i, size_t a, size_t b, size_t m) {
+    return (i * a + b) % m < m / 2;
+}
+
+/// Repeats f until at least 20 ms have passed, returns elements per second.
+template <typename F>
+double measure (size_t n, F f) {
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now ();
+    size_t rounds = 0;
+    std::chrono::duration<double> elapsed;
+    do {
+        for (size_t i = 0; i < 16; ++ i)
+            f ();
+        rounds += 16;
+        elapsed = Clock::now () - start;
+    } while (elapsed.count () < 0.02);
+
+    return static_cast<double> (rounds * n) / elapsed.count ();
+}
+
+template <typename Op, typename T>
+bool run (const char* typeName, size_t n, bool checkOnly) {
+    using R = decltype (Op::apply (T (), T ()));
+
+    std::vector<Slot<T> > slotX (n), slotY (n);
+    std::vector<Slot<R> > slotDest (n);
+    // Not std::vector, which packs bool:
+    std::unique_ptr<T[]> x (new T[n]), y (new T[n]);
+    std::unique_ptr<R[]> dest (new R[n]);
+    for (size_t i = 0; i < n; ++ i) {
+        x[i] = sample<T> (i, 7, 3, 101);
+        y[i] = sample<T> (i, 13, 5, 97);
+        slotX[i].value = x[i];
+        slotY[i].value = y[i];
+    }
+
+    auto unpacked = [&] () {
+        for (size_t i = 0; i < n; ++ i)
+            slotDest[i].value = Op::apply (slotX[i].value, slotY[i].value);
+    };
+
+    auto packed = [&] () { Op::kernel (dest.get (), x.get (), y.get (), n); };
+
+    unpacked ();
+    packed ();
+    for (size_t i = 0; i < n; ++ i) {
+        if (std::memcmp (&dest[i], &slotDest[i].value, sizeof (R)) != 0) {
+            std::cerr << Op::name () << " on " << typeName << "[" << n
+                      << "] differs at " << i << "." << std::endl;
+            return false;
+        }
+    }
+
+    if (! checkOnly) {
+        const double before = measure (n, unpacked);
+        const double after = measure (n, packed);
+        std::cout << std::setw (8) << typeName << std::setw (5) << Op::name ()
+                  << std::setw (8) << n
+                  << std::setw (12) << std::fixed << std::setprecision (1) << before / 1e6
+                  << std::setw (12) << after / 1e6
+                  << std::setw (8) << std::setprecision (2) << after / before << "x"
+                  << std::endl;
+    }
+
+    return true;
+}
+
+const std::initializer_list<size_t> lengths = { 1u, 15u, 16u, 100u, 4096u, 65536u };
+
+template <typename T>
+bool runNumeric (const char* typeName, bool checkOnly) {
+    bool ok = true;
+    for (size_t n : lengths) {
+        ok = run<Add, T> (typeName, n, checkOnly) && ok;
+        ok = run<Sub, T> (typeName, n, checkOnly) && ok;
+        ok = run<Mul, T> (typeName, n, checkOnly) && ok;
+        ok = run<Eq, T> (typeName, n, checkOnly) && ok;
+        ok = run<Ne, T> (typeName, n, checkOnly) && ok;
+        ok = run<Lt, T> (typeName, n, checkOnly) && ok;
+        ok = run<Le, T> (typeName, n, checkOnly) && ok;
+        ok = run<Gt, T> (typeName, n, checkOnly) && ok;
+        ok = run<Ge, T> (typeName, n, checkOnly) && ok;
+    }
+
+    return ok;
+}
+
+template <typename T>
+bool runInteger (const char* typeName, bool checkOnly) {
+    bool ok = runNumeric<T> (typeName, checkOnly);
+    for (size_t n : lengths) {
+        ok = run<BAnd, T> (typeName, n, checkOnly) && ok;
+        ok = run<BOr, T> (typeName, n, checkOnly) && ok;
+        ok = run<BXor, T> (typeName, n, checkOnly) && ok;
+    }
+
+    return ok;
+}
+
+bool runLogic (bool checkOnly) {
+    bool ok = true;
+    for (size_t n : lengths) {
+        ok = run<LAnd, bool> ("bool", n, checkOnly) && ok;
+        ok = run<LOr, bool> ("bool", n, checkOnly) && ok;
+    }
+
+    return ok;
+}
+
+} // anonymous namespace
+
+int main (int argc, char* argv[]) {
+    const bool checkOnly = argc > 1 && std::strcmp (argv[1], "--check") == 0;
+
+    std::cout << "Instruction set: "
+              << VMKernels::instructionSetName (VMKernels::instructionSet ())
+              << std::endl;
+    if (! checkOnly) {
+        std::cout << "    type   op  length  unpacked M/s  packed M/s  speedup" << std::endl;
+    }
+
+    bool ok = true;
+    ok = runInteger<int8_t> ("int8", checkOnly) && ok;
+    ok = runInteger<int16_t> ("int16", checkOnly) && ok;
+    ok = runInteger<int32_t> ("int32", checkOnly) && ok;
+    ok = runInteger<int64_t> ("int64", checkOnly) && ok;
+    ok = runInteger<uint8_t> ("uint8", checkOnly) && ok;
+    ok = runInteger<uint16_t> ("uint16", checkOnly) && ok;
+    ok = runInteger<uint32_t> ("uint32", checkOnly) && ok;
+    ok = runInteger<uint64_t> ("uint64", checkOnly) && ok;
+    ok = runNumeric<float> ("float32", checkOnly) && ok;
+    ok = runNumeric<double> ("float64", checkOnly) && ok;
+    ok = runLogic (checkOnly) && ok;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+/*
+ * Compiles the given programs on several threads at once, each compilation
+ * with its own ICode, and checks that every thread produces the same
+ * optimized intermediate code as a sequential compilation.
+ *
+ * Usage: test-libscc-testconcurrent <threads> <source>...
+ */
+
+#include <libscc/Intermediate.h>
+#include <libscc/Optimizer.h>
+#include <libscc/TreeNode.h>
+
+#include <atomic>
+#include <boost/optional.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::string compileToIR (const std::string& path) {
+    std::unique_ptr<SecreC::TreeNodeModule> parseTree;
+    SecreC::ICode icode;
+
+    parseTree.reset (icode.parseMain (path));
+    if (icode.status () != SecreC::ICode::OK) {
+        std::ostringstream os;
+        os << "Parsing failed:" << std::endl << icode.compileLog ();
+        return os.str ();
+    }
+
+    icode.compile (parseTree.get (), SecreC::Location::PathStyle::FileName);
+    if (icode.status () != SecreC::ICode::OK) {
+        std::ostringstream os;
+        os << "Compilation failed:" << std::endl << icode.compileLog ();
+        return os.str ();
+    }
+
+    SecreC::optimizeCode (icode);
+
+    std::ostringstream os;
+    os << icode.program ();
+    return os.str ();
+}
+
+} // anonymous namespace
+
+int main (int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <threads> <source>..." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const unsigned numThreads = std::stoul (argv[1]);
+    const std::vector<std::string> sources (argv + 2, argv + argc);
+
+    std::vector<std::string> expected;
+    for (const std::string& source : sources)
+        expected.push_back (compileToIR (source));
+
+    std::atomic<unsigned> mismatches (0u);
+    std::mutex errorMutex;
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; ++ t) {
+        threads.emplace_back ([&, t] {
+            // Every thread starts from a different program so that different
+            // programs are compiled at the same time.
+            for (size_t i = 0; i < sources.size (); ++ i) {
+                const size_t j = (i + t) % sources.size ();
+                if (compileToIR (sources[j]) != expected[j]) {
+                    ++ mismatches;
+                    std::lock_guard<std::mutex> lock (errorMutex);
+                    std::cerr << "Thread " << t << " compiled " << sources[j]
+                              << " differently." << std::endl;
+                }
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+        thread.join ();
+
+    if (mismatches > 0u) {
+        std::cerr << mismatches << " compilations differed." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
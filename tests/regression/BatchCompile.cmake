@@ -0,0 +1,71 @@
+#
+# Copyright (C) 2015 Cybernetica
+#
+# Research/Commercial License Usage
+# Licensees holding a valid Research License or Commercial License
+# for the Software may use this file according to the written
+# agreement between you and Cybernetica.
+#
+# GNU General Public License Usage
+# Alternatively, this file may be used under the terms of the GNU
+# General Public License version 3.0 as published by the Free Software
+# Foundation and appearing in the file LICENSE.GPL included in the
+# packaging of this file.  Please review the following information to
+# ensure the GNU General Public License version 3.0 requirements will be
+# met: http://www.gnu.org/copyleft/gpl-3.0.html.
+#
+# For further information, please contact us at sharemind@cyber.ee.
+#
+
+# Compiles a set of programs with scc one at a time and then all at once in
+# batch mode, and checks that the batch produces byte-identical executables.
+# Invoked by the "batch/scc" test with SCC set to the compiler binary, CORPUS
+# set to the regression test directory and WORKDIR set to a scratch directory.
+
+SET(PROGRAMS
+    "modules/00-module-cache"
+    "scalars/31-fib"
+    "scalars/33-string"
+    "arrays/31-concat-2d"
+    "arrays/56-private-gather-scatter"
+    "structs/01-simple-definition")
+
+FILE(REMOVE_RECURSE "${WORKDIR}")
+FILE(MAKE_DIRECTORY "${WORKDIR}")
+
+SET(BATCH_LIST "${WORKDIR}/batch.txt")
+FILE(WRITE "${BATCH_LIST}" "# Generated by BatchCompile.cmake\n")
+
+FOREACH(PROGRAM ${PROGRAMS})
+    STRING(REPLACE "/" "-" NAME "${PROGRAM}")
+    EXECUTE_PROCESS(COMMAND "${SCC}" --no-stdlib -I "${CORPUS}/modules/lib"
+                            -o "${WORKDIR}/${NAME}-single.sb"
+                            "${CORPUS}/${PROGRAM}.sc"
+                    RESULT_VARIABLE RESULT
+                    ERROR_VARIABLE ERRORS)
+    IF(NOT RESULT EQUAL 0)
+        MESSAGE(FATAL_ERROR "Compiling ${PROGRAM} failed:\n${ERRORS}")
+    ENDIF()
+
+    FILE(APPEND "${BATCH_LIST}"
+         "${CORPUS}/${PROGRAM}.sc ${WORKDIR}/${NAME}-batch.sb\n")
+ENDFOREACH()
+
+EXECUTE_PROCESS(COMMAND "${SCC}" --no-stdlib -I "${CORPUS}/modules/lib"
+                        --batch "${BATCH_LIST}" -j 4
+                RESULT_VARIABLE RESULT
+                ERROR_VARIABLE ERRORS)
+IF(NOT RESULT EQUAL 0)
+    MESSAGE(FATAL_ERROR "Batch compilation failed:\n${ERRORS}")
+ENDIF()
+
+FOREACH(PROGRAM ${PROGRAMS})
+    STRING(REPLACE "/" "-" NAME "${PROGRAM}")
+    EXECUTE_PROCESS(COMMAND "${CMAKE_COMMAND}" -E compare_files
+                            "${WORKDIR}/${NAME}-single.sb"
+                            "${WORKDIR}/${NAME}-batch.sb"
+                    RESULT_VARIABLE RESULT)
+    IF(NOT RESULT EQUAL 0)
+        MESSAGE(FATAL_ERROR "Batch compilation changed the bytecode of ${PROGRAM}.")
+    ENDIF()
+ENDFOREACH()
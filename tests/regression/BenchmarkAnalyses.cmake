@@ -0,0 +1,62 @@
+#
+# Copyright (C) 2015 Cybernetica
+#
+# Research/Commercial License Usage
+# Licensees holding a valid Research License or Commercial License
+# for the Software may use this file according to the written
+# agreement between you and Cybernetica.
+#
+# GNU General Public License Usage
+# Alternatively, this file may be used under the terms of the GNU
+# General Public License version 3.0 as published by the Free Software
+# Foundation and appearing in the file LICENSE.GPL included in the
+# packaging of this file.  Please review the following information to
+# ensure the GNU General Public License version 3.0 requirements will be
+# met: http://www.gnu.org/copyleft/gpl-3.0.html.
+#
+# For further information, please contact us at sharemind@cyber.ee.
+#
+
+
+# Measures the time and memory taken by the live variables, reaching
+# definitions and reachable uses analyses over the regression corpus. Invoked
+# by the "benchmark-analyses" target with SCA set to the analyzer binary and
+# CORPUS set to the test directory. Compare the totals between builds.
+
+SET(ANALYSES lv rd ru)
+
+FILE(GLOB_RECURSE SOURCES "${CORPUS}/*.sc")
+LIST(SORT SOURCES)
+
+FOREACH(ANALYSIS ${ANALYSES})
+    SET(TIME_${ANALYSIS} 0)
+    SET(MEMORY_${ANALYSIS} 0)
+ENDFOREACH()
+
+FOREACH(SOURCE ${SOURCES})
+    FOREACH(ANALYSIS ${ANALYSES})
+        EXECUTE_PROCESS(COMMAND "${SCA}" -v -a ${ANALYSIS} "${SOURCE}"
+            OUTPUT_QUIET
+            ERROR_VARIABLE LOG)
+
+        # Times are summed in microseconds:
+        IF(LOG MATCHES "Analysis \"${ANALYSIS}\": [0-9]+ runs, [0-9]+ rounds, [0-9]+ blocks visited in ([0-9]+)\\.?([0-9]*) ms")
+            SET(WHOLE "${CMAKE_MATCH_1}")
+            SET(FRACTION "${CMAKE_MATCH_2}000")
+            STRING(SUBSTRING "${FRACTION}" 0 3 FRACTION)
+            STRING(REGEX REPLACE "^0+([0-9])" "\\1" FRACTION "${FRACTION}")
+            MATH(EXPR TIME_${ANALYSIS} "${TIME_${ANALYSIS}} + ${WHOLE} * 1000 + ${FRACTION}")
+        ENDIF()
+
+        IF(LOG MATCHES "results take ([0-9]+) KiB")
+            MATH(EXPR MEMORY_${ANALYSIS} "${MEMORY_${ANALYSIS}} + ${CMAKE_MATCH_1}")
+        ENDIF()
+    ENDFOREACH()
+ENDFOREACH()
+
+LIST(LENGTH SOURCES COUNT)
+MESSAGE(STATUS "Analysed ${COUNT} programs:")
+FOREACH(ANALYSIS ${ANALYSES})
+    MATH(EXPR MILLISECONDS "${TIME_${ANALYSIS}} / 1000")
+    MESSAGE(STATUS "  ${ANALYSIS}: ${MILLISECONDS} ms, ${MEMORY_${ANALYSIS}} KiB")
+ENDFOREACH()
@@ -0,0 +1,65 @@
+#
+# Copyright (C) 2015 Cybernetica
+#
+# Research/Commercial License Usage
+# Licensees holding a valid Research License or Commercial License
+# for the Software may use this file according to the written
+# agreement between you and Cybernetica.
+#
+# GNU General Public License Usage
+# Alternatively, this file may be used under the terms of the GNU
+# General Public License version 3.0 as published by the Free Software
+# Foundation and appearing in the file LICENSE.GPL included in the
+# packaging of this file.  Please review the following information to
+# ensure the GNU General Public License version 3.0 requirements will be
+# met: http://www.gnu.org/copyleft/gpl-3.0.html.
+#
+# For further information, please contact us at sharemind@cyber.ee.
+#
+
+# Measures the peak memory use of scc over the regression corpus, and the
+# amount of generated code it holds. Invoked by the "benchmark-memory" target
+# with SCC set to the compiler binary, CORPUS set to the test directory and
+# WORKDIR set to a scratch directory. Programs that need the standard library
+# are skipped. Compare the totals between builds.
+
+FILE(GLOB_RECURSE SOURCES "${CORPUS}/*.sc")
+LIST(SORT SOURCES)
+
+FILE(REMOVE_RECURSE "${WORKDIR}")
+FILE(MAKE_DIRECTORY "${WORKDIR}")
+
+SET(COUNT 0)
+SET(SKIPPED 0)
+SET(PEAK_MAX 0)
+SET(PEAK_TOTAL 0)
+SET(CODE_TOTAL 0)
+
+FOREACH(SOURCE ${SOURCES})
+    EXECUTE_PROCESS(COMMAND "${SCC}" -v -S --no-stdlib -I "${CORPUS}/modules/lib"
+                            -o "${WORKDIR}/out.s" "${SOURCE}"
+        RESULT_VARIABLE RESULT
+        OUTPUT_QUIET
+        ERROR_VARIABLE LOG)
+
+    IF(NOT RESULT EQUAL 0 OR NOT LOG MATCHES "Peak memory: ([0-9]+) KiB, ([0-9]+) bytes of generated code")
+        MATH(EXPR SKIPPED "${SKIPPED} + 1")
+    ELSE()
+        MATH(EXPR COUNT "${COUNT} + 1")
+        MATH(EXPR PEAK_TOTAL "${PEAK_TOTAL} + ${CMAKE_MATCH_1}")
+        MATH(EXPR CODE_TOTAL "${CODE_TOTAL} + ${CMAKE_MATCH_2}")
+        IF(CMAKE_MATCH_1 GREATER PEAK_MAX)
+            SET(PEAK_MAX ${CMAKE_MATCH_1})
+        ENDIF()
+    ENDIF()
+ENDFOREACH()
+
+IF(COUNT EQUAL 0)
+    MESSAGE(FATAL_ERROR "No programs were compiled.")
+ENDIF()
+
+MATH(EXPR PEAK_AVERAGE "${PEAK_TOTAL} / ${COUNT}")
+MATH(EXPR CODE_TOTAL "${CODE_TOTAL} / 1024")
+MESSAGE(STATUS "Compiled ${COUNT} programs, ${SKIPPED} skipped:")
+MESSAGE(STATUS "  peak memory:    ${PEAK_MAX} KiB at most, ${PEAK_AVERAGE} KiB on average")
+MESSAGE(STATUS "  generated code: ${CODE_TOTAL} KiB in total")
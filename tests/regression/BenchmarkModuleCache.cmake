@@ -0,0 +1,73 @@
+#
+# Copyright (C) 2015 Cybernetica
+#
+# Research/Commercial License Usage
+# Licensees holding a valid Research License or Commercial License
+# for the Software may use this file according to the written
+# agreement between you and Cybernetica.
+#
+# GNU General Public License Usage
+# Alternatively, this file may be used under the terms of the GNU
+# General Public License version 3.0 as published by the Free Software
+# Foundation and appearing in the file LICENSE.GPL included in the
+# packaging of this file.  Please review the following information to
+# ensure the GNU General Public License version 3.0 requirements will be
+# met: http://www.gnu.org/copyleft/gpl-3.0.html.
+#
+# For further information, please contact us at sharemind@cyber.ee.
+#
+
+
+# Measures how long it takes to compile a program importing each module of
+# the standard library, first with an empty and then with a warm module cache.
+# Invoked by the "benchmark-module-cache" target with SCA set to the analyzer
+# binary, MODULES set to the standard library directory and WORKDIR set to a
+# scratch directory for the cache and the generated programs.
+
+FILE(GLOB MODULE_SOURCES "${MODULES}/*.sc")
+LIST(SORT MODULE_SOURCES)
+IF(NOT MODULE_SOURCES)
+    MESSAGE(FATAL_ERROR "No modules found in ${MODULES}.")
+ENDIF()
+
+SET(CACHE_DIR "${WORKDIR}/cache")
+SET(TOTAL_cold 0)
+SET(TOTAL_warm 0)
+SET(FAILURES 0)
+
+FILE(REMOVE_RECURSE "${WORKDIR}")
+FILE(MAKE_DIRECTORY "${WORKDIR}")
+
+FOREACH(MODULE_SOURCE ${MODULE_SOURCES})
+    GET_FILENAME_COMPONENT(MODULE "${MODULE_SOURCE}" NAME_WE)
+    SET(SOURCE "${WORKDIR}/import-${MODULE}.sc")
+    FILE(WRITE "${SOURCE}" "import ${MODULE};\nvoid main () { }\n")
+
+    FOREACH(MODE cold warm)
+        IF(MODE STREQUAL "cold")
+            FILE(REMOVE_RECURSE "${CACHE_DIR}")
+        ENDIF()
+
+        EXECUTE_PROCESS(COMMAND "${SCA}" -v --no-stdlib -I "${MODULES}"
+                                --module-cache "${CACHE_DIR}" "${SOURCE}"
+                        RESULT_VARIABLE RESULT
+                        OUTPUT_QUIET
+                        ERROR_VARIABLE LOG)
+
+        IF(NOT RESULT EQUAL 0)
+            MESSAGE(WARNING "Importing ${MODULE} failed (${MODE} cache)")
+            MATH(EXPR FAILURES "${FAILURES} + 1")
+        ELSEIF(LOG MATCHES "generated in ([0-9]+) ms")
+            MATH(EXPR TOTAL_${MODE} "${TOTAL_${MODE}} + ${CMAKE_MATCH_1}")
+        ENDIF()
+    ENDFOREACH()
+ENDFOREACH()
+
+LIST(LENGTH MODULE_SOURCES COUNT)
+MESSAGE(STATUS "Imported ${COUNT} modules:")
+MESSAGE(STATUS "  cold module cache: ${TOTAL_cold} ms")
+MESSAGE(STATUS "  warm module cache: ${TOTAL_warm} ms")
+
+IF(FAILURES GREATER 0)
+    MESSAGE(FATAL_ERROR "${FAILURES} imports failed.")
+ENDIF()
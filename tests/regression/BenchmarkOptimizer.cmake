@@ -0,0 +1,63 @@
+#
+# Copyright (C) 2015 Cybernetica
+#
+# Research/Commercial License Usage
+# Licensees holding a valid Research License or Commercial License
+# for the Software may use this file according to the written
+# agreement between you and Cybernetica.
+#
+# GNU General Public License Usage
+# Alternatively, this file may be used under the terms of the GNU
+# General Public License version 3.0 as published by the Free Software
+# Foundation and appearing in the file LICENSE.GPL included in the
+# packaging of this file.  Please review the following information to
+# ensure the GNU General Public License version 3.0 requirements will be
+# met: http://www.gnu.org/copyleft/gpl-3.0.html.
+#
+# For further information, please contact us at sharemind@cyber.ee.
+#
+
+
+# Measures the time spent in the optimizer over the regression corpus, both
+# with incremental and with full re-analysis, and checks that both produce the
+# same intermediate code. Invoked by the "benchmark-optimizer" target with
+# SCA set to the analyzer binary and CORPUS set to the test directory.
+
+FILE(GLOB_RECURSE SOURCES "${CORPUS}/*.sc")
+LIST(SORT SOURCES)
+
+SET(TOTAL_incremental 0)
+SET(TOTAL_full 0)
+SET(MISMATCHES 0)
+
+FOREACH(SOURCE ${SOURCES})
+    FOREACH(MODE incremental full)
+        IF(MODE STREQUAL "full")
+            SET(FLAGS "--full-reanalysis")
+        ELSE()
+            SET(FLAGS "")
+        ENDIF()
+
+        EXECUTE_PROCESS(COMMAND "${SCA}" -O -v --print-ir ${FLAGS} "${SOURCE}"
+            OUTPUT_VARIABLE IR_${MODE}
+            ERROR_VARIABLE LOG)
+
+        IF(LOG MATCHES "Optimized in ([0-9]+) ms")
+            MATH(EXPR TOTAL_${MODE} "${TOTAL_${MODE}} + ${CMAKE_MATCH_1}")
+        ENDIF()
+    ENDFOREACH()
+
+    IF(NOT IR_incremental STREQUAL IR_full)
+        MESSAGE(WARNING "Incremental and full re-analysis disagree on ${SOURCE}")
+        MATH(EXPR MISMATCHES "${MISMATCHES} + 1")
+    ENDIF()
+ENDFOREACH()
+
+LIST(LENGTH SOURCES COUNT)
+MESSAGE(STATUS "Optimized ${COUNT} programs:")
+MESSAGE(STATUS "  full re-analysis:        ${TOTAL_full} ms")
+MESSAGE(STATUS "  incremental re-analysis: ${TOTAL_incremental} ms")
+
+IF(MISMATCHES GREATER 0)
+    MESSAGE(FATAL_ERROR "${MISMATCHES} programs were optimized differently.")
+ENDIF()
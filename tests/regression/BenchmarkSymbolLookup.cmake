@@ -0,0 +1,78 @@
+#
+# Copyright (C) 2015 Cybernetica
+#
+# Research/Commercial License Usage
+# Licensees holding a valid Research License or Commercial License
+# for the Software may use this file according to the written
+# agreement between you and Cybernetica.
+#
+# GNU General Public License Usage
+# Alternatively, this file may be used under the terms of the GNU
+# General Public License version 3.0 as published by the Free Software
+# Foundation and appearing in the file LICENSE.GPL included in the
+# packaging of this file.  Please review the following information to
+# ensure the GNU General Public License version 3.0 requirements will be
+# met: http://www.gnu.org/copyleft/gpl-3.0.html.
+#
+# For further information, please contact us at sharemind@cyber.ee.
+#
+
+
+# Measures the time the type checker spends looking symbols up by name while
+# compiling a program importing each module of the standard library, once
+# with the per-scope name index and once comparing the name of every symbol
+# as before the index. Invoked by the "benchmark-symbol-lookup" target with
+# SCA set to the analyzer binary, MODULES set to the standard library
+# directory and WORKDIR set to a scratch directory for the generated programs.
+
+FILE(GLOB MODULE_SOURCES "${MODULES}/*.sc")
+LIST(SORT MODULE_SOURCES)
+IF(NOT MODULE_SOURCES)
+    MESSAGE(FATAL_ERROR "No modules found in ${MODULES}.")
+ENDIF()
+
+SET(TOTAL_scan 0)
+SET(TOTAL_index 0)
+SET(LOOKUPS 0)
+SET(FAILURES 0)
+
+FILE(REMOVE_RECURSE "${WORKDIR}")
+FILE(MAKE_DIRECTORY "${WORKDIR}")
+
+FOREACH(MODULE_SOURCE ${MODULE_SOURCES})
+    GET_FILENAME_COMPONENT(MODULE "${MODULE_SOURCE}" NAME_WE)
+    SET(SOURCE "${WORKDIR}/import-${MODULE}.sc")
+    FILE(WRITE "${SOURCE}" "import ${MODULE};\nvoid main () { }\n")
+
+    FOREACH(MODE scan index)
+        IF(MODE STREQUAL "scan")
+            SET(FLAGS "--no-symbol-index")
+        ELSE()
+            SET(FLAGS "")
+        ENDIF()
+
+        EXECUTE_PROCESS(COMMAND "${SCA}" -v ${FLAGS} --no-stdlib -I "${MODULES}" "${SOURCE}"
+                        RESULT_VARIABLE RESULT
+                        OUTPUT_QUIET
+                        ERROR_VARIABLE LOG)
+
+        IF(NOT RESULT EQUAL 0)
+            MESSAGE(WARNING "Importing ${MODULE} failed (${MODE})")
+            MATH(EXPR FAILURES "${FAILURES} + 1")
+        ELSEIF(LOG MATCHES "Symbol lookup: ([0-9]+) lookups in ([0-9]+) us")
+            MATH(EXPR TOTAL_${MODE} "${TOTAL_${MODE}} + ${CMAKE_MATCH_2}")
+            IF(MODE STREQUAL "index")
+                MATH(EXPR LOOKUPS "${LOOKUPS} + ${CMAKE_MATCH_1}")
+            ENDIF()
+        ENDIF()
+    ENDFOREACH()
+ENDFOREACH()
+
+LIST(LENGTH MODULE_SOURCES COUNT)
+MESSAGE(STATUS "Imported ${COUNT} modules with ${LOOKUPS} symbol lookups:")
+MESSAGE(STATUS "  comparing every name: ${TOTAL_scan} us")
+MESSAGE(STATUS "  name index:           ${TOTAL_index} us")
+
+IF(FAILURES GREATER 0)
+    MESSAGE(FATAL_ERROR "${FAILURES} imports failed.")
+ENDIF()
@@ -0,0 +1,44 @@
+#
+# Copyright (C) 2015 Cybernetica
+#
+# Research/Commercial License Usage
+# Licensees holding a valid Research License or Commercial License
+# for the Software may use this file according to the written
+# agreement between you and Cybernetica.
+#
+# GNU General Public License Usage
+# Alternatively, this file may be used under the terms of the GNU
+# General Public License version 3.0 as published by the Free Software
+# Foundation and appearing in the file LICENSE.GPL included in the
+# packaging of this file.  Please review the following information to
+# ensure the GNU General Public License version 3.0 requirements will be
+# met: http://www.gnu.org/copyleft/gpl-3.0.html.
+#
+# For further information, please contact us at sharemind@cyber.ee.
+#
+
+# Measures the throughput of the reference interpreter on loop and call heavy
+# programs. Invoked by the "benchmark-vm" target with SCA set to the analyzer
+# binary and CORPUS set to the test directory. Compare the rates between builds.
+
+SET(PROGRAMS
+    "scalars/06-rec"
+    "scalars/13-loop-bench"
+    "scalars/31-fib"
+    "scalars/87-call-loop-bench")
+
+FOREACH(PROGRAM ${PROGRAMS})
+    EXECUTE_PROCESS(COMMAND "${SCA}" -v --eval "${CORPUS}/${PROGRAM}.sc"
+        RESULT_VARIABLE RESULT
+        OUTPUT_QUIET
+        ERROR_VARIABLE LOG)
+    IF(NOT RESULT EQUAL 0)
+        MESSAGE(FATAL_ERROR "Evaluating ${PROGRAM} failed:\n${LOG}")
+    ENDIF()
+
+    IF(LOG MATCHES "Executed ([0-9]+) instructions in ([0-9]+) ms( \\(([0-9]+) instructions/s\\))?")
+        MESSAGE(STATUS "${PROGRAM}: ${CMAKE_MATCH_1} instructions in ${CMAKE_MATCH_2} ms, ${CMAKE_MATCH_4} instructions/s")
+    ELSE()
+        MESSAGE(FATAL_ERROR "No interpreter statistics for ${PROGRAM}:\n${LOG}")
+    ENDIF()
+ENDFOREACH()
@@ -0,0 +1,72 @@
+#
+# Copyright (C) 2015 Cybernetica
+#
+# Research/Commercial License Usage
+# Licensees holding a valid Research License or Commercial License
+# for the Software may use this file according to the written
+# agreement between you and Cybernetica.
+#
+# GNU General Public License Usage
+# Alternatively, this file may be used under the terms of the GNU
+# General Public License version 3.0 as published by the Free Software
+# Foundation and appearing in the file LICENSE.GPL included in the
+# packaging of this file.  Please review the following information to
+# ensure the GNU General Public License version 3.0 requirements will be
+# met: http://www.gnu.org/copyleft/gpl-3.0.html.
+#
+# For further information, please contact us at sharemind@cyber.ee.
+#
+
+
+# Compiles SOURCE with scc once with the in-memory assembler and once through
+# a temporary assembly file, and checks that the bytecode is byte-identical.
+# It is also compiled with every procedure allocated by linear scan, so that
+# debug builds check the slots of the allocator. If REFERENCE_SCC is set, the
+# assembly must also be identical to the one of that compiler, such as a build
+# from before VM code was kept in an arena. Invoked by the "bytecode/..." tests
+# with SCC set to the compiler binary and OUTPUT set to the path prefix for the
+# executables.
+
+FOREACH(MODE memory file linear-scan)
+    IF(MODE STREQUAL "file")
+        SET(FLAGS "--assemble-via-file")
+    ELSEIF(MODE STREQUAL "linear-scan")
+        SET(FLAGS "--linear-scan-threshold" "0")
+    ELSE()
+        SET(FLAGS "")
+    ENDIF()
+
+    EXECUTE_PROCESS(COMMAND "${SCC}" ${FLAGS} --no-stdlib
+                            -o "${OUTPUT}-${MODE}.sb" "${SOURCE}"
+                    RESULT_VARIABLE RESULT
+                    ERROR_VARIABLE ERRORS)
+    IF(NOT RESULT EQUAL 0)
+        MESSAGE(FATAL_ERROR "Compiling ${SOURCE} (${MODE}) failed:\n${ERRORS}")
+    ENDIF()
+ENDFOREACH()
+
+EXECUTE_PROCESS(COMMAND "${CMAKE_COMMAND}" -E compare_files
+                        "${OUTPUT}-memory.sb" "${OUTPUT}-file.sb"
+                RESULT_VARIABLE RESULT)
+IF(NOT RESULT EQUAL 0)
+    MESSAGE(FATAL_ERROR "Bytecode of ${SOURCE} differs between the in-memory and file assemblers.")
+ENDIF()
+
+IF(REFERENCE_SCC)
+    FOREACH(COMPILER SCC REFERENCE_SCC)
+        EXECUTE_PROCESS(COMMAND "${${COMPILER}}" --no-stdlib -S
+                                -o "${OUTPUT}-${COMPILER}.s" "${SOURCE}"
+                        RESULT_VARIABLE RESULT
+                        ERROR_VARIABLE ERRORS)
+        IF(NOT RESULT EQUAL 0)
+            MESSAGE(FATAL_ERROR "Compiling ${SOURCE} to assembly with ${${COMPILER}} failed:\n${ERRORS}")
+        ENDIF()
+    ENDFOREACH()
+
+    EXECUTE_PROCESS(COMMAND "${CMAKE_COMMAND}" -E compare_files
+                            "${OUTPUT}-SCC.s" "${OUTPUT}-REFERENCE_SCC.s"
+                    RESULT_VARIABLE RESULT)
+    IF(NOT RESULT EQUAL 0)
+        MESSAGE(FATAL_ERROR "Assembly of ${SOURCE} differs from the one of ${REFERENCE_SCC}.")
+    ENDIF()
+ENDIF()
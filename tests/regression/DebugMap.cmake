@@ -0,0 +1,114 @@
+#
+# Copyright (C) 2015 Cybernetica
+#
+# Research/Commercial License Usage
+# Licensees holding a valid Research License or Commercial License
+# for the Software may use this file according to the written
+# agreement between you and Cybernetica.
+#
+# GNU General Public License Usage
+# Alternatively, this file may be used under the terms of the GNU
+# General Public License version 3.0 as published by the Free Software
+# Foundation and appearing in the file LICENSE.GPL included in the
+# packaging of this file.  Please review the following information to
+# ensure the GNU General Public License version 3.0 requirements will be
+# met: http://www.gnu.org/copyleft/gpl-3.0.html.
+#
+# For further information, please contact us at sharemind@cyber.ee.
+#
+
+# Compiles a program of several procedures with scc --debug-map and checks
+# that the functions and instructions are mapped to the lines of the source
+# they were generated for, at the offsets of the assembled code. Invoked by
+# the "codegen/02-debug-map-scc" test with SCC set to the compiler binary,
+# CORPUS set to the regression test directory and WORKDIR set to a scratch
+# directory.
+
+FILE(REMOVE_RECURSE "${WORKDIR}")
+FILE(MAKE_DIRECTORY "${WORKDIR}")
+
+SET(MAP "${WORKDIR}/debug-map.json")
+EXECUTE_PROCESS(COMMAND "${SCC}" --no-stdlib --debug-map "${MAP}"
+                        -o "${WORKDIR}/debug-map.sb"
+                        "${CORPUS}/codegen/02-debug-map.sc"
+                RESULT_VARIABLE RESULT
+                ERROR_VARIABLE ERRORS)
+IF(NOT RESULT EQUAL 0)
+    MESSAGE(FATAL_ERROR "Compiling the program failed:\n${ERRORS}")
+ENDIF()
+
+FILE(READ "${MAP}" map)
+
+FUNCTION(expect PATTERN)
+    IF(NOT map MATCHES "${PATTERN}")
+        MESSAGE(FATAL_ERROR "The debug map does not match \"${PATTERN}\":\n${map}")
+    ENDIF()
+ENDFUNCTION()
+
+SET(FILE "\"file\": \"[^\"]*02-debug-map.sc\"")
+
+# Functions start at the definitions of their procedures:
+expect("\"label\": \":start\", \"offset\": [0-9]+, \"procedure\": \"<entry>\"}")
+expect("\"offset\": [0-9]+, \"procedure\": \"square\", ${FILE}, \"line\": 4, \"column\": [0-9]+}")
+expect("\"offset\": [0-9]+, \"procedure\": \"sumOfSquares\", ${FILE}, \"line\": 8, \"column\": [0-9]+}")
+expect("\"offset\": [0-9]+, \"procedure\": \"main\", ${FILE}, \"line\": 17, \"column\": [0-9]+}")
+
+# Instructions map to the statements of the enclosing procedure:
+expect("\"procedure\": \"square\", ${FILE}, \"line\": 5, \"column\": [0-9]+}")
+expect("\"procedure\": \"sumOfSquares\", ${FILE}, \"line\": 9, \"column\": [0-9]+}")
+expect("\"procedure\": \"sumOfSquares\", ${FILE}, \"line\": 11, \"column\": [0-9]+}")
+expect("\"procedure\": \"main\", ${FILE}, \"line\": 18, \"column\": [0-9]+}")
+
+# Ranges are in the order of the code and do not overlap:
+STRING(REGEX MATCHALL "\"begin\": [0-9]+, \"end\": [0-9]+" ranges "${map}")
+SET(previous 0)
+FOREACH(range ${ranges})
+    STRING(REGEX MATCH "\"begin\": ([0-9]+), \"end\": ([0-9]+)" range "${range}")
+    IF(CMAKE_MATCH_1 LESS previous OR NOT CMAKE_MATCH_2 GREATER CMAKE_MATCH_1)
+        MESSAGE(FATAL_ERROR "Ranges overlap at \"${range}\":\n${map}")
+    ENDIF()
+    SET(previous ${CMAKE_MATCH_2})
+ENDFOREACH()
+
+# Offsets are in code blocks of the bytecode. The constants assigned on lines
+# 19 and 21 of main are arguments of instructions of the same form, so they
+# are as many 8-byte code blocks apart in the executable as the ranges of the
+# two lines are in the map:
+FILE(READ "${WORKDIR}/debug-map.sb" bytecode HEX)
+
+FUNCTION(block_of CONSTANT RESULT_VAR)
+    STRING(FIND "${bytecode}" "${CONSTANT}" position)
+    STRING(FIND "${bytecode}" "${CONSTANT}" last REVERSE)
+    IF(position EQUAL -1 OR NOT position EQUAL last)
+        MESSAGE(FATAL_ERROR "The constant ${CONSTANT} is not in the bytecode exactly once.")
+    ENDIF()
+
+    # Two hexadecimal digits per byte, 8 bytes per code block:
+    MATH(EXPR remainder "${position} % 16")
+    MATH(EXPR block "${position} / 16")
+    SET(${RESULT_VAR} ${block} PARENT_SCOPE)
+    SET(${RESULT_VAR}_ALIGNMENT ${remainder} PARENT_SCOPE)
+ENDFUNCTION()
+
+FUNCTION(begin_of LINE RESULT_VAR)
+    IF(NOT map MATCHES "\"begin\": ([0-9]+), \"end\": [0-9]+, \"function\": \"[^\"]*\", \"procedure\": \"main\", ${FILE}, \"line\": ${LINE},")
+        MESSAGE(FATAL_ERROR "No instructions of line ${LINE} in the debug map:\n${map}")
+    ENDIF()
+    SET(${RESULT_VAR} ${CMAKE_MATCH_1} PARENT_SCOPE)
+ENDFUNCTION()
+
+# 1589887198 and 1589886703 as 64-bit little-endian code blocks:
+block_of("dec0c35e00000000" first)
+block_of("efbec35e00000000" second)
+IF(NOT first_ALIGNMENT EQUAL second_ALIGNMENT)
+    MESSAGE(FATAL_ERROR "The constants are not in aligned code blocks of the bytecode.")
+ENDIF()
+
+begin_of(19 firstBegin)
+begin_of(21 secondBegin)
+MATH(EXPR expected "${second} - ${first}")
+MATH(EXPR actual "${secondBegin} - ${firstBegin}")
+IF(NOT actual EQUAL expected)
+    MESSAGE(FATAL_ERROR "Lines 19 and 21 are ${actual} code blocks apart in the debug map, "
+                        "${expected} in the bytecode:\n${map}")
+ENDIF()
@@ -0,0 +1,65 @@
+#
+# Copyright (C) 2015 Cybernetica
+#
+# Research/Commercial License Usage
+# Licensees holding a valid Research License or Commercial License
+# for the Software may use this file according to the written
+# agreement between you and Cybernetica.
+#
+# GNU General Public License Usage
+# Alternatively, this file may be used under the terms of the GNU
+# General Public License version 3.0 as published by the Free Software
+# Foundation and appearing in the file LICENSE.GPL included in the
+# packaging of this file.  Please review the following information to
+# ensure the GNU General Public License version 3.0 requirements will be
+# met: http://www.gnu.org/copyleft/gpl-3.0.html.
+#
+# For further information, please contact us at sharemind@cyber.ee.
+#
+
+
+# Evaluates programs with and without optimizations under sca --profile and
+# checks that loop-invariant code motion has moved instructions out of their
+# loops, so that the optimized program executes fewer instructions. Invoked by
+# the "optimizer/licm" test with SCA set to the analyzer binary, CORPUS set to
+# the regression test directory and WORKDIR set to a scratch directory.
+
+FILE(REMOVE_RECURSE "${WORKDIR}")
+FILE(MAKE_DIRECTORY "${WORKDIR}")
+
+FUNCTION(executed PROGRAM RESULT_VAR)
+    STRING(REPLACE "/" "-" NAME "${PROGRAM}")
+    SET(REPORT "${WORKDIR}/${NAME}-${RESULT_VAR}.txt")
+    EXECUTE_PROCESS(COMMAND "${SCA}" ${ARGN} --verbose --profile "${REPORT}" "${CORPUS}/${PROGRAM}.sc"
+                    RESULT_VARIABLE RESULT
+                    ERROR_VARIABLE ERRORS)
+    IF(NOT RESULT EQUAL 0)
+        MESSAGE(FATAL_ERROR "Evaluating ${PROGRAM} ${ARGN} failed:\n${ERRORS}")
+    ENDIF()
+
+    FILE(READ "${REPORT}" report)
+    IF(NOT report MATCHES "Executed ([0-9]+) instructions")
+        MESSAGE(FATAL_ERROR "No instruction count in the profile of ${PROGRAM}:\n${report}")
+    ENDIF()
+
+    SET(${RESULT_VAR} "${CMAKE_MATCH_1}" PARENT_SCOPE)
+    SET(log "${ERRORS}" PARENT_SCOPE)
+ENDFUNCTION()
+
+FUNCTION(expect_fewer PROGRAM)
+    executed("${PROGRAM}" plain)
+    executed("${PROGRAM}" optimized --optimize)
+    IF(NOT log MATCHES "Loop-invariant code motion: [1-9][0-9]* instructions hoisted")
+        MESSAGE(FATAL_ERROR "Nothing was hoisted out of the loops of ${PROGRAM}:\n${log}")
+    ENDIF()
+
+    IF(NOT optimized LESS plain)
+        MESSAGE(FATAL_ERROR "Optimized ${PROGRAM} executed ${optimized} instructions, "
+                            "unoptimized ${plain}.")
+    ENDIF()
+
+    MESSAGE(STATUS "${PROGRAM}: ${plain} -> ${optimized} instructions executed")
+ENDFUNCTION()
+
+expect_fewer("optimizer/01-licm-nested-slices")
+expect_fewer("arrays/15-index-assing-slice-2d")
@@ -0,0 +1,89 @@
+#
+# Copyright (C) 2015 Cybernetica
+#
+# Research/Commercial License Usage
+# Licensees holding a valid Research License or Commercial License
+# for the Software may use this file according to the written
+# agreement between you and Cybernetica.
+#
+# GNU General Public License Usage
+# Alternatively, this file may be used under the terms of the GNU
+# General Public License version 3.0 as published by the Free Software
+# Foundation and appearing in the file LICENSE.GPL included in the
+# packaging of this file.  Please review the following information to
+# ensure the GNU General Public License version 3.0 requirements will be
+# met: http://www.gnu.org/copyleft/gpl-3.0.html.
+#
+# For further information, please contact us at sharemind@cyber.ee.
+#
+
+
+# Compiles SOURCE with sca without a module cache, then with a cold and with a
+# warm cache in CACHE_DIR, and checks that all three produce the same
+# intermediate code and that the warm run loads its imports from the cache.
+# Finally truncates the cache entries and checks that they count as misses.
+# Invoked by the "module-cache/..." tests with SCA set to the analyzer binary
+# and MODULES set to the module search path.
+
+FILE(REMOVE_RECURSE "${CACHE_DIR}")
+
+FOREACH(MODE uncached cold warm)
+    IF(MODE STREQUAL "uncached")
+        SET(FLAGS "")
+    ELSE()
+        SET(FLAGS --module-cache "${CACHE_DIR}")
+    ENDIF()
+
+    EXECUTE_PROCESS(COMMAND "${SCA}" -v --no-stdlib -I "${MODULES}" ${FLAGS}
+                            --print-ir "${SOURCE}"
+                    RESULT_VARIABLE RESULT
+                    OUTPUT_VARIABLE IR_${MODE}
+                    ERROR_VARIABLE LOG_${MODE})
+    IF(NOT RESULT EQUAL 0)
+        MESSAGE(FATAL_ERROR "Compiling ${SOURCE} (${MODE}) failed:\n${LOG_${MODE}}")
+    ENDIF()
+ENDFOREACH()
+
+IF(NOT LOG_cold MATCHES "Module cache: 0 hits")
+    MESSAGE(FATAL_ERROR "Cold module cache was not empty:\n${LOG_cold}")
+ENDIF()
+
+IF(NOT LOG_warm MATCHES "Module cache: [1-9][0-9]* hits, 0 misses")
+    MESSAGE(FATAL_ERROR "Warm module cache was not used:\n${LOG_warm}")
+ENDIF()
+
+IF(NOT IR_cold STREQUAL IR_uncached OR NOT IR_warm STREQUAL IR_uncached)
+    MESSAGE(FATAL_ERROR "Module cache changed the intermediate code of ${SOURCE}.")
+ENDIF()
+
+EXECUTE_PROCESS(COMMAND "${SCA}" --no-stdlib -I "${MODULES}"
+                        --module-cache "${CACHE_DIR}" --eval "${SOURCE}"
+                RESULT_VARIABLE RESULT
+                ERROR_VARIABLE ERRORS)
+IF(NOT RESULT EQUAL 0)
+    MESSAGE(FATAL_ERROR "Evaluating ${SOURCE} with a warm cache failed:\n${ERRORS}")
+ENDIF()
+
+# Cut the entries inside the compiler version, past which their length points:
+FILE(GLOB ENTRIES "${CACHE_DIR}/*.ast")
+FOREACH(ENTRY ${ENTRIES})
+    EXECUTE_PROCESS(COMMAND head -c 14 "${ENTRY}" OUTPUT_FILE "${ENTRY}.cut")
+    FILE(RENAME "${ENTRY}.cut" "${ENTRY}")
+ENDFOREACH()
+
+EXECUTE_PROCESS(COMMAND "${SCA}" -v --no-stdlib -I "${MODULES}"
+                        --module-cache "${CACHE_DIR}" --print-ir "${SOURCE}"
+                RESULT_VARIABLE RESULT
+                OUTPUT_VARIABLE IR_truncated
+                ERROR_VARIABLE LOG_truncated)
+IF(NOT RESULT EQUAL 0)
+    MESSAGE(FATAL_ERROR "Compiling ${SOURCE} with a truncated cache failed:\n${LOG_truncated}")
+ENDIF()
+
+IF(NOT LOG_truncated MATCHES "Module cache: 0 hits, [1-9][0-9]* misses")
+    MESSAGE(FATAL_ERROR "Truncated module cache entries were used:\n${LOG_truncated}")
+ENDIF()
+
+IF(NOT IR_truncated STREQUAL IR_uncached)
+    MESSAGE(FATAL_ERROR "Truncated module cache changed the intermediate code of ${SOURCE}.")
+ENDIF()
@@ -0,0 +1,110 @@
+#
+# Copyright (C) 2015 Cybernetica
+#
+# Research/Commercial License Usage
+# Licensees holding a valid Research License or Commercial License
+# for the Software may use this file according to the written
+# agreement between you and Cybernetica.
+#
+# GNU General Public License Usage
+# Alternatively, this file may be used under the terms of the GNU
+# General Public License version 3.0 as published by the Free Software
+# Foundation and appearing in the file LICENSE.GPL included in the
+# packaging of this file.  Please review the following information to
+# ensure the GNU General Public License version 3.0 requirements will be
+# met: http://www.gnu.org/copyleft/gpl-3.0.html.
+#
+# For further information, please contact us at sharemind@cyber.ee.
+#
+
+# Compiles the peephole test program with scc -S and checks that none of the
+# patterns the peephole optimizer rewrites are left in the assembly: jumps on
+# constants, jumps to blocks that only jump and jumps to the following block.
+# Invoked by the "codegen/00-peephole-asm" test with SCC set to the compiler
+# binary, CORPUS set to the regression test directory and WORKDIR set to a
+# scratch directory.
+
+FILE(REMOVE_RECURSE "${WORKDIR}")
+FILE(MAKE_DIRECTORY "${WORKDIR}")
+
+SET(ASM "${WORKDIR}/peephole.s")
+EXECUTE_PROCESS(COMMAND "${SCC}" --no-stdlib -S -o "${ASM}"
+                        "${CORPUS}/codegen/00-peephole.sc"
+                RESULT_VARIABLE RESULT
+                ERROR_VARIABLE ERRORS)
+IF(NOT RESULT EQUAL 0)
+    MESSAGE(FATAL_ERROR "Compiling the program failed:\n${ERRORS}")
+ENDIF()
+
+# Blank lines between the blocks are dropped, comments are not code:
+FILE(STRINGS "${ASM}" lines)
+SET(code "")
+FOREACH(line ${lines})
+    IF(NOT line MATCHES "^#")
+        LIST(APPEND code "${line}")
+    ENDIF()
+ENDFOREACH()
+
+SET(VALUE "(reg|stack) 0x[0-9a-f]+")
+SET(JUMP "^(jmp|jz|jnz) imm (:[A-Za-z0-9_]+)")
+
+# Labels of the blocks that consist of a single jump:
+SET(jumpOnly "")
+SET(label "")
+FOREACH(line ${code})
+    IF(label AND line MATCHES "^jmp imm :")
+        SET(candidate "${label}")
+    ELSE()
+        IF(candidate AND line MATCHES "^:")
+            LIST(APPEND jumpOnly "${candidate}")
+        ENDIF()
+        SET(candidate "")
+    ENDIF()
+
+    IF(line MATCHES "^(:[A-Za-z0-9_]+)$")
+        SET(label "${CMAKE_MATCH_1}")
+    ELSE()
+        SET(label "")
+    ENDIF()
+ENDFOREACH()
+
+LIST(LENGTH code count)
+MATH(EXPR last "${count} - 1")
+FOREACH(i RANGE ${last})
+    LIST(GET code ${i} line)
+    MATH(EXPR n "${i} + 1")
+    SET(next "")
+    IF(n LESS count)
+        LIST(GET code ${n} next)
+    ENDIF()
+
+    # mov imm C T; jnz L type T
+    IF(line MATCHES "^mov imm 0x[0-9a-f]+ (${VALUE})$")
+        SET(temporary "${CMAKE_MATCH_1}")
+        IF(next MATCHES "^j(n)?z imm :[A-Za-z0-9_]+ [a-z0-9]+ ${temporary}$")
+            MESSAGE(FATAL_ERROR "Jump on a constant left in the assembly:\n${line}\n${next}")
+        ENDIF()
+    ENDIF()
+
+    IF(NOT line MATCHES "${JUMP}")
+        CONTINUE()
+    ENDIF()
+
+    SET(target "${CMAKE_MATCH_2}")
+    LIST(FIND jumpOnly "${target}" found)
+    IF(NOT found EQUAL -1)
+        MESSAGE(FATAL_ERROR "Jump to a block that only jumps left in the assembly:\n${line}")
+    ENDIF()
+
+    # Only labels between the jump and its target:
+    WHILE(n LESS count)
+        LIST(GET code ${n} next)
+        IF(NOT next MATCHES "^:[A-Za-z0-9_]+$")
+            BREAK()
+        ENDIF()
+        IF(next STREQUAL target)
+            MESSAGE(FATAL_ERROR "Jump to the following block left in the assembly:\n${line}")
+        ENDIF()
+        MATH(EXPR n "${n} + 1")
+    ENDWHILE()
+ENDFOREACH()
@@ -0,0 +1,67 @@
+#
+# Copyright (C) 2015 Cybernetica
+#
+# Research/Commercial License Usage
+# Licensees holding a valid Research License or Commercial License
+# for the Software may use this file according to the written
+# agreement between you and Cybernetica.
+#
+# GNU General Public License Usage
+# Alternatively, this file may be used under the terms of the GNU
+# General Public License version 3.0 as published by the Free Software
+# Foundation and appearing in the file LICENSE.GPL included in the
+# packaging of this file.  Please review the following information to
+# ensure the GNU General Public License version 3.0 requirements will be
+# met: http://www.gnu.org/copyleft/gpl-3.0.html.
+#
+# For further information, please contact us at sharemind@cyber.ee.
+#
+
+
+# Evaluates programs with sca --profile and checks that the hot-spot report and
+# the collapsed call stacks are written. Invoked by the "profile/sca" test with
+# SCA set to the analyzer binary, CORPUS set to the regression test directory
+# and WORKDIR set to a scratch directory.
+
+FILE(REMOVE_RECURSE "${WORKDIR}")
+FILE(MAKE_DIRECTORY "${WORKDIR}")
+
+FUNCTION(profile PROGRAM)
+    STRING(REPLACE "/" "-" NAME "${PROGRAM}")
+    SET(REPORT "${WORKDIR}/${NAME}.txt")
+    EXECUTE_PROCESS(COMMAND "${SCA}" --profile "${REPORT}" "${CORPUS}/${PROGRAM}.sc"
+                    RESULT_VARIABLE RESULT
+                    ERROR_VARIABLE ERRORS)
+    IF(NOT RESULT EQUAL 0)
+        MESSAGE(FATAL_ERROR "Profiling ${PROGRAM} failed:\n${ERRORS}")
+    ENDIF()
+
+    FILE(READ "${REPORT}" report)
+    FILE(READ "${REPORT}.folded" stacks)
+    SET(report "${report}" PARENT_SCOPE)
+    SET(stacks "${stacks}" PARENT_SCOPE)
+ENDFUNCTION()
+
+FUNCTION(expect TEXT PATTERN WHAT)
+    IF(NOT TEXT MATCHES "${PATTERN}")
+        MESSAGE(FATAL_ERROR "The profile ${WHAT} does not match \"${PATTERN}\":\n${TEXT}")
+    ENDIF()
+ENDFUNCTION()
+
+# Tables with more rows than fit the report only show the top ones:
+SET(TOP "( \\(top [0-9]+ of [0-9]+\\))?:\n")
+
+# Calls of a procedure in a loop:
+profile("scalars/87-call-loop-bench")
+expect("${report}" "\nInstructions${TOP}" "report")
+expect("${report}" "\nProcedures \\(self time\\)${TOP}" "report")
+expect("${report}" "\nSource locations${TOP}" "report")
+expect("${report}" "  step\\(int(64)?, int(64)?\\)\n" "report")
+expect("${report}" "87-call-loop-bench.sc:[0-9]+\n" "report")
+expect("${stacks}" "(^|\n)<entry>;main\\(\\) [0-9]+\n" "stack file")
+expect("${stacks}" "\n<entry>;main\\(\\);step\\(int(64)?, int(64)?\\) [0-9]+\n" "stack file")
+
+# Vectorized instructions count the elements they process:
+profile("arrays/02-expression")
+expect("${report}" "processed [1-9][0-9]* elements" "report")
+expect("${report}" " [1-9][0-9]*  ADD\n" "report")
@@ -0,0 +1,61 @@
+#
+# Copyright (C) 2015 Cybernetica
+#
+# Research/Commercial License Usage
+# Licensees holding a valid Research License or Commercial License
+# for the Software may use this file according to the written
+# agreement between you and Cybernetica.
+#
+# GNU General Public License Usage
+# Alternatively, this file may be used under the terms of the GNU
+# General Public License version 3.0 as published by the Free Software
+# Foundation and appearing in the file LICENSE.GPL included in the
+# packaging of this file.  Please review the following information to
+# ensure the GNU General Public License version 3.0 requirements will be
+# met: http://www.gnu.org/copyleft/gpl-3.0.html.
+#
+# For further information, please contact us at sharemind@cyber.ee.
+#
+
+
+# Evaluates a program that makes system calls with sca --syscall-report and
+# checks the estimated costs in the report. Invoked by the "syscalls/report"
+# test with SCA set to the analyzer binary, CORPUS set to the regression test
+# directory and WORKDIR set to a scratch directory.
+
+FILE(REMOVE_RECURSE "${WORKDIR}")
+FILE(MAKE_DIRECTORY "${WORKDIR}")
+
+SET(REPORT "${WORKDIR}/report.txt")
+EXECUTE_PROCESS(COMMAND "${SCA}"
+                        --syscall-costs "${CORPUS}/syscalls/shared3p-costs.txt"
+                        --syscall-report "${REPORT}"
+                        "${CORPUS}/syscalls/00-shared3p-vec.sc"
+                RESULT_VARIABLE RESULT
+                ERROR_VARIABLE ERRORS)
+IF(NOT RESULT EQUAL 0)
+    MESSAGE(FATAL_ERROR "Evaluating the program failed:\n${ERRORS}")
+ENDIF()
+
+FILE(READ "${REPORT}" report)
+
+FUNCTION(expect PATTERN)
+    IF(NOT report MATCHES "${PATTERN}")
+        MESSAGE(FATAL_ERROR "The system call report does not match \"${PATTERN}\":\n${report}")
+    ENDIF()
+ENDFUNCTION()
+
+# Two multiplications of 4 elements, and a comparison, a sum and a
+# declassification of 4 elements each:
+expect("^Made 5 system calls on 20 elements, estimated to take 10 rounds and 832 bytes.\n")
+expect("\n +2 +384 +2 +8  shared3p::mul_int64_vec\n")
+expect("\n +7 +416 +1 +4  shared3p::lt_int64_vec\n")
+expect("\n +1 +32 +1 +4  shared3p::declassify_int64_vec\n")
+expect("\n +0 +0 +1 +4  shared3p::sum_int64_vec\n")
+
+# Procedures and source lines include the calls made by their callees:
+expect("\n +10 +832 +5 +20  main\\(\\)\n")
+expect("\n +1 +192 +2 +8  dot\\([^\n]*\\)\n")
+expect("\n +1 +192 +2 +8  [^\n]*00-shared3p-vec.sc:51\n")
+
+expect("No cost is known for:\n  shared3p::sum_int64_vec\n")
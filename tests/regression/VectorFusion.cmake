@@ -0,0 +1,69 @@
+#
+# Copyright (C) 2015 Cybernetica
+#
+# Research/Commercial License Usage
+# Licensees holding a valid Research License or Commercial License
+# for the Software may use this file according to the written
+# agreement between you and Cybernetica.
+#
+# GNU General Public License Usage
+# Alternatively, this file may be used under the terms of the GNU
+# General Public License version 3.0 as published by the Free Software
+# Foundation and appearing in the file LICENSE.GPL included in the
+# packaging of this file.  Please review the following information to
+# ensure the GNU General Public License version 3.0 requirements will be
+# met: http://www.gnu.org/copyleft/gpl-3.0.html.
+#
+# For further information, please contact us at sharemind@cyber.ee.
+#
+
+# Compiles the vector fusion test program with scc -S and checks the body of
+# the loop fused from the affine map "a * x + b" of int64 vectors. The scalars
+# a and b are used from the arguments, only x is loaded. Invoked by the
+# "codegen/01-vector-fusion-asm" test with SCC set to the compiler binary,
+# CORPUS set to the regression test directory and WORKDIR set to a scratch
+# directory.
+
+FILE(REMOVE_RECURSE "${WORKDIR}")
+FILE(MAKE_DIRECTORY "${WORKDIR}")
+
+SET(ASM "${WORKDIR}/vector-fusion.s")
+EXECUTE_PROCESS(COMMAND "${SCC}" --no-stdlib -S -o "${ASM}"
+                        "${CORPUS}/codegen/01-vector-fusion.sc"
+                RESULT_VARIABLE RESULT
+                ERROR_VARIABLE ERRORS)
+IF(NOT RESULT EQUAL 0)
+    MESSAGE(FATAL_ERROR "Compiling the program failed:\n${ERRORS}")
+ENDIF()
+
+FILE(READ "${ASM}" asm)
+
+# Stack: 0 destination, 1 a, 2 x, 3 b, 4 size, 5 counter, 6 offset, 7 element
+# of x, 8 a * x, 9 a * x + b.
+SET(FUSED
+":fused_vec_[0-9]+
+resizestack 0xa
+mov imm 0x0 stack 0x5
+mov imm 0x0 stack 0x6
+
+(:back_[0-9]+)
+jge imm (:out_[0-9]+) uint64 stack 0x5 stack 0x4
+mov mem stack 0x2 stack 0x6 stack 0x7 imm 0x8
+tmul int64 stack 0x8 stack 0x1 stack 0x7
+tadd int64 stack 0x9 stack 0x8 stack 0x3
+mov stack 0x9 mem stack 0x0 stack 0x6 imm 0x8
+badd uint64 stack 0x6 imm 0x8
+uinc uint64 stack 0x5
+jmp imm (:back_[0-9]+)
+
+(:out_[0-9]+)
+return imm 0x0
+")
+
+IF(NOT asm MATCHES "${FUSED}")
+    MESSAGE(FATAL_ERROR "No fused loop for \"a * x + b\" in the assembly:\n${asm}")
+ENDIF()
+
+IF(NOT CMAKE_MATCH_1 STREQUAL CMAKE_MATCH_3 OR NOT CMAKE_MATCH_2 STREQUAL CMAKE_MATCH_4)
+    MESSAGE(FATAL_ERROR "The fused loop for \"a * x + b\" jumps to the wrong blocks:\n${CMAKE_MATCH_0}")
+ENDIF()
@@ -0,0 +1,44 @@
+kind additive3pp {
+    type uint { public = uint };
+}
+
+domain pd additive3pp;
+
+template <dim N>
+bool all (bool [[N]] arr) {
+    uint n = size (arr);
+    bool [[1]] flat = reshape (arr, n);
+    for (uint i = 0; i < n; ++ i)
+        if (!flat[i])
+            return false;
+    return true;
+}
+
+void main () {
+    uint [[2]] pub (4, 5);
+    for (uint i = 0; i < 4; ++ i)
+        for (uint j = 0; j < 5; ++ j)
+            pub[i, j] = 5 * i + j;
+
+    pd uint [[2]] arr = pub;
+
+    // Slices are loaded with GATHER:
+    assert (all (declassify (arr[1:3, 2:4]) == pub[1:3, 2:4]));
+    assert (all (declassify (arr[:, 3]) == pub[:, 3]));
+    assert (size (arr[2:2, :]) == 0);
+
+    // and stored with SCATTER:
+    pd uint [[1]] col (4) = 7;
+    arr[:, 1] = col;
+    pub[:, 1] = 7;
+    assert (all (declassify (arr) == pub));
+
+    pd uint x = 9;
+    arr[0:2, 3:5] = x;
+    pub[0:2, 3:5] = 9;
+    assert (all (declassify (arr) == pub));
+
+    // Concatenation scatters both arguments:
+    assert (all (declassify (cat (arr, arr[1:3, :])) == cat (pub, pub[1:3, :])));
+    assert (all (declassify (cat (arr, arr[:, 0:2], 1)) == cat (pub, pub[:, 0:2], 1)));
+}
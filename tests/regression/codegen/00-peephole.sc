@@ -0,0 +1,34 @@
+// Control flow that leaves jumps on constants, jumps to jumps and jumps to
+// the following block in the generated code.
+
+int collatzSteps (int n) {
+    int steps = 0;
+    while (n != 1) {
+        if (n % 2 == 0) {
+            n = n / 2;
+        } else {
+            n = 3 * n + 1;
+        }
+
+        steps += 1;
+    }
+
+    return steps;
+}
+
+void main () {
+    int x = 0;
+    if (true) {
+        x = 1;
+    } else {
+        x = 2;
+    }
+
+    while (false) {
+        x = 3;
+    }
+
+    assert (x == 1);
+    assert (collatzSteps (6) == 8);
+    assert (collatzSteps (27) == 111);
+}
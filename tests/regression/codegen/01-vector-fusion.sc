@@ -0,0 +1,31 @@
+// Chains of public vector operations whose intermediate results are only
+// used by the next operation, with scalars broadcast to vectors.
+
+int64[[1]] affine (int64[[1]] x, int64 a, int64 b) {
+    return a * x + b;
+}
+
+void main () {
+    int64[[1]] x (5) = 3;
+    x[1] = 1;
+    x[4] = -2;
+
+    int64[[1]] y = affine (x, 2, 1);
+    assert (y[0] == 7 && y[1] == 3 && y[4] == -3);
+
+    int64[[1]] z = -(x * x + 1) * 2;
+    assert (z[0] == -20 && z[1] == -4 && z[4] == -10);
+
+    bool[[1]] b = !(x * 2 > 5);
+    assert (!b[0] && b[1] && b[4]);
+
+    uint32[[1]] u (3) = 5;
+    uint32[[1]] w = u * 4 + u - 1;
+    assert (w[0] == 24 && w[2] == 24);
+
+    for (uint i = 0; i < 3; ++i) {
+        x = x * 2 + 1;
+    }
+
+    assert (x[0] == 31 && x[1] == 15 && x[4] == -9);
+}
@@ -0,0 +1,23 @@
+// Procedures on known lines, for the map from the generated code back to the
+// source. Checked by DebugMap.cmake.
+
+int square (int x) {
+    return x * x;
+}
+
+int sumOfSquares (int n) {
+    int sum = 0;
+    for (int i = 0; i < n; ++ i) {
+        sum += square (i);
+    }
+
+    return sum;
+}
+
+void main () {
+    assert (sumOfSquares (4) == 14);
+    int64 first = 1589887198;
+    int64 between = first * 3 + sumOfSquares (2);
+    int64 second = 1589886703;
+    assert (first - second == 495 && between == 4769661595);
+}
@@ -0,0 +1,18 @@
+import cachedmod;
+
+void main () {
+    point p = make_point (1, 2);
+    assert (p.x == 1 && p.y == 2);
+
+    pd int a = 21;
+    assert (declassify (twice (a)) == 42);
+    assert (declassify (a * 2) == 43);
+    assert (declassify ((uint8) a) == 7);
+
+    int[[1]] v = {1, 2, 3};
+    assert (twice (v)[2] == 6);
+
+    assert (half (5.0) == 2.0);
+    assert (greeting ("world") == "hello, world!");
+    assert (is_small (2) && !is_small (3));
+}
@@ -0,0 +1,47 @@
+module cachedmod;
+
+kind additive3pp {
+    type int { public = int };
+    type uint8 { public = uint8 };
+}
+
+domain pd additive3pp;
+
+struct point {
+    int x;
+    int y;
+}
+
+point make_point (int x, int y) {
+    point p;
+    p.x = x;
+    p.y = y;
+    return p;
+}
+
+template <domain D, type T, dim N>
+D T[[N]] twice (D T[[N]] x) {
+    return x + x;
+}
+
+template <domain D : additive3pp>
+D int operator * (D int x, int y) {
+    return declassify (x) * y + 1;
+}
+
+pd uint8 cast (pd int x) {
+    pd uint8 r = 7;
+    return r;
+}
+
+float64 half (float64 x) {
+    return x / 2.5;
+}
+
+string greeting (string name) {
+    return "hello, " + name + "!";
+}
+
+bool is_small (uint64 x) {
+    return x < 0x10 && !(x == 3);
+}
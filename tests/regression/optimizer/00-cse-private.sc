@@ -0,0 +1,21 @@
+kind shared3p {
+    type int { public = int };
+}
+
+domain pd_shared3p shared3p;
+
+void main () {
+    int[[1]] a = {1, 2, 3, 4};
+    pd_shared3p int[[1]] x = a;
+    pd_shared3p int[[1]] y = a;
+
+    pd_shared3p int[[1]] p (4);
+    pd_shared3p int[[1]] q (4);
+    __syscall ("shared3p::mul_int64_vec", __domainid (pd_shared3p), x, y, __pure p);
+    __syscall ("shared3p::mul_int64_vec", __domainid (pd_shared3p), x, y, __pure q);
+
+    int[[1]] r = declassify (p);
+    int[[1]] s = declassify (q);
+    assert (r[0] == 1 && r[1] == 4 && r[2] == 9 && r[3] == 16);
+    assert (s[0] == 1 && s[1] == 4 && s[2] == 9 && s[3] == 16);
+}
@@ -0,0 +1,31 @@
+kind additive3pp {
+    type uint { public = uint };
+}
+
+domain pd additive3pp;
+
+void main () {
+    uint n = 12;
+    uint [[2]] a (n, n);
+    for (uint i = 0; i < n; ++ i) {
+        for (uint j = 0; j < n; ++ j) {
+            a[i, j] = i * n + j;
+        }
+    }
+
+    // Nested loops generated for the slice:
+    uint [[2]] b = a[2:10, 3:9];
+    assert (shape (b)[0] == 8 && shape (b)[1] == 6);
+    assert (b[0, 0] == 27);
+    assert (b[7, 5] == 116);
+
+    // Classification of a value that does not change in the loop:
+    uint k = 5;
+    uint sum = 0;
+    for (uint i = 0; i < n; ++ i) {
+        pd uint pk = k;
+        sum = sum + declassify (pk);
+    }
+
+    assert (sum == 60);
+}
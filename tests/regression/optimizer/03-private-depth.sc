@@ -0,0 +1,24 @@
+kind shared3p {
+    type int { public = int };
+}
+
+domain pd_shared3p shared3p;
+
+pd_shared3p int poly (pd_shared3p int x, pd_shared3p int y) {
+    pd_shared3p int xy;
+    pd_shared3p int yy;
+    pd_shared3p int s;
+
+    // The products are independent, only the sum depends on them:
+    __syscall ("shared3p::mul_int64_vec", __domainid (pd_shared3p), x, y, __pure xy);
+    __syscall ("shared3p::mul_int64_vec", __domainid (pd_shared3p), y, y, __pure yy);
+    __syscall ("shared3p::add_int64_vec", __domainid (pd_shared3p), xy, yy, __pure s);
+    return s;
+}
+
+void main () {
+    pd_shared3p int a = 3;
+    pd_shared3p int b = 4;
+    assert (declassify (poly (a, b)) == 28);
+    print ("Scheduled program computed the expected value.");
+}
@@ -0,0 +1,39 @@
+kind shared3p {
+    type int { public = int };
+}
+
+domain pd_shared3p shared3p;
+
+// The division is invariant but must not be moved above the return that
+// guards it:
+int sumOfQuotients (int a, int b, uint n) {
+    int sum = 0;
+    for (uint i = 0; i < n; ++ i) {
+        if (b == 0)
+            return -1;
+        sum = sum + a / b;
+    }
+
+    return sum;
+}
+
+// The classified temporary is released when the loop is left by returning:
+int firstAbove (int k, int limit, uint n) {
+    for (uint i = 0; i < n; ++ i) {
+        pd_shared3p int pk = k;
+        if (declassify (pk) + (int) i > limit)
+            return (int) i;
+    }
+
+    return -1;
+}
+
+void main () {
+    // Not known to the constant folding:
+    pd_shared3p int zero = 0;
+    int b = declassify (zero);
+    assert (sumOfQuotients (7, b, 3) == -1);
+    assert (sumOfQuotients (7, b + 2, 3) == 9);
+    assert (firstAbove (5, 7, 10) == 3);
+    assert (firstAbove (5, 70, 10) == -1);
+}
@@ -0,0 +1,25 @@
+kind shared3p {
+    type int { public = int };
+}
+
+domain pd_shared3p shared3p;
+
+// The division is invariant but must not be moved above the assertion that
+// guards it, the assertion has to fail first:
+int sumOfQuotients (int a, int b, uint n) {
+    int sum = 0;
+    for (uint i = 0; i < n; ++ i) {
+        assert (b != 0);
+        sum = sum + a / b;
+    }
+
+    return sum;
+}
+
+void main () {
+    // Not known to the constant folding:
+    pd_shared3p int zero = 0;
+    int b = declassify (zero);
+    assert (sumOfQuotients (7, b + 2, 3) == 9);
+    sumOfQuotients (7, b, 3);
+}
@@ -0,0 +1,30 @@
+int x = 1;
+
+int f (int y) { return 1; }
+int f (bool y) { return 2; }
+
+int g () { return x; }
+
+void main () {
+    assert (x == 1);
+    int x = 2;
+    assert (x == 2);
+    {
+        assert (x == 2);
+        int x = 3;
+        {
+            int x = 4;
+            assert (x == 4);
+        }
+        assert (x == 3);
+    }
+    assert (x == 2);
+    assert (g () == 1);
+    assert (f (x) == 1);
+    assert (f (true) == 2);
+    for (int i = 0; i < 10; ++ i) {
+        int x = i;
+        assert (x == i);
+    }
+    assert (x == 2);
+}
@@ -0,0 +1,15 @@
+int step (int acc, int i) {
+  int t = acc + i;
+  if (t > 1000000) t = t - 1000000;
+  return t;
+}
+
+void main () {
+  int acc = 0;
+  int i = 0;
+  while (i < 20000) {
+    acc = step (acc, i);
+    i = i + 1;
+  }
+  assert (acc == 990000);
+}
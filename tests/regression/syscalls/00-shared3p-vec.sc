@@ -0,0 +1,55 @@
+kind shared3p {
+    type bool { public = bool };
+    type int { public = int };
+}
+
+domain pd_shared3p shared3p;
+
+template <domain D : shared3p>
+D int[[1]] mul (D int[[1]] x, D int[[1]] y) {
+    D int[[1]] out (size (x));
+    __syscall ("shared3p::mul_int64_vec", __domainid (D), x, y, out);
+    return out;
+}
+
+template <domain D : shared3p>
+D bool[[1]] lt (D int[[1]] x, D int[[1]] y) {
+    D bool[[1]] out (size (x));
+    __syscall ("shared3p::lt_int64_vec", __domainid (D), x, y, out);
+    return out;
+}
+
+template <domain D : shared3p>
+D int sum (D int[[1]] x) {
+    D int out;
+    __syscall ("shared3p::sum_int64_vec", __domainid (D), x, out);
+    return out;
+}
+
+template <domain D : shared3p>
+int[[1]] declassifyVec (D int[[1]] x) {
+    int[[1]] out (size (x));
+    __syscall ("shared3p::declassify_int64_vec", __domainid (D), x, __ref out);
+    return out;
+}
+
+template <domain D : shared3p>
+D int dot (D int[[1]] x, D int[[1]] y) {
+    return sum (mul (x, y));
+}
+
+void main () {
+    int[[1]] a = {1, 2, 3, 4};
+    int[[1]] b = {5, 6, 7, 8};
+    pd_shared3p int[[1]] x = a;
+    pd_shared3p int[[1]] y = b;
+
+    int[[1]] p = declassifyVec (mul (x, y));
+    assert (size (p) == 4);
+    assert (p[0] == 5 && p[1] == 12 && p[2] == 21 && p[3] == 32);
+
+    assert (declassify (dot (x, y)) == 70);
+
+    bool[[1]] c = declassify (lt (x, y));
+    assert (c[0] && c[1] && c[2] && c[3]);
+}
@@ -0,0 +1,10 @@
+kind shared3p {
+    type int { public = int };
+}
+
+domain pd_shared3p shared3p;
+
+void main () {
+    pd_shared3p int[[1]] x (4) = 1;
+    __syscall ("shared3p::shuffle_int64_vec", __domainid (pd_shared3p), x);
+}
@@ -0,0 +1,41 @@
+kind shared3p {
+    type int { public = int };
+}
+
+domain pd_shared3p shared3p;
+
+template <domain D : shared3p>
+D int[[1]] div (D int[[1]] x, D int[[1]] y) {
+    D int[[1]] out (size (x));
+    __syscall ("shared3p::div_int64_vec", __domainid (D), x, y, out);
+    return out;
+}
+
+template <domain D : shared3p>
+D int[[1]] mod (D int[[1]] x, D int[[1]] y) {
+    D int[[1]] out (size (x));
+    __syscall ("shared3p::mod_int64_vec", __domainid (D), x, y, out);
+    return out;
+}
+
+template <domain D : shared3p>
+int[[1]] declassifyVec (D int[[1]] x) {
+    int[[1]] out (size (x));
+    __syscall ("shared3p::declassify_int64_vec", __domainid (D), x, __ref out);
+    return out;
+}
+
+// The smallest int64 divided by -1 wraps around instead of trapping:
+void main () {
+    int min = -9223372036854775807 - 1;
+    int[[1]] a = {min, min, 7};
+    int[[1]] b = {-1, 1, -1};
+    pd_shared3p int[[1]] x = a;
+    pd_shared3p int[[1]] y = b;
+
+    int[[1]] q = declassifyVec (div (x, y));
+    assert (q[0] == min && q[1] == min && q[2] == -7);
+
+    int[[1]] r = declassifyVec (mod (x, y));
+    assert (r[0] == 0 && r[1] == 0 && r[2] == 0);
+}
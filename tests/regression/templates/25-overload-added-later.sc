@@ -0,0 +1,25 @@
+template <domain D>
+int f (D int x) {
+    return 1;
+}
+
+int g () {
+    return f (0);
+}
+
+int f (int x) {
+    return 2;
+}
+
+int h () {
+    return f (0);
+}
+
+void main () {
+    assert (g () == 1);
+    assert (h () == 2);
+    for (uint i = 0; i < 10; ++ i) {
+        assert (f (0) == 2);
+        assert (g () + h () == 3);
+    }
+}
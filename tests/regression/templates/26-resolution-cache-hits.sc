@@ -0,0 +1,23 @@
+// Declarations of other names between the calls must not drop the cached
+// resolutions of "twice".
+
+template <domain D>
+D int twice (D int x) {
+    return x + x;
+}
+
+int a () {
+    return twice (1);
+}
+
+int b (int x) {
+    return x;
+}
+
+int c () {
+    return twice (2) + b (twice (3));
+}
+
+void main () {
+    assert (a () + c () == 12);
+}